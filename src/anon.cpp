@@ -20,6 +20,7 @@
 #include <consensus/validation.h>
 #include <chainparams.h>
 #include <txmempool.h>
+#include <proofcache.h>
 #include "adapter.h"
 
 
@@ -97,8 +98,10 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
         vpInputSplitCommits.reserve(tx.vin.size());
     }
     uint256 txhash = tx.GetHash();
+    const uint256 &wtxid = tx.GetWitnessHash();
 
-    for (const auto &txin : tx.vin) {
+    for (uint32_t n = 0; n < tx.vin.size(); ++n) {
+        const auto &txin = tx.vin[n];
         if (!txin.IsAnonInput()) {
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-anon-input");
         }
@@ -217,12 +220,23 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
             LogPrintf("ERROR: %s: prepare-mlsag-failed %d\n", __func__, rv);
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "prepare-mlsag-failed");
         }
+
+        // vM now holds the ring pubkeys and the commitment sums, the key images
+        // and signature are committed to by the wtxid.
+        uint256 cache_entry;
+        ComputeMLSAGCacheEntry(cache_entry, wtxid, n, vM);
+        if (ProofCacheGet(cache_entry, state.m_erase_cached_proofs)) {
+            continue;
+        }
         if (0 != (rv = secp256k1_verify_mlsag(secp256k1_ctx_blind,
             txhash.begin(), nCols, nRows,
             &vM[0], &vKeyImages[0], &vDL[0], &vDL[32]))) {
             LogPrintf("ERROR: %s: verify-mlsag-failed %d\n", __func__, rv);
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "verify-mlsag-failed");
         }
+        if (!state.m_in_block) {
+            ProofCacheSet(cache_entry);
+        }
     }
 
     // Verify commitment sums match
@@ -438,7 +452,10 @@ bool RewindRangeProof(const std::vector<uint8_t> &rangeproof, const std::vector<
         return false;
     }
     memcpy(&commitment_type.data[0], commitment.data(), 33);
-    return (1 == secp256k1_bulletproof_rangeproof_rewind(secp256k1_ctx_blind, blind_gens,
-            (uint64_t*) &value_out, blind_out.data(), rangeproof.data(), rangeproof.size(),
-            0, &commitment_type, &secp256k1_generator_const_h, nonce.begin(), nullptr, 0));
+    uint64_t value;
+    if (!RewindBulletproof(rangeproof, &commitment_type, nonce, value, blind_out.data())) {
+        return false;
+    }
+    value_out = (CAmount)value;
+    return true;
 };
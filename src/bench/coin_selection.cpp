@@ -114,5 +114,32 @@ static void BnBExhaustion(benchmark::Bench& bench)
     });
 }
 
+static void BnBRingManySmallCoins(benchmark::Bench& bench)
+{
+    // Anon wallet holding many small coins, inputs are signed in groups of three
+    FastRandomContext rng(true);
+    std::vector<CAmount> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(COIN / 100 + rng.randrange(COIN / 10));
+    }
+    for (int i = 0; i < 10; ++i) {
+        values.push_back(COIN + rng.randrange(COIN));
+    }
+
+    RingCoinSelectionParams params;
+    params.input_fee = 2000;
+    params.sig_fee = 6000;
+    params.inputs_per_sig = 3;
+    params.not_input_fees = 4000;
+    params.cost_of_change = 20000;
+    std::vector<size_t> selection;
+    CAmount value_ret = 0;
+
+    bench.run([&] {
+        SelectCoinsBnBRing(values, 3 * COIN, params, selection, value_ret);
+    });
+}
+
 BENCHMARK(CoinSelection);
 BENCHMARK(BnBExhaustion);
+BENCHMARK(BnBRingManySmallCoins);
@@ -0,0 +1,210 @@
+// Copyright (c) 2017-2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <test/util/setup_common.h>
+
+#include <arith_uint256.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <consensus/validation.h>
+#include <key.h>
+#include <pos/kernel.h>
+#include <primitives/transaction.h>
+#include <script/sign.h>
+#include <script/signingprovider.h>
+#include <script/standard.h>
+#include <validation.h>
+
+#include "coldreward/coldrewardtracker.h"
+
+#include <string>
+#include <vector>
+
+// Number of addresses tracked for GVR, and the number touched per block
+static const int GVR_TRACKED_ADDRESSES = 5000;
+static const int GVR_ADDRESSES_PER_BLOCK = 200;
+
+static ColdRewardTracker::AddressType BenchGvrAddress(int n)
+{
+    std::string s = "gvr-bench-address-" + std::to_string(n);
+    return ColdRewardTracker::AddressType(s.begin(), s.end());
+}
+
+/** Fill the block tree db backed tracker with addresses above the GVR threshold. */
+static void PopulateRewardTracker(ColdRewardTracker &tracker, int height) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    const std::map<int, uint256> &checkpoints = Params().GetGvrCheckpoints();
+    tracker.startPersistedTransaction();
+    for (int i = 0; i < GVR_TRACKED_ADDRESSES; ++i) {
+        // Spread balances over a few reward multipliers
+        CAmount amount = tracker.GVRThreshold * (1 + i % 3) + i;
+        tracker.addAddressTransaction(height, BenchGvrAddress(i), amount, checkpoints);
+    }
+    tracker.endPersistedTransaction();
+    FlushRewardTracker(false);
+}
+
+// Per block cost of tracking GVR balances in ConnectBlock, and of undoing
+// them again in DisconnectBlock, written out per block as outside of IBD.
+static void GvrConnectDisconnectBlock(benchmark::Bench& bench)
+{
+    TestingSetup test_setup{CBaseChainParams::REGTEST, {}, true};
+
+    LOCK(cs_main);
+    ColdRewardTracker &tracker = initColdReward();
+    PopulateRewardTracker(tracker, 1);
+
+    const std::map<int, uint256> &checkpoints = Params().GetGvrCheckpoints();
+    std::vector<ColdRewardTracker::AddressType> block_addresses;
+    for (int i = 0; i < GVR_ADDRESSES_PER_BLOCK; ++i) {
+        block_addresses.push_back(BenchGvrAddress(i * (GVR_TRACKED_ADDRESSES / GVR_ADDRESSES_PER_BLOCK)));
+    }
+
+    const int height = 2;
+    const CAmount change = 10 * COIN;
+    bench.run([&] {
+        tracker.startPersistedTransaction();
+        for (const auto &addr : block_addresses) {
+            tracker.addAddressTransaction(height, addr, change, checkpoints);
+        }
+        tracker.endPersistedTransaction();
+        FlushRewardTracker(false);
+
+        tracker.startPersistedTransaction();
+        for (auto it = block_addresses.rbegin(); it != block_addresses.rend(); ++it) {
+            tracker.removeAddressTransaction(height, *it, change);
+        }
+        tracker.endPersistedTransaction();
+        FlushRewardTracker(false);
+    });
+
+    clearTrackedData();
+}
+
+// GVR payout verification, run for every proof of stake block after activation.
+static void GvrGetEligibleAddresses(benchmark::Bench& bench)
+{
+    TestingSetup test_setup{CBaseChainParams::REGTEST, {}, true};
+
+    LOCK(cs_main);
+    ColdRewardTracker &tracker = initColdReward();
+    PopulateRewardTracker(tracker, 1);
+
+    const int height = 2 + Params().GetConsensus().minRewardRangeSpan;
+    bench.run([&] {
+        std::vector<std::pair<ColdRewardTracker::AddressType, unsigned>> eligible = tracker.getEligibleAddresses(height);
+        assert(eligible.size() <= (size_t)GVR_TRACKED_ADDRESSES);
+    });
+
+    clearTrackedData();
+}
+
+static void CheckProofOfStakeBench(benchmark::Bench& bench)
+{
+    TestingSetup test_setup{CBaseChainParams::REGTEST, {}, true};
+
+    FillableSigningProvider keystore;
+    CKey key;
+    key.MakeNewKey(true);
+    keystore.AddKey(key);
+    CScript script = GetScriptForDestination(PKHash(key.GetPubKey()));
+
+    const CAmount stake_amount = 10000 * COIN;
+    const COutPoint kernel(GetRandHash(), 0);
+
+    LOCK(cs_main);
+    CBlockIndex *pindexPrev = ::ChainActive().Tip();
+    ::ChainstateActive().CoinsTip().AddCoin(kernel, Coin(CTxOut(stake_amount, script), pindexPrev->nHeight, false), false);
+
+    CMutableTransaction txn;
+    txn.nVersion = GHOST_TXN_VERSION;
+    txn.SetType(TXN_COINSTAKE);
+    txn.vin.push_back(CTxIn(kernel));
+
+    OUTPUT_PTR<CTxOutData> out0 = MAKE_OUTPUT<CTxOutData>();
+    out0->vData.resize(4);
+    uint32_t tmp = htole32(pindexPrev->nHeight + 1);
+    memcpy(&out0->vData[0], &tmp, 4);
+    txn.vpout.push_back(out0);
+
+    OUTPUT_PTR<CTxOutStandard> out1 = MAKE_OUTPUT<CTxOutStandard>();
+    out1->nValue = stake_amount + COIN;
+    out1->scriptPubKey = script;
+    txn.vpout.push_back(out1);
+
+    std::vector<uint8_t> vchAmount(8);
+    part::SetAmount(vchAmount, stake_amount);
+    SignatureData sigdata;
+    assert(ProduceSignature(keystore, MutableTransactionSignatureCreator(&txn, 0, vchAmount, SIGHASH_ALL), script, sigdata));
+    UpdateInput(txn.vin[0], sigdata);
+    const CTransaction tx(txn);
+
+    // Find a block time for which the kernel meets an easy target
+    const unsigned int nBits = UintToArith256(uint256S("00000000000000ffffffffffffffffffffffffffffffffffffffffffffffffff")).GetCompact();
+    uint256 hashProofOfStake, targetProofOfStake;
+    int64_t nTime = pindexPrev->GetBlockTime() + 16;
+    while (!CheckStakeKernelHash(pindexPrev, nBits, pindexPrev->GetBlockTime(), stake_amount, kernel, nTime,
+                                 hashProofOfStake, targetProofOfStake)) {
+        nTime += 16;
+    }
+
+    bench.run([&] {
+        BlockValidationState state;
+        bool rv = CheckProofOfStake(state, pindexPrev, tx, nTime, nBits, hashProofOfStake, targetProofOfStake);
+        assert(rv);
+    });
+}
+
+// Disconnect and reconnect the tip, a block spending mature coinbases, as the
+// invalidateblock and reconsiderblock RPCs do.
+static void ConnectDisconnectBlock(benchmark::Bench& bench)
+{
+    TestChain100Setup test_setup;
+    const CChainParams& chainparams = Params();
+
+    CScript scriptPubKey = CScript() << ToByteVector(test_setup.coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    std::vector<CMutableTransaction> spends(20);
+    // Mature the coinbases to spend
+    for (size_t i = 1; i < spends.size(); i++) {
+        test_setup.CreateAndProcessBlock({}, scriptPubKey);
+    }
+    for (size_t i = 0; i < spends.size(); i++) {
+        CMutableTransaction& tx = spends[i];
+        tx.nVersion = 1;
+        tx.vin.resize(1);
+        tx.vin[0].prevout.hash = test_setup.m_coinbase_txns[i]->GetHash();
+        tx.vin[0].prevout.n = 0;
+        tx.vout.resize(10);
+        for (auto& out : tx.vout) {
+            out.nValue = 1 * CENT;
+            out.scriptPubKey = scriptPubKey;
+        }
+
+        std::vector<unsigned char> vchSig;
+        std::vector<uint8_t> vchAmount(8);
+        part::SetAmount(vchAmount, 0);
+        uint256 hash = SignatureHash(scriptPubKey, tx, 0, SIGHASH_ALL, vchAmount, SigVersion::BASE);
+        assert(test_setup.coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        tx.vin[0].scriptSig << vchSig;
+    }
+    const CBlock block = test_setup.CreateAndProcessBlock(spends, scriptPubKey);
+    CBlockIndex *pindex = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    assert(pindex->GetBlockHash() == block.GetHash());
+
+    bench.run([&] {
+        BlockValidationState state;
+        bool rv = InvalidateBlock(state, chainparams, pindex);
+        assert(rv);
+        WITH_LOCK(cs_main, ResetBlockFailureFlags(pindex));
+        rv = ActivateBestChain(state, chainparams);
+        assert(rv && WITH_LOCK(cs_main, return ::ChainActive().Tip()) == pindex);
+    });
+}
+
+BENCHMARK(GvrConnectDisconnectBlock);
+BENCHMARK(GvrGetEligibleAddresses);
+BENCHMARK(CheckProofOfStakeBench);
+BENCHMARK(ConnectDisconnectBlock);
@@ -229,6 +229,56 @@ static void AddTx(benchmark::Bench& bench, const std::string from, const std::st
     ECC_Stop_Blinding();
 }
 
+static void CreateAnonTx(benchmark::Bench& bench, size_t num_inputs, int num_threads)
+{
+    gArgs.ForceSetArg("-acceptanontxn", "1");
+    gArgs.ForceSetArg("-anonrestricted", "0");
+
+    TestingSetup test_setup{CBaseChainParams::REGTEST, {}, true};
+    util::Ref context{test_setup.m_node};
+
+    ECC_Start_Stealth();
+    ECC_Start_Blinding();
+
+    std::unique_ptr<interfaces::Chain> m_chain = interfaces::MakeChain(test_setup.m_node);
+    std::unique_ptr<interfaces::ChainClient> m_chain_client = interfaces::MakeWalletClient(*m_chain, *Assert(test_setup.m_node.args));
+    m_chain_client->registerRpcs();
+
+    std::shared_ptr<CHDWallet> pwallet_a = CreateTestWallet(*m_chain.get(), "a");
+    assert(pwallet_a.get());
+    AddWallet(pwallet_a);
+
+    {
+        int last_height = ::ChainActive().Height();
+        uint256 last_hash = ::ChainActive().Tip()->GetBlockHash();
+        LOCK(pwallet_a->cs_wallet);
+        pwallet_a->SetLastBlockProcessed(last_height, last_hash);
+    }
+
+    CallRPC("extkeyimportmaster tprv8ZgxMBicQKsPeK5mCpvMsd1cwyT1JZsrBN82XkoYuZY1EVK7EwDaiL9sDfqUU5SntTfbRfnRedFWjg5xkDG5i3iwd3yP7neX5F2dtdCojk4", context, "a");
+    UniValue rv = CallRPC("getnewstealthaddress", context, "a");
+    CBitcoinAddress addr_a(part::StripQuotes(rv.write()));
+
+    // Twice as many anon outputs as inputs, the rest are picked as decoys
+    for (size_t i = 0; i < num_inputs * 2; ++i) {
+        AddAnonTxn(pwallet_a.get(), addr_a, 1 * COIN, OUTPUT_RINGCT);
+    }
+    StakeNBlocks(pwallet_a.get(), 2);
+
+    pwallet_a->m_blind_sign_threads = num_threads;
+    CAmount amount = num_inputs * COIN - COIN / 2;
+    bench.run([&] {
+        CTransactionRef tx = CreateTxn(pwallet_a.get(), addr_a, amount, OUTPUT_RINGCT, OUTPUT_RINGCT);
+        assert(tx->vin.size() >= num_inputs);
+    });
+
+    RemoveWallet(pwallet_a, nullopt);
+    pwallet_a.reset();
+
+    ECC_Stop_Stealth();
+    ECC_Stop_Blinding();
+}
+
 static void ParticlAddTxPlainPlainNotOwned(benchmark::Bench& bench) { AddTx(bench, "plain", "plain", false); }
 static void ParticlAddTxPlainPlainOwned(benchmark::Bench& bench) { AddTx(bench, "plain", "plain", true); }
 static void ParticlAddTxPlainBlindNotOwned(benchmark::Bench& bench) { AddTx(bench, "plain", "blind", false); }
@@ -270,3 +320,9 @@ BENCHMARK(ParticlAddTxAnonBlindNotOwned);
 BENCHMARK(ParticlAddTxAnonBlindOwned);
 BENCHMARK(ParticlAddTxAnonAnonNotOwned);
 BENCHMARK(ParticlAddTxAnonAnonOwned);
+
+static void ParticlCreateTxAnon8InputsOneThread(benchmark::Bench& bench) { CreateAnonTx(bench, 8, 1); }
+static void ParticlCreateTxAnon8InputsFourThreads(benchmark::Bench& bench) { CreateAnonTx(bench, 8, 4); }
+
+BENCHMARK(ParticlCreateTxAnon8InputsOneThread);
+BENCHMARK(ParticlCreateTxAnon8InputsFourThreads);
@@ -0,0 +1,107 @@
+// Copyright (c) 2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat.h>
+#include <netbase.h>
+
+#include <cassert>
+#include <vector>
+
+#ifdef USE_POLL
+#include <poll.h>
+#endif
+
+#ifdef USE_EPOLL
+// One message is delivered per iteration to a single connection among
+// num_peers mostly idle ones, as on a node with many quiet peers.
+struct SocketPairs
+{
+    std::vector<SOCKET> local, remote;
+    size_t next{0};
+
+    explicit SocketPairs(size_t num_peers)
+    {
+        for (size_t i = 0; i < num_peers; ++i) {
+            int fds[2];
+            assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+            SetSocketNonBlocking(fds[0], true);
+            local.push_back(fds[0]);
+            remote.push_back(fds[1]);
+        }
+    }
+    ~SocketPairs()
+    {
+        for (SOCKET& s : local) CloseSocket(s);
+        for (SOCKET& s : remote) CloseSocket(s);
+    }
+
+    size_t SendOne()
+    {
+        size_t i = next++ % remote.size();
+        char c = 'x';
+        assert(send(remote[i], &c, 1, MSG_NOSIGNAL) == 1);
+        return i;
+    }
+    void RecvOne(size_t i)
+    {
+        char buf[16];
+        assert(recv(local[i], buf, sizeof(buf), MSG_DONTWAIT) == 1);
+    }
+};
+
+static void SocketEventsPoll(benchmark::Bench& bench, size_t num_peers)
+{
+    SocketPairs pairs(num_peers);
+    std::vector<struct pollfd> vpollfds(num_peers);
+    bench.unit("message").run([&] {
+        pairs.SendOne();
+        // The poll backend rebuilds and scans the whole set for every wakeup
+        for (size_t i = 0; i < num_peers; ++i) {
+            vpollfds[i].fd = pairs.local[i];
+            vpollfds[i].events = POLLIN;
+            vpollfds[i].revents = 0;
+        }
+        assert(poll(vpollfds.data(), vpollfds.size(), 1000) == 1);
+        for (size_t i = 0; i < num_peers; ++i) {
+            if (vpollfds[i].revents & POLLIN) {
+                pairs.RecvOne(i);
+            }
+        }
+    });
+}
+
+static void SocketEventsEpoll(benchmark::Bench& bench, size_t num_peers)
+{
+    SocketPairs pairs(num_peers);
+    EpollSocketSet socket_events;
+    for (size_t i = 0; i < num_peers; ++i) {
+        assert(socket_events.Add(pairs.local[i], i));
+    }
+    std::vector<EpollSocketSet::Event> events;
+    // Drain the initial writable edges
+    do {
+        assert(socket_events.Wait(events, 0));
+    } while (!events.empty());
+    bench.unit("message").run([&] {
+        pairs.SendOne();
+        assert(socket_events.Wait(events, 1000) && events.size() == 1);
+        pairs.RecvOne(events[0].tag);
+    });
+}
+
+static void SocketEventsPoll100(benchmark::Bench& bench) { SocketEventsPoll(bench, 100); }
+static void SocketEventsPoll500(benchmark::Bench& bench) { SocketEventsPoll(bench, 500); }
+static void SocketEventsPoll1000(benchmark::Bench& bench) { SocketEventsPoll(bench, 1000); }
+static void SocketEventsEpoll100(benchmark::Bench& bench) { SocketEventsEpoll(bench, 100); }
+static void SocketEventsEpoll500(benchmark::Bench& bench) { SocketEventsEpoll(bench, 500); }
+static void SocketEventsEpoll1000(benchmark::Bench& bench) { SocketEventsEpoll(bench, 1000); }
+
+BENCHMARK(SocketEventsPoll100);
+BENCHMARK(SocketEventsPoll500);
+BENCHMARK(SocketEventsPoll1000);
+BENCHMARK(SocketEventsEpoll100);
+BENCHMARK(SocketEventsEpoll500);
+BENCHMARK(SocketEventsEpoll1000);
+#endif // USE_EPOLL
@@ -8,6 +8,8 @@
 #include <secp256k1_rangeproof.h>
 
 #include <support/allocators/secure.h>
+#include <crypto/common.h>
+#include <crypto/hmac_sha512.h>
 #include <random.h>
 #include <util/system.h>
 #include <serialize.h>
@@ -18,12 +20,14 @@
 #include <chain/ct_tainted.h>
 #include <chain/tx_blacklist.h>
 #include <chain/tx_whitelist.h>
+#include <uint256.h>
 #include <set>
 
 
 secp256k1_context *secp256k1_ctx_blind = nullptr;
 secp256k1_scratch_space *blind_scratch = nullptr;
 secp256k1_bulletproof_generators *blind_gens = nullptr;
+secp256k1_bulletproof_generators *blind_gens_aggregated = nullptr;
 
 static CBloomFilter ct_tainted_filter;
 static std::set<uint256> ct_whitelist;
@@ -142,6 +146,59 @@ int GetRangeProofInfo(const std::vector<uint8_t> &vRangeproof, int &rexp, int &r
         &vRangeproof[0], vRangeproof.size()) == 1));
 }
 
+static void GetAggregatedAmountKey(const uint256 &nonce, uint8_t *key_out)
+{
+    static const std::string tag = "ghost aggregated amount";
+    CHMAC_SHA512(nonce.begin(), 32).Write((const uint8_t*)tag.data(), tag.size()).Finalize(key_out);
+}
+
+void EncryptAggregatedAmount(const uint256 &nonce, uint64_t value, const uint8_t *blind, uint8_t *data_out)
+{
+    uint8_t key[CHMAC_SHA512::OUTPUT_SIZE];
+    GetAggregatedAmountKey(nonce, key);
+
+    WriteLE64(data_out, value);
+    memcpy(data_out + 8, blind, 32);
+    for (size_t i = 0; i < AGGREGATED_AMOUNT_SIZE; ++i) {
+        data_out[i] ^= key[i];
+    }
+    memory_cleanse(key, sizeof(key));
+}
+
+bool DecryptAggregatedAmount(const uint256 &nonce, const uint8_t *data, const secp256k1_pedersen_commitment *commitment, uint64_t &value, uint8_t *blind_out)
+{
+    uint8_t key[CHMAC_SHA512::OUTPUT_SIZE], plain[AGGREGATED_AMOUNT_SIZE];
+    GetAggregatedAmountKey(nonce, key);
+    for (size_t i = 0; i < AGGREGATED_AMOUNT_SIZE; ++i) {
+        plain[i] = data[i] ^ key[i];
+    }
+    memory_cleanse(key, sizeof(key));
+
+    value = ReadLE64(plain);
+    memcpy(blind_out, plain + 8, 32);
+    memory_cleanse(plain, sizeof(plain));
+
+    secp256k1_pedersen_commitment check;
+    if (!secp256k1_pedersen_commit(secp256k1_ctx_blind, &check, blind_out, value, &secp256k1_generator_const_h, &secp256k1_generator_const_g)) {
+        return false;
+    }
+    return memcmp(check.data, commitment->data, 33) == 0;
+}
+
+bool RewindBulletproof(const std::vector<uint8_t> &vRangeproof, const secp256k1_pedersen_commitment *commitment, const uint256 &nonce, uint64_t &value, uint8_t *blind_out)
+{
+    if (vRangeproof.size() > AGGREGATED_AMOUNT_SIZE &&
+        1 == secp256k1_bulletproof_rangeproof_rewind(secp256k1_ctx_blind, blind_gens,
+            &value, blind_out, vRangeproof.data(), vRangeproof.size(),
+            0, commitment, &secp256k1_generator_const_h, nonce.begin(), nullptr, 0)) {
+        return true;
+    }
+    if (vRangeproof.size() < AGGREGATED_AMOUNT_SIZE) {
+        return false;
+    }
+    return DecryptAggregatedAmount(nonce, &vRangeproof[vRangeproof.size() - AGGREGATED_AMOUNT_SIZE], commitment, value, blind_out);
+}
+
 void LoadRCTBlacklist(const int64_t indices[], size_t num_indices)
 {
     rct_blacklist = std::set<int64_t>(indices, indices + num_indices);
@@ -225,10 +282,14 @@ void ECC_Start_Blinding()
     assert(blind_scratch);
     blind_gens = secp256k1_bulletproof_generators_create(secp256k1_ctx_blind, &secp256k1_generator_const_g, 128);
     assert(blind_gens);
+    // The H generators start halfway through the set, aggregated proofs can't share the single proof generators
+    blind_gens_aggregated = secp256k1_bulletproof_generators_create(secp256k1_ctx_blind, &secp256k1_generator_const_g, 2 * 64 * MAX_AGGREGATED_RANGEPROOF_OUTPUTS);
+    assert(blind_gens_aggregated);
 }
 
 void ECC_Stop_Blinding()
 {
+    secp256k1_bulletproof_generators_destroy(secp256k1_ctx_blind, blind_gens_aggregated);
     secp256k1_bulletproof_generators_destroy(secp256k1_ctx_blind, blind_gens);
     secp256k1_scratch_space_destroy(secp256k1_ctx_blind, blind_scratch);
 
@@ -15,14 +15,30 @@
 
 class uint256;
 
+/** Maximum number of outputs covered by one aggregated bulletproof, must be a power of two */
+static const size_t MAX_AGGREGATED_RANGEPROOF_OUTPUTS = 16;
+/** Encrypted value and blinding factor carried by each output covered by an aggregated bulletproof */
+static const size_t AGGREGATED_AMOUNT_SIZE = 8 + 32;
+
 extern secp256k1_context *secp256k1_ctx_blind;
 extern secp256k1_scratch_space *blind_scratch;
 extern secp256k1_bulletproof_generators *blind_gens;
+extern secp256k1_bulletproof_generators *blind_gens_aggregated;
 
 int SelectRangeProofParameters(uint64_t nValueIn, uint64_t &minValue, int &exponent, int &nBits);
 
 int GetRangeProofInfo(const std::vector<uint8_t> &vRangeproof, int &rexp, int &rmantissa, CAmount &min_value, CAmount &max_value);
 
+/** Encrypt the value and blinding factor of an output covered by an aggregated bulletproof to the output's nonce */
+void EncryptAggregatedAmount(const uint256 &nonce, uint64_t value, const uint8_t *blind, uint8_t *data_out);
+/** Decrypt data written by EncryptAggregatedAmount, fails if the result doesn't open commitment */
+bool DecryptAggregatedAmount(const uint256 &nonce, const uint8_t *data, const secp256k1_pedersen_commitment *commitment, uint64_t &value, uint8_t *blind_out);
+/**
+ * Recover the value and blinding factor from a bulletproof rangeproof.
+ * Outputs covered by an aggregated bulletproof end with their encrypted amount.
+ */
+bool RewindBulletproof(const std::vector<uint8_t> &vRangeproof, const secp256k1_pedersen_commitment *commitment, const uint256 &nonce, uint64_t &value, uint8_t *blind_out);
+
 void LoadRCTBlacklist(const int64_t indices[], size_t num_indices);
 void LoadRCTWhitelist(const int64_t indices[], size_t num_indices, int list_id);
 void LoadCTWhitelist(const unsigned char *data, size_t data_length);
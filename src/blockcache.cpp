@@ -0,0 +1,174 @@
+// Copyright (c) 2021 The Particl Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file license.txt or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockcache.h>
+
+#include <blockencodings.h>
+#include <core_memusage.h>
+#include <memusage.h>
+#include <serialize.h>
+#include <util/system.h>
+#include <validation.h>
+#include <version.h>
+
+BlockCache g_block_cache(DEFAULT_BLOCK_CACHE_SIZE * ((size_t) 1 << 20));
+
+static size_t EntryUsage(const std::shared_ptr<const CBlock>& block)
+{
+    return block ? sizeof(CBlock) + RecursiveDynamicUsage(*block) : 0;
+}
+
+static size_t EntryUsage(const CSharedNetMsgDataRef& raw)
+{
+    return raw ? sizeof(CSharedNetMsgData) + memusage::DynamicUsage(raw->data) : 0;
+}
+
+static size_t EntryUsage(const std::shared_ptr<const CBlockHeaderAndShortTxIDs>& cmpctblock)
+{
+    // Close enough, the short ids dominate
+    return cmpctblock ? sizeof(CBlockHeaderAndShortTxIDs) + ::GetSerializeSize(*cmpctblock, PROTOCOL_VERSION) : 0;
+}
+
+BlockCache::Entry* BlockCache::Lookup(const uint256& hash)
+{
+    auto it = m_index.find(hash);
+    if (it == m_index.end()) {
+        return nullptr;
+    }
+    // Move to the front
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &*it->second;
+}
+
+BlockCache::Entry& BlockCache::LookupOrCreate(const uint256& hash)
+{
+    Entry* entry = Lookup(hash);
+    if (entry) {
+        return *entry;
+    }
+    m_entries.emplace_front();
+    m_entries.front().hash = hash;
+    m_index.emplace(hash, m_entries.begin());
+    return m_entries.front();
+}
+
+void BlockCache::Resize(Entry& entry, size_t bytes)
+{
+    m_bytes = m_bytes - entry.bytes + bytes;
+    entry.bytes = bytes;
+    Evict();
+}
+
+void BlockCache::Evict()
+{
+    while (m_bytes > m_max_bytes && !m_entries.empty()) {
+        const Entry& entry = m_entries.back();
+        m_bytes -= entry.bytes;
+        m_index.erase(entry.hash);
+        m_entries.pop_back();
+    }
+}
+
+std::shared_ptr<const CBlock> BlockCache::GetBlock(const uint256& hash)
+{
+    LOCK(m_mutex);
+    Entry* entry = Lookup(hash);
+    if (entry && entry->block) {
+        m_stats.block_hits++;
+        return entry->block;
+    }
+    m_stats.block_misses++;
+    return nullptr;
+}
+
+CSharedNetMsgDataRef BlockCache::GetRawBlock(const uint256& hash)
+{
+    LOCK(m_mutex);
+    Entry* entry = Lookup(hash);
+    if (entry && entry->raw) {
+        m_stats.raw_hits++;
+        return entry->raw;
+    }
+    m_stats.raw_misses++;
+    return nullptr;
+}
+
+std::shared_ptr<const CBlockHeaderAndShortTxIDs> BlockCache::GetCompactBlock(const uint256& hash, bool use_wtxid)
+{
+    LOCK(m_mutex);
+    Entry* entry = Lookup(hash);
+    if (entry && entry->cmpct[use_wtxid]) {
+        m_stats.cmpct_hits++;
+        return entry->cmpct[use_wtxid];
+    }
+    m_stats.cmpct_misses++;
+    return nullptr;
+}
+
+void BlockCache::AddBlock(const std::shared_ptr<const CBlock>& block)
+{
+    LOCK(m_mutex);
+    Entry& entry = LookupOrCreate(block->GetHash());
+    size_t bytes = entry.bytes - EntryUsage(entry.block) + EntryUsage(block);
+    entry.block = block;
+    Resize(entry, bytes);
+}
+
+void BlockCache::AddRawBlock(const uint256& hash, const CSharedNetMsgDataRef& raw)
+{
+    LOCK(m_mutex);
+    Entry& entry = LookupOrCreate(hash);
+    size_t bytes = entry.bytes - EntryUsage(entry.raw) + EntryUsage(raw);
+    entry.raw = raw;
+    Resize(entry, bytes);
+}
+
+void BlockCache::AddCompactBlock(const uint256& hash, bool use_wtxid, const std::shared_ptr<const CBlockHeaderAndShortTxIDs>& cmpctblock)
+{
+    LOCK(m_mutex);
+    Entry& entry = LookupOrCreate(hash);
+    size_t bytes = entry.bytes - EntryUsage(entry.cmpct[use_wtxid]) + EntryUsage(cmpctblock);
+    entry.cmpct[use_wtxid] = cmpctblock;
+    Resize(entry, bytes);
+}
+
+void BlockCache::SetMaxBytes(size_t max_bytes)
+{
+    LOCK(m_mutex);
+    m_max_bytes = max_bytes;
+    Evict();
+}
+
+BlockCacheStats BlockCache::GetStats() const
+{
+    LOCK(m_mutex);
+    BlockCacheStats stats = m_stats;
+    stats.entries = m_entries.size();
+    stats.bytes = m_bytes;
+    stats.max_bytes = m_max_bytes;
+    return stats;
+}
+
+std::shared_ptr<const CBlock> GetCachedBlock(const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+{
+    std::shared_ptr<const CBlock> pblock = g_block_cache.GetBlock(pindex->GetBlockHash());
+    if (pblock) {
+        return pblock;
+    }
+    std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
+    if (!ReadBlockFromDisk(*pblockRead, pindex, consensusParams)) {
+        return nullptr;
+    }
+    if (::ChainActive().Height() - pindex->nHeight <= BLOCK_CACHE_MAX_DEPTH) {
+        g_block_cache.AddBlock(pblockRead);
+    }
+    return pblockRead;
+}
+
+void InitBlockCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-blockcachesize", DEFAULT_BLOCK_CACHE_SIZE)), MAX_BLOCK_CACHE_SIZE) * ((size_t) 1 << 20);
+    g_block_cache.SetMaxBytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB for the recent block cache\n", nMaxCacheSize >> 20);
+}
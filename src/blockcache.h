@@ -0,0 +1,101 @@
+// Copyright (c) 2021 The Particl Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file license.txt or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PARTICL_BLOCKCACHE_H
+#define PARTICL_BLOCKCACHE_H
+
+#include <net.h>
+#include <primitives/block.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <list>
+#include <map>
+#include <memory>
+
+class CBlockHeaderAndShortTxIDs;
+class CBlockIndex;
+namespace Consensus {
+struct Params;
+}
+
+// Limit the cache of recent blocks to 32MB by default.
+static const unsigned int DEFAULT_BLOCK_CACHE_SIZE = 32;
+// Maximum block cache size allowed
+static const int64_t MAX_BLOCK_CACHE_SIZE = 4096;
+// Blocks read from disk are only added to the cache if within this depth of the tip
+static const int BLOCK_CACHE_MAX_DEPTH = 10;
+
+struct BlockCacheStats
+{
+    size_t entries{0};
+    size_t bytes{0};
+    size_t max_bytes{0};
+    uint64_t block_hits{0};
+    uint64_t block_misses{0};
+    uint64_t raw_hits{0};
+    uint64_t raw_misses{0};
+    uint64_t cmpct_hits{0};
+    uint64_t cmpct_misses{0};
+};
+
+/**
+ * LRU cache of recently connected blocks, keyed by block hash.
+ *
+ * When a new block propagates most peers request it, or its compact form,
+ * within a short time.  An entry can hold the deserialized block, its raw
+ * witness serialization and the compact blocks built from it, so these
+ * requests are served from memory.  Entries are evicted least recently used
+ * first once the estimated memory usage exceeds the limit.
+ */
+class BlockCache
+{
+public:
+    explicit BlockCache(size_t max_bytes) : m_max_bytes(max_bytes) {}
+
+    std::shared_ptr<const CBlock> GetBlock(const uint256& hash);
+    CSharedNetMsgDataRef GetRawBlock(const uint256& hash);
+    std::shared_ptr<const CBlockHeaderAndShortTxIDs> GetCompactBlock(const uint256& hash, bool use_wtxid);
+
+    void AddBlock(const std::shared_ptr<const CBlock>& block);
+    void AddRawBlock(const uint256& hash, const CSharedNetMsgDataRef& raw);
+    void AddCompactBlock(const uint256& hash, bool use_wtxid, const std::shared_ptr<const CBlockHeaderAndShortTxIDs>& cmpctblock);
+
+    void SetMaxBytes(size_t max_bytes);
+    BlockCacheStats GetStats() const;
+
+private:
+    struct Entry {
+        uint256 hash;
+        std::shared_ptr<const CBlock> block;
+        CSharedNetMsgDataRef raw;
+        //! Indexed by use_wtxid
+        std::shared_ptr<const CBlockHeaderAndShortTxIDs> cmpct[2];
+        size_t bytes{0};
+    };
+    typedef std::list<Entry> EntryList;
+
+    mutable Mutex m_mutex;
+    //! Most recently used first
+    EntryList m_entries GUARDED_BY(m_mutex);
+    std::map<uint256, EntryList::iterator> m_index GUARDED_BY(m_mutex);
+    size_t m_bytes GUARDED_BY(m_mutex){0};
+    size_t m_max_bytes GUARDED_BY(m_mutex);
+    BlockCacheStats m_stats GUARDED_BY(m_mutex);
+
+    Entry* Lookup(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    Entry& LookupOrCreate(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Resize(Entry& entry, size_t bytes) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Evict() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+extern BlockCache g_block_cache;
+
+/** Get a block from the cache, or read it from disk and cache it if it's near the tip */
+std::shared_ptr<const CBlock> GetCachedBlock(const CBlockIndex* pindex, const Consensus::Params& consensusParams) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+// To be called once in AppInitMain to apply -blockcachesize.
+void InitBlockCache();
+
+#endif // PARTICL_BLOCKCACHE_H
@@ -1001,6 +1001,7 @@ public:
         consensus.smsg_difficulty_time = 0;
 
         consensus.clamp_tx_version_time = 0;
+        consensus.aggregate_bulletproof_time = 0;
 
         consensus.smsg_fee_period = 50;
         consensus.smsg_fee_funding_tx_per_k = 200000;
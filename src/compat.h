@@ -92,6 +92,11 @@ typedef char* sockopt_arg_type;
 #define USE_POLL
 #endif
 
+// Edge triggered readiness notification for the socket handler
+#if defined(__linux__)
+#define USE_EPOLL
+#endif
+
 bool static inline IsSelectableSocket(const SOCKET& s) {
 #if defined(USE_POLL) || defined(WIN32)
     return true;
@@ -26,6 +26,7 @@
 // Ghost dependencies
 #include <blind.h>
 #include <insight/balanceindex.h>
+#include <proofcache.h>
 #include <adapter.h>
 
 bool IsFinalTx(const CTransaction &tx, int nBlockHeight, int64_t nBlockTime)
@@ -559,11 +560,14 @@ static bool CheckStandardOutput(TxValidationState &state, const CTxOutStandard *
     return true;
 }
 
-static bool CheckBlindOutput(TxValidationState &state, const CTxOutCT *p)
+static bool CheckBlindOutput(TxValidationState &state, const CTxOutCT *p, const uint256 &wtxid, uint32_t n, bool aggregated)
 {
     if (p->vData.size() < 33 || p->vData.size() > 33 + 5 + 33) {
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-ctout-ephem-size");
     }
+    if (aggregated) {
+        return true; // Rangeproof is checked with its group
+    }
     size_t nRangeProofLen = 5134;
     if (p->vRangeproof.size() < 500 || p->vRangeproof.size() > nRangeProofLen) {
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-ctout-rangeproof-size");
@@ -573,6 +577,14 @@ static bool CheckBlindOutput(TxValidationState &state, const CTxOutCT *p)
         return true;
     }
 
+    // Proofs verified on entry to the mempool are not verified again when
+    // connecting the block.
+    uint256 cache_entry;
+    ComputeRangeProofCacheEntry(cache_entry, wtxid, n, p->commitment, state.fBulletproofsActive);
+    if (ProofCacheGet(cache_entry, state.m_erase_cached_proofs)) {
+        return true;
+    }
+
     uint64_t min_value = 0, max_value = 0;
     int rv = 0;
 
@@ -596,10 +608,14 @@ static bool CheckBlindOutput(TxValidationState &state, const CTxOutCT *p)
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-ctout-rangeproof-verify");
     }
 
+    if (!state.m_in_block) {
+        ProofCacheSet(cache_entry);
+    }
+
     return true;
 }
 
-bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p)
+bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p, const uint256 &wtxid, uint32_t n, bool aggregated)
 {
     if (!state.rct_active) {
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "rctout-before-active");
@@ -607,6 +623,9 @@ bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p)
     if (p->vData.size() < 33 || p->vData.size() > 33 + 5 + 33) {
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-rctout-ephem-size");
     }
+    if (aggregated) {
+        return true; // Rangeproof is checked with its group
+    }
 
     size_t nRangeProofLen = 5134;
     if (p->vRangeproof.size() < 500 || p->vRangeproof.size() > nRangeProofLen) {
@@ -617,6 +636,14 @@ bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p)
         return true;
     }
 
+    // Proofs verified on entry to the mempool are not verified again when
+    // connecting the block.
+    uint256 cache_entry;
+    ComputeRangeProofCacheEntry(cache_entry, wtxid, n, p->commitment, state.fBulletproofsActive);
+    if (ProofCacheGet(cache_entry, state.m_erase_cached_proofs)) {
+        return true;
+    }
+
     uint64_t min_value = 0, max_value = 0;
     int rv = 0;
 
@@ -640,6 +667,94 @@ bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p)
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-rctout-rangeproof-verify");
     }
 
+    if (!state.m_in_block) {
+        ProofCacheSet(cache_entry);
+    }
+
+    return true;
+}
+
+/**
+ * Find the outputs covered by aggregated bulletproofs.
+ * The first blinded output of a group carries the aggregated proof followed by its encrypted amount,
+ * the other outputs of the group carry only their encrypted amount and must directly follow it.
+ * vGroupSizes[n] is set to the number of outputs covered by the proof in output n, 0 for outputs
+ * covered by an earlier output and 1 for outputs with their own proof.
+ */
+static bool GetRangeProofGroups(TxValidationState &state, const CTransaction &tx, std::vector<uint32_t> &vGroupSizes)
+{
+    vGroupSizes.assign(tx.vpout.size(), 1);
+    if (!state.fBulletproofsActive || !state.m_aggregate_bulletproofs) {
+        return true;
+    }
+
+    int nFirst = -1;
+    for (uint32_t n = 0; n < tx.vpout.size(); ++n) {
+        const auto &txout = tx.vpout[n];
+        if (!txout->IsType(OUTPUT_CT) && !txout->IsType(OUTPUT_RINGCT)) {
+            nFirst = -1;
+            continue;
+        }
+        if (txout->GetPRangeproof()->size() != AGGREGATED_AMOUNT_SIZE) {
+            nFirst = n;
+            continue;
+        }
+        if (nFirst < 0) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-rangeproof-aggregate");
+        }
+        vGroupSizes[n] = 0;
+        if (++vGroupSizes[nFirst] > MAX_AGGREGATED_RANGEPROOF_OUTPUTS) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-rangeproof-aggregate-size");
+        }
+    }
+
+    for (const auto nGroupSize : vGroupSizes) {
+        if (nGroupSize > 1 && (nGroupSize & (nGroupSize - 1)) != 0) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-rangeproof-aggregate-size");
+        }
+    }
+    return true;
+}
+
+static bool CheckAggregatedRangeProof(TxValidationState &state, const CTransaction &tx, const uint256 &wtxid, uint32_t n, uint32_t nGroupSize)
+{
+    const std::vector<uint8_t> &vRangeproof = *tx.vpout[n]->GetPRangeproof();
+    if (vRangeproof.size() < 500 + AGGREGATED_AMOUNT_SIZE || vRangeproof.size() >= 1000) {
+        return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-rangeproof-aggregate-size");
+    }
+    size_t nProofLen = vRangeproof.size() - AGGREGATED_AMOUNT_SIZE;
+
+    if (state.m_skip_rangeproof) {
+        return true;
+    }
+
+    uint256 cache_entry;
+    ComputeRangeProofCacheEntry(cache_entry, wtxid, n, *tx.vpout[n]->GetPCommitment(), true);
+    if (ProofCacheGet(cache_entry, state.m_erase_cached_proofs)) {
+        return true;
+    }
+
+    std::vector<secp256k1_pedersen_commitment> vCommitments(nGroupSize);
+    for (uint32_t k = 0; k < nGroupSize; ++k) {
+        vCommitments[k] = *tx.vpout[n + k]->GetPCommitment();
+    }
+
+    int rv = secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind,
+        blind_scratch, blind_gens_aggregated, vRangeproof.data(), nProofLen,
+        nullptr, vCommitments.data(), nGroupSize, 64, &secp256k1_generator_const_h, nullptr, 0);
+
+    if (LogAcceptCategory(BCLog::RINGCT)) {
+        LogPrintf("%s: rv %d, outputs %d-%d\n", __func__, rv, n, n + nGroupSize - 1);
+    }
+
+    if (rv != 1) {
+        return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-rangeproof-aggregate-verify");
+    }
+
+    if (!state.m_in_block) {
+        ProofCacheSet(cache_entry);
+    }
+
     return true;
 }
 
@@ -677,9 +792,16 @@ bool CheckTransaction(const CTransaction& tx, TxValidationState &state)
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-vout-not-empty");
         }
 
+        std::vector<uint32_t> vGroupSizes;
+        if (!GetRangeProofGroups(state, tx, vGroupSizes)) {
+            return false;
+        }
+
         size_t nStandardOutputs = 0, nDataOutputs = 0, nBlindOutputs = 0, nAnonOutputs = 0;
         CAmount nValueOut = 0;
-        for (const auto &txout : tx.vpout) {
+        const uint256 &wtxid = tx.GetWitnessHash();
+        for (uint32_t n = 0; n < tx.vpout.size(); ++n) {
+            const auto &txout = tx.vpout[n];
             switch (txout->nVersion) {
                 case OUTPUT_STANDARD:
                     if (!CheckStandardOutput(state, (CTxOutStandard*) txout.get(), nValueOut)) {
@@ -688,13 +810,13 @@ bool CheckTransaction(const CTransaction& tx, TxValidationState &state)
                     nStandardOutputs++;
                     break;
                 case OUTPUT_CT:
-                    if (!CheckBlindOutput(state, (CTxOutCT*) txout.get())) {
+                    if (!CheckBlindOutput(state, (CTxOutCT*) txout.get(), wtxid, n, vGroupSizes[n] != 1)) {
                         return false;
                     }
                     nBlindOutputs++;
                     break;
                 case OUTPUT_RINGCT:
-                    if (!CheckAnonOutput(state, (CTxOutRingCT*) txout.get())) {
+                    if (!CheckAnonOutput(state, (CTxOutRingCT*) txout.get(), wtxid, n, vGroupSizes[n] != 1)) {
                         return false;
                     }
                     nAnonOutputs++;
@@ -712,6 +834,10 @@ bool CheckTransaction(const CTransaction& tx, TxValidationState &state)
             if (!MoneyRange(nValueOut)) {
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-txouttotal-toolarge");
             }
+            if (vGroupSizes[n] > 1 &&
+                !CheckAggregatedRangeProof(state, tx, wtxid, n, vGroupSizes[n])) {
+                return false;
+            }
         }
 
         size_t max_data_outputs = 1 + nStandardOutputs; // extra 1 for ct fee output
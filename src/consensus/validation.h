@@ -152,6 +152,7 @@ public:
     int nFlags = 0;
     bool fEnforceSmsgFees = false;
     bool fBulletproofsActive = false;
+    bool m_aggregate_bulletproofs = false;
     bool rct_active = false;
     int m_spend_height = 0;
     bool m_particl_mode = false;
@@ -169,6 +170,7 @@ public:
     bool m_exploit_fix_1 = false;
     bool m_exploit_fix_2 = false;
     bool m_in_block = false;
+    bool m_erase_cached_proofs = false; // Set when connecting a block, not when only checking it
     bool m_check_equal_rct_txid = true;
     bool m_punish_for_duplicates = false;
     CAmount tx_balances[6] = {0};
@@ -181,6 +183,7 @@ public:
         m_consensus_params = &consensusParams;
         fEnforceSmsgFees = time >= consensusParams.nPaidSmsgTime;
         fBulletproofsActive = time >= consensusParams.bulletproof_time;
+        m_aggregate_bulletproofs = time >= consensusParams.aggregate_bulletproof_time;
         rct_active = time >= consensusParams.rct_time;
         if (spend_height > -1) {
             m_spend_height = spend_height; // Pass through connectblock->checkblock
@@ -200,9 +203,11 @@ public:
     {
         m_time = state_from.m_time;
         m_in_block = state_from.m_in_block;
+        m_erase_cached_proofs = state_from.m_erase_cached_proofs;
         m_consensus_params = state_from.m_consensus_params;
         fEnforceSmsgFees = state_from.fEnforceSmsgFees;
         fBulletproofsActive = state_from.fBulletproofsActive;
+        m_aggregate_bulletproofs = state_from.m_aggregate_bulletproofs;
         rct_active = state_from.rct_active;
         m_spend_height = state_from.m_spend_height;
 
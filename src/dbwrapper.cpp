@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <random.h>
+#include <util/string.h>
 
 #include <leveldb/cache.h>
 #include <leveldb/env.h>
@@ -13,6 +14,7 @@
 #include <memenv.h>
 #include <stdint.h>
 #include <algorithm>
+#include <sstream>
 
 class CBitcoinLevelDBLogger : public leveldb::Logger {
 public:
@@ -181,6 +183,25 @@ CDBWrapper::~CDBWrapper()
     options.env = nullptr;
 }
 
+CDBSnapshot::CDBSnapshot(const CDBWrapper &parent_in) : parent(parent_in)
+{
+    m_snapshot = parent.pdb->GetSnapshot();
+    readoptions = parent.readoptions;
+    readoptions.snapshot = m_snapshot;
+    iteroptions = parent.iteroptions;
+    iteroptions.snapshot = m_snapshot;
+}
+
+CDBSnapshot::~CDBSnapshot()
+{
+    parent.pdb->ReleaseSnapshot(m_snapshot);
+}
+
+CDBIterator *CDBSnapshot::NewIterator() const
+{
+    return new CDBIterator(parent, parent.pdb->NewIterator(iteroptions));
+}
+
 bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
 {
     const bool log_memory = LogAcceptCategory(BCLog::LEVELDB);
@@ -198,6 +219,75 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     return true;
 }
 
+void CDBBatch::WriteFromIterator(const CDBIterator& it)
+{
+    leveldb::Slice slKey = it.piter->key();
+    leveldb::Slice slValue = it.piter->value();
+
+    const std::vector<unsigned char>& src_key = dbwrapper_private::GetObfuscateKey(it.parent);
+    const std::vector<unsigned char>& dst_key = dbwrapper_private::GetObfuscateKey(parent);
+    if (src_key == dst_key) {
+        batch.Put(slKey, slValue);
+    } else {
+        ssValue.write(slValue.data(), slValue.size());
+        ssValue.Xor(src_key);
+        ssValue.Xor(dst_key);
+        batch.Put(slKey, leveldb::Slice(ssValue.data(), ssValue.size()));
+        ssValue.clear();
+    }
+    size_estimate += 3 + (slKey.size() > 127) + slKey.size() + (slValue.size() > 127) + slValue.size();
+}
+
+void CDBBatch::EraseAtIterator(const CDBIterator& it)
+{
+    assert(&it.parent == &parent);
+    leveldb::Slice slKey = it.piter->key();
+    batch.Delete(slKey);
+    size_estimate += 2 + (slKey.size() > 127) + slKey.size();
+}
+
+bool CDBWrapper::GetStats(CDBStats& stats) const
+{
+    stats.name = m_name;
+    stats.memory_usage = DynamicMemoryUsage();
+
+    // Keys are prefixed by a type byte, a run of 0xff bytes sorts after all of them
+    const std::string max_key(DBWRAPPER_PREALLOC_KEY_SIZE, '\xff');
+    leveldb::Range range{leveldb::Slice(), leveldb::Slice(max_key)};
+    pdb->GetApproximateSizes(&range, 1, &stats.approximate_size);
+
+    stats.files_per_level.clear();
+    for (int level = 0;; ++level) {
+        std::string value;
+        if (!pdb->GetProperty("leveldb.num-files-at-level" + ToString(level), &value)) {
+            break; // Past the last level
+        }
+        stats.files_per_level.push_back(atoi(value));
+    }
+
+    // Rows of: level, files, size (MB), compaction time (sec), read (MB), written (MB)
+    std::string str_stats;
+    if (!pdb->GetProperty("leveldb.stats", &str_stats)) {
+        return false;
+    }
+    stats.compaction_seconds = 0;
+    stats.compaction_read_bytes = 0;
+    stats.compaction_write_bytes = 0;
+    std::istringstream ss(str_stats);
+    std::string line;
+    while (std::getline(ss, line)) {
+        int level, files;
+        double size_mb, seconds, read_mb, write_mb;
+        if (sscanf(line.c_str(), "%d %d %lf %lf %lf %lf", &level, &files, &size_mb, &seconds, &read_mb, &write_mb) != 6) {
+            continue;
+        }
+        stats.compaction_seconds += seconds;
+        stats.compaction_read_bytes += read_mb * 1048576;
+        stats.compaction_write_bytes += write_mb * 1048576;
+    }
+    return true;
+}
+
 size_t CDBWrapper::DynamicMemoryUsage() const {
     std::string memory;
     if (!pdb->GetProperty("leveldb.approximate-memory-usage", &memory)) {
@@ -25,6 +25,20 @@ public:
 };
 
 class CDBWrapper;
+class CDBIterator;
+
+/** Size and compaction statistics of one database */
+struct CDBStats
+{
+    std::string name;
+    uint64_t approximate_size{0};
+    size_t memory_usage{0};
+    std::vector<int> files_per_level;
+    //! Totals over all levels since the database was opened
+    double compaction_seconds{0};
+    uint64_t compaction_read_bytes{0};
+    uint64_t compaction_write_bytes{0};
+};
 
 /** These should be considered an implementation detail of the specific database.
  */
@@ -110,11 +124,18 @@ public:
         ssKey.clear();
     }
 
+    /** Copy the record at the cursor of another database, re-obfuscating the value for this one */
+    void WriteFromIterator(const CDBIterator& it);
+
+    /** Erase the record at the cursor, the cursor must belong to the database of this batch */
+    void EraseAtIterator(const CDBIterator& it);
+
     size_t SizeEstimate() const { return size_estimate; }
 };
 
 class CDBIterator
 {
+    friend class CDBBatch;
 private:
     const CDBWrapper &parent;
     leveldb::Iterator *piter;
@@ -185,6 +206,7 @@ public:
 class CDBWrapper
 {
     friend const std::vector<unsigned char>& dbwrapper_private::GetObfuscateKey(const CDBWrapper &w);
+    friend class CDBSnapshot;
 private:
     //! custom environment this database is using (may be nullptr in case of default environment)
     leveldb::Env* penv;
@@ -221,26 +243,8 @@ private:
 
     std::vector<unsigned char> CreateObfuscateKey() const;
 
-public:
-    /**
-     * @param[in] path          Location in the filesystem where leveldb data will be stored.
-     * @param[in] nCacheSize    Configures various leveldb cache settings.
-     * @param[in] fMemory       If true, use leveldb's memory environment.
-     * @param[in] fWipe         If true, remove all existing data.
-     * @param[in] obfuscate     If true, store data obfuscated via simple XOR. If false, XOR
-     *                          with a zero'd byte array.
-     * @param[in] compression   Enable snappy compression for the database
-     * @param[in] maxOpenFiles  The maximum number of open files for the database
-     */
-
-    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false, bool compression = false, int maxOpenFiles = 64);
-    ~CDBWrapper();
-
-    CDBWrapper(const CDBWrapper&) = delete;
-    CDBWrapper& operator=(const CDBWrapper&) = delete;
-
     template <typename K, typename V>
-    bool Read(const K& key, V& value) const
+    bool ReadWithOptions(const leveldb::ReadOptions& options, const K& key, V& value) const
     {
         CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
@@ -248,7 +252,7 @@ public:
         leveldb::Slice slKey(ssKey.data(), ssKey.size());
 
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = pdb->Get(options, slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
@@ -266,7 +270,7 @@ public:
     }
 
     template <typename K>
-    bool ReadStream(const K& key, CDataStream& ssValue) const
+    bool ExistsWithOptions(const leveldb::ReadOptions& options, const K& key) const
     {
         CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
@@ -274,32 +278,42 @@ public:
         leveldb::Slice slKey(ssKey.data(), ssKey.size());
 
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = pdb->Get(options, slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
             LogPrintf("LevelDB read failure: %s\n", status.ToString());
             dbwrapper_private::HandleError(status);
         }
-        try {
-            ssValue.Init(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
-            ssValue.Xor(obfuscate_key);
-        } catch (const std::exception&) {
-            return false;
-        }
         return true;
     }
 
+public:
+    /**
+     * @param[in] path          Location in the filesystem where leveldb data will be stored.
+     * @param[in] nCacheSize    Configures various leveldb cache settings.
+     * @param[in] fMemory       If true, use leveldb's memory environment.
+     * @param[in] fWipe         If true, remove all existing data.
+     * @param[in] obfuscate     If true, store data obfuscated via simple XOR. If false, XOR
+     *                          with a zero'd byte array.
+     * @param[in] compression   Enable snappy compression for the database
+     * @param[in] maxOpenFiles  The maximum number of open files for the database
+     */
+
+    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false, bool compression = false, int maxOpenFiles = 64);
+    ~CDBWrapper();
+
+    CDBWrapper(const CDBWrapper&) = delete;
+    CDBWrapper& operator=(const CDBWrapper&) = delete;
+
     template <typename K, typename V>
-    bool Write(const K& key, const V& value, bool fSync = false)
+    bool Read(const K& key, V& value) const
     {
-        CDBBatch batch(*this);
-        batch.Write(key, value);
-        return WriteBatch(batch, fSync);
+        return ReadWithOptions(readoptions, key, value);
     }
 
     template <typename K>
-    bool Exists(const K& key) const
+    bool ReadStream(const K& key, CDataStream& ssValue) const
     {
         CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
@@ -314,9 +328,29 @@ public:
             LogPrintf("LevelDB read failure: %s\n", status.ToString());
             dbwrapper_private::HandleError(status);
         }
+        try {
+            ssValue.Init(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+            ssValue.Xor(obfuscate_key);
+        } catch (const std::exception&) {
+            return false;
+        }
         return true;
     }
 
+    template <typename K, typename V>
+    bool Write(const K& key, const V& value, bool fSync = false)
+    {
+        CDBBatch batch(*this);
+        batch.Write(key, value);
+        return WriteBatch(batch, fSync);
+    }
+
+    template <typename K>
+    bool Exists(const K& key) const
+    {
+        return ExistsWithOptions(readoptions, key);
+    }
+
     template <typename K>
     bool Erase(const K& key, bool fSync = false)
     {
@@ -327,9 +361,14 @@ public:
 
     bool WriteBatch(CDBBatch& batch, bool fSync = false);
 
+    const std::string& GetName() const { return m_name; }
+
     // Get an estimate of LevelDB memory usage (in bytes).
     size_t DynamicMemoryUsage() const;
 
+    /** Fill stats from the leveldb properties, returns false if they could not be read. */
+    bool GetStats(CDBStats& stats) const;
+
     CDBIterator *NewIterator()
     {
         return new CDBIterator(*this, pdb->NewIterator(iteroptions));
@@ -374,4 +413,39 @@ public:
 
 };
 
+/**
+ * A consistent, read-only view of a CDBWrapper at the time it was created.
+ * Readers holding a snapshot are not affected by batches written to the
+ * database afterwards. The wrapped database must outlive the snapshot.
+ */
+class CDBSnapshot
+{
+protected:
+    const CDBWrapper &parent;
+    const leveldb::Snapshot *m_snapshot;
+    leveldb::ReadOptions readoptions;
+    leveldb::ReadOptions iteroptions;
+
+public:
+    explicit CDBSnapshot(const CDBWrapper &parent_in);
+    ~CDBSnapshot();
+
+    CDBSnapshot(const CDBSnapshot&) = delete;
+    CDBSnapshot& operator=(const CDBSnapshot&) = delete;
+
+    template <typename K, typename V>
+    bool Read(const K& key, V& value) const
+    {
+        return parent.ReadWithOptions(readoptions, key, value);
+    }
+
+    template <typename K>
+    bool Exists(const K& key) const
+    {
+        return parent.ExistsWithOptions(readoptions, key);
+    }
+
+    CDBIterator *NewIterator() const;
+};
+
 #endif // BITCOIN_DBWRAPPER_H
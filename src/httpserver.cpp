@@ -17,6 +17,7 @@
 #include <util/translation.h>
 
 #include <deque>
+#include <map>
 #include <memory>
 #include <stdio.h>
 #include <stdlib.h>
@@ -287,6 +288,9 @@ static void http_reject_request_cb(struct evhttp_request* req, void*)
 }
 
 /** Event dispatcher thread */
+//! -rpcservertimeout, also the longest a chunked reply waits for the client to read
+static int64_t g_http_server_timeout{DEFAULT_HTTP_SERVER_TIMEOUT};
+
 static bool ThreadHTTP(struct event_base* base)
 {
     util::ThreadRename("http");
@@ -391,7 +395,8 @@ bool InitHTTPServer()
 
     evhttp_set_allowed_methods(http, EVHTTP_REQ_GET | EVHTTP_REQ_POST |
         EVHTTP_REQ_HEAD | EVHTTP_REQ_PUT | EVHTTP_REQ_OPTIONS);
-    evhttp_set_timeout(http, gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
+    g_http_server_timeout = gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT);
+    evhttp_set_timeout(http, g_http_server_timeout);
     evhttp_set_max_headers_size(http, MAX_HEADERS_SIZE);
     evhttp_set_max_body_size(http, MAX_SIZE);
     evhttp_set_gencb(http, http_request_cb, nullptr);
@@ -516,13 +521,74 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
+
+/** Maximum number of bytes of a chunked reply waiting to be sent before the writer blocks */
+static const size_t HTTP_CHUNKED_MAX_PENDING = 1 << 20;
+
+/** State of a chunked reply, shared between the worker writing it and the http thread */
+struct HTTPChunkedReply
+{
+    Mutex cs;
+    std::condition_variable cond;
+    //! Bytes posted to the http thread but not yet added to the connection's output buffer
+    size_t queued GUARDED_BY(cs){0};
+    //! Bytes in the connection's output buffer, as of the last chunk or drain
+    size_t buffered GUARDED_BY(cs){0};
+    //! Set when the connection closes before the reply is finished
+    bool closed GUARDED_BY(cs){false};
+    //! Close the connection instead of finishing the reply, only used by the writing worker
+    bool abort{false};
+
+    void Update(size_t written, size_t now_buffered, bool now_closed)
+    {
+        LOCK(cs);
+        queued -= written;
+        buffered = now_buffered;
+        closed |= now_closed;
+        cond.notify_all();
+    }
+};
+
+/** Chunked replies in progress by connection, only accessed from the http thread */
+static std::map<evhttp_connection*, std::shared_ptr<HTTPChunkedReply>> g_chunked_replies;
+
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+static size_t http_connection_buffered(evhttp_connection* conn)
+{
+    bufferevent* bev = conn ? evhttp_connection_get_bufferevent(conn) : nullptr;
+    return bev ? evbuffer_get_length(bufferevent_get_output(bev)) : 0;
+}
+
+/** Called when the output buffer of a connection sending a chunked reply has drained */
+static void http_chunk_sent_cb(evhttp_connection* conn, void*)
+{
+    auto it = g_chunked_replies.find(conn);
+    if (it != g_chunked_replies.end()) {
+        it->second->Update(0, 0, false);
+    }
+}
+#endif
+
+/** Called when a connection closes while sending a chunked reply */
+static void http_chunked_close_cb(evhttp_connection* conn, void*)
+{
+    auto it = g_chunked_replies.find(conn);
+    if (it != g_chunked_replies.end()) {
+        it->second->Update(0, 0, true);
+        g_chunked_replies.erase(it);
+    }
+}
+
 HTTPRequest::HTTPRequest(struct evhttp_request* _req, bool _replySent) : req(_req), replySent(_replySent)
 {
 }
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (chunked) {
+        // Complete a chunked reply the handler didn't finish
+        WriteReplyEnd();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -603,6 +669,118 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     req = nullptr; // transferred back to main thread
 }
 
+void HTTPRequest::WriteReplyStart(int nStatus)
+{
+    assert(!replySent && !chunked && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    chunked = std::make_shared<HTTPChunkedReply>();
+    auto req_copy = req;
+    auto state = chunked;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus, state]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (!conn) {
+            // The client is already gone, evhttp_send_reply_end will clean up
+            state->Update(0, 0, true);
+            return;
+        }
+        g_chunked_replies[conn] = state;
+        evhttp_connection_set_closecb(conn, http_chunked_close_cb, nullptr);
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(chunked && req);
+    if (strChunk.empty()) {
+        // An empty chunk would terminate the reply
+        return true;
+    }
+    {
+        WAIT_LOCK(chunked->cs, lock);
+        // Wait for the client to catch up rather than buffering the whole reply
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(g_http_server_timeout);
+        while (!chunked->closed && chunked->queued + chunked->buffered > HTTP_CHUNKED_MAX_PENDING) {
+            if (ShutdownRequested()) {
+                return false;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                LogPrint(BCLog::HTTP, "Client stopped reading a chunked reply, closing the connection\n");
+                chunked->abort = true;
+                return false;
+            }
+            chunked->cond.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        if (chunked->closed) {
+            return false;
+        }
+        chunked->queued += strChunk.size();
+    }
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    auto req_copy = req;
+    auto state = chunked;
+    size_t size = strChunk.size();
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, evb, state, size]{
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+        evhttp_send_reply_chunk_with_cb(req_copy, evb, http_chunk_sent_cb, nullptr);
+        size_t buffered = http_connection_buffered(evhttp_request_get_connection(req_copy));
+#else
+        // Without a drain callback only the chunks not yet passed to libevent can be waited for
+        evhttp_send_reply_chunk(req_copy, evb);
+        size_t buffered = 0;
+#endif
+        evbuffer_free(evb);
+        state->Update(size, buffered, false);
+    });
+    ev->trigger(nullptr);
+    return !ShutdownRequested();
+}
+
+void HTTPRequest::WriteReplyAbort()
+{
+    assert(chunked && req);
+    chunked->abort = true;
+    WriteReplyEnd();
+}
+
+void HTTPRequest::WriteReplyEnd()
+{
+    assert(chunked && req);
+    auto req_copy = req;
+    bool abort = chunked->abort;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, abort]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+            g_chunked_replies.erase(conn);
+            if (abort) {
+                // Without the terminating chunk the client can tell the reply is incomplete,
+                // freeing the connection frees the request too.
+                evhttp_connection_free(conn);
+                return;
+            }
+            // Re-enable reading from the socket, as in WriteReply. This is done
+            // first as evhttp_send_reply_end may free the connection.
+            if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+                if (bev) {
+                    bufferevent_enable(bev, EV_READ | EV_WRITE);
+                }
+            }
+        }
+        evhttp_send_reply_end(req_copy);
+    });
+    ev->trigger(nullptr);
+    chunked.reset();
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
 CService HTTPRequest::GetPeer() const
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
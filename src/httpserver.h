@@ -7,6 +7,7 @@
 
 #include <string>
 #include <functional>
+#include <memory>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
@@ -16,6 +17,7 @@ struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkedReply;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -58,6 +60,8 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    //! Set while a chunked reply is in progress
+    std::shared_ptr<HTTPChunkedReply> chunked;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, bool replySent = false);
@@ -114,6 +118,40 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply, for replies too large to build in memory.
+     * nStatus is the HTTP status code to send.
+     *
+     * @note Write the headers first, then send the body with any number of
+     * WriteReplyChunk calls and finish with WriteReplyEnd.
+     */
+    void WriteReplyStart(int nStatus);
+
+    /**
+     * Send the next part of a chunked reply.
+     * Blocks while too much of the reply is still waiting to be sent to the client,
+     * for at most -rpcservertimeout seconds.
+     * Returns false if the client went away, stopped reading or the node is shutting down,
+     * in which case the rest of the reply should not be generated.
+     */
+    bool WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Finish a chunked reply.
+     * If the client stopped reading the connection is closed instead, as in WriteReplyAbort.
+     *
+     * @note As with WriteReply, do not call any other HTTPRequest methods after calling this.
+     */
+    void WriteReplyEnd();
+
+    /**
+     * End a chunked reply by closing the connection without the terminating chunk,
+     * so the client sees the reply is incomplete.
+     *
+     * @note As with WriteReply, do not call any other HTTPRequest methods after calling this.
+     */
+    void WriteReplyAbort();
 };
 
 /** Event handler closure.
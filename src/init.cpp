@@ -12,6 +12,7 @@
 #include <addrman.h>
 #include <amount.h>
 #include <banman.h>
+#include <blockcache.h>
 #include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
@@ -37,6 +38,7 @@
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
+#include <proofcache.h>
 #include <protocol.h>
 #include <rpc/blockchain.h>
 #include <rpc/register.h>
@@ -97,6 +99,7 @@
 #if ENABLE_ZMQ
 #include <zmq/zmqabstractnotifier.h>
 #include <zmq/zmqnotificationinterface.h>
+#include <zmq/zmqpublishnotifier.h>
 #include <zmq/zmqrpc.h>
 #endif
 
@@ -376,6 +379,7 @@ void Shutdown(NodeContext& node)
         for (CChainState* chainstate : node.chainman->GetAll()) {
             if (chainstate->CanFlushToDisk()) {
                 chainstate->ForceFlushStateToDisk();
+                ClearChainstateReadView();
                 chainstate->ResetCoinsViews();
             }
         }
@@ -502,6 +506,7 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-alertnotify=<cmd>", "Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #endif
     argsman.AddArg("-assumevalid=<hex>", strprintf("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s )", defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex() /*, signetChainParams->GetConsensus().defaultAssumeValid.GetHex()*/), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-blockcachesize=<n>", strprintf("Keep up to <n> MiB of recently connected blocks in memory to serve peer and REST requests, 0 to disable (default: %u)", DEFAULT_BLOCK_CACHE_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blocksdir=<dir>", "Specify directory to hold blocks subdirectory for *.dat files (default: <datadir>)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #if HAVE_SYSTEM
     argsman.AddArg("-blocknotify=<cmd>", "Execute command when the best block changes (%s in cmd is replaced by block hash)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -512,10 +517,14 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-datadir=<dir>", "Specify data directory", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbcache=<n>", strprintf("Maximum database cache size <n> MiB (%d to %d, default: %d). In addition, unused mempool memory is shared for this cache (see -maxmempool).", nMinDbCache, nMaxDbCache, nDefaultDbCache), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-addressdbcache=<n>", "Cache size in MiB of the insight index database, blocks/insight (default: share of -dbcache)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-gvrdbcache=<n>", "Cache size in MiB of the cold reward tracker database, blocks/gvr (default: share of -dbcache)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-rctdbcache=<n>", "Cache size in MiB of the anon output and key image database, blocks/rct (default: share of -dbcache)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-debuglogfile=<file>", strprintf("Specify location of debug log file. Relative paths will be prefixed by a net-specific datadir location. (-nodebuglogfile to disable; default: %s)", DEFAULT_DEBUGLOGFILE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-feefilter", strprintf("Tell other nodes to filter invs to us by our mempool min fee (default: %u)", DEFAULT_FEEFILTER), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-includeconf=<file>", "Specify additional configuration file, relative to the -datadir path (only useable from configuration file, not command line)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-loadblock=<file>", "Imports blocks from external file on startup", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-loadblockthreads=<n>", strprintf("Set the number of threads deserializing blocks ahead of validation during -reindex and -loadblock (0 = disable, max: %d, default: %d)", MAX_LOADBLOCK_THREADS, DEFAULT_LOADBLOCK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-maxmempool=<n>", strprintf("Keep the transaction memory pool below <n> megabytes (default: %u)", DEFAULT_MAX_MEMPOOL_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-maxorphantx=<n>", strprintf("Keep at most <n> unconnectable transactions in memory (default: %u)", DEFAULT_MAX_ORPHAN_TRANSACTIONS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-mempoolexpiry=<n>", strprintf("Do not keep transactions in the mempool longer than <n> hours (default: %u)", DEFAULT_MEMPOOL_EXPIRY), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -590,9 +599,15 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-proxy=<ip:port>", "Connect through SOCKS5 proxy, set -noproxy to disable (default: disabled)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-proxyrandomize", strprintf("Randomize credentials for every proxy connection. This enables Tor stream isolation (default: %u)", DEFAULT_PROXYRANDOMIZE), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-seednode=<ip>", "Connect to a node to retrieve peer addresses, and disconnect. This option can be specified multiple times to connect to multiple nodes.", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-msghandlerthreads=<n>", strprintf("Number of threads processing peer messages, each peer is handled by one thread (1 to %d, default: %d)", MAX_MSGHANDLER_THREADS, DEFAULT_MSGHANDLER_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-networkactive", "Enable all P2P network activity (default: 1). Can be changed by the setnetworkactive RPC command", ArgsManager::ALLOW_BOOL, OptionsCategory::CONNECTION);
     argsman.AddArg("-timeout=<n>", strprintf("Specify connection timeout in milliseconds (minimum: 1, default: %d)", DEFAULT_CONNECT_TIMEOUT), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-peertimeout=<n>", strprintf("Specify p2p connection timeout in seconds. This option determines the amount of time a peer may be inactive before the connection to it is dropped. (minimum: 1, default: %d)", DEFAULT_PEER_CONNECT_TIMEOUT), true, OptionsCategory::CONNECTION);
+#ifdef USE_EPOLL
+    argsman.AddArg("-socketevents=<mode>", strprintf("Socket readiness backend used by the network thread, epoll or poll (default: %s)", DEFAULT_SOCKETEVENTS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+#else
+    hidden_args.emplace_back("-socketevents=<mode>");
+#endif
     argsman.AddArg("-torcontrol=<ip>:<port>", strprintf("Tor control port to use if onion listening enabled (default: %s)", DEFAULT_TOR_CONTROL), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-torpassword=<pass>", "Tor control port password (default: empty)", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::CONNECTION);
 #ifdef USE_UPNP
@@ -632,10 +647,13 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-zmqpubrawblockhwm=<n>", strprintf("Set publish raw block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtxhwm=<n>", strprintf("Set publish raw transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequencehwm=<n>", strprintf("Set publish hash sequence message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawtxbatch=<n>", strprintf("Publish up to <n> raw transactions in one rawtx message while earlier messages are waiting to be sent (1 to %d, default: %d)", MAX_ZMQ_RAWTX_BATCH, DEFAULT_ZMQ_RAWTX_BATCH), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 
     // Ghost
     argsman.AddArg("-zmqpubhashwtx=<address>", "Enable publish hash transaction received by wallets in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsmsg=<address>", "Enable publish secure message in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubhashwtxhwm=<n>", strprintf("Set publish hash wallet transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubsmsghwm=<n>", strprintf("Set publish secure message outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-serverkeyzmq=<secret_key>", "Base64 encoded string of the z85 encoded secret key for CurveZMQ.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-newserverkeypairzmq", "Generate new key pair for CurveZMQ, print and exit.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-whitelistzmq=<IP address or network>", "Whitelist peers connecting from the given IP address (e.g. 1.2.3.4) or CIDR notated network (e.g. 1.2.3.0/24). Can be specified multiple times.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
@@ -650,9 +668,12 @@ void SetupServerArgs(NodeContext& node)
     hidden_args.emplace_back("-zmqpubrawblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubsequencehwm=<n>");
+    hidden_args.emplace_back("-zmqpubrawtxbatch=<n>");
 
     hidden_args.emplace_back("-zmqpubhashwtx=<address>");
     hidden_args.emplace_back("-zmqpubsmsg=<address>");
+    hidden_args.emplace_back("-zmqpubhashwtxhwm=<n>");
+    hidden_args.emplace_back("-zmqpubsmsghwm=<n>");
     hidden_args.emplace_back("-serverkeyzmq=<secret_key>");
     hidden_args.emplace_back("-newserverkeypairzmq");
     hidden_args.emplace_back("-whitelistzmq=<IP address or network>");
@@ -685,6 +706,7 @@ void SetupServerArgs(NodeContext& node)
 #endif
     argsman.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-mocktime=<n>", "Replace actual time with " + UNIX_EPOCH_TIME + " (default: 0)", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-maxproofcachesize=<n>", strprintf("Limit size of the verified rangeproof and mlsag cache to <n> MiB (default: %u)", DEFAULT_MAX_PROOF_CACHE_SIZE), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-maxsigcachesize=<n>", strprintf("Limit sum of signature cache and script execution cache sizes to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-printpriority", strprintf("Log transaction fee per kB when mining blocks (default: %u)", DEFAULT_PRINTPRIORITY), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
@@ -713,8 +735,10 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-rest", strprintf("Accept public REST requests (default: %u)", DEFAULT_REST_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcallowip=<ip>", "Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcauth=<userpw>", "Username and HMAC-SHA-256 hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcauth. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::RPC);
+    argsman.AddArg("-rpcbatchthreads=<n>", strprintf("Execute the entries of JSON-RPC batch requests in parallel on up to <n> additional threads. Entries of one batch can then run concurrently and in any order, results are returned in order (0 to %d, default: %d)", MAX_RPC_BATCH_THREADS, DEFAULT_RPC_BATCH_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcbind=<addr>[:port]", "Bind to given address to listen for JSON-RPC connections. Do not expose the RPC server to untrusted networks such as the public internet! This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost)", ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY | ArgsManager::SENSITIVE, OptionsCategory::RPC);
     argsman.AddArg("-rpccookiefile=<loc>", "Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcmethodlimit=<method>:<n>", "Allow at most <n> concurrent calls of an RPC method, further calls wait for a free slot (0 = no limit). This option can be specified multiple times", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcpassword=<pw>", "Password for JSON-RPC connections", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::RPC);
     argsman.AddArg("-rpcport=<port>", strprintf("Listen for JSON-RPC connections on <port> (default: %u, testnet: %u, regtest: %u)", defaultBaseParams->RPCPort(), testnetBaseParams->RPCPort(), /*signetBaseParams->RPCPort(),*/ regtestBaseParams->RPCPort()), ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::RPC);
     argsman.AddArg("-rpcserialversion", strprintf("Sets the serialization of raw transaction or block hex returned in non-verbose mode, non-segwit(0) or segwit(1) (default: %d)", DEFAULT_RPC_SERIALIZE_VERSION), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
@@ -1340,6 +1364,13 @@ bool AppInitParameterInteraction(const ArgsManager& args)
         return InitError(Untranslated("peertimeout cannot be configured with a negative value."));
     }
 
+#ifdef USE_EPOLL
+    const std::string socket_events = args.GetArg("-socketevents", DEFAULT_SOCKETEVENTS);
+    if (socket_events != "epoll" && socket_events != "poll") {
+        return InitError(strprintf(_("Unknown -socketevents value %s."), socket_events));
+    }
+#endif
+
     if (args.IsArgSet("-minrelaytxfee")) {
         CAmount n = 0;
         if (!ParseMoney(args.GetArg("-minrelaytxfee", ""), n)) {
@@ -1394,6 +1425,13 @@ bool AppInitParameterInteraction(const ArgsManager& args)
     if (args.GetArg("-rpcserialversion", DEFAULT_RPC_SERIALIZE_VERSION) > 1)
         return InitError(Untranslated("Unknown rpcserialversion requested."));
 
+    {
+        std::string error;
+        if (!SetRPCMethodLimits(args.GetArgs("-rpcmethodlimit"), error)) {
+            return InitError(Untranslated(error));
+        }
+    }
+
     nMaxTipAge = args.GetArg("-maxtipage", DEFAULT_MAX_TIP_AGE);
 
     if (args.IsArgSet("-proxy") && args.GetArg("-proxy", "").empty()) {
@@ -1527,6 +1565,8 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
 
     InitSignatureCache();
     InitScriptExecutionCache();
+    InitProofCache();
+    InitBlockCache();
 
     int script_threads = args.GetArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
     if (script_threads <= 0) {
@@ -1775,6 +1815,7 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
     int64_t nTotalCache = (args.GetArg("-dbcache", nDefaultDbCache) << 20);
     nTotalCache = std::max(nTotalCache, nMinDbCache << 20); // total cache cannot be less than nMinDbCache
     nTotalCache = std::min(nTotalCache, nMaxDbCache << 20); // total cache cannot be greater than nMaxDbcache
+    nTotalCache = std::max(nTotalCache, (nMinDbCache + 4 * nMinBlockTreeSubDBCache) << 20); // room for the smallest block tree databases
     int64_t nBlockTreeDBCache = nTotalCache / 8;
 
     if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) || gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
@@ -1785,6 +1826,27 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
     }
 
     //int64_t nBlockTreeDBCache = std::min(nTotalCache / 8, nMaxBlockDBCache << 20);
+
+    // Split the block tree budget between the block index and the subsystem databases,
+    // the insight indexes take what is left after the others.
+    // Each database gets at least nMinBlockTreeSubDBCache and the overrides are taken from
+    // the same budget, which always leaves nMinDbCache for the chainstate.
+    BlockTreeDBCacheSizes block_tree_cache;
+    int num_sub_dbs = 4;
+    int64_t block_tree_budget = nTotalCache - (nMinDbCache << 20);
+    auto sub_db_cache = [&](const std::string &arg, int64_t default_size) -> int64_t {
+        int64_t size = !arg.empty() && args.IsArgSet(arg) ? args.GetArg(arg, 0) << 20 : default_size;
+        size = std::min(std::max(size, nMinBlockTreeSubDBCache << 20), nMaxDbCache << 20);
+        num_sub_dbs--;
+        size = std::min(size, block_tree_budget - num_sub_dbs * (nMinBlockTreeSubDBCache << 20));
+        block_tree_budget -= size;
+        return size;
+    };
+    block_tree_cache.index = sub_db_cache("", nBlockTreeDBCache / 8);
+    block_tree_cache.rct = sub_db_cache("-rctdbcache", nBlockTreeDBCache / 8);
+    block_tree_cache.gvr = sub_db_cache("-gvrdbcache", nBlockTreeDBCache / 16);
+    block_tree_cache.insight = sub_db_cache("-addressdbcache", nBlockTreeDBCache - nBlockTreeDBCache / 8 * 2 - nBlockTreeDBCache / 16);
+    nBlockTreeDBCache = block_tree_cache.index + block_tree_cache.rct + block_tree_cache.gvr + block_tree_cache.insight;
     nTotalCache -= nBlockTreeDBCache;
     int64_t nTxIndexCache = std::min(nTotalCache / 8, args.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
     nTotalCache -= nTxIndexCache;
@@ -1802,7 +1864,10 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
     int64_t nMempoolSizeMax = args.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
     LogPrintf("Cache configuration:\n");
     LogPrintf("* Max cache setting possible %.1fMiB\n", nMaxDbCache);
-    LogPrintf("* Using %.1f MiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1f MiB for block index database\n", block_tree_cache.index * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1f MiB for anon output database\n", block_tree_cache.rct * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1f MiB for insight index database\n", block_tree_cache.insight * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1f MiB for cold reward tracker database\n", block_tree_cache.gvr * (1.0 / 1024 / 1024));
     if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         LogPrintf("* Using %.1f MiB for transaction index database\n", nTxIndexCache * (1.0 / 1024 / 1024));
     }
@@ -1837,14 +1902,20 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
                 // new CBlockTreeDB tries to delete the existing file, which
                 // fails if it's still open from the previous loop. Close it first:
                 pblocktree.reset();
-                pblocktree.reset(new CBlockTreeDB(nBlockTreeDBCache, false, fReset));
+                pblocktree.reset(new CBlockTreeDB(block_tree_cache, false, fReset));
 
                 // Automatically start reindexing if necessary
                 if (!fReset && ShouldAutoReindex()) {
                     fReindex = true;
                     fReset = true;
                     pblocktree.reset();
-                    pblocktree.reset(new CBlockTreeDB(nBlockTreeDBCache, false, fReset));
+                    pblocktree.reset(new CBlockTreeDB(block_tree_cache, false, fReset));
+                }
+
+                if (!pblocktree->MigrateSubsystemDBs()) {
+                    if (ShutdownRequested()) break;
+                    strLoadError = _("Error splitting block database");
+                    break;
                 }
 
                 if (fReset) {
@@ -2242,6 +2313,11 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
     connOptions.nMaxOutboundTimeframe = nMaxOutboundTimeframe;
     connOptions.nMaxOutboundLimit = nMaxOutboundLimit;
     connOptions.m_peer_connect_timeout = peer_connect_timeout;
+#ifdef USE_EPOLL
+    connOptions.m_use_epoll = args.GetArg("-socketevents", DEFAULT_SOCKETEVENTS) == "epoll";
+#endif
+    connOptions.m_msghandler_threads = args.GetArg("-msghandlerthreads", DEFAULT_MSGHANDLER_THREADS);
+    connOptions.m_smsg_handler_thread = smsg::fSecMsgEnabled && args.GetBoolArg("-smsghandlerthread", DEFAULT_SMSG_HANDLER_THREAD);
 
     for (const std::string& bind_arg : args.GetArgs("-bind")) {
         CService bind_addr;
@@ -0,0 +1,147 @@
+// Copyright (c) 2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <insight/blockdeltas.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <insight/insight.h>
+#include <shutdown.h>
+#include <tinyformat.h>
+#include <undo.h>
+#include <util/threadnames.h>
+#include <validation.h>
+
+BlockDeltasReader::BlockDeltasReader(int start, int end, size_t max_prefetch)
+    : m_start(start), m_end(end), m_max_prefetch(std::max(max_prefetch, (size_t)1))
+{
+    m_thread = std::thread([this] {
+        util::ThreadRename("blockdeltas");
+        ThreadRead();
+    });
+}
+
+BlockDeltasReader::~BlockDeltasReader()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+        m_cond.notify_all();
+    }
+    m_thread.join();
+}
+
+bool BlockDeltasReader::Next(CBlockDeltasItem &item)
+{
+    WAIT_LOCK(m_mutex, lock);
+    while (m_items.empty() && !m_done) {
+        m_cond.wait(lock);
+    }
+    if (m_items.empty()) {
+        return false;
+    }
+    item = std::move(m_items.front());
+    m_items.pop_front();
+    m_cond.notify_all();
+    return true;
+}
+
+std::string BlockDeltasReader::GetError()
+{
+    LOCK(m_mutex);
+    return m_error;
+}
+
+bool BlockDeltasReader::ReadBlock(int height, const uint256 &prev_hash, CBlockDeltasItem &item, std::string &error)
+{
+    CBlock block;
+    CBlockUndo blockundo;
+    const CBlockIndex *pindex;
+    FlatFilePos block_pos, undo_pos;
+    uint256 undo_prev_hash;
+    {
+        // Copy what's needed from the block index under cs_main, the disk reads are done without it
+        LOCK(cs_main);
+        pindex = ::ChainActive()[height];
+        if (!pindex) {
+            error = strprintf("Block height %d out of range", height);
+            return false;
+        }
+        if (IsBlockPruned(pindex)) {
+            error = strprintf("Block %d not available (pruned data)", height);
+            return false;
+        }
+        item.hash = pindex->GetBlockHash();
+        item.median_time = pindex->GetMedianTimePast();
+        block_pos = pindex->GetBlockPos();
+        undo_pos = pindex->GetUndoPos();
+        if (pindex->pprev) {
+            undo_prev_hash = pindex->pprev->GetBlockHash();
+        }
+    }
+
+    // The files may be pruned while reading, the hash and checksum checks catch reused files
+    if (!ReadBlockFromDisk(block, block_pos, Params().GetConsensus()) || block.GetHash() != item.hash) {
+        error = strprintf("Can't read block %d from disk", height);
+        return false;
+    }
+    // The genesis block is not connected and has no undo data
+    if (height > 0 && !UndoReadFromDisk(blockundo, undo_pos, undo_prev_hash)) {
+        error = strprintf("Can't read undo data for block %d from disk", height);
+        return false;
+    }
+    if (WITH_LOCK(cs_main, return IsBlockPruned(pindex))) {
+        error = strprintf("Block %d not available (pruned data)", height);
+        return false;
+    }
+    if (height > m_start && block.hashPrevBlock != prev_hash) {
+        error = strprintf("Active chain changed at block %d while reading", height);
+        return false;
+    }
+    if (!GetBlockDeltas(block, blockundo, item.txs)) {
+        error = strprintf("Block %d and undo data inconsistent", height);
+        return false;
+    }
+
+    item.header.header = block.GetBlockHeader();
+    item.header.height = height;
+    item.header.num_tx = block.vtx.size();
+    return true;
+}
+
+void BlockDeltasReader::ThreadRead()
+{
+    uint256 prev_hash;
+    std::string error;
+    for (int height = m_start; height <= m_end; height++) {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            while (!m_stop && m_items.size() >= m_max_prefetch) {
+                m_cond.wait(lock);
+            }
+            if (m_stop) {
+                break;
+            }
+        }
+        if (ShutdownRequested()) {
+            error = "Shutting down";
+            break;
+        }
+
+        CBlockDeltasItem item;
+        if (!ReadBlock(height, prev_hash, item, error)) {
+            break;
+        }
+        prev_hash = item.hash;
+
+        LOCK(m_mutex);
+        m_items.push_back(std::move(item));
+        m_cond.notify_all();
+    }
+
+    LOCK(m_mutex);
+    m_error = error;
+    m_done = true;
+    m_cond.notify_all();
+}
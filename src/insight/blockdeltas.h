@@ -0,0 +1,122 @@
+// Copyright (c) 2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PARTICL_INSIGHT_BLOCKDELTAS_H
+#define PARTICL_INSIGHT_BLOCKDELTAS_H
+
+#include <amount.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Number of blocks read ahead of the writer by a range export
+static const size_t BLOCK_DELTAS_PREFETCH = 16;
+
+/** Value leaving an address through a transaction input */
+struct CInputDelta {
+    uint32_t index{0};
+    COutPoint prevout;
+    uint8_t addressType{0};
+    uint256 addressHash;
+    CAmount satoshis{0}; // -1 for blinded inputs
+
+    SERIALIZE_METHODS(CInputDelta, obj)
+    {
+        READWRITE(obj.index, obj.prevout, obj.addressType, obj.addressHash, obj.satoshis);
+    }
+};
+
+/** Value received by a transaction output.
+ * Blinded outputs carry their commitment in data, anon outputs their pubkey and commitment.
+ */
+struct COutputDelta {
+    uint32_t index{0};
+    uint8_t type{0};
+    uint8_t addressType{0};
+    uint256 addressHash;
+    CAmount satoshis{0};
+    std::vector<uint8_t> data;
+
+    SERIALIZE_METHODS(COutputDelta, obj)
+    {
+        READWRITE(obj.index, obj.type, obj.addressType, obj.addressHash, obj.satoshis, obj.data);
+    }
+};
+
+/** Address deltas of one transaction in a block, as returned by getblockdeltas */
+struct CTxDeltas {
+    uint256 txid;
+    uint32_t index{0};
+    std::vector<CInputDelta> inputs;
+    std::vector<COutputDelta> outputs;
+
+    SERIALIZE_METHODS(CTxDeltas, obj)
+    {
+        READWRITE(obj.txid, obj.index, obj.inputs, obj.outputs);
+    }
+};
+
+/** Block fields preceding the transaction deltas in the binary format */
+struct CBlockDeltasHeader {
+    CBlockHeader header;
+    int32_t height{0};
+    uint32_t num_tx{0};
+
+    SERIALIZE_METHODS(CBlockDeltasHeader, obj)
+    {
+        READWRITE(obj.header, obj.height, obj.num_tx);
+    }
+};
+
+/** Deltas of one block of a range export */
+struct CBlockDeltasItem {
+    CBlockDeltasHeader header;
+    uint256 hash;
+    int64_t median_time{0};
+    std::vector<CTxDeltas> txs;
+};
+
+/**
+ * Reads the blocks of a height range of the active chain with their undo
+ * data on a background thread, ahead of the caller writing them out.
+ * Input values and addresses are taken from the undo data, so no index
+ * lookups are needed per input.
+ */
+class BlockDeltasReader
+{
+public:
+    BlockDeltasReader(int start, int end, size_t max_prefetch = BLOCK_DELTAS_PREFETCH);
+    ~BlockDeltasReader();
+
+    /** Wait for the next block in the range, returns false when done or on error. */
+    bool Next(CBlockDeltasItem &item);
+    /** Why the range was not read completely, empty if it was. */
+    std::string GetError();
+
+private:
+    const int m_start;
+    const int m_end;
+    const size_t m_max_prefetch;
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<CBlockDeltasItem> m_items GUARDED_BY(m_mutex);
+    bool m_done GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::string m_error GUARDED_BY(m_mutex);
+    std::thread m_thread;
+
+    void ThreadRead();
+    bool ReadBlock(int height, const uint256 &prev_hash, CBlockDeltasItem &item, std::string &error);
+};
+
+#endif // PARTICL_INSIGHT_BLOCKDELTAS_H
@@ -4,12 +4,14 @@
 
 #include <insight/insight.h>
 #include <insight/addressindex.h>
+#include <insight/blockdeltas.h>
 #include <insight/spentindex.h>
 #include <insight/timestampindex.h>
 #include <validation.h>
 #include <txdb.h>
 #include <txmempool.h>
 #include <uint256.h>
+#include <undo.h>
 #include <script/script.h>
 #include <script/standard.h>
 #include <key_io.h>
@@ -91,7 +93,8 @@ bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const
     return true;
 };
 
-bool GetSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool *pmempool)
+bool GetSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool *pmempool,
+                   const CBlockTreeSnapshot *snapshot)
 {
     if (!fSpentIndex) {
         return false;
@@ -99,7 +102,8 @@ bool GetSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value, const CTx
     if (pmempool && pmempool->getSpentIndex(key, value)) {
         return true;
     }
-    if (!pblocktree->ReadSpentIndex(key, value)) {
+    if (snapshot ? !snapshot->ReadSpentIndex(key, value)
+                 : !pblocktree->ReadSpentIndex(key, value)) {
         return false;
     }
 
@@ -118,12 +122,14 @@ bool HashOnchainActive(const uint256 &hash)
 };
 
 bool GetAddressIndex(const uint256 &addressHash, int type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
+                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end,
+                     const CBlockTreeSnapshot *snapshot)
 {
     if (!fAddressIndex) {
         return error("Address index not enabled");
     }
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end)) {
+    if (snapshot ? !snapshot->ReadAddressIndex(addressHash, type, addressIndex, start, end)
+                 : !pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end)) {
         return error("Unable to get txids for address");
     }
 
@@ -131,30 +137,170 @@ bool GetAddressIndex(const uint256 &addressHash, int type,
 };
 
 bool GetAddressUnspent(const uint256 &addressHash, int type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                       const CBlockTreeSnapshot *snapshot)
 {
     if (!fAddressIndex) {
         return error("Address index not enabled");
     }
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)) {
+    if (snapshot ? !snapshot->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)
+                 : !pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)) {
         return error("Unable to get txids for address");
     }
 
     return true;
 };
 
-bool GetBlockBalances(const uint256 &block_hash, BlockBalances &balances)
+bool GetBlockBalances(const uint256 &block_hash, BlockBalances &balances, const CBlockTreeSnapshot *snapshot)
 {
     if (!fBalancesIndex) {
         return error("Balances index not enabled");
     }
-    if (!pblocktree->ReadBlockBalancesIndex(block_hash, balances)) {
+    if (snapshot ? !snapshot->ReadBlockBalancesIndex(block_hash, balances)
+                 : !pblocktree->ReadBlockBalancesIndex(block_hash, balances)) {
         return error("Unable to get balances for block %s", block_hash.ToString());
     }
 
     return true;
 };
 
+/** Only plain P2PKH and P2SH outputs are given an address by getblockdeltas */
+static void SetOutputAddress(const CScript &script, COutputDelta &delta)
+{
+    if (script.IsPayToScriptHash()) {
+        delta.addressType = ADDR_INDT_SCRIPT_ADDRESS;
+        delta.addressHash = uint256(script.data() + 2, 20);
+    } else
+    if (script.IsPayToPublicKeyHash()) {
+        delta.addressType = ADDR_INDT_PUBKEY_ADDRESS;
+        delta.addressHash = uint256(script.data() + 3, 20);
+    } else
+    if (script.IsPayToScriptHash256()) {
+        delta.addressType = ADDR_INDT_SCRIPT_ADDRESS_256;
+        delta.addressHash = uint256(script.data() + 2, 32);
+    } else
+    if (script.IsPayToPublicKeyHash256()) {
+        delta.addressType = ADDR_INDT_PUBKEY_ADDRESS_256;
+        delta.addressHash = uint256(script.data() + 3, 32);
+    }
+}
+
+static void AddOutputDeltas(const CTransaction &tx, CTxDeltas &deltas)
+{
+    for (size_t k = 0; k < tx.vpout.size(); k++) {
+        const CTxOutBase *out = tx.vpout[k].get();
+        COutputDelta delta;
+        delta.index = k;
+        delta.type = out->GetType();
+
+        if (out->IsType(OUTPUT_STANDARD) || out->IsType(OUTPUT_CT)) {
+            const CScript *pScript = out->GetPScriptPubKey();
+            if (out->IsType(OUTPUT_STANDARD)) {
+                delta.satoshis = out->GetValue();
+            }
+            SetOutputAddress(*pScript, delta);
+            if (out->IsType(OUTPUT_CT)) {
+                const CTxOutCT *ct = (const CTxOutCT*) out;
+                delta.data.assign(ct->commitment.data, ct->commitment.data + 33);
+            }
+        } else
+        if (out->IsType(OUTPUT_RINGCT)) {
+            const CTxOutRingCT *rct = (const CTxOutRingCT*) out;
+            delta.data.assign(rct->pk.begin(), rct->pk.end());
+            delta.data.insert(delta.data.end(), rct->commitment.data, rct->commitment.data + 33);
+        } else {
+            continue;
+        }
+        deltas.outputs.push_back(delta);
+    }
+}
+
+bool GetTxDeltas(const CTransaction &tx, unsigned int index, const CTxMemPool *pmempool, CTxDeltas &deltas,
+                 const CBlockTreeSnapshot *snapshot)
+{
+    deltas.txid = tx.GetHash();
+    deltas.index = index;
+    deltas.inputs.clear();
+    deltas.outputs.clear();
+
+    if (!tx.IsCoinBase()) {
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const CTxIn &input = tx.vin[j];
+            CSpentIndexValue spentInfo;
+            if (!GetSpentIndex(CSpentIndexKey(input.prevout.hash, input.prevout.n), spentInfo, pmempool, snapshot)) {
+                return false;
+            }
+            CInputDelta delta;
+            delta.index = j;
+            delta.prevout = input.prevout;
+            delta.addressType = spentInfo.addressType;
+            delta.addressHash = spentInfo.addressHash;
+            delta.satoshis = spentInfo.satoshis;
+            deltas.inputs.push_back(delta);
+        }
+    }
+
+    AddOutputDeltas(tx, deltas);
+    return true;
+};
+
+bool GetTxDeltasFromUndo(const CTransaction &tx, unsigned int index, const CTxUndo *txundo, CTxDeltas &deltas)
+{
+    deltas.txid = tx.GetHash();
+    deltas.index = index;
+    deltas.inputs.clear();
+    deltas.outputs.clear();
+
+    if (!tx.IsCoinBase()) {
+        // Anon inputs have no undo data and are skipped
+        size_t k = 0;
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const CTxIn &input = tx.vin[j];
+            if (input.IsAnonInput()) {
+                continue;
+            }
+            if (!txundo || k >= txundo->vprevout.size()) {
+                return false;
+            }
+            const Coin &coin = txundo->vprevout[k++];
+            CInputDelta delta;
+            delta.index = j;
+            delta.prevout = input.prevout;
+            delta.satoshis = coin.nType == OUTPUT_CT ? -1 : coin.out.nValue;
+            std::vector<uint8_t> hashBytes;
+            int scriptType = 0;
+            if (ExtractIndexInfo(&coin.out.scriptPubKey, scriptType, hashBytes) && scriptType != ADDR_INDT_UNKNOWN) {
+                delta.addressType = scriptType;
+                delta.addressHash = uint256(hashBytes.data(), hashBytes.size());
+            }
+            deltas.inputs.push_back(delta);
+        }
+    }
+
+    AddOutputDeltas(tx, deltas);
+    return true;
+};
+
+bool GetBlockDeltas(const CBlock &block, const CBlockUndo &blockundo, std::vector<CTxDeltas> &deltas)
+{
+    deltas.resize(block.vtx.size());
+    size_t k = 0;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const CTransaction &tx = *block.vtx[i];
+        const CTxUndo *txundo = nullptr;
+        if (!tx.IsCoinBase()) {
+            if (k >= blockundo.vtxundo.size()) {
+                return false;
+            }
+            txundo = &blockundo.vtxundo[k++];
+        }
+        if (!GetTxDeltasFromUndo(tx, i, txundo, deltas[i])) {
+            return false;
+        }
+    }
+    return k == blockundo.vtxundo.size();
+};
+
 bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address)
 {
     if (type == ADDR_INDT_SCRIPT_ADDRESS) {
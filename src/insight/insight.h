@@ -23,30 +23,47 @@ extern bool fSpentIndex;
 extern bool fTimestampIndex;
 extern bool fBalancesIndex;
 
+class CBlock;
+class CBlockUndo;
+class CTransaction;
 class CTxOutBase;
+class CTxUndo;
 class CScript;
 class uint256;
 class CTxMemPool;
 class BlockBalances;
+class CBlockTreeSnapshot;
 struct CAddressIndexKey;
 struct CAddressUnspentKey;
 struct CAddressUnspentValue;
 struct CSpentIndexKey;
 struct CSpentIndexValue;
+struct CTxDeltas;
 
 bool ExtractIndexInfo(const CScript *pScript, int &scriptType, std::vector<uint8_t> &hashBytes);
 bool ExtractIndexInfo(const CTxOutBase *out, int &scriptType, std::vector<uint8_t> &hashBytes, CAmount &nValue, const CScript *&pScript);
 
-/** Functions for insight block explorer */
+/** Functions for insight block explorer
+ * Where snapshot is set the index is read from it instead of pblocktree.
+ */
 bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
-bool GetSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool *pmempool);
+bool GetSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool *pmempool,
+                   const CBlockTreeSnapshot *snapshot = nullptr);
 bool HashOnchainActive(const uint256 &hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 bool GetAddressIndex(const uint256 &addressHash, int type,
                      std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                     int start = 0, int end = 0);
+                     int start = 0, int end = 0, const CBlockTreeSnapshot *snapshot = nullptr);
 bool GetAddressUnspent(const uint256 &addressHash, int type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
-bool GetBlockBalances(const uint256 &block_hash, BlockBalances &balances);
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                       const CBlockTreeSnapshot *snapshot = nullptr);
+/** Get the address deltas of a transaction in a block, inputs are resolved through the spent index */
+bool GetTxDeltas(const CTransaction &tx, unsigned int index, const CTxMemPool *pmempool, CTxDeltas &deltas,
+                 const CBlockTreeSnapshot *snapshot = nullptr);
+/** As above, with the inputs resolved from the transaction's undo data, null for the coinbase */
+bool GetTxDeltasFromUndo(const CTransaction &tx, unsigned int index, const CTxUndo *txundo, CTxDeltas &deltas);
+/** Get the address deltas of all transactions in a block from the block's undo data */
+bool GetBlockDeltas(const CBlock &block, const CBlockUndo &blockundo, std::vector<CTxDeltas> &deltas);
+bool GetBlockBalances(const uint256 &block_hash, BlockBalances &balances, const CBlockTreeSnapshot *snapshot = nullptr);
 
 bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address);
 
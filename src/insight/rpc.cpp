@@ -8,15 +8,19 @@
 
 #include <util/strencodings.h>
 #include <insight/insight.h>
+#include <insight/blockdeltas.h>
 #include <insight/csindex.h>
+#include <insight/rpc.h>
 #include <index/txindex.h>
 #include <validation.h>
 #include <txmempool.h>
 #include <key_io.h>
 #include <core_io.h>
+#include <fs.h>
 #include <node/context.h>
 #include <script/standard.h>
 #include <shutdown.h>
+#include <streams.h>
 
 #include <univalue.h>
 
@@ -25,7 +29,7 @@
 // Avoid initialization-order-fiasco
 #define _UNIX_EPOCH_TIME "UNIX epoch time"
 
-static bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type) {
+bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type) {
     if (dest.type() == typeid(PKHash)) {
         const PKHash &id = boost::get<PKHash>(dest);
         memcpy(hashBytes.begin(), id.begin(), 20);
@@ -100,6 +104,38 @@ bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint25
     return true;
 }
 
+bool AddressUtxoToJSON(const CAddressUnspentKey &key, const CAddressUnspentValue &value, UniValue &output)
+{
+    std::string address;
+    if (!getAddressFromIndex(key.type, key.hashBytes, address)) {
+        return false;
+    }
+
+    output.pushKV("address", address);
+    output.pushKV("txid", key.txhash.GetHex());
+    output.pushKV("outputIndex", (int)key.index);
+    output.pushKV("script", HexStr(value.script));
+    output.pushKV("satoshis", value.satoshis);
+    output.pushKV("height", value.blockHeight);
+    return true;
+}
+
+bool AddressDeltaToJSON(const CAddressIndexKey &key, CAmount amount, UniValue &delta)
+{
+    std::string address;
+    if (!getAddressFromIndex(key.type, key.hashBytes, address)) {
+        return false;
+    }
+
+    delta.pushKV("satoshis", amount);
+    delta.pushKV("txid", key.txhash.GetHex());
+    delta.pushKV("index", (int)key.index);
+    delta.pushKV("blockindex", (int)key.txindex);
+    delta.pushKV("height", key.blockHeight);
+    delta.pushKV("address", address);
+    return true;
+}
+
 bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
                 std::pair<CAddressUnspentKey, CAddressUnspentValue> b)
 {
@@ -235,9 +271,13 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    // Read the index and chain info from the same snapshot, without waiting on cs_main
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    const CBlockTreeSnapshot *snapshot = view ? view->block_tree.get() : nullptr;
+
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressUnspent(it->first, it->second, unspentOutputs)) {
+        if (!GetAddressUnspent(it->first, it->second, unspentOutputs, snapshot)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
     }
@@ -248,17 +288,9 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
 
     for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=unspentOutputs.begin(); it!=unspentOutputs.end(); it++) {
         UniValue output(UniValue::VOBJ);
-        std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
+        if (!AddressUtxoToJSON(it->first, it->second, output)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
         }
-
-        output.pushKV("address", address);
-        output.pushKV("txid", it->first.txhash.GetHex());
-        output.pushKV("outputIndex", (int)it->first.index);
-        output.pushKV("script", HexStr(it->second.script));
-        output.pushKV("satoshis", it->second.satoshis);
-        output.pushKV("height", it->second.blockHeight);
         utxos.push_back(output);
     }
 
@@ -266,6 +298,11 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
         UniValue result(UniValue::VOBJ);
         result.pushKV("utxos", utxos);
 
+        if (view) {
+            result.pushKV("hash", view->tip_hash.GetHex());
+            result.pushKV("height", view->tip_height);
+            return result;
+        }
         LOCK(cs_main);
         result.pushKV("hash", ::ChainActive().Tip()->GetBlockHash().GetHex());
         result.pushKV("height", (int)::ChainActive().Height());
@@ -339,15 +376,18 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    const CBlockTreeSnapshot *snapshot = view ? view->block_tree.get() : nullptr;
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
-            if (!GetAddressIndex(it->first, it->second, addressIndex, start, end)) {
+            if (!GetAddressIndex(it->first, it->second, addressIndex, start, end, snapshot)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         } else {
-            if (!GetAddressIndex(it->first, it->second, addressIndex)) {
+            if (!GetAddressIndex(it->first, it->second, addressIndex, 0, 0, snapshot)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         }
@@ -356,20 +396,14 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
     UniValue deltas(UniValue::VARR);
 
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
+        UniValue delta(UniValue::VOBJ);
+        if (!AddressDeltaToJSON(it->first, it->second, delta)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
         }
-
-        UniValue delta(UniValue::VOBJ);
-        delta.pushKV("satoshis", it->second);
-        delta.pushKV("txid", it->first.txhash.GetHex());
-        delta.pushKV("index", (int)it->first.index);
-        delta.pushKV("blockindex", (int)it->first.txindex);
-        delta.pushKV("height", it->first.blockHeight);
-        delta.pushKV("address", address);
         deltas.push_back(delta);
     }
+    // Don't hold the databases open while waiting on cs_main
+    view.reset();
 
     UniValue result(UniValue::VOBJ);
 
@@ -436,10 +470,13 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    const CBlockTreeSnapshot *snapshot = view ? view->block_tree.get() : nullptr;
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex(it->first, it->second, addressIndex)) {
+        if (!GetAddressIndex(it->first, it->second, addressIndex, 0, 0, snapshot)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
     }
@@ -507,15 +544,18 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
         }
     }
 
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    const CBlockTreeSnapshot *snapshot = view ? view->block_tree.get() : nullptr;
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
-            if (!GetAddressIndex(it->first, it->second, addressIndex, start, end)) {
+            if (!GetAddressIndex(it->first, it->second, addressIndex, start, end, snapshot)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         } else {
-            if (!GetAddressIndex(it->first, it->second, addressIndex)) {
+            if (!GetAddressIndex(it->first, it->second, addressIndex, 0, 0, snapshot)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         }
@@ -546,6 +586,15 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
     return result;
 }
 
+UniValue SpentInfoToJSON(const CSpentIndexValue &value)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("txid", value.txid.GetHex());
+    obj.pushKV("index", (int)value.inputIndex);
+    obj.pushKV("height", value.blockHeight);
+    return obj;
+}
+
 UniValue getspentinfo(const JSONRPCRequest& request)
 {
             RPCHelpMan{"getspentinfo",
@@ -587,39 +636,69 @@ UniValue getspentinfo(const JSONRPCRequest& request)
     CSpentIndexKey key(txid, outputIndex);
     CSpentIndexValue value;
 
-    if (!GetSpentIndex(key, value, &mempool)) {
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    if (!GetSpentIndex(key, value, &mempool, view ? view->block_tree.get() : nullptr)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unable to get spent info");
     }
 
-    UniValue obj(UniValue::VOBJ);
-    obj.pushKV("txid", value.txid.GetHex());
-    obj.pushKV("index", (int)value.inputIndex);
-    obj.pushKV("height", value.blockHeight);
-
-    return obj;
+    return SpentInfoToJSON(value);
 }
 
-static void AddAddress(CScript *script, UniValue &uv)
+UniValue TxDeltasToJSON(const CTxDeltas &tx_deltas)
 {
-    if (script->IsPayToScriptHash()) {
-        std::vector<unsigned char> hashBytes(script->begin()+2, script->begin()+22);
-        uv.pushKV("address", EncodeDestination(ScriptHash(uint160(hashBytes))));
-    } else
-    if (script->IsPayToPublicKeyHash()) {
-        std::vector<unsigned char> hashBytes(script->begin()+3, script->begin()+23);
-        uv.pushKV("address", EncodeDestination(PKHash(uint160(hashBytes))));
-    } else
-    if (script->IsPayToScriptHash256()) {
-        std::vector<unsigned char> hashBytes(script->begin()+2, script->begin()+34);
-        uv.pushKV("address", EncodeDestination(CScriptID256(uint256(hashBytes))));
-    } else
-    if (script->IsPayToPublicKeyHash256()) {
-        std::vector<unsigned char> hashBytes(script->begin()+3, script->begin()+35);
-        uv.pushKV("address", EncodeDestination(CKeyID256(uint256(hashBytes))));
+    UniValue entry(UniValue::VOBJ);
+    entry.pushKV("txid", tx_deltas.txid.GetHex());
+    entry.pushKV("index", (int)tx_deltas.index);
+
+    UniValue inputs(UniValue::VARR);
+    for (const auto &input : tx_deltas.inputs) {
+        std::string address;
+        if (!getAddressFromIndex(input.addressType, input.addressHash, address)) {
+            continue;
+        }
+        UniValue delta(UniValue::VOBJ);
+        delta.pushKV("address", address);
+        delta.pushKV("satoshis", -1 * input.satoshis);
+        delta.pushKV("index", (int)input.index);
+        delta.pushKV("prevtxid", input.prevout.hash.GetHex());
+        delta.pushKV("prevout", (int)input.prevout.n);
+        inputs.push_back(delta);
     }
+    entry.pushKV("inputs", inputs);
+
+    UniValue outputs(UniValue::VARR);
+    for (const auto &output : tx_deltas.outputs) {
+        UniValue delta(UniValue::VOBJ);
+        delta.pushKV("index", (int)output.index);
+        switch (output.type) {
+            case OUTPUT_STANDARD:
+                delta.pushKV("type", "standard");
+                delta.pushKV("satoshis", output.satoshis);
+                break;
+            case OUTPUT_CT:
+                delta.pushKV("type", "blind");
+                delta.pushKV("valueCommitment", HexStr(output.data));
+                break;
+            case OUTPUT_RINGCT:
+                delta.pushKV("type", "anon");
+                delta.pushKV("pubkey", HexStr(Span<const uint8_t>(output.data.data(), 33)));
+                delta.pushKV("valueCommitment", HexStr(Span<const uint8_t>(output.data.data() + 33, 33)));
+                break;
+            default:
+                continue;
+        }
+        std::string address;
+        if (getAddressFromIndex(output.addressType, output.addressHash, address)) {
+            delta.pushKV("address", address);
+        }
+        outputs.push_back(delta);
+    }
+    entry.pushKV("outputs", outputs);
+
+    return entry;
 }
 
-static UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blockindex, const CTxMemPool *pmempool)
+UniValue BlockDeltasHeaderToJSON(const CBlock& block, const CBlockIndex* blockindex, const UniValue* deltas)
 {
     UniValue result(UniValue::VOBJ);
     result.pushKV("hash", block.GetHash().GetHex());
@@ -636,97 +715,9 @@ static UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blocki
     result.pushKV("version", block.nVersion);
     result.pushKV("merkleroot", block.hashMerkleRoot.GetHex());
     result.pushKV("witnessmerkleroot", block.hashWitnessMerkleRoot.GetHex());
-
-    UniValue deltas(UniValue::VARR);
-
-    for (unsigned int i = 0; i < block.vtx.size(); i++) {
-        const CTransaction &tx = *(block.vtx[i]);
-        const uint256 txhash = tx.GetHash();
-
-        UniValue entry(UniValue::VOBJ);
-        entry.pushKV("txid", txhash.GetHex());
-        entry.pushKV("index", (int)i);
-
-        UniValue inputs(UniValue::VARR);
-
-        if (!tx.IsCoinBase()) {
-
-            for (size_t j = 0; j < tx.vin.size(); j++) {
-                const CTxIn input = tx.vin[j];
-
-                UniValue delta(UniValue::VOBJ);
-
-                CSpentIndexValue spentInfo;
-                CSpentIndexKey spentKey(input.prevout.hash, input.prevout.n);
-
-                if (GetSpentIndex(spentKey, spentInfo, pmempool)) {
-                    std::string address;
-                    if (!getAddressFromIndex(spentInfo.addressType, spentInfo.addressHash, address)) {
-                        continue;
-                    }
-                    delta.pushKV("address", address);
-                    delta.pushKV("satoshis", -1 * spentInfo.satoshis);
-                    delta.pushKV("index", (int)j);
-                    delta.pushKV("prevtxid", input.prevout.hash.GetHex());
-                    delta.pushKV("prevout", (int)input.prevout.n);
-
-                    inputs.push_back(delta);
-                } else {
-                    throw JSONRPCError(RPC_INTERNAL_ERROR, "Spent information not available");
-                }
-            }
-        }
-
-        entry.pushKV("inputs", inputs);
-
-        UniValue outputs(UniValue::VARR);
-
-        for (unsigned int k = 0; k < tx.vpout.size(); k++) {
-            const CTxOutBase *out = tx.vpout[k].get();
-
-            UniValue delta(UniValue::VOBJ);
-
-            delta.pushKV("index", (int)k);
-
-            switch (out->GetType())
-            {
-                case OUTPUT_STANDARD:
-                    {
-                    delta.pushKV("type", "standard");
-                    CTxOutStandard *s = (CTxOutStandard*) out;
-                    delta.pushKV("satoshis", s->nValue);
-                    AddAddress(&s->scriptPubKey, delta);
-                    }
-                    break;
-                case OUTPUT_CT:
-                    {
-                    CTxOutCT *s = (CTxOutCT*) out;
-                    delta.pushKV("type", "blind");
-                    delta.pushKV("valueCommitment", HexStr(Span<const unsigned char>(s->commitment.data, 33)));
-                    AddAddress(&s->scriptPubKey, delta);
-                    }
-                    break;
-                case OUTPUT_RINGCT:
-                    {
-                    CTxOutRingCT *s = (CTxOutRingCT*) out;
-                    delta.pushKV("type", "anon");
-                    delta.pushKV("pubkey", HexStr(s->pk));
-                    delta.pushKV("valueCommitment", HexStr(Span<const unsigned char>(s->commitment.data, 33)));
-                    }
-                    break;
-                default:
-                    continue;
-                    break;
-            };
-
-            outputs.push_back(delta);
-        }
-
-        entry.pushKV("outputs", outputs);
-        deltas.push_back(entry);
-
+    if (deltas) {
+        result.pushKV("deltas", *deltas);
     }
-    result.pushKV("deltas", deltas);
     PushTime(result, "time", block.GetBlockTime());
     PushTime(result, "mediantime", blockindex->GetMedianTimePast());
     result.pushKV("nonce", (uint64_t)block.nNonce);
@@ -742,6 +733,39 @@ static UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blocki
     return result;
 }
 
+UniValue BlockDeltasItemToJSON(const CBlockDeltasItem &item)
+{
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("hash", item.hash.GetHex());
+    result.pushKV("height", item.header.height);
+    result.pushKV("version", item.header.header.nVersion);
+    result.pushKV("merkleroot", item.header.header.hashMerkleRoot.GetHex());
+    PushTime(result, "time", item.header.header.GetBlockTime());
+    PushTime(result, "mediantime", item.median_time);
+    result.pushKV("previousblockhash", item.header.header.hashPrevBlock.GetHex());
+
+    UniValue deltas(UniValue::VARR);
+    for (const auto &tx_deltas : item.txs) {
+        deltas.push_back(TxDeltasToJSON(tx_deltas));
+    }
+    result.pushKV("deltas", deltas);
+    return result;
+}
+
+static UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blockindex, const CTxMemPool *pmempool) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    UniValue deltas(UniValue::VARR);
+    CTxDeltas tx_deltas;
+    for (unsigned int i = 0; i < block.vtx.size(); i++) {
+        if (!GetTxDeltas(*block.vtx[i], i, pmempool, tx_deltas)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Spent information not available");
+        }
+        deltas.push_back(TxDeltasToJSON(tx_deltas));
+    }
+
+    return BlockDeltasHeaderToJSON(block, blockindex, &deltas);
+}
+
 static UniValue getblockdeltas(const JSONRPCRequest& request)
 {
     RPCHelpMan{"getblockdeltas",
@@ -781,6 +805,96 @@ static UniValue getblockdeltas(const JSONRPCRequest& request)
     return blockToDeltasJSON(block, pblockindex, &mempool);
 }
 
+static UniValue exportblockdeltas(const JSONRPCRequest& request)
+{
+    RPCHelpMan{"exportblockdeltas",
+        "\nWrite the address deltas of a range of blocks in the active chain to a file.\n"
+        "Input values are read from the undo data of each block, no index is required.\n"
+        "The binary format has per block the header, height and number of transactions followed by\n"
+        "one record per transaction, the json format has one getblockdeltas like object per line.\n",
+        {
+            {"start", RPCArg::Type::NUM, RPCArg::Optional::NO, "The first block height."},
+            {"end", RPCArg::Type::NUM, RPCArg::Optional::NO, "The last block height."},
+            {"path", RPCArg::Type::STR, RPCArg::Optional::NO, "Path to the output file. If relative, will be prefixed by datadir."},
+            {"format", RPCArg::Type::STR, /* default */ "bin", "The output format, \"bin\" or \"json\"."},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "", {
+                {RPCResult::Type::NUM, "blocks_written", "The number of blocks written"},
+                {RPCResult::Type::NUM, "bytes_written", "The size of the file"},
+                {RPCResult::Type::STR, "path", "The absolute path the deltas were written to"},
+            }
+        },
+        RPCExamples{
+        HelpExampleCli("exportblockdeltas", "1 1000 deltas.dat") +
+        "\nAs a JSON-RPC call\n"
+        + HelpExampleRpc("exportblockdeltas", "1, 1000, \"deltas.json\", \"json\"")
+        },
+    }.Check(request);
+
+    int start = request.params[0].get_int();
+    int end = request.params[1].get_int();
+    bool json = false;
+    if (!request.params[3].isNull()) {
+        const std::string &format = request.params[3].get_str();
+        if (format == "json") {
+            json = true;
+        } else
+        if (format != "bin") {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown format: " + format);
+        }
+    }
+    {
+        LOCK(cs_main);
+        if (start < 0 || end < start || end > ::ChainActive().Height()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block range out of range");
+        }
+    }
+
+    fs::path path = fs::absolute(request.params[2].get_str(), GetDataDir());
+    // Write to a temporary path and then move into `path` on completion
+    fs::path temppath = fs::absolute(request.params[2].get_str() + ".incomplete", GetDataDir());
+    if (fs::exists(path)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER,
+            path.string() + " already exists. If you are sure this is what you want, move it out of the way first");
+    }
+
+    CAutoFile afile(fsbridge::fopen(temppath, "wb"), SER_NETWORK, PROTOCOL_VERSION);
+    if (afile.IsNull()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Unable to open " + temppath.string());
+    }
+
+    BlockDeltasReader reader(start, end);
+    CBlockDeltasItem item;
+    int blocks_written = 0;
+    while (reader.Next(item)) {
+        if (json) {
+            std::string line = BlockDeltasItemToJSON(item).write() + "\n";
+            afile.write(line.data(), line.size());
+        } else {
+            afile << item.header;
+            for (const auto &tx_deltas : item.txs) {
+                afile << tx_deltas;
+            }
+        }
+        blocks_written++;
+    }
+    afile.fclose();
+
+    std::string error = reader.GetError();
+    if (!error.empty()) {
+        fs::remove(temppath);
+        throw JSONRPCError(RPC_MISC_ERROR, error);
+    }
+    fs::rename(temppath, path);
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("blocks_written", blocks_written);
+    result.pushKV("bytes_written", (uint64_t)fs::file_size(path));
+    result.pushKV("path", path.string());
+    return result;
+}
+
 static UniValue getblockhashes(const JSONRPCRequest& request)
 {
             RPCHelpMan{"getblockhashes",
@@ -1184,8 +1298,6 @@ UniValue getblockbalances(const JSONRPCRequest& request)
 
     RPCTypeCheck(request.params, {UniValue::VSTR, UniValue::VOBJ}, true);
 
-    LOCK(cs_main);
-
     if (!fBalancesIndex) {
         throw JSONRPCError(RPC_MISC_ERROR, "Balances index is not enabled.");
     }
@@ -1205,7 +1317,15 @@ UniValue getblockbalances(const JSONRPCRequest& request)
     }
 
     BlockBalances balances;
-    if (!GetBlockBalances(hash, balances)) {
+    bool have_balances;
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    if (view) {
+        have_balances = GetBlockBalances(hash, balances, view->block_tree.get());
+    } else {
+        LOCK(cs_main);
+        have_balances = GetBlockBalances(hash, balances);
+    }
+    if (!have_balances) {
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Unable to get balances info");
     }
 
@@ -1428,6 +1548,7 @@ static const CRPCCommand commands[] =
 
     { "blockchain",         "getspentinfo",           &getspentinfo,           {"inputs"} },
     { "blockchain",         "getblockdeltas",         &getblockdeltas,         {"blockhash"} },
+    { "blockchain",         "exportblockdeltas",      &exportblockdeltas,      {"start","end","path","format"} },
     { "blockchain",         "getblockhashes",         &getblockhashes,         {"high","low","options"} },
     { "blockchain",         "gettxoutsetinfobyscript",&gettxoutsetinfobyscript,{} },
     { "blockchain",         "getblockreward",         &getblockreward,         {"height"} },
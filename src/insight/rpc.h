@@ -5,8 +5,37 @@
 #ifndef PARTICL_INSIGHT_RPC_H
 #define PARTICL_INSIGHT_RPC_H
 
+#include <amount.h>
+#include <script/standard.h>
+#include <sync.h>
+
+class CBlock;
+class CBlockIndex;
 class CRPCTable;
+class UniValue;
+class uint256;
+struct CAddressIndexKey;
+struct CBlockDeltasItem;
+struct CAddressUnspentKey;
+struct CAddressUnspentValue;
+struct CSpentIndexValue;
+struct CTxDeltas;
+
+extern RecursiveMutex cs_main;
 
 void RegisterInsightRPCCommands(CRPCTable &t);
 
+bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type);
+
+/** JSON forms of the insight index records, shared with the REST interface.
+ * The record functions return false if the address type is unknown.
+ */
+bool AddressUtxoToJSON(const CAddressUnspentKey &key, const CAddressUnspentValue &value, UniValue &output);
+bool AddressDeltaToJSON(const CAddressIndexKey &key, CAmount amount, UniValue &delta);
+UniValue SpentInfoToJSON(const CSpentIndexValue &value);
+UniValue TxDeltasToJSON(const CTxDeltas &tx_deltas);
+UniValue BlockDeltasItemToJSON(const CBlockDeltasItem &item);
+/** The fields of getblockdeltas, with the deltas only if given, throws if the block is not in the active chain */
+UniValue BlockDeltasHeaderToJSON(const CBlock &block, const CBlockIndex *blockindex, const UniValue *deltas = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 #endif // PARTICL_INSIGHT_RPC_H
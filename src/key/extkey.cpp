@@ -599,7 +599,7 @@ int CExtKeyAccount::HaveSavedKey(const CKeyID &id)
     return HK_NO;
 };
 
-int CExtKeyAccount::HaveKey(const CKeyID &id, bool fUpdate, const CEKAKey *&pak, const CEKASCKey *&pasc, isminetype &ismine)
+int CExtKeyAccount::HaveKey(const CKeyID &id, bool fUpdate, const CEKAKey *&pak, const CEKASCKey *&pasc, isminetype &ismine, bool fCheckLookAhead)
 {
     // If fUpdate, promote key if found in look ahead
     LOCK(cs_account);
@@ -612,12 +612,10 @@ int CExtKeyAccount::HaveKey(const CKeyID &id, bool fUpdate, const CEKAKey *&pak,
         return HK_YES;
     }
 
-    mi = mapLookAhead.find(id);
-    if (mi != mapLookAhead.end()) {
-        pak = &mi->second;
+    if (fCheckLookAhead && (pak = FindLookAhead(id)) != nullptr) {
         ismine = IsMine(pak->nParent);
         if (LogAcceptCategory(BCLog::HDWALLET)) {
-            LogPrintf("HaveKey in lookAhead %s\n", EncodeDestination(PKHash(mi->first)));
+            LogPrintf("HaveKey in lookAhead %s\n", EncodeDestination(PKHash(id)));
         }
         return fUpdate ? HK_LOOKAHEAD_DO_UPDATE : HK_LOOKAHEAD;
     }
@@ -784,7 +782,7 @@ bool CExtKeyAccount::SaveKey(const CKeyID &id, const CEKAKey &keyIn)
         return false; // Already saved
     }
 
-    if (mapLookAhead.erase(id) != 1) {
+    if (!EraseLookAhead(id)) {
         LogPrintf("Warning: SaveKey %s key not found in look ahead %s.\n", GetIDString58(), EncodeDestination(PKHash(id)));
     }
 
@@ -931,7 +929,7 @@ int CExtKeyAccount::AddLookBehind(uint32_t nChain, uint32_t nKeys)
                 continue;
             }
 
-            if ((mi = mapLookAhead.find(keyId)) != mapLookAhead.end()) {
+            if (LookAheadIndex().count(keyId)) {
                 continue;
             }
 
@@ -944,10 +942,12 @@ int CExtKeyAccount::AddLookBehind(uint32_t nChain, uint32_t nKeys)
             continue;
         }
 
-        mapLookAhead[keyId] = CEKAKey(nChain, nChildOut);
+        if (LookAheadIndex().insert(keyId, CEKALookAheadKey(this, CEKAKey(nChain, nChildOut)))) {
+            nLookAhead++;
+        }
 
         if (LogAcceptCategory(BCLog::HDWALLET)) {
-            LogPrintf("%s: Added %s, look-ahead size %u.\n", __func__, EncodeDestination(PKHash(keyId)), mapLookAhead.size());
+            LogPrintf("%s: Added %s, look-ahead size %u.\n", __func__, EncodeDestination(PKHash(keyId)), nLookAhead);
         }
     }
 
@@ -992,7 +992,7 @@ int CExtKeyAccount::AddLookAhead(uint32_t nChain, uint32_t nKeys)
                 continue;
             }
 
-            if ((mi = mapLookAhead.find(keyId)) != mapLookAhead.end()) {
+            if (LookAheadIndex().count(keyId)) {
                 continue;
             }
 
@@ -1005,11 +1005,13 @@ int CExtKeyAccount::AddLookAhead(uint32_t nChain, uint32_t nKeys)
             continue;
         }
 
-        mapLookAhead[keyId] = CEKAKey(nChain, nChildOut);
+        if (LookAheadIndex().insert(keyId, CEKALookAheadKey(this, CEKAKey(nChain, nChildOut)))) {
+            nLookAhead++;
+        }
         pc->nLastLookAhead = nChildOut;
 
         if (LogAcceptCategory(BCLog::HDWALLET)) {
-            LogPrintf("%s: Added %s, look-ahead size %u.\n", __func__, EncodeDestination(PKHash(keyId)), mapLookAhead.size());
+            LogPrintf("%s: Added %s, look-ahead size %u.\n", __func__, EncodeDestination(PKHash(keyId)), nLookAhead);
         }
     }
 
@@ -1022,8 +1024,82 @@ int CExtKeyAccount::ClearLookAhead()
         CStoredExtKey *sek = vExtKeys[i];
         sek->nLastLookAhead = 0;
     }
-    mapLookAhead.clear();
+    EraseLookAheadKeys();
+    vLookAheadPending.clear();
+
+    return 0;
+};
+
+void CExtKeyAccount::EraseLookAheadKeys()
+{
+    if (nLookAhead == 0) {
+        return;
+    }
+    if (pLookAhead) {
+        pLookAhead->erase_if([this](const CKeyID &id, const CEKALookAheadKey &lak) { return lak.pa == this; });
+    } else
+    if (pLookAheadOwn) {
+        pLookAheadOwn->clear();
+    }
+    nLookAhead = 0;
+};
+
+void CExtKeyAccount::SetLookAheadIndex(AccLookAheadMap *pIndex)
+{
+    LOCK(cs_account);
+    if (pLookAhead == pIndex) {
+        return;
+    }
+    AccLookAheadMap moved;
+    LookAheadIndex().ForEach([this, &moved](const CKeyID &id, const CEKALookAheadKey &lak) {
+        if (lak.pa == this) {
+            moved.insert(id, lak);
+        }
+    });
+    EraseLookAheadKeys();
+    pLookAheadOwn.reset();
+
+    pLookAhead = pIndex;
+    moved.ForEach([this](const CKeyID &id, const CEKALookAheadKey &lak) {
+        if (LookAheadIndex().insert(id, lak)) {
+            nLookAhead++;
+        }
+    });
+};
+
+const CEKAKey *CExtKeyAccount::FindLookAhead(const CKeyID &id) const
+{
+    const AccLookAheadMap *pIndex = pLookAhead ? pLookAhead : pLookAheadOwn.get();
+    if (!pIndex) {
+        return nullptr;
+    }
+    const CEKALookAheadKey *plak = pIndex->find(id);
+    if (!plak || plak->pa != this) {
+        return nullptr;
+    }
+    return &plak->ak;
+};
 
+bool CExtKeyAccount::EraseLookAhead(const CKeyID &id)
+{
+    if (!FindLookAhead(id)) {
+        return false;
+    }
+    LookAheadIndex().erase(id);
+    nLookAhead--;
+    return true;
+};
+
+int CExtKeyAccount::AddPendingLookAhead()
+{
+    LOCK(cs_account);
+    std::vector<std::pair<uint32_t, uint32_t> > vPending;
+    vPending.swap(vLookAheadPending);
+    for (const auto &p : vPending) {
+        if (0 != AddLookAhead(p.first, p.second)) {
+            return 1;
+        }
+    }
     return 0;
 };
 
@@ -11,9 +11,12 @@
 #include <key/stealth.h>
 #include <key/types.h>
 #include <key/keyutil.h>
+#include <key/keyidmap.h>
 #include <sync.h>
 #include <script/ismine.h>
 
+#include <memory>
+
 static const uint32_t MAX_DERIVE_TRIES = 16;
 static const uint32_t BIP32_KEY_LEN = 82;       // Raw, 74 + 4 bytes id + 4 checksum
 static const uint32_t BIP32_KEY_N_BYTES = 74;   // Raw without id and checksum
@@ -668,8 +671,22 @@ public:
 };
 
 
+class CExtKeyAccount;
+
+class CEKALookAheadKey
+{
+// Look ahead key of an account chain, in memory only
+public:
+    CEKALookAheadKey() {};
+    CEKALookAheadKey(CExtKeyAccount *pa_, const CEKAKey &ak_) : pa(pa_), ak(ak_) {};
+
+    CExtKeyAccount *pa = nullptr;
+    CEKAKey ak;
+};
+
 typedef std::map<CKeyID, CEKLKey> LooseKeyMap;
 typedef std::map<CKeyID, CEKAKey> AccKeyMap;
+typedef KeyIDHashMap<CEKALookAheadKey> AccLookAheadMap;
 typedef std::map<CKeyID, CEKASCKey> AccKeySCMap;
 typedef std::map<CKeyID, CEKAStealthKey> AccStealthKeyMap;
 
@@ -688,6 +705,12 @@ public:
         nPackStealthKeys = 0;
     };
 
+    ~CExtKeyAccount()
+    {
+        // Chains may already be freed, only remove keys from a shared index
+        EraseLookAheadKeys();
+    };
+
     int FreeChains()
     {
         // Keys are normally freed by the wallet
@@ -710,7 +733,7 @@ public:
     };
 
     int HaveSavedKey(const CKeyID &id);
-    int HaveKey(const CKeyID &id, bool fUpdate, const CEKAKey *&pak, const CEKASCKey *&pasc, isminetype &ismine);
+    int HaveKey(const CKeyID &id, bool fUpdate, const CEKAKey *&pak, const CEKASCKey *&pasc, isminetype &ismine, bool fCheckLookAhead=true);
     int HaveStealthKey(const CKeyID &id, const CEKASCKey *&pasc, isminetype &ismine);
     bool GetKey(const CKeyID &id, CKey &keyOut) const;
     bool GetKey(const CEKAKey &ak, CKey &keyOut) const;
@@ -808,6 +831,39 @@ public:
 
     int ClearLookAhead();
 
+    /** Share the look ahead index of the wallet, existing look ahead keys are moved into it */
+    void SetLookAheadIndex(AccLookAheadMap *pIndex);
+    const CEKAKey *FindLookAhead(const CKeyID &id) const;
+    bool EraseLookAhead(const CKeyID &id);
+    size_t NumLookAhead() const { return nLookAhead; }
+
+    /** Defer deriving look ahead keys until AddPendingLookAhead is called */
+    void QueueLookAhead(uint32_t nChain, uint32_t nKeys)
+    {
+        vLookAheadPending.emplace_back(nChain, nKeys);
+    };
+    size_t NumPendingLookAhead() const
+    {
+        size_t n = 0;
+        for (const auto &p : vLookAheadPending) {
+            n += p.second;
+        }
+        return n;
+    };
+    int AddPendingLookAhead();
+
+    AccLookAheadMap &LookAheadIndex()
+    {
+        if (pLookAhead) {
+            return *pLookAhead;
+        }
+        if (!pLookAheadOwn) {
+            pLookAheadOwn.reset(new AccLookAheadMap());
+        }
+        return *pLookAheadOwn;
+    };
+    void EraseLookAheadKeys();
+
     int ExpandStealthChildKey(const CEKAStealthKey *aks, const CKey &sShared, CKey &kOut) const;
     int ExpandStealthChildPubKey(const CEKAStealthKey *aks, const CKey &sShared, CPubKey &pkOut) const;
 
@@ -852,7 +908,12 @@ public:
 
     // TODO: Could store used keys in archived packs, which don't get loaded into memory
     AccKeyMap mapKeys;
-    AccKeyMap mapLookAhead;
+
+    // Look ahead keys live in an index shared by all accounts of a wallet, or in pLookAheadOwn if unset
+    AccLookAheadMap *pLookAhead = nullptr;
+    std::unique_ptr<AccLookAheadMap> pLookAheadOwn;
+    size_t nLookAhead = 0; // Entries in the index owned by this account
+    std::vector<std::pair<uint32_t, uint32_t> > vLookAheadPending; // chain, num keys
 
     AccKeySCMap mapStealthChildKeys; // keys derived from stealth addresses
 
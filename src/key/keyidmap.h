@@ -0,0 +1,188 @@
+// Copyright (c) 2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PARTICL_KEY_KEYIDMAP_H
+#define PARTICL_KEY_KEYIDMAP_H
+
+#include <crypto/common.h>
+#include <pubkey.h>
+
+#include <assert.h>
+#include <vector>
+
+/**
+ * Flat open addressing hash map keyed by CKeyID.
+ *
+ * Slots are stored inline in one vector and probed linearly, erase shifts
+ * following entries back so no tombstones are needed.  A null CKeyID marks
+ * an empty slot and can't be inserted.
+ * KeyIDs are hash160 outputs, the low 64 bits are used as the hash directly.
+ */
+template <typename T>
+class KeyIDHashMap
+{
+public:
+    struct Entry {
+        CKeyID id;
+        T value;
+    };
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_slots.size(); }
+    size_t DynamicMemoryUsage() const { return m_slots.capacity() * sizeof(Entry); }
+
+    void clear()
+    {
+        std::vector<Entry>().swap(m_slots);
+        m_size = 0;
+    }
+
+    /** Grow the table to hold n entries without rehashing */
+    void reserve(size_t n)
+    {
+        size_t nSlots = MIN_SLOTS;
+        while (n * 4 > nSlots * 3) {
+            nSlots *= 2;
+        }
+        if (nSlots > m_slots.size()) {
+            Rehash(nSlots);
+        }
+    }
+
+    const T *find(const CKeyID &id) const
+    {
+        if (m_size == 0) {
+            return nullptr;
+        }
+        const size_t nMask = m_slots.size() - 1;
+        for (size_t i = Hash(id) & nMask;; i = (i + 1) & nMask) {
+            const Entry &e = m_slots[i];
+            if (e.id == id) {
+                return &e.value;
+            }
+            if (e.id.IsNull()) {
+                return nullptr;
+            }
+        }
+    }
+
+    T *find(const CKeyID &id)
+    {
+        return const_cast<T*>(static_cast<const KeyIDHashMap*>(this)->find(id));
+    }
+
+    size_t count(const CKeyID &id) const { return find(id) ? 1 : 0; }
+
+    /** Insert or overwrite, returns false if id was already present */
+    bool insert(const CKeyID &id, const T &value)
+    {
+        assert(!id.IsNull());
+        if ((m_size + 1) * 4 > m_slots.size() * 3) {
+            Rehash(m_slots.empty() ? size_t(MIN_SLOTS) : m_slots.size() * 2);
+        }
+        const size_t nMask = m_slots.size() - 1;
+        for (size_t i = Hash(id) & nMask;; i = (i + 1) & nMask) {
+            Entry &e = m_slots[i];
+            if (e.id == id) {
+                e.value = value;
+                return false;
+            }
+            if (e.id.IsNull()) {
+                e.id = id;
+                e.value = value;
+                m_size++;
+                return true;
+            }
+        }
+    }
+
+    size_t erase(const CKeyID &id)
+    {
+        if (m_size == 0 || id.IsNull()) {
+            return 0;
+        }
+        const size_t nMask = m_slots.size() - 1;
+        size_t i = Hash(id) & nMask;
+        for (;; i = (i + 1) & nMask) {
+            if (m_slots[i].id == id) {
+                break;
+            }
+            if (m_slots[i].id.IsNull()) {
+                return 0;
+            }
+        }
+        // Shift back following entries which would no longer be reachable
+        for (size_t j = (i + 1) & nMask;; j = (j + 1) & nMask) {
+            if (m_slots[j].id.IsNull()) {
+                break;
+            }
+            size_t nHome = Hash(m_slots[j].id) & nMask;
+            if (((j - nHome) & nMask) >= ((j - i) & nMask)) {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i] = Entry();
+        m_size--;
+        return 1;
+    }
+
+    /** Remove all entries matching fn, returns the number removed */
+    template <typename Fn>
+    size_t erase_if(Fn fn)
+    {
+        std::vector<Entry> vKeep;
+        for (const auto &e : m_slots) {
+            if (!e.id.IsNull() && !fn(e.id, e.value)) {
+                vKeep.push_back(e);
+            }
+        }
+        size_t nRemoved = m_size - vKeep.size();
+        if (nRemoved == 0) {
+            return 0;
+        }
+        m_slots.assign(m_slots.size(), Entry());
+        m_size = 0;
+        for (const auto &e : vKeep) {
+            insert(e.id, e.value);
+        }
+        return nRemoved;
+    }
+
+    template <typename Fn>
+    void ForEach(Fn fn) const
+    {
+        for (const auto &e : m_slots) {
+            if (!e.id.IsNull()) {
+                fn(e.id, e.value);
+            }
+        }
+    }
+
+private:
+    static const size_t MIN_SLOTS = 16;
+
+    static size_t Hash(const CKeyID &id)
+    {
+        return (size_t)ReadLE64(id.begin());
+    }
+
+    void Rehash(size_t nSlots)
+    {
+        std::vector<Entry> vOld(nSlots);
+        vOld.swap(m_slots);
+        m_size = 0;
+        for (const auto &e : vOld) {
+            if (!e.id.IsNull()) {
+                insert(e.id, e.value);
+            }
+        }
+    }
+
+    std::vector<Entry> m_slots;
+    size_t m_size = 0;
+};
+
+#endif // PARTICL_KEY_KEYIDMAP_H
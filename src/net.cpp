@@ -798,11 +798,11 @@ Optional<CNetMessage> V1TransportDeserializer::GetMessage(const std::chrono::mic
 }
 
 void V1TransportSerializer::prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) {
-    // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
+    // create dbl-sha256 checksum, shared payloads carry a precomputed one
+    uint256 hash = msg.shared_data ? msg.shared_data->hash : Hash(msg.data);
 
     // create header
-    CMessageHeader hdr(Params().MessageStart(), msg.m_type.c_str(), msg.data.size());
+    CMessageHeader hdr(Params().MessageStart(), msg.m_type.c_str(), msg.PayloadSize());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     // serialize header
@@ -1159,6 +1159,9 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
+#ifdef USE_EPOLL
+        RegisterNodeSocket(pnode);
+#endif
     }
 
     // We received a new connection, harvest entropy from the time (and our peer count)
@@ -1188,6 +1191,10 @@ void CConnman::DisconnectNodes()
             {
                 // remove from vNodes
                 vNodes.erase(remove(vNodes.begin(), vNodes.end(), pnode), vNodes.end());
+#ifdef USE_EPOLL
+                m_recv_ready_nodes.erase(pnode);
+                m_send_ready_nodes.erase(pnode);
+#endif
 
                 // release outbound grant (if any)
                 pnode->grantOutbound.Release();
@@ -1217,6 +1224,13 @@ void CConnman::DisconnectNodes()
                 }
                 if (fDelete) {
                     vNodesDisconnected.remove(pnode);
+#ifdef USE_EPOLL
+                    {
+                        // A send may have queued data after the node left vNodes
+                        LOCK(cs_send_pending);
+                        m_send_pending_nodes.erase(pnode);
+                    }
+#endif
                     DeleteNode(pnode);
                 }
             }
@@ -1436,8 +1450,72 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
 }
 #endif
 
+bool CConnman::SocketRecvData(CNode* pnode)
+{
+    // typical socket buffer is 8K-64K
+    char pchBuf[0x10000];
+    int nBytes = 0;
+    {
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket == INVALID_SOCKET)
+            return false;
+        nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+    }
+    if (nBytes > 0)
+    {
+        bool notify = false;
+        if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
+            pnode->CloseSocketDisconnect();
+        RecordBytesRecv(nBytes);
+        if (notify) {
+            size_t nSizeAdded = 0;
+            auto it(pnode->vRecvMsg.begin());
+            for (; it != pnode->vRecvMsg.end(); ++it) {
+                // vRecvMsg contains only completed CNetMessage
+                // the single possible partially deserialized message are held by TransportDeserializer
+                nSizeAdded += it->m_raw_message_size;
+            }
+            {
+                LOCK(pnode->cs_vProcessMsg);
+                pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
+                pnode->nProcessQueueSize += nSizeAdded;
+                pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+            }
+            WakeMessageHandler(pnode->GetId());
+        }
+    }
+    else if (nBytes == 0)
+    {
+        // socket closed gracefully
+        if (!pnode->fDisconnect) {
+            LogPrint(BCLog::NET, "socket closed for peer=%d\n", pnode->GetId());
+        }
+        pnode->CloseSocketDisconnect();
+    }
+    else if (nBytes < 0)
+    {
+        // error
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
+        {
+            if (!pnode->fDisconnect) {
+                LogPrint(BCLog::NET, "socket recv error for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(nErr));
+            }
+            pnode->CloseSocketDisconnect();
+        }
+    }
+
+    return nBytes == (int)sizeof(pchBuf);
+}
+
 void CConnman::SocketHandler()
 {
+#ifdef USE_EPOLL
+    if (m_socket_events) {
+        EpollSocketHandler();
+        return;
+    }
+#endif
     std::set<SOCKET> recv_set, send_set, error_set;
     SocketEvents(recv_set, send_set, error_set);
 
@@ -1485,58 +1563,7 @@ void CConnman::SocketHandler()
         }
         if (recvSet || errorSet)
         {
-            // typical socket buffer is 8K-64K
-            char pchBuf[0x10000];
-            int nBytes = 0;
-            {
-                LOCK(pnode->cs_hSocket);
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-                nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-            }
-            if (nBytes > 0)
-            {
-                bool notify = false;
-                if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
-                    pnode->CloseSocketDisconnect();
-                RecordBytesRecv(nBytes);
-                if (notify) {
-                    size_t nSizeAdded = 0;
-                    auto it(pnode->vRecvMsg.begin());
-                    for (; it != pnode->vRecvMsg.end(); ++it) {
-                        // vRecvMsg contains only completed CNetMessage
-                        // the single possible partially deserialized message are held by TransportDeserializer
-                        nSizeAdded += it->m_raw_message_size;
-                    }
-                    {
-                        LOCK(pnode->cs_vProcessMsg);
-                        pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                        pnode->nProcessQueueSize += nSizeAdded;
-                        pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
-                    }
-                    WakeMessageHandler();
-                }
-            }
-            else if (nBytes == 0)
-            {
-                // socket closed gracefully
-                if (!pnode->fDisconnect) {
-                    LogPrint(BCLog::NET, "socket closed for peer=%d\n", pnode->GetId());
-                }
-                pnode->CloseSocketDisconnect();
-            }
-            else if (nBytes < 0)
-            {
-                // error
-                int nErr = WSAGetLastError();
-                if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
-                {
-                    if (!pnode->fDisconnect) {
-                        LogPrint(BCLog::NET, "socket recv error for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(nErr));
-                    }
-                    pnode->CloseSocketDisconnect();
-                }
-            }
+            SocketRecvData(pnode);
         }
 
         //
@@ -1560,6 +1587,134 @@ void CConnman::SocketHandler()
     }
 }
 
+#ifdef USE_EPOLL
+bool CConnman::StartSocketEvents()
+{
+    auto socket_events = MakeUnique<EpollSocketSet>();
+    if (!socket_events->IsValid()) {
+        return false;
+    }
+    // Listen sockets are tagged with the address of their entry, vhListenSocket isn't resized while the socket handler runs
+    for (const ListenSocket& hListenSocket : vhListenSocket) {
+        if (!socket_events->Add(hListenSocket.socket, (uint64_t)(uintptr_t)&hListenSocket, true)) {
+            return false;
+        }
+    }
+    m_socket_events = std::move(socket_events);
+    return true;
+}
+
+void CConnman::RegisterNodeSocket(CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(cs_vNodes)
+{
+    if (!m_socket_events) {
+        return;
+    }
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket != INVALID_SOCKET && !m_socket_events->Add(pnode->hSocket, (uint64_t)(uintptr_t)pnode)) {
+        LogPrintf("socket epoll registration failed for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(WSAGetLastError()));
+        pnode->fDisconnect = true;
+    }
+}
+
+void CConnman::EpollSocketHandler()
+{
+    std::unordered_set<CNode*> send_pending;
+    {
+        LOCK(cs_send_pending);
+        send_pending = m_send_pending_nodes;
+    }
+
+    // Sockets are edge triggered, don't block while a ready socket hasn't been drained
+    bool fHaveWork = false;
+    for (CNode* pnode : m_recv_ready_nodes) {
+        if (!pnode->fPauseRecv && send_pending.count(pnode) == 0) {
+            fHaveWork = true;
+            break;
+        }
+    }
+    for (CNode* pnode : send_pending) {
+        if (fHaveWork) {
+            break;
+        }
+        fHaveWork = m_send_ready_nodes.count(pnode) > 0;
+    }
+
+    std::vector<EpollSocketSet::Event> events;
+    if (!m_socket_events->Wait(events, fHaveWork ? 0 : SELECT_TIMEOUT_MILLISECONDS)) {
+        LogPrintf("socket epoll error %s\n", NetworkErrorString(WSAGetLastError()));
+        interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
+        return;
+    }
+
+    if (interruptNet) return;
+
+    for (const EpollSocketSet::Event& event : events) {
+        const ListenSocket* listen_socket = nullptr;
+        for (const ListenSocket& hListenSocket : vhListenSocket) {
+            if (event.tag == (uint64_t)(uintptr_t)&hListenSocket) {
+                listen_socket = &hListenSocket;
+                break;
+            }
+        }
+        if (listen_socket) {
+            AcceptConnection(*listen_socket);
+            continue;
+        }
+        // Closed sockets leave the epoll set, so events only arrive for nodes which haven't been deleted
+        CNode* pnode = (CNode*)(uintptr_t)event.tag;
+        if (event.recv || event.error) {
+            m_recv_ready_nodes.insert(pnode);
+        }
+        if (event.send) {
+            m_send_ready_nodes.insert(pnode);
+        }
+    }
+
+    //
+    // Send, nodes with queued data are drained before reading more from them
+    //
+    for (CNode* pnode : send_pending) {
+        if (interruptNet) return;
+        if (m_send_ready_nodes.count(pnode) == 0) {
+            continue;
+        }
+        LOCK(pnode->cs_vSend);
+        size_t nBytes = SocketSendData(pnode);
+        if (nBytes) {
+            RecordBytesSent(nBytes);
+        }
+        if (pnode->vSendMsg.empty()) {
+            LOCK(cs_send_pending);
+            m_send_pending_nodes.erase(pnode);
+        } else {
+            m_send_ready_nodes.erase(pnode);
+        }
+    }
+
+    //
+    // Receive
+    //
+    for (auto it = m_recv_ready_nodes.begin(); it != m_recv_ready_nodes.end();) {
+        if (interruptNet) return;
+        CNode* pnode = *it;
+        if (pnode->fPauseRecv || send_pending.count(pnode) > 0 || SocketRecvData(pnode)) {
+            ++it;
+        } else {
+            it = m_recv_ready_nodes.erase(it);
+        }
+    }
+
+    int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime != m_last_inactivity_check) {
+        m_last_inactivity_check = nTime;
+        LOCK(cs_vNodes);
+        for (CNode* pnode : vNodes) {
+            InactivityCheck(pnode);
+        }
+    }
+}
+#endif // USE_EPOLL
+
 void CConnman::ThreadSocketHandler()
 {
     while (!interruptNet)
@@ -1570,13 +1725,73 @@ void CConnman::ThreadSocketHandler()
     }
 }
 
+void CConnman::WakeWorker(MessageHandlerWorker& worker)
+{
+    {
+        LOCK(worker.mutex);
+        worker.fWake = true;
+    }
+    worker.cond.notify_one();
+}
+
 void CConnman::WakeMessageHandler()
 {
+    for (const auto& worker : m_msg_workers) {
+        {
+            LOCK(worker->mutex);
+            worker->fWakeAll = true;
+            worker->fWake = true;
+        }
+        worker->cond.notify_one();
+    }
+}
+
+void CConnman::WakeMessageHandler(NodeId id)
+{
+    if (!m_msg_workers.empty()) {
+        MessageHandlerWorker& worker = *m_msg_workers[MessageHandlerIndex(id)];
+        {
+            LOCK(worker.mutex);
+            worker.ready_nodes.insert(id);
+            worker.fWake = true;
+        }
+        worker.cond.notify_one();
+    }
+}
+
+void CConnman::WakeSmsgHandler()
+{
+    if (m_smsg_worker) {
+        WakeWorker(*m_smsg_worker);
+    }
+}
+
+std::vector<MessageHandlerStats> CConnman::GetMessageHandlerStats() const
+{
+    std::vector<MessageHandlerStats> stats(m_msg_workers.size());
+    for (size_t i = 0; i < m_msg_workers.size(); ++i) {
+        stats[i].name = m_msg_workers[i]->name;
+        stats[i].num_peers = 0;
+        stats[i].busy_micros = m_msg_workers[i]->busy_micros;
+    }
+    int num_peers = 0;
     {
-        LOCK(mutexMsgProc);
-        fMsgProcWake = true;
+        LOCK(cs_vNodes);
+        num_peers = vNodes.size();
+        for (const CNode* pnode : vNodes) {
+            if (!stats.empty()) {
+                stats[MessageHandlerIndex(pnode->GetId())].num_peers++;
+            }
+        }
+    }
+    if (m_smsg_worker) {
+        MessageHandlerStats smsg_stats;
+        smsg_stats.name = m_smsg_worker->name;
+        smsg_stats.num_peers = num_peers;
+        smsg_stats.busy_micros = m_smsg_worker->busy_micros;
+        stats.push_back(smsg_stats);
     }
-    condMsgProc.notify_one();
+    return stats;
 }
 
 
@@ -2219,14 +2434,23 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
+#ifdef USE_EPOLL
+        RegisterNodeSocket(pnode);
+#endif
     }
 }
 
-void CConnman::ThreadMessageHandler()
+void CConnman::ThreadMessageHandler(size_t worker_index)
 {
+    MessageHandlerWorker& worker = *m_msg_workers[worker_index];
     const int64_t nTimeDecBanThreshold = 60; // TODO: make option
     int64_t nTimeNextBanReduced = GetTime() + nTimeDecBanThreshold;
 
+    // Peers woken for new messages are processed on their own, all peers at least every 100ms
+    bool fProcessAll = true;
+    std::set<NodeId> ready_nodes;
+    auto next_process_all = std::chrono::steady_clock::now();
+
     while (!flagInterruptMsgProc)
     {
         std::vector<CNode*> vNodesCopy;
@@ -2238,16 +2462,20 @@ void CConnman::ThreadMessageHandler()
             }
         }
 
-        bool fMoreWork = false;
+        std::set<NodeId> more_work_nodes;
+        int64_t nStart = GetTimeMicros();
 
         for (CNode* pnode : vNodesCopy)
         {
-            if (pnode->fDisconnect)
+            if (pnode->fDisconnect || MessageHandlerIndex(pnode->GetId()) != worker_index)
+                continue;
+            if (!fProcessAll && !ready_nodes.count(pnode->GetId()))
                 continue;
 
             // Receive messages
             bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
-            fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
+            if (fMoreNodeWork && !pnode->fPauseSend)
+                more_work_nodes.insert(pnode->GetId());
             if (flagInterruptMsgProc)
                 return;
             // Send messages
@@ -2261,7 +2489,7 @@ void CConnman::ThreadMessageHandler()
         }
 
         int64_t nTimeNow = GetTime();
-        if (nTimeNextBanReduced < nTimeNow) {
+        if (worker_index == 0 && nTimeNextBanReduced < nTimeNow) {
             LOCK(cs_main);
             CheckUnreceivedHeaders(nTimeNow); // Also reduces persistent misbehaviour score
             for (auto *pnode : vNodesCopy) {
@@ -2271,6 +2499,7 @@ void CConnman::ThreadMessageHandler()
             }
             nTimeNextBanReduced = nTimeNow + nTimeDecBanThreshold;
         }
+        worker.busy_micros += GetTimeMicros() - nStart;
 
         {
             LOCK(cs_vNodes);
@@ -2278,11 +2507,67 @@ void CConnman::ThreadMessageHandler()
                 pnode->Release();
         }
 
-        WAIT_LOCK(mutexMsgProc, lock);
+        if (fProcessAll) {
+            next_process_all = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        }
+
+        WAIT_LOCK(worker.mutex, lock);
+        if (more_work_nodes.empty()) {
+            worker.cond.wait_until(lock, next_process_all, [&worker]() EXCLUSIVE_LOCKS_REQUIRED(worker.mutex) { return worker.fWake; });
+        }
+        worker.fWake = false;
+        fProcessAll = worker.fWakeAll || std::chrono::steady_clock::now() >= next_process_all;
+        worker.fWakeAll = false;
+        ready_nodes = std::move(more_work_nodes);
+        ready_nodes.insert(worker.ready_nodes.begin(), worker.ready_nodes.end());
+        worker.ready_nodes.clear();
+    }
+}
+
+void CConnman::ThreadSmsgHandler()
+{
+    MessageHandlerWorker& worker = *m_smsg_worker;
+
+    while (!flagInterruptMsgProc)
+    {
+        std::vector<CNode*> vNodesCopy;
+        {
+            LOCK(cs_vNodes);
+            vNodesCopy = vNodes;
+            for (CNode* pnode : vNodesCopy) {
+                pnode->AddRef();
+            }
+        }
+
+        bool fMoreWork = false;
+        int64_t nStart = GetTimeMicros();
+        for (CNode* pnode : vNodesCopy)
+        {
+            if (pnode->fDisconnect)
+                continue;
+
+            // Received commands are processed in batches so one busy peer can't starve the others
+            fMoreWork |= m_msgproc->ProcessSmsgMessages(pnode);
+            if (flagInterruptMsgProc)
+                return;
+
+            m_msgproc->SendSmsgMessages(pnode);
+            if (flagInterruptMsgProc)
+                return;
+        }
+        worker.busy_micros += GetTimeMicros() - nStart;
+
+        {
+            LOCK(cs_vNodes);
+            for (CNode* pnode : vNodesCopy)
+                pnode->Release();
+        }
+
+        WAIT_LOCK(worker.mutex, lock);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) { return fMsgProcWake; });
+            worker.cond.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [&worker]() EXCLUSIVE_LOCKS_REQUIRED(worker.mutex) { return worker.fWake; });
         }
-        fMsgProcWake = false;
+        worker.fWake = false;
     }
 }
 
@@ -2502,6 +2787,13 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+#ifdef USE_EPOLL
+    if (m_use_epoll && !StartSocketEvents()) {
+        LogPrintf("Failed to set up epoll, falling back to poll: %s\n", NetworkErrorString(WSAGetLastError()));
+        m_use_epoll = false;
+    }
+#endif
+
     for (const auto& strDest : connOptions.vSeedNodes) {
         AddAddrFetch(strDest);
     }
@@ -2552,9 +2844,15 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     interruptNet.reset();
     flagInterruptMsgProc = false;
 
-    {
-        LOCK(mutexMsgProc);
-        fMsgProcWake = false;
+    m_msg_workers.clear();
+    for (int i = 0; i < m_msghandler_threads; ++i) {
+        m_msg_workers.push_back(MakeUnique<MessageHandlerWorker>());
+        m_msg_workers.back()->name = i == 0 ? "msghand" : strprintf("msghand.%d", i);
+    }
+    m_smsg_worker.reset();
+    if (m_smsg_handler_thread) {
+        m_smsg_worker = MakeUnique<MessageHandlerWorker>();
+        m_smsg_worker->name = "smsghand";
     }
 
     // Send and receive from sockets, accept connections
@@ -2579,8 +2877,13 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     if (connOptions.m_use_addrman_outgoing || !connOptions.m_specified_outgoing.empty())
         threadOpenConnections = std::thread(&TraceThread<std::function<void()> >, "opencon", std::function<void()>(std::bind(&CConnman::ThreadOpenConnections, this, connOptions.m_specified_outgoing)));
 
-    // Process messages
-    threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    // Process messages, each peer is handled by one thread
+    for (size_t i = 0; i < m_msg_workers.size(); ++i) {
+        m_msg_workers[i]->thread = std::thread(&TraceThread<std::function<void()> >, m_msg_workers[i]->name.c_str(), std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this, i)));
+    }
+    if (m_smsg_worker) {
+        m_smsg_worker->thread = std::thread(&TraceThread<std::function<void()> >, m_smsg_worker->name.c_str(), std::function<void()>(std::bind(&CConnman::ThreadSmsgHandler, this)));
+    }
 
     // Dump network addresses
     scheduler.scheduleEvery([this] { DumpAddresses(); }, DUMP_PEERS_INTERVAL);
@@ -2605,11 +2908,11 @@ static CNetCleanup instance_of_cnetcleanup;
 
 void CConnman::Interrupt()
 {
-    {
-        LOCK(mutexMsgProc);
-        flagInterruptMsgProc = true;
+    flagInterruptMsgProc = true;
+    WakeMessageHandler();
+    if (m_smsg_worker) {
+        WakeWorker(*m_smsg_worker);
     }
-    condMsgProc.notify_all();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2629,8 +2932,12 @@ void CConnman::Interrupt()
 
 void CConnman::StopThreads()
 {
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (const auto& worker : m_msg_workers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+    if (m_smsg_worker && m_smsg_worker->thread.joinable())
+        m_smsg_worker->thread.join();
     if (threadOpenConnections.joinable())
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
@@ -2676,6 +2983,15 @@ void CConnman::StopNodes()
     vNodes.clear();
     vNodesDisconnected.clear();
     vhListenSocket.clear();
+#ifdef USE_EPOLL
+    m_socket_events.reset();
+    m_recv_ready_nodes.clear();
+    m_send_ready_nodes.clear();
+    {
+        LOCK(cs_send_pending);
+        m_send_pending_nodes.clear();
+    }
+#endif
     semOutbound.reset();
     semAddnode.reset();
 }
@@ -3038,7 +3354,7 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
 
 void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 {
-    size_t nMessageSize = msg.data.size();
+    size_t nMessageSize = msg.PayloadSize();
     LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg.m_type), nMessageSize, pnode->GetId());
 
     // make sure we use the appropriate network transport format
@@ -3057,13 +3373,24 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 
         if (pnode->nSendSize > nSendBufferMaxSize)
             pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize)
-            pnode->vSendMsg.push_back(std::move(msg.data));
+        pnode->vSendMsg.emplace_back(std::move(serializedHeader));
+        if (msg.shared_data) {
+            if (nMessageSize)
+                pnode->vSendMsg.emplace_back(std::move(msg.shared_data));
+        } else if (nMessageSize) {
+            pnode->vSendMsg.emplace_back(std::move(msg.data));
+        }
 
         // If write queue empty, attempt "optimistic write"
         if (optimisticSend == true)
             nBytesSent = SocketSendData(pnode);
+#ifdef USE_EPOLL
+        // The rest is sent once the socket handler sees the socket writable
+        if (m_use_epoll && !pnode->vSendMsg.empty()) {
+            LOCK(cs_send_pending);
+            m_send_pending_nodes.insert(pnode);
+        }
+#endif
     }
     if (nBytesSent)
         RecordBytesSent(nBytesSent);
@@ -32,6 +32,7 @@
 #include <thread>
 #include <memory>
 #include <condition_variable>
+#include <unordered_set>
 
 #ifndef WIN32
 #include <arpa/inet.h>
@@ -42,6 +43,9 @@
 
 class CScheduler;
 class CNode;
+#ifdef USE_EPOLL
+class EpollSocketSet;
+#endif
 class BanMan;
 struct bilingual_str;
 
@@ -90,6 +94,13 @@ static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
+/** -socketevents default, where epoll is available */
+static const char* const DEFAULT_SOCKETEVENTS = "poll";
+/** -msghandlerthreads default */
+static const int DEFAULT_MSGHANDLER_THREADS = 1;
+static const int MAX_MSGHANDLER_THREADS = 16;
+/** -smsghandlerthread default */
+static const bool DEFAULT_SMSG_HANDLER_THREAD = false;
 
 typedef int64_t NodeId;
 
@@ -107,6 +118,20 @@ struct AddedNodeInfo
 class CNodeStats;
 class CClientUIInterface;
 
+/**
+ * Immutable message payload which can be queued to several peers without
+ * copying, the checksum is computed once when it's created.
+ */
+struct CSharedNetMsgData
+{
+    explicit CSharedNetMsgData(std::vector<unsigned char>&& data_in)
+        : data(std::move(data_in)), hash(Hash(data)) {}
+
+    const std::vector<unsigned char> data;
+    const uint256 hash;
+};
+typedef std::shared_ptr<const CSharedNetMsgData> CSharedNetMsgDataRef;
+
 struct CSerializedNetMsg
 {
     CSerializedNetMsg() = default;
@@ -116,10 +141,29 @@ struct CSerializedNetMsg
     CSerializedNetMsg(const CSerializedNetMsg& msg) = delete;
     CSerializedNetMsg& operator=(const CSerializedNetMsg&) = delete;
 
+    size_t PayloadSize() const { return shared_data ? shared_data->data.size() : data.size(); }
+
     std::vector<unsigned char> data;
+    //! If set the payload is shared_data and data is unused
+    CSharedNetMsgDataRef shared_data;
     std::string m_type;
 };
 
+/** One entry in a peer's send queue, either owned bytes or a shared payload */
+class CSendBuffer
+{
+public:
+    explicit CSendBuffer(std::vector<unsigned char>&& data) : m_data(std::move(data)) {}
+    explicit CSendBuffer(CSharedNetMsgDataRef shared_data) : m_shared_data(std::move(shared_data)) {}
+
+    const unsigned char* data() const { return m_shared_data ? m_shared_data->data.data() : m_data.data(); }
+    size_t size() const { return m_shared_data ? m_shared_data->data.size() : m_data.size(); }
+
+private:
+    std::vector<unsigned char> m_data;
+    CSharedNetMsgDataRef m_shared_data;
+};
+
 /** Different types of connections to a peer. This enum encapsulates the
  * information we have available at the time of opening or accepting the
  * connection. Aside from INBOUND, all types are initiated by us.
@@ -189,6 +233,13 @@ enum class ConnectionType {
 };
 
 class NetEventsInterface;
+
+struct MessageHandlerStats
+{
+    std::string name;
+    int num_peers;
+    int64_t busy_micros;
+};
 class CConnman
 {
 public:
@@ -226,6 +277,9 @@ public:
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
         std::vector<bool> m_asmap;
+        bool m_use_epoll = false;
+        int m_msghandler_threads = DEFAULT_MSGHANDLER_THREADS;
+        bool m_smsg_handler_thread = DEFAULT_SMSG_HANDLER_THREAD;
     };
 
     void Init(const Options& connOptions) {
@@ -255,6 +309,9 @@ public:
             vAddedNodes = connOptions.m_added_nodes;
         }
         m_onion_binds = connOptions.onion_binds;
+        m_use_epoll = connOptions.m_use_epoll;
+        m_msghandler_threads = std::max(1, std::min(connOptions.m_msghandler_threads, MAX_MSGHANDLER_THREADS));
+        m_smsg_handler_thread = connOptions.m_smsg_handler_thread;
     }
 
     CConnman(uint64_t seed0, uint64_t seed1, bool network_active = true);
@@ -399,7 +456,14 @@ public:
 
     unsigned int GetReceiveFloodSize() const;
 
+    /** Wake all message handler threads */
     void WakeMessageHandler();
+    /** Wake the message handler thread the node is pinned to, to process only that node */
+    void WakeMessageHandler(NodeId id);
+    /** True if smsg commands are processed on their own thread instead of the peer's message handler */
+    bool HasSmsgHandlerThread() const { return m_smsg_handler_thread; }
+    void WakeSmsgHandler();
+    std::vector<MessageHandlerStats> GetMessageHandlerStats() const;
 
     /** Attempts to obfuscate tx time through exponentially distributed emitting.
         Works assuming that a single interval is used.
@@ -430,7 +494,10 @@ public:
     void AddAddrFetch(const std::string& strDest);
     void ProcessAddrFetch();
     void ThreadOpenConnections(std::vector<std::string> connect);
-    void ThreadMessageHandler();
+    /** Index of the message handler thread processing a peer, fixed for the life of the connection to keep its messages in order */
+    size_t MessageHandlerIndex(NodeId id) const { return id % m_msg_workers.size(); }
+    void ThreadMessageHandler(size_t worker_index);
+    void ThreadSmsgHandler();
     void AcceptConnection(const ListenSocket& hListenSocket);
     void DisconnectNodes();
     void NotifyNumConnectionsChanged();
@@ -438,6 +505,13 @@ public:
     bool GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void SocketHandler();
+    /** Read once from the node's socket, returns true if the read filled the buffer and more data may be waiting */
+    bool SocketRecvData(CNode* pnode);
+#ifdef USE_EPOLL
+    bool StartSocketEvents();
+    void RegisterNodeSocket(CNode* pnode);
+    void EpollSocketHandler();
+#endif
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
 
@@ -584,20 +658,37 @@ public:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake GUARDED_BY(mutexMsgProc);
+    struct MessageHandlerWorker
+    {
+        std::string name;
+        std::thread thread;
+        Mutex mutex;
+        std::condition_variable cond;
+        /** flag for waking the message processor. */
+        bool fWake GUARDED_BY(mutex){false};
+        /** Process every peer of the worker on wakeup, not only those in ready_nodes */
+        bool fWakeAll GUARDED_BY(mutex){false};
+        /** Peers woken since the last wakeup, with new messages to process */
+        std::set<NodeId> ready_nodes GUARDED_BY(mutex);
+        /** Time spent processing peers, excluding waits */
+        std::atomic<int64_t> busy_micros{0};
+    };
 
-    std::condition_variable condMsgProc;
-    Mutex mutexMsgProc;
+    int m_msghandler_threads{DEFAULT_MSGHANDLER_THREADS};
+    bool m_smsg_handler_thread{DEFAULT_SMSG_HANDLER_THREAD};
+    /** Created in Start() and not resized until the next Start() */
+    std::vector<std::unique_ptr<MessageHandlerWorker>> m_msg_workers;
+    std::unique_ptr<MessageHandlerWorker> m_smsg_worker;
     std::atomic<bool> flagInterruptMsgProc{false};
 
+    void WakeWorker(MessageHandlerWorker& worker);
+
     CThreadInterrupt interruptNet;
 
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
 
     /** flag for deciding to connect to an extra outbound peer,
      *  in excess of m_max_outbound_full_relay
@@ -612,6 +703,18 @@ public:
      */
     std::vector<CService> m_onion_binds;
 
+    bool m_use_epoll{false};
+#ifdef USE_EPOLL
+    std::unique_ptr<EpollSocketSet> m_socket_events;
+    /** Nodes whose socket reported readiness and wasn't drained yet, only touched by the socket handler thread */
+    std::unordered_set<CNode*> m_recv_ready_nodes;
+    std::unordered_set<CNode*> m_send_ready_nodes;
+    /** Nodes left with queued send data, lock order is pnode->cs_vSend then cs_send_pending */
+    Mutex cs_send_pending;
+    std::unordered_set<CNode*> m_send_pending_nodes GUARDED_BY(cs_send_pending);
+    int64_t m_last_inactivity_check{0};
+#endif
+
     friend struct CConnmanTest;
     friend struct ConnmanTestMsg;
 };
@@ -629,6 +732,8 @@ class NetEventsInterface
 public:
     virtual bool ProcessMessages(CNode* pnode, std::atomic<bool>& interrupt) = 0;
     virtual bool SendMessages(CNode* pnode) = 0;
+    virtual bool ProcessSmsgMessages(CNode* pnode) = 0;
+    virtual void SendSmsgMessages(CNode* pnode) = 0;
     virtual void InitializeNode(CNode* pnode) = 0;
     virtual void FinalizeNode(const CNode& node, bool& update_connection_time) = 0;
 
@@ -859,7 +964,7 @@ public:
     size_t nSendSize{0}; // total size of all vSendMsg entries
     size_t nSendOffset{0}; // offset inside the first vSendMsg already sent
     uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
-    std::deque<std::vector<unsigned char>> vSendMsg GUARDED_BY(cs_vSend);
+    std::deque<CSendBuffer> vSendMsg GUARDED_BY(cs_vSend);
     RecursiveMutex cs_vSend;
     RecursiveMutex cs_hSocket;
     RecursiveMutex cs_vRecv;
@@ -7,6 +7,7 @@
 
 #include <addrman.h>
 #include <banman.h>
+#include <blockcache.h>
 #include <blockencodings.h>
 #include <blockfilter.h>
 #include <chainparams.h>
@@ -1659,6 +1660,87 @@ static std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_bloc
 static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
 static bool fWitnessesPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_block);
 
+/**
+ * Witness serialized blocks still queued to at least one peer, keyed by hash.
+ * Peers requesting the same block share one buffer, read once from disk.
+ */
+static Mutex cs_shared_block_data;
+static std::map<uint256, std::weak_ptr<const CSharedNetMsgData>> g_shared_block_data GUARDED_BY(cs_shared_block_data);
+
+/** Get the witness serialized block, from a recent block if it matches, else raw from the block files */
+static CSharedNetMsgDataRef GetSharedBlockData(const CBlockIndex* pindex, const std::shared_ptr<const CBlock>& recent_block, const CChainParams& chainparams) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    const uint256& hash = pindex->GetBlockHash();
+    CSharedNetMsgDataRef cached = g_block_cache.GetRawBlock(hash);
+    if (cached) {
+        return cached;
+    }
+    const bool add_to_cache = ::ChainActive().Height() - pindex->nHeight <= BLOCK_CACHE_MAX_DEPTH;
+    {
+        LOCK(cs_shared_block_data);
+        auto it = g_shared_block_data.find(hash);
+        if (it != g_shared_block_data.end()) {
+            CSharedNetMsgDataRef data = it->second.lock();
+            if (data) {
+                if (add_to_cache) {
+                    g_block_cache.AddRawBlock(hash, data);
+                }
+                return data;
+            }
+        }
+    }
+
+    CSharedNetMsgDataRef data;
+    std::shared_ptr<const CBlock> block = recent_block && recent_block->GetHash() == hash ? recent_block : g_block_cache.GetBlock(hash);
+    if (block) {
+        data = CNetMsgMaker(PROTOCOL_VERSION).MakeSharedPayload(0, *block);
+    } else {
+        // The network format matches the format on disk, so no need to deserialize
+        std::vector<uint8_t> block_data;
+        if (!ReadRawBlockFromDisk(block_data, pindex->GetBlockPos(), chainparams.MessageStart())) {
+            return nullptr;
+        }
+        data = std::make_shared<const CSharedNetMsgData>(std::move(block_data));
+    }
+    if (add_to_cache) {
+        g_block_cache.AddRawBlock(hash, data);
+    }
+
+    LOCK(cs_shared_block_data);
+    for (auto it = g_shared_block_data.begin(); it != g_shared_block_data.end();) {
+        if (it->second.expired()) {
+            it = g_shared_block_data.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    g_shared_block_data[hash] = data;
+    return data;
+}
+
+/**
+ * Get a compact block from the recent block cache, or build it and cache it if it's near the tip.
+ * pblock is loaded with GetCachedBlock if null.
+ */
+static std::shared_ptr<const CBlockHeaderAndShortTxIDs> GetCachedCompactBlock(const CBlockIndex* pindex, std::shared_ptr<const CBlock> pblock, bool use_wtxid, const Consensus::Params& consensusParams) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblock = g_block_cache.GetCompactBlock(pindex->GetBlockHash(), use_wtxid);
+    if (pcmpctblock) {
+        return pcmpctblock;
+    }
+    if (!pblock) {
+        pblock = GetCachedBlock(pindex, consensusParams);
+        if (!pblock) {
+            return nullptr;
+        }
+    }
+    pcmpctblock = std::make_shared<const CBlockHeaderAndShortTxIDs>(*pblock, use_wtxid);
+    if (::ChainActive().Height() - pindex->nHeight <= BLOCK_CACHE_MAX_DEPTH) {
+        g_block_cache.AddCompactBlock(pindex->GetBlockHash(), use_wtxid, pcmpctblock);
+    }
+    return pcmpctblock;
+}
+
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
  * to compatible peers.
@@ -1684,11 +1766,14 @@ void PeerManager::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_
         most_recent_compact_block = pcmpctblock;
         fWitnessesPresentInMostRecentCompactBlock = fWitnessEnabled;
     }
+    g_block_cache.AddBlock(pblock);
+    g_block_cache.AddCompactBlock(hashBlock, true, pcmpctblock);
 
-    m_connman.ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    // Serialized on first use and shared by all peers it's announced to
+    CSharedNetMsgDataRef cmpctblock_data;
+    m_connman.ForEachNode([this, &pcmpctblock, &cmpctblock_data, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
-        // TODO: Avoid the repeated-serialization here
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
             return;
         ProcessBlockAvailability(pnode->GetId());
@@ -1701,7 +1786,10 @@ void PeerManager::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_
 
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
-            m_connman.PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+            if (!cmpctblock_data) {
+                cmpctblock_data = msgMaker.MakeSharedPayload(0, *pcmpctblock);
+            }
+            m_connman.PushMessage(pnode, msgMaker.MakeShared(NetMsgType::CMPCTBLOCK, cmpctblock_data));
             state.pindexBestHeaderSent = pindex;
         }
     });
@@ -1954,23 +2042,22 @@ void static ProcessGetBlockData(CNode& pfrom, const CChainParams& chainparams, c
     if (send && (pindex->nStatus & BLOCK_HAVE_DATA))
     {
         std::shared_ptr<const CBlock> pblock;
-        if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
-            pblock = a_recent_block;
-        } else if (inv.IsMsgWitnessBlk()) {
-            // Fast-path: in this case it is possible to serve the block directly from disk,
-            // as the network format matches the format on disk
-            std::vector<uint8_t> block_data;
-            if (!ReadRawBlockFromDisk(block_data, pindex, chainparams.MessageStart())) {
+        if (inv.IsMsgWitnessBlk()) {
+            // Fast-path: queue the serialized block without copying, shared
+            // with any other peer it's still queued to
+            CSharedNetMsgDataRef block_data = GetSharedBlockData(pindex, a_recent_block, chainparams);
+            if (!block_data) {
                 assert(!"cannot load block from disk");
             }
-            connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, MakeSpan(block_data)));
+            connman.PushMessage(&pfrom, msgMaker.MakeShared(NetMsgType::BLOCK, std::move(block_data)));
             // Don't set pblock as we've sent the block
+        } else if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
+            pblock = a_recent_block;
         } else {
-            // Send block from disk
-            std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
-            if (!ReadBlockFromDisk(*pblockRead, pindex, consensusParams))
+            // Send block from the cache or disk
+            pblock = GetCachedBlock(pindex, consensusParams);
+            if (!pblock)
                 assert(!"cannot load block from disk");
-            pblock = pblockRead;
         }
         if (pblock) {
             if (inv.IsMsgBlk()) {
@@ -2012,8 +2099,7 @@ void static ProcessGetBlockData(CNode& pfrom, const CChainParams& chainparams, c
                     if ((fPeerWantsWitness || !fWitnessesPresentInARecentCompactBlock) && a_recent_compact_block && a_recent_compact_block->header.GetHash() == pindex->GetBlockHash()) {
                         connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *a_recent_compact_block));
                     } else {
-                        CBlockHeaderAndShortTxIDs cmpctblock(*pblock, fPeerWantsWitness);
-                        connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
+                        connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *GetCachedCompactBlock(pindex, pblock, fPeerWantsWitness, consensusParams)));
                     }
                 } else {
                     connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::BLOCK, *pblock));
@@ -3295,11 +3381,10 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             }
 
             if (pindex->nHeight >= ::ChainActive().Height() - MAX_BLOCKTXN_DEPTH) {
-                CBlock block;
-                bool ret = ReadBlockFromDisk(block, pindex, m_chainparams.GetConsensus());
-                assert(ret);
+                std::shared_ptr<const CBlock> pblock = GetCachedBlock(pindex, m_chainparams.GetConsensus());
+                assert(pblock);
 
-                SendBlockTransactions(pfrom, block, req);
+                SendBlockTransactions(pfrom, *pblock, req);
                 return;
             }
         }
@@ -4232,10 +4317,17 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
         return;
     }
 
-    if (!(pfrom.IsAddrFetchConn() || pfrom.IsFeelerConn()) &&
-        smsg::SMSG_UNKNOWN_MESSAGE != smsgModule.ReceiveData(this, &pfrom, msg_type, vRecv)) {
-        // If smsg::fSecMsgEnabled is false smsgModule.ReceiveData will ignore SMSGMsgType::PING messages to avoid the Unknown command message
-        return;
+    if (!(pfrom.IsAddrFetchConn() || pfrom.IsFeelerConn())) {
+        if (m_connman.HasSmsgHandlerThread()) {
+            if (smsgModule.QueueReceivedData(&pfrom, msg_type, vRecv)) {
+                m_connman.WakeSmsgHandler();
+                return;
+            }
+        } else
+        if (smsg::SMSG_UNKNOWN_MESSAGE != smsgModule.ReceiveData(this, &pfrom, msg_type, vRecv)) {
+            // If smsg::fSecMsgEnabled is false smsgModule.ReceiveData will ignore SMSGMsgType::PING messages to avoid the Unknown command message
+            return;
+        }
     }
 
     // Ignore unknown commands for extensibility
@@ -4341,6 +4433,11 @@ bool PeerManager::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgP
     if (pfrom->fPauseSend)
         return false;
 
+    // Hold back the peer's messages until the smsg handler thread catches up,
+    // the receive buffer fills and flow control pushes back on the peer
+    if (m_connman.HasSmsgHandlerThread() && smsgModule.IsPeerQueueFull(pfrom))
+        return false;
+
     std::list<CNetMessage> msgs;
     {
         LOCK(pfrom->cs_vProcessMsg);
@@ -4742,11 +4839,9 @@ bool PeerManager::SendMessages(CNode* pto)
                         }
                     }
                     if (!fGotBlockFromCache) {
-                        CBlock block;
-                        bool ret = ReadBlockFromDisk(block, pBestIndex, consensusParams);
-                        assert(ret);
-                        CBlockHeaderAndShortTxIDs cmpctblock(block, state.fWantsCmpctWitness);
-                        m_connman.PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
+                        std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblock = GetCachedCompactBlock(pBestIndex, nullptr, state.fWantsCmpctWitness, consensusParams);
+                        assert(pcmpctblock);
+                        m_connman.PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *pcmpctblock));
                     }
                     state.pindexBestHeaderSent = pBestIndex;
                 } else if (state.fPreferHeaders) {
@@ -5105,12 +5200,33 @@ bool PeerManager::SendMessages(CNode* pto)
         }
     } // release cs_main
 
+    if (!m_connman.HasSmsgHandlerThread()) {
+        SendSmsgMessages(pto);
+    }
+    return true;
+}
+
+bool PeerManager::ProcessSmsgMessages(CNode* pfrom)
+{
+    bool was_full = smsgModule.IsPeerQueueFull(pfrom);
+    bool fMoreWork = smsgModule.ProcessReceivedData(this, pfrom);
+    if (was_full && !smsgModule.IsPeerQueueFull(pfrom)) {
+        LogPrint(BCLog::SMSG, "smsg receive queue drained, resuming peer=%d\n", pfrom->GetId());
+        m_connman.WakeMessageHandler(pfrom->GetId());
+    }
+    return fMoreWork;
+}
+
+void PeerManager::SendSmsgMessages(CNode* pto)
+{
+    if (!pto->fSuccessfullyConnected || pto->fDisconnect) {
+        return;
+    }
     if (smsg::fSecMsgEnabled &&
         !(pto->IsAddrFetchConn() || pto->IsFeelerConn())) {
         bool fSendTrickle = pto->HasPermission(PF_NOBAN);
         smsgModule.SendData(pto, fSendTrickle);
     }
-    return true;
 }
 
 class CNetProcessingCleanup
@@ -74,6 +74,10 @@ public:
     * @return                      True if there is more work to be done
     */
     bool SendMessages(CNode* pto) override EXCLUSIVE_LOCKS_REQUIRED(pto->cs_sendProcessing);
+    /** Process smsg commands queued from a node, called from the smsg handler thread */
+    bool ProcessSmsgMessages(CNode* pfrom) override;
+    /** Send smsg inventory to a node, called from SendMessages or from the smsg handler thread */
+    void SendSmsgMessages(CNode* pto) override;
 
     /** Consider evicting an outbound peer based on the amount of time they've been behind our tip */
     void ConsiderEviction(CNode& pto, int64_t time_in_seconds) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
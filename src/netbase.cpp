@@ -25,6 +25,10 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #if !defined(MSG_NOSIGNAL)
 #define MSG_NOSIGNAL 0
 #endif
@@ -958,3 +962,55 @@ void InterruptSocks5(bool interrupt)
 {
     interruptSocks5Recv = interrupt;
 }
+
+#ifdef USE_EPOLL
+//! Max events returned by one epoll_wait, more remain queued for the next call
+static const int MAX_EPOLL_EVENTS = 256;
+
+EpollSocketSet::EpollSocketSet()
+{
+    m_fd = epoll_create1(EPOLL_CLOEXEC);
+}
+
+EpollSocketSet::~EpollSocketSet()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+bool EpollSocketSet::Add(const SOCKET& hSocket, uint64_t tag, bool fLevelTriggered)
+{
+    struct epoll_event event;
+    event.events = fLevelTriggered ? EPOLLIN : (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET);
+    event.data.u64 = tag;
+    return epoll_ctl(m_fd, EPOLL_CTL_ADD, hSocket, &event) == 0;
+}
+
+bool EpollSocketSet::Remove(const SOCKET& hSocket)
+{
+    // Closed sockets drop out of the set by themselves
+    struct epoll_event event;
+    return epoll_ctl(m_fd, EPOLL_CTL_DEL, hSocket, &event) == 0;
+}
+
+bool EpollSocketSet::Wait(std::vector<Event>& events, int nTimeoutMs)
+{
+    events.clear();
+    struct epoll_event ready[MAX_EPOLL_EVENTS];
+    int nReady = epoll_wait(m_fd, ready, MAX_EPOLL_EVENTS, nTimeoutMs);
+    if (nReady < 0) {
+        return errno == EINTR;
+    }
+    events.reserve(nReady);
+    for (int i = 0; i < nReady; ++i) {
+        Event event;
+        event.tag = ready[i].data.u64;
+        event.recv = ready[i].events & EPOLLIN;
+        event.send = ready[i].events & EPOLLOUT;
+        event.error = ready[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP);
+        events.push_back(event);
+    }
+    return true;
+}
+#endif // USE_EPOLL
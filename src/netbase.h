@@ -68,4 +68,40 @@ bool SetSocketNoDelay(const SOCKET& hSocket);
 struct timeval MillisToTimeval(int64_t nTimeout);
 void InterruptSocks5(bool interrupt);
 
+#ifdef USE_EPOLL
+/**
+ * Set of sockets watched by one epoll instance.
+ *
+ * Sockets are registered once and Wait() only returns those which became
+ * ready, so the cost of a wakeup doesn't grow with the number of idle sockets.
+ * Edge triggered sockets are reported again only after new data arrives or
+ * send space frees up, the caller must drain them until they would block.
+ */
+class EpollSocketSet
+{
+public:
+    struct Event {
+        uint64_t tag;
+        bool recv;
+        bool send;
+        bool error;
+    };
+
+    EpollSocketSet();
+    ~EpollSocketSet();
+    EpollSocketSet(const EpollSocketSet&) = delete;
+    EpollSocketSet& operator=(const EpollSocketSet&) = delete;
+
+    bool IsValid() const { return m_fd >= 0; }
+    /** Watch hSocket for reads and writes, tag is returned with its events */
+    bool Add(const SOCKET& hSocket, uint64_t tag, bool fLevelTriggered = false);
+    bool Remove(const SOCKET& hSocket);
+    /** Wait up to nTimeoutMs for events, returns false on error */
+    bool Wait(std::vector<Event>& events, int nTimeoutMs);
+
+private:
+    int m_fd;
+};
+#endif // USE_EPOLL
+
 #endif // BITCOIN_NETBASE_H
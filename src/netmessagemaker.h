@@ -29,6 +29,23 @@ public:
         return Make(0, std::move(msg_type), std::forward<Args>(args)...);
     }
 
+    /** Serialize a payload once so it can be queued to several peers */
+    template <typename... Args>
+    CSharedNetMsgDataRef MakeSharedPayload(int nFlags, Args&&... args) const
+    {
+        std::vector<unsigned char> data;
+        CVectorWriter{ SER_NETWORK, nFlags | nVersion, data, 0, std::forward<Args>(args)... };
+        return std::make_shared<const CSharedNetMsgData>(std::move(data));
+    }
+
+    CSerializedNetMsg MakeShared(std::string msg_type, CSharedNetMsgDataRef payload) const
+    {
+        CSerializedNetMsg msg;
+        msg.m_type = std::move(msg_type);
+        msg.shared_data = std::move(payload);
+        return msg;
+    }
+
 private:
     const int nVersion;
 };
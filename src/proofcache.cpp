@@ -0,0 +1,105 @@
+// Copyright (c) 2017-2021 The Particl Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file license.txt or http://www.opensource.org/licenses/mit-license.php.
+
+#include <proofcache.h>
+
+#include <crypto/sha256.h>
+#include <cuckoocache.h>
+#include <random.h>
+#include <script/sigcache.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <boost/thread/shared_mutex.hpp>
+
+namespace {
+class CProofCache
+{
+private:
+    //! Entries are SHA256(nonce || 'R' or 'M' || 31 zero bytes || wtxid || index || proof context)
+    CSHA256 m_salted_hasher_rangeproof;
+    CSHA256 m_salted_hasher_mlsag;
+    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_proofcache;
+
+public:
+    CProofCache()
+    {
+        uint256 nonce = GetRandHash();
+        static constexpr unsigned char PADDING_RANGEPROOF[32] = {'R'};
+        static constexpr unsigned char PADDING_MLSAG[32] = {'M'};
+        m_salted_hasher_rangeproof.Write(nonce.begin(), 32);
+        m_salted_hasher_rangeproof.Write(PADDING_RANGEPROOF, 32);
+        m_salted_hasher_mlsag.Write(nonce.begin(), 32);
+        m_salted_hasher_mlsag.Write(PADDING_MLSAG, 32);
+    }
+
+    void ComputeEntryRangeProof(uint256 &entry, const uint256 &wtxid, uint32_t n,
+                                const secp256k1_pedersen_commitment &commitment, bool bulletproof) const
+    {
+        unsigned char type = bulletproof ? 1 : 0;
+        CSHA256 hasher = m_salted_hasher_rangeproof;
+        hasher.Write(wtxid.begin(), 32).Write((const unsigned char*)&n, sizeof(n))
+              .Write(commitment.data, sizeof(commitment.data)).Write(&type, 1).Finalize(entry.begin());
+    }
+
+    void ComputeEntryMLSAG(uint256 &entry, const uint256 &wtxid, uint32_t n, const std::vector<uint8_t> &vM) const
+    {
+        CSHA256 hasher = m_salted_hasher_mlsag;
+        hasher.Write(wtxid.begin(), 32).Write((const unsigned char*)&n, sizeof(n))
+              .Write(vM.data(), vM.size()).Finalize(entry.begin());
+    }
+
+    bool Get(const uint256 &entry, const bool erase)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return setValid.contains(entry, erase);
+    }
+
+    void Set(const uint256 &entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        setValid.insert(entry);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        return setValid.setup_bytes(n);
+    }
+};
+
+static CProofCache proofCache;
+} // namespace
+
+void ComputeRangeProofCacheEntry(uint256 &entry, const uint256 &wtxid, uint32_t n,
+                                 const secp256k1_pedersen_commitment &commitment, bool bulletproof)
+{
+    proofCache.ComputeEntryRangeProof(entry, wtxid, n, commitment, bulletproof);
+}
+
+void ComputeMLSAGCacheEntry(uint256 &entry, const uint256 &wtxid, uint32_t n, const std::vector<uint8_t> &vM)
+{
+    proofCache.ComputeEntryMLSAG(entry, wtxid, n, vM);
+}
+
+bool ProofCacheGet(const uint256 &entry, bool erase)
+{
+    return proofCache.Get(entry, erase);
+}
+
+void ProofCacheSet(const uint256 &entry)
+{
+    proofCache.Set(entry);
+}
+
+// To be called once in AppInitMain/BasicTestingSetup to initialize the
+// proofCache.
+void InitProofCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxproofcachesize", DEFAULT_MAX_PROOF_CACHE_SIZE)), MAX_MAX_PROOF_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = proofCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for rangeproof and mlsag cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
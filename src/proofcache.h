@@ -0,0 +1,38 @@
+// Copyright (c) 2017-2021 The Particl Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file license.txt or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PARTICL_PROOFCACHE_H
+#define PARTICL_PROOFCACHE_H
+
+#include <secp256k1_rangeproof.h>
+
+#include <stdint.h>
+#include <vector>
+
+class uint256;
+
+// Limit the cache of verified rangeproofs and MLSAGs to 16MB by default.
+static const unsigned int DEFAULT_MAX_PROOF_CACHE_SIZE = 16;
+// Maximum proof cache size allowed
+static const int64_t MAX_MAX_PROOF_CACHE_SIZE = 16384;
+
+/**
+ * Valid proof cache, to avoid verifying the rangeproofs of blinded outputs and
+ * the MLSAGs of anon inputs twice for every transaction (once when accepted
+ * into the memory pool, and again when accepted into the block chain).
+ *
+ * Entries are salted hashes over the wtxid, which commits to the proof data,
+ * the output or input index and the data the proof was verified against.
+ */
+void ComputeRangeProofCacheEntry(uint256 &entry, const uint256 &wtxid, uint32_t n,
+                                 const secp256k1_pedersen_commitment &commitment, bool bulletproof);
+void ComputeMLSAGCacheEntry(uint256 &entry, const uint256 &wtxid, uint32_t n, const std::vector<uint8_t> &vM);
+
+/** Return true if entry was verified before, erase the entry if erase is set. */
+bool ProofCacheGet(const uint256 &entry, bool erase);
+void ProofCacheSet(const uint256 &entry);
+
+void InitProofCache();
+
+#endif // PARTICL_PROOFCACHE_H
@@ -3,11 +3,18 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <blockcache.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <core_io.h>
 #include <httpserver.h>
 #include <index/txindex.h>
+#include <insight/addressindex.h>
+#include <insight/blockdeltas.h>
+#include <insight/insight.h>
+#include <insight/rpc.h>
+#include <insight/spentindex.h>
+#include <key_io.h>
 #include <node/context.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
@@ -30,6 +37,7 @@
 extern bool fParticlMode;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const size_t REST_STREAM_CHUNK_SIZE = 64 * 1024; //size of the chunks streamed replies are sent in
 
 enum class RetFormat {
     UNDEF,
@@ -69,6 +77,89 @@ static bool RESTERR(HTTPRequest* req, enum HTTPStatusCode status, std::string me
     return false;
 }
 
+/**
+ * Streams a reply using chunked transfer encoding, so large results are
+ * sent as they are produced instead of being built in memory first.
+ * Records are serialized for the binary and hex formats, JSON replies are
+ * written by the caller around JSON array items.
+ */
+class RESTStream
+{
+public:
+    RESTStream(HTTPRequest* req, RetFormat rf, const char* json_type = "application/json") : m_req(req), m_rf(rf)
+    {
+        m_req->WriteHeader("Content-Type", rf == RetFormat::BINARY ? "application/octet-stream" :
+                                           rf == RetFormat::HEX ? "text/plain" : json_type);
+        m_req->WriteReplyStart(HTTP_OK);
+    }
+    ~RESTStream()
+    {
+        if (m_abort) {
+            m_req->WriteReplyAbort();
+            return;
+        }
+        if (m_rf == RetFormat::HEX) {
+            m_buffer += "\n";
+        }
+        if (m_ok) {
+            m_req->WriteReplyChunk(m_buffer);
+        }
+        m_req->WriteReplyEnd();
+    }
+
+    /** Returns false once the client has gone away */
+    bool Ok() const { return m_ok; }
+
+    /** Drop what isn't sent yet and close the connection without completing the reply */
+    void Abort() { m_abort = true; }
+
+    template <typename T>
+    bool WriteRecord(const T& obj)
+    {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << obj;
+        if (m_rf == RetFormat::HEX) {
+            m_buffer += HexStr(ss);
+        } else {
+            m_buffer.append(ss.begin(), ss.end());
+        }
+        return MaybeFlush();
+    }
+
+    bool WriteRaw(const std::string& str)
+    {
+        m_buffer += str;
+        return MaybeFlush();
+    }
+
+    /** Write an item of a JSON array, separated from the previous one */
+    bool WriteJSONItem(const UniValue& obj)
+    {
+        if (m_items++ > 0) {
+            m_buffer += ",";
+        }
+        m_buffer += obj.write();
+        return MaybeFlush();
+    }
+
+private:
+    HTTPRequest* m_req;
+    RetFormat m_rf;
+    std::string m_buffer;
+    size_t m_items{0};
+    bool m_ok{true};
+    bool m_abort{false};
+
+    bool MaybeFlush()
+    {
+        if (m_ok && m_buffer.size() >= REST_STREAM_CHUNK_SIZE) {
+            m_ok = m_req->WriteReplyChunk(m_buffer);
+            m_buffer.clear();
+        }
+        return m_ok;
+    }
+};
+
 /**
  * Get the node context.
  *
@@ -243,7 +334,8 @@ static bool rest_block(HTTPRequest* req,
     if (!ParseHashStr(hashStr, hash))
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
-    CBlock block;
+    std::shared_ptr<const CBlock> pblock;
+    CSharedNetMsgDataRef raw_block;
     CBlockIndex* pblockindex = nullptr;
     CBlockIndex* tip = nullptr;
     {
@@ -257,31 +349,48 @@ static bool rest_block(HTTPRequest* req,
         if (IsBlockPruned(pblockindex))
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
-            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        // The cached raw block is witness serialized, as sent to peers
+        if (rf != RetFormat::JSON && RPCSerializationFlags() == 0) {
+            raw_block = g_block_cache.GetRawBlock(hash);
+        }
+        if (!raw_block) {
+            pblock = GetCachedBlock(pblockindex, Params().GetConsensus());
+            if (!pblock)
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
     }
 
     switch (rf) {
     case RetFormat::BINARY: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string binaryBlock = ssBlock.str();
+        std::string binaryBlock;
+        if (raw_block) {
+            binaryBlock.assign(raw_block->data.begin(), raw_block->data.end());
+        } else {
+            CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+            ssBlock << *pblock;
+            binaryBlock = ssBlock.str();
+        }
         req->WriteHeader("Content-Type", "application/octet-stream");
         req->WriteReply(HTTP_OK, binaryBlock);
         return true;
     }
 
     case RetFormat::HEX: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock) + "\n";
+        std::string strHex;
+        if (raw_block) {
+            strHex = HexStr(raw_block->data) + "\n";
+        } else {
+            CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+            ssBlock << *pblock;
+            strHex = HexStr(ssBlock) + "\n";
+        }
         req->WriteHeader("Content-Type", "text/plain");
         req->WriteReply(HTTP_OK, strHex);
         return true;
     }
 
     case RetFormat::JSON: {
-        UniValue objBlock = blockToJSON(block, tip, pblockindex, showTxDetails);
+        UniValue objBlock = blockToJSON(*pblock, tip, pblockindex, showTxDetails);
         std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, strJSON);
@@ -533,6 +642,8 @@ static bool rest_getutxos(const util::Ref& context, HTTPRequest* req, const std:
     std::vector<CCoin> outs;
     std::string bitmapStringRepresentation;
     std::vector<bool> hits;
+    int chain_height;
+    uint256 chain_tip_hash;
     bitmap.resize((vOutPoints.size() + 7) / 8);
     {
         auto process_utxos = [&vOutPoints, &outs, &hits](const CCoinsView& view, const CTxMemPool& mempool) {
@@ -552,9 +663,24 @@ static bool rest_getutxos(const util::Ref& context, HTTPRequest* req, const std:
             CCoinsViewCache& viewChain = ::ChainstateActive().CoinsTip();
             CCoinsViewMemPool viewMempool(&viewChain, *mempool);
             process_utxos(viewMempool, *mempool);
+            chain_height = ::ChainActive().Height();
+            chain_tip_hash = ::ChainActive().Tip()->GetBlockHash();
         } else {
-            LOCK(cs_main);  // no need to lock mempool!
-            process_utxos(::ChainstateActive().CoinsTip(), CTxMemPool());
+            // Read from the coins db snapshot when it was flushed at the tip,
+            // no need to lock cs_main or the mempool.
+            std::shared_ptr<const ChainstateReadView> read_view = GetChainstateReadView();
+            if (read_view && read_view->coins && read_view->coins_best_block == read_view->tip_hash) {
+                process_utxos(*read_view->coins, CTxMemPool());
+                chain_height = read_view->tip_height;
+                chain_tip_hash = read_view->tip_hash;
+            } else {
+                // The view holds the coins db open, which a cache resize under cs_main waits on
+                read_view.reset();
+                LOCK(cs_main);  // no need to lock mempool!
+                process_utxos(::ChainstateActive().CoinsTip(), CTxMemPool());
+                chain_height = ::ChainActive().Height();
+                chain_tip_hash = ::ChainActive().Tip()->GetBlockHash();
+            }
         }
 
         for (size_t i = 0; i < hits.size(); ++i) {
@@ -569,7 +695,7 @@ static bool rest_getutxos(const util::Ref& context, HTTPRequest* req, const std:
         // serialize data
         // use exact same output as mentioned in Bip64
         CDataStream ssGetUTXOResponse(SER_NETWORK, PROTOCOL_VERSION);
-        ssGetUTXOResponse << ::ChainActive().Height() << ::ChainActive().Tip()->GetBlockHash() << bitmap << outs;
+        ssGetUTXOResponse << chain_height << chain_tip_hash << bitmap << outs;
         std::string ssGetUTXOResponseString = ssGetUTXOResponse.str();
 
         req->WriteHeader("Content-Type", "application/octet-stream");
@@ -579,7 +705,7 @@ static bool rest_getutxos(const util::Ref& context, HTTPRequest* req, const std:
 
     case RetFormat::HEX: {
         CDataStream ssGetUTXOResponse(SER_NETWORK, PROTOCOL_VERSION);
-        ssGetUTXOResponse << ::ChainActive().Height() << ::ChainActive().Tip()->GetBlockHash() << bitmap << outs;
+        ssGetUTXOResponse << chain_height << chain_tip_hash << bitmap << outs;
         std::string strHex = HexStr(ssGetUTXOResponse) + "\n";
 
         req->WriteHeader("Content-Type", "text/plain");
@@ -592,8 +718,8 @@ static bool rest_getutxos(const util::Ref& context, HTTPRequest* req, const std:
 
         // pack in some essentials
         // use more or less the same output as mentioned in Bip64
-        objGetUTXOResponse.pushKV("chainHeight", ::ChainActive().Height());
-        objGetUTXOResponse.pushKV("chaintipHash", ::ChainActive().Tip()->GetBlockHash().GetHex());
+        objGetUTXOResponse.pushKV("chainHeight", chain_height);
+        objGetUTXOResponse.pushKV("chaintipHash", chain_tip_hash.GetHex());
         objGetUTXOResponse.pushKV("bitmap", bitmapStringRepresentation);
 
         UniValue utxos(UniValue::VARR);
@@ -668,6 +794,330 @@ static bool rest_blockhash_by_height(const util::Ref& context, HTTPRequest* req,
     }
 }
 
+static bool ParseRESTAddresses(HTTPRequest* req, const std::string& str, std::vector<std::pair<uint256, int>>& addresses)
+{
+    std::vector<std::string> address_strs;
+    boost::split(address_strs, str, boost::is_any_of(","));
+    for (const std::string& address_str : address_strs) {
+        uint256 hash_bytes;
+        int type = 0;
+        if (!GetIndexKey(DecodeDestination(address_str), hash_bytes, type)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address_str));
+        }
+        addresses.emplace_back(hash_bytes, type);
+    }
+    return true;
+}
+
+static bool rest_addressdeltas(const util::Ref& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf == RetFormat::UNDEF) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+
+    // /rest/addressdeltas/<address>[,<address>...][/<start height>/<end height>]
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+    if (path.size() != 1 && path.size() != 3) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/addressdeltas/<address>[,<address>...][/<start>/<end>].<ext>");
+    }
+    if (!fAddressIndex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    }
+
+    int start = 0, end = 0;
+    if (path.size() == 3) {
+        if (!ParseInt32(path[1], &start) || !ParseInt32(path[2], &end) || start <= 0 || end <= 0) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Start and end are expected to be greater than zero");
+        }
+        if (end < start) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "End is expected to be greater than start");
+        }
+    }
+
+    std::vector<std::pair<uint256, int>> addresses;
+    if (!ParseRESTAddresses(req, path[0], addresses)) {
+        return false;
+    }
+
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    const CBlockTreeSnapshot* snapshot = view ? view->block_tree.get() : nullptr;
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> address_index;
+    for (const auto& address : addresses) {
+        if (!GetAddressIndex(address.first, address.second, address_index, start, end, snapshot)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+        }
+    }
+
+    // Binary records are the index key followed by the amount
+    RESTStream stream(req, rf);
+    if (rf == RetFormat::JSON) {
+        stream.WriteRaw("[");
+    }
+    for (const auto& delta : address_index) {
+        if (rf == RetFormat::JSON) {
+            UniValue obj(UniValue::VOBJ);
+            if (AddressDeltaToJSON(delta.first, delta.second, obj) && !stream.WriteJSONItem(obj)) {
+                break;
+            }
+        } else if (!stream.WriteRecord(delta)) {
+            break;
+        }
+    }
+    if (rf == RetFormat::JSON) {
+        stream.WriteRaw("]\n");
+    }
+    return true;
+}
+
+static bool rest_addressutxos(const util::Ref& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf == RetFormat::UNDEF) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    if (!fAddressIndex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    }
+
+    std::vector<std::pair<uint256, int>> addresses;
+    if (!ParseRESTAddresses(req, param, addresses)) {
+        return false;
+    }
+
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    const CBlockTreeSnapshot* snapshot = view ? view->block_tree.get() : nullptr;
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent_outputs;
+    for (const auto& address : addresses) {
+        if (!GetAddressUnspent(address.first, address.second, unspent_outputs, snapshot)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+        }
+    }
+    std::sort(unspent_outputs.begin(), unspent_outputs.end(),
+        [](const std::pair<CAddressUnspentKey, CAddressUnspentValue>& a, const std::pair<CAddressUnspentKey, CAddressUnspentValue>& b) {
+            return a.second.blockHeight < b.second.blockHeight;
+        });
+
+    // Binary records are the unspent index key followed by its value
+    RESTStream stream(req, rf);
+    if (rf == RetFormat::JSON) {
+        stream.WriteRaw("[");
+    }
+    for (const auto& output : unspent_outputs) {
+        if (rf == RetFormat::JSON) {
+            UniValue obj(UniValue::VOBJ);
+            if (AddressUtxoToJSON(output.first, output.second, obj) && !stream.WriteJSONItem(obj)) {
+                break;
+            }
+        } else if (!stream.WriteRecord(output)) {
+            break;
+        }
+    }
+    if (rf == RetFormat::JSON) {
+        stream.WriteRaw("]\n");
+    }
+    return true;
+}
+
+static bool rest_blockdeltas(const util::Ref& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RetFormat rf = ParseDataFormat(hashStr, strURIPart);
+    if (rf == RetFormat::UNDEF) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+
+    uint256 hash;
+    if (!ParseHashStr(hashStr, hash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+    if (!fSpentIndex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Spent index is not enabled");
+    }
+
+    std::shared_ptr<const CBlock> pblock;
+    CBlockDeltasHeader header;
+    UniValue header_json;
+    {
+        LOCK(cs_main);
+        CBlockIndex* pblockindex = LookupBlockIndex(hash);
+        if (!pblockindex || !::ChainActive().Contains(pblockindex)) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found in the active chain");
+        }
+        if (IsBlockPruned(pblockindex))
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
+
+        pblock = GetCachedBlock(pblockindex, Params().GetConsensus());
+        if (!pblock)
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+
+        header.header = pblock->GetBlockHeader();
+        header.height = pblockindex->nHeight;
+        header.num_tx = pblock->vtx.size();
+        if (rf == RetFormat::JSON) {
+            header_json = BlockDeltasHeaderToJSON(*pblock, pblockindex);
+        }
+    }
+
+    // The published view is used only if it already includes the block
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    const CBlockTreeSnapshot* snapshot = view && view->tip_height >= header.height ? view->block_tree.get() : nullptr;
+
+    // Resolve all inputs first so a failure can still be reported
+    std::vector<CTxDeltas> tx_deltas(pblock->vtx.size());
+    for (size_t i = 0; i < pblock->vtx.size(); i++) {
+        if (!GetTxDeltas(*pblock->vtx[i], i, nullptr, tx_deltas[i], snapshot)) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Spent information not available");
+        }
+    }
+
+    RESTStream stream(req, rf);
+    if (rf == RetFormat::JSON) {
+        // Stream the deltas as the last field of the header object
+        std::string prefix = header_json.write();
+        prefix.pop_back();
+        stream.WriteRaw(prefix + ",\"deltas\":[");
+    } else {
+        stream.WriteRecord(header);
+    }
+    for (const CTxDeltas& deltas : tx_deltas) {
+        if (!(rf == RetFormat::JSON ? stream.WriteJSONItem(TxDeltasToJSON(deltas)) : stream.WriteRecord(deltas))) {
+            break;
+        }
+    }
+    if (rf == RetFormat::JSON) {
+        stream.WriteRaw("]}\n");
+    }
+    return true;
+}
+
+static bool rest_blockdeltasrange(const util::Ref& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf == RetFormat::UNDEF) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+
+    // /rest/blockdeltasrange/<start height>/<end height>
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+    int32_t start = -1, end = -1;
+    if (path.size() != 2 || !ParseInt32(path[0], &start) || !ParseInt32(path[1], &end)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/blockdeltasrange/<start>/<end>.<ext>");
+    }
+    {
+        LOCK(cs_main);
+        if (start < 0 || end < start || end > ::ChainActive().Height()) {
+            return RESTERR(req, HTTP_NOT_FOUND, "Block range out of range");
+        }
+    }
+
+    // Blocks are read ahead while the previous ones are sent, JSON is sent as one object per line
+    BlockDeltasReader reader(start, end);
+    RESTStream stream(req, rf, "application/x-ndjson");
+    CBlockDeltasItem item;
+    while (reader.Next(item)) {
+        if (rf == RetFormat::JSON) {
+            if (!stream.WriteRaw(BlockDeltasItemToJSON(item).write() + "\n")) {
+                return true;
+            }
+            continue;
+        }
+        stream.WriteRecord(item.header);
+        for (const CTxDeltas& deltas : item.txs) {
+            stream.WriteRecord(deltas);
+        }
+        if (!stream.Ok()) {
+            return true;
+        }
+    }
+
+    // The status has been sent already, binary replies can only be failed by closing the
+    // connection without the terminating chunk, which the client sees as a truncated reply.
+    std::string error = reader.GetError();
+    if (!error.empty()) {
+        LogPrint(BCLog::HTTP, "%s: %s\n", __func__, error);
+        if (rf == RetFormat::JSON) {
+            UniValue obj(UniValue::VOBJ);
+            obj.pushKV("error", error);
+            stream.WriteRaw(obj.write() + "\n");
+        } else {
+            stream.Abort();
+        }
+    }
+    return true;
+}
+
+static bool rest_spentinfo(const util::Ref& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    // /rest/spentinfo/<txid>-<n>
+    std::vector<std::string> parts;
+    boost::split(parts, param, boost::is_any_of("-"));
+    uint256 txid;
+    int32_t n = -1;
+    if (parts.size() != 2 || !ParseHashStr(parts[0], txid) || !ParseInt32(parts[1], &n) || n < 0) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/spentinfo/<txid>-<n>.<ext>");
+    }
+    if (!fSpentIndex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Spent index is not enabled");
+    }
+
+    const CTxMemPool* mempool = GetMemPool(context, req);
+    if (!mempool) return false;
+
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+    CSpentIndexValue value;
+    if (!GetSpentIndex(CSpentIndexKey(txid, n), value, mempool, view ? view->block_tree.get() : nullptr)) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Unable to get spent info");
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY: {
+        CDataStream ssValue(SER_NETWORK, PROTOCOL_VERSION);
+        ssValue << value;
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, ssValue.str());
+        return true;
+    }
+
+    case RetFormat::HEX: {
+        CDataStream ssValue(SER_NETWORK, PROTOCOL_VERSION);
+        ssValue << value;
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, HexStr(ssValue) + "\n");
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, SpentInfoToJSON(value).write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const util::Ref& context, HTTPRequest* req, const std::string& strReq);
@@ -681,6 +1131,11 @@ static const struct {
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/addressdeltas/", rest_addressdeltas},
+      {"/rest/addressutxos/", rest_addressutxos},
+      {"/rest/blockdeltas/", rest_blockdeltas},
+      {"/rest/blockdeltasrange/", rest_blockdeltasrange},
+      {"/rest/spentinfo/", rest_spentinfo},
 };
 
 void StartREST(const util::Ref& context)
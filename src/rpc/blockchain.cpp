@@ -1197,8 +1197,6 @@ static RPCHelpMan gettxout()
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    LOCK(cs_main);
-
     UniValue ret(UniValue::VOBJ);
 
     uint256 hash(ParseHashV(request.params[0], "txid"));
@@ -1209,6 +1207,28 @@ static RPCHelpMan gettxout()
         fMempool = request.params[2].get_bool();
 
     Coin coin;
+
+    // Without the mempool the coin can be read from the last coins db snapshot
+    // if it was flushed at the current tip, avoiding cs_main.
+    std::shared_ptr<const ChainstateReadView> read_view = GetChainstateReadView();
+    if (!fMempool && read_view && read_view->coins &&
+        read_view->coins_best_block == read_view->tip_hash) {
+        if (!read_view->coins->GetCoin(out, coin)) {
+            return NullUniValue;
+        }
+        ret.pushKV("bestblock", read_view->tip_hash.GetHex());
+        ret.pushKV("confirmations", (int64_t)(read_view->tip_height - coin.nHeight + 1));
+        ret.pushKV("value", ValueFromAmount(coin.out.nValue));
+        UniValue o(UniValue::VOBJ);
+        ScriptPubKeyToUniv(coin.out.scriptPubKey, o, true);
+        ret.pushKV("scriptPubKey", o);
+        ret.pushKV("coinbase", (bool)coin.fCoinBase);
+        return ret;
+    }
+    // The view holds the coins db open, which a cache resize under cs_main waits on
+    read_view.reset();
+
+    LOCK(cs_main);
     CCoinsViewCache* coins_view = &::ChainstateActive().CoinsTip();
 
     if (fMempool) {
@@ -2497,6 +2517,64 @@ static RPCHelpMan getposdifficulty()
     };
 }
 
+static RPCHelpMan getdbinfo()
+{
+    return RPCHelpMan{"getdbinfo",
+            "\nReturns size and compaction statistics of the block index database and the databases split out of it.\n",
+            {},
+            RPCResult{
+                RPCResult::Type::ARR, "", "",
+                {
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR, "name", "the database name: index, rct, insight or gvr"},
+                        {RPCResult::Type::NUM, "approximate_size", "the estimated size of the database on disk, in bytes"},
+                        {RPCResult::Type::NUM, "memory_usage", "the memory used by the database, in bytes"},
+                        {RPCResult::Type::ARR, "files_per_level", "the number of table files at each level",
+                        {
+                            {RPCResult::Type::NUM, "", "number of files"},
+                        }},
+                        {RPCResult::Type::NUM, "compaction_seconds", "the time spent compacting since the database was opened"},
+                        {RPCResult::Type::NUM, "compaction_read_bytes", "the bytes read by compactions since the database was opened"},
+                        {RPCResult::Type::NUM, "compaction_write_bytes", "the bytes written by compactions since the database was opened"},
+                    }},
+                }},
+            RPCExamples{
+                HelpExampleCli("getdbinfo", "")
+        + HelpExampleRpc("getdbinfo", "")
+    },
+    [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::vector<CDBStats> db_stats;
+    {
+        LOCK(cs_main);
+        if (!pblocktree) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Block tree database not loaded");
+        }
+        db_stats = pblocktree->GetDBStats();
+    }
+
+    UniValue result(UniValue::VARR);
+    for (const auto &stats : db_stats) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("name", stats.name);
+        obj.pushKV("approximate_size", stats.approximate_size);
+        obj.pushKV("memory_usage", (uint64_t)stats.memory_usage);
+        UniValue files(UniValue::VARR);
+        for (int n : stats.files_per_level) {
+            files.push_back(n);
+        }
+        obj.pushKV("files_per_level", files);
+        obj.pushKV("compaction_seconds", stats.compaction_seconds);
+        obj.pushKV("compaction_read_bytes", stats.compaction_read_bytes);
+        obj.pushKV("compaction_write_bytes", stats.compaction_write_bytes);
+        result.push_back(obj);
+    }
+    return result;
+},
+    };
+}
+
 /**
  * Serialize the UTXO set to a file for loading elsewhere.
  *
@@ -2637,6 +2715,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "scantxoutset",           &scantxoutset,           {"action", "scanobjects"} },
     { "blockchain",         "getblockfilter",         &getblockfilter,         {"blockhash", "filtertype"} },
     { "blockchain",         "getposdifficulty",       &getposdifficulty,       {"height"} },
+    { "blockchain",         "getdbinfo",              &getdbinfo,              {} },
 
     /* Not shown in help */
     { "hidden",             "invalidateblock",        &invalidateblock,        {"blockhash"} },
@@ -172,6 +172,8 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getblockhashes", 1, "low"},
     { "getblockhashes", 2, "options" },
     { "getspentinfo", 0, "inputs"},
+    { "exportblockdeltas", 0, "start"},
+    { "exportblockdeltas", 1, "end"},
     { "getaddresstxids", 0, "addresses"},
     { "getaddressbalance", 0, "addresses"},
     { "getaddressdeltas", 0, "addresses"},
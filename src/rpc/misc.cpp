@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <blockcache.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
@@ -528,6 +529,33 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCBlockCacheInfo()
+{
+    BlockCacheStats stats = g_block_cache.GetStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("entries", uint64_t(stats.entries));
+    obj.pushKV("usage", uint64_t(stats.bytes));
+    obj.pushKV("max", uint64_t(stats.max_bytes));
+    uint64_t hits = stats.block_hits + stats.raw_hits + stats.cmpct_hits;
+    uint64_t lookups = hits + stats.block_misses + stats.raw_misses + stats.cmpct_misses;
+    obj.pushKV("hits", hits);
+    obj.pushKV("misses", lookups - hits);
+    obj.pushKV("hitrate", lookups ? double(hits) / lookups : 0.0);
+    UniValue block(UniValue::VOBJ);
+    block.pushKV("hits", stats.block_hits);
+    block.pushKV("misses", stats.block_misses);
+    obj.pushKV("block", block);
+    UniValue raw(UniValue::VOBJ);
+    raw.pushKV("hits", stats.raw_hits);
+    raw.pushKV("misses", stats.raw_misses);
+    obj.pushKV("raw", raw);
+    UniValue cmpct(UniValue::VOBJ);
+    cmpct.pushKV("hits", stats.cmpct_hits);
+    cmpct.pushKV("misses", stats.cmpct_misses);
+    obj.pushKV("compact", cmpct);
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -572,6 +600,30 @@ static RPCHelpMan getmemoryinfo()
                                 {RPCResult::Type::NUM, "chunks_used", "Number allocated chunks"},
                                 {RPCResult::Type::NUM, "chunks_free", "Number unused chunks"},
                             }},
+                            {RPCResult::Type::OBJ, "blockcache", "Information about the recent block cache",
+                            {
+                                {RPCResult::Type::NUM, "entries", "Number of cached blocks"},
+                                {RPCResult::Type::NUM, "usage", "Estimated memory usage in bytes"},
+                                {RPCResult::Type::NUM, "max", "Maximum memory usage in bytes (-blockcachesize)"},
+                                {RPCResult::Type::NUM, "hits", "Total number of lookups served from the cache"},
+                                {RPCResult::Type::NUM, "misses", "Total number of lookups not found in the cache"},
+                                {RPCResult::Type::NUM, "hitrate", "Fraction of lookups served from the cache"},
+                                {RPCResult::Type::OBJ, "block", "Deserialized block lookups",
+                                {
+                                    {RPCResult::Type::NUM, "hits", "Number of hits"},
+                                    {RPCResult::Type::NUM, "misses", "Number of misses"},
+                                }},
+                                {RPCResult::Type::OBJ, "raw", "Serialized block lookups",
+                                {
+                                    {RPCResult::Type::NUM, "hits", "Number of hits"},
+                                    {RPCResult::Type::NUM, "misses", "Number of misses"},
+                                }},
+                                {RPCResult::Type::OBJ, "compact", "Compact block lookups",
+                                {
+                                    {RPCResult::Type::NUM, "hits", "Number of hits"},
+                                    {RPCResult::Type::NUM, "misses", "Number of misses"},
+                                }},
+                            }},
                         }
                     },
                     RPCResult{"mode \"mallocinfo\"",
@@ -588,6 +640,7 @@ static RPCHelpMan getmemoryinfo()
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("blockcache", RPCBlockCacheInfo());
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -559,6 +559,15 @@ static RPCHelpMan getnetworkinfo()
                                 {RPCResult::Type::BOOL, "proxy_randomize_credentials", "Whether randomized credentials are used"},
                             }},
                         }},
+                        {RPCResult::Type::ARR, "messagehandlers", "information per message handler thread",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR, "name", "thread name"},
+                                {RPCResult::Type::NUM, "peers", "the number of peers handled by the thread"},
+                                {RPCResult::Type::NUM, "busytime", "total time spent processing peers, in seconds"},
+                            }},
+                        }},
                         {RPCResult::Type::NUM, "relayfee", "minimum relay fee for transactions in " + CURRENCY_UNIT + "/kB"},
                         {RPCResult::Type::NUM, "incrementalfee", "minimum fee increment for mempool limiting or BIP 125 replacement in " + CURRENCY_UNIT + "/kB"},
                         {RPCResult::Type::ARR, "localaddresses", "list of local addresses",
@@ -600,6 +609,17 @@ static RPCHelpMan getnetworkinfo()
     }
     obj.pushKV("dos_states",    GetNumDOSStates());
     obj.pushKV("networks",      GetNetworksInfo());
+    if (node.connman) {
+        UniValue handlers(UniValue::VARR);
+        for (const MessageHandlerStats& stats : node.connman->GetMessageHandlerStats()) {
+            UniValue rec(UniValue::VOBJ);
+            rec.pushKV("name", stats.name);
+            rec.pushKV("peers", stats.num_peers);
+            rec.pushKV("busytime", stats.busy_micros * 0.000001);
+            handlers.push_back(rec);
+        }
+        obj.pushKV("messagehandlers", handlers);
+    }
     obj.pushKV("relayfee",      ValueFromAmount(::minRelayTxFee.GetFeePerK()));
     obj.pushKV("incrementalfee", ValueFromAmount(::incrementalRelayFee.GetFeePerK()));
     UniValue localAddresses(UniValue::VARR);
@@ -10,14 +10,19 @@
 #include <sync.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/signals2/signal.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <memory> // for unique_ptr
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <time.h>
 
@@ -38,14 +43,219 @@ struct RPCCommandExecutionInfo
     int64_t start;
 };
 
+//! Upper bounds of the time histogram buckets in microseconds, the last bucket is unbounded
+static const int64_t RPC_TIME_BUCKETS[] = {1000, 10000, 100000, 1000000, 10000000};
+static const char* const RPC_TIME_BUCKET_NAMES[] = {"1ms", "10ms", "100ms", "1s", "10s", "inf"};
+//! Upper bounds of the queue depth histogram buckets, the last bucket is unbounded
+static const int RPC_DEPTH_BUCKETS[] = {0, 1, 3, 7, 15};
+static const char* const RPC_DEPTH_BUCKET_NAMES[] = {"0", "1", "3", "7", "15", "inf"};
+static const size_t RPC_HISTOGRAM_SIZE = 6;
+
+template <typename T, size_t N>
+static size_t HistogramBucket(const T (&bounds)[N], T value)
+{
+    static_assert(N + 1 == RPC_HISTOGRAM_SIZE, "histogram size mismatch");
+    size_t i = 0;
+    while (i < N && value > bounds[i]) {
+        i++;
+    }
+    return i;
+}
+
+struct RPCMethodStats
+{
+    //! Maximum number of concurrent calls, 0 for no limit
+    int limit{0};
+    int active{0};
+    int queued{0};
+    int max_queued{0};
+    uint64_t calls{0};
+    uint64_t errors{0};
+    int64_t total_time{0};
+    //! Calls by number of calls to the method already active or queued on arrival
+    uint64_t depth[RPC_HISTOGRAM_SIZE]{};
+    //! Calls by time spent waiting for the method's limit
+    uint64_t wait[RPC_HISTOGRAM_SIZE]{};
+    //! Calls by execution time
+    uint64_t latency[RPC_HISTOGRAM_SIZE]{};
+};
+
 struct RPCServerInfo
 {
     Mutex mutex;
+    std::condition_variable cond;
     std::list<RPCCommandExecutionInfo> active_commands GUARDED_BY(mutex);
+    std::map<std::string, RPCMethodStats> methods GUARDED_BY(mutex);
 };
 
 static RPCServerInfo g_rpc_server_info;
 
+/** Waits for a free slot under the method's concurrency limit and records the call's statistics */
+struct RPCMethodSlot
+{
+    const std::string& method;
+    int64_t start;
+    bool success{false};
+    explicit RPCMethodSlot(const std::string& method_in) : method(method_in)
+    {
+        int64_t arrival = GetTimeMicros();
+        WAIT_LOCK(g_rpc_server_info.mutex, lock);
+        RPCMethodStats& stats = g_rpc_server_info.methods[method];
+        stats.depth[HistogramBucket(RPC_DEPTH_BUCKETS, stats.active + stats.queued)]++;
+        if (stats.limit > 0 && stats.active >= stats.limit) {
+            stats.queued++;
+            stats.max_queued = std::max(stats.max_queued, stats.queued);
+            // Don't hold up shutdown, interrupted calls are allowed through
+            while (stats.active >= stats.limit && IsRPCRunning()) {
+                g_rpc_server_info.cond.wait(lock);
+            }
+            stats.queued--;
+        }
+        stats.active++;
+        start = GetTimeMicros();
+        stats.wait[HistogramBucket(RPC_TIME_BUCKETS, start - arrival)]++;
+    }
+    ~RPCMethodSlot()
+    {
+        int64_t duration = GetTimeMicros() - start;
+        LOCK(g_rpc_server_info.mutex);
+        RPCMethodStats& stats = g_rpc_server_info.methods[method];
+        stats.active--;
+        stats.calls++;
+        if (!success) {
+            stats.errors++;
+        }
+        stats.total_time += duration;
+        stats.latency[HistogramBucket(RPC_TIME_BUCKETS, duration)]++;
+        if (stats.limit > 0) {
+            g_rpc_server_info.cond.notify_all();
+        }
+    }
+};
+
+static UniValue RPCHistogramToJSON(const uint64_t (&counts)[RPC_HISTOGRAM_SIZE], const char* const (&names)[RPC_HISTOGRAM_SIZE])
+{
+    UniValue obj(UniValue::VOBJ);
+    for (size_t i = 0; i < RPC_HISTOGRAM_SIZE; ++i) {
+        obj.pushKV(names[i], counts[i]);
+    }
+    return obj;
+}
+
+/**
+ * Threads executing the entries of JSON-RPC batches in parallel.
+ * The thread which received the batch takes part too, so a batch always
+ * completes even if every pool thread is busy.
+ */
+class RPCBatchPool
+{
+public:
+    struct Job
+    {
+        Job(const JSONRPCRequest& jreq_in, const UniValue& vReq_in) : jreq(jreq_in), vReq(vReq_in), size(vReq_in.size()), results(size) {}
+
+        //! Only used for claimed entries, which all complete before Execute returns
+        const JSONRPCRequest& jreq;
+        const UniValue& vReq;
+        //! A pool thread may still claim from the job after Execute returned, and finds it empty
+        const size_t size;
+        std::vector<UniValue> results;
+        std::atomic<size_t> next{0};
+        Mutex mutex;
+        std::condition_variable cond;
+        size_t done GUARDED_BY(mutex){0};
+
+        //! Execute entries until none are left to claim
+        void Run();
+    };
+
+    void Start(int num_threads)
+    {
+        LOCK(m_mutex);
+        m_running = true;
+        for (int i = 0; i < num_threads; ++i) {
+            m_threads.emplace_back(&RPCBatchPool::ThreadRun, this, i);
+        }
+        m_num_threads = m_threads.size();
+    }
+
+    void Stop()
+    {
+        m_num_threads = 0;
+        {
+            LOCK(m_mutex);
+            m_running = false;
+            m_cond.notify_all();
+        }
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+        m_threads.clear();
+        WITH_LOCK(m_mutex, m_jobs.clear());
+    }
+
+    size_t NumThreads() const { return m_num_threads; }
+
+    /** Execute the batch on the calling thread and up to NumThreads() pool threads */
+    std::vector<UniValue> Execute(const JSONRPCRequest& jreq, const UniValue& vReq)
+    {
+        auto job = std::make_shared<Job>(jreq, vReq);
+        size_t num_helpers = std::min(NumThreads(), vReq.size() - 1);
+        {
+            LOCK(m_mutex);
+            for (size_t i = 0; i < num_helpers; ++i) {
+                m_jobs.push_back(job);
+            }
+        }
+        if (num_helpers > 0) {
+            m_cond.notify_all();
+        }
+        job->Run();
+        // Every entry is claimed now, drop the copies no pool thread has taken
+        {
+            LOCK(m_mutex);
+            m_jobs.erase(std::remove(m_jobs.begin(), m_jobs.end(), job), m_jobs.end());
+        }
+        WAIT_LOCK(job->mutex, lock);
+        while (job->done < job->size) {
+            job->cond.wait(lock);
+        }
+        return std::move(job->results);
+    }
+
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::shared_ptr<Job>> m_jobs GUARDED_BY(m_mutex);
+    bool m_running GUARDED_BY(m_mutex){false};
+    //! Only changed while the RPC server isn't running
+    std::vector<std::thread> m_threads;
+    //! Read by HTTP workers, which may still be running while the pool stops
+    std::atomic<size_t> m_num_threads{0};
+
+    void ThreadRun(int worker_num)
+    {
+        util::ThreadRename(strprintf("rpcbatch.%i", worker_num));
+        while (true) {
+            std::shared_ptr<Job> job;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                while (m_running && m_jobs.empty()) {
+                    m_cond.wait(lock);
+                }
+                if (!m_running) {
+                    break;
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job->Run();
+        }
+    }
+};
+
+static RPCBatchPool g_rpc_batch_pool;
+
 struct RPCCommandExecution
 {
     std::list<RPCCommandExecutionInfo>::iterator it;
@@ -216,6 +426,32 @@ static RPCHelpMan getrpcinfo()
                             }},
                         }},
                         {RPCResult::Type::STR, "logpath", "The complete file path to the debug log"},
+                        {RPCResult::Type::NUM, "batch_threads", "Number of threads executing batch entries in parallel (-rpcbatchthreads)"},
+                        {RPCResult::Type::OBJ_DYN, "methods", "Statistics of each method called since startup or with a limit set",
+                        {
+                            {RPCResult::Type::OBJ, "method", "",
+                            {
+                                {RPCResult::Type::NUM, "limit", "Maximum number of concurrent calls (-rpcmethodlimit), 0 for no limit"},
+                                {RPCResult::Type::NUM, "active", "Number of calls executing"},
+                                {RPCResult::Type::NUM, "queued", "Number of calls waiting for the limit"},
+                                {RPCResult::Type::NUM, "max_queued", "Highest number of calls waiting for the limit"},
+                                {RPCResult::Type::NUM, "calls", "Number of completed calls"},
+                                {RPCResult::Type::NUM, "errors", "Number of completed calls which returned an error"},
+                                {RPCResult::Type::NUM, "total_time", "Total execution time in microseconds"},
+                                {RPCResult::Type::OBJ_DYN, "depth", "Calls by the number of calls to the method already active or queued on arrival, keyed by bucket upper bound",
+                                {
+                                    {RPCResult::Type::NUM, "bound", "Number of calls"},
+                                }},
+                                {RPCResult::Type::OBJ_DYN, "wait", "Calls by time spent waiting for the limit, keyed by bucket upper bound",
+                                {
+                                    {RPCResult::Type::NUM, "bound", "Number of calls"},
+                                }},
+                                {RPCResult::Type::OBJ_DYN, "latency", "Calls by execution time, keyed by bucket upper bound",
+                                {
+                                    {RPCResult::Type::NUM, "bound", "Number of calls"},
+                                }},
+                            }},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -232,12 +468,31 @@ static RPCHelpMan getrpcinfo()
         active_commands.push_back(entry);
     }
 
+    UniValue methods(UniValue::VOBJ);
+    for (const auto& it : g_rpc_server_info.methods) {
+        const RPCMethodStats& stats = it.second;
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("limit", stats.limit);
+        entry.pushKV("active", stats.active);
+        entry.pushKV("queued", stats.queued);
+        entry.pushKV("max_queued", stats.max_queued);
+        entry.pushKV("calls", stats.calls);
+        entry.pushKV("errors", stats.errors);
+        entry.pushKV("total_time", stats.total_time);
+        entry.pushKV("depth", RPCHistogramToJSON(stats.depth, RPC_DEPTH_BUCKET_NAMES));
+        entry.pushKV("wait", RPCHistogramToJSON(stats.wait, RPC_TIME_BUCKET_NAMES));
+        entry.pushKV("latency", RPCHistogramToJSON(stats.latency, RPC_TIME_BUCKET_NAMES));
+        methods.pushKV(it.first, entry);
+    }
+
     UniValue result(UniValue::VOBJ);
     result.pushKV("active_commands", active_commands);
 
     const std::string path = LogInstance().m_file_path.string();
     UniValue log_path(UniValue::VSTR, path);
     result.pushKV("logpath", log_path);
+    result.pushKV("batch_threads", (uint64_t)g_rpc_batch_pool.NumThreads());
+    result.pushKV("methods", methods);
 
     return result;
 }
@@ -283,9 +538,33 @@ bool CRPCTable::removeCommand(const std::string& name, const CRPCCommand* pcmd)
     return false;
 }
 
+bool SetRPCMethodLimits(const std::vector<std::string>& limits, std::string& error)
+{
+    std::map<std::string, int> parsed;
+    for (const std::string& limit : limits) {
+        size_t pos = limit.find(':');
+        int n;
+        if (pos == std::string::npos || !ParseInt32(limit.substr(pos + 1), &n) || n < 0) {
+            error = strprintf("Invalid -rpcmethodlimit value %s, expected <method>:<n>", limit);
+            return false;
+        }
+        parsed[limit.substr(0, pos)] = n;
+    }
+    LOCK(g_rpc_server_info.mutex);
+    for (const auto& it : parsed) {
+        g_rpc_server_info.methods[it.first].limit = it.second;
+    }
+    return true;
+}
+
 void StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
+    int batch_threads = std::max(0, std::min((int)gArgs.GetArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), MAX_RPC_BATCH_THREADS));
+    if (batch_threads > 0) {
+        LogPrintf("RPC: starting %d batch threads\n", batch_threads);
+        g_rpc_batch_pool.Start(batch_threads);
+    }
     g_rpc_running = true;
     g_rpcSignals.Started();
 }
@@ -298,6 +577,8 @@ void InterruptRPC()
         LogPrint(BCLog::RPC, "Interrupting RPC\n");
         // Interrupt e.g. running longpolls
         g_rpc_running = false;
+        // Release calls waiting for a method limit
+        WITH_LOCK(g_rpc_server_info.mutex, g_rpc_server_info.cond.notify_all());
     });
 }
 
@@ -308,6 +589,7 @@ void StopRPC()
     assert(!g_rpc_running);
     std::call_once(g_rpc_stop_flag, []() {
         LogPrint(BCLog::RPC, "Stopping RPC\n");
+        g_rpc_batch_pool.Stop();
         WITH_LOCK(g_deadline_timers_mutex, deadlineTimers.clear());
         DeleteAuthCookie();
         g_rpcSignals.Stopped();
@@ -375,11 +657,29 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
+void RPCBatchPool::Job::Run()
+{
+    size_t i;
+    while ((i = next++) < size) {
+        results[i] = JSONRPCExecOne(jreq, vReq[i]);
+        LOCK(mutex);
+        if (++done == size) {
+            cond.notify_all();
+        }
+    }
+}
+
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    if (vReq.size() > 1 && g_rpc_batch_pool.NumThreads() > 0) {
+        for (UniValue& result : g_rpc_batch_pool.Execute(jreq, vReq)) {
+            ret.push_back(std::move(result));
+        }
+    } else {
+        for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
+            ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    }
 
     return ret.write() + "\n";
 }
@@ -446,9 +746,11 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
     // Find method
     auto it = mapCommands.find(request.strMethod);
     if (it != mapCommands.end()) {
+        RPCMethodSlot slot(it->first);
         UniValue result;
         for (const auto& command : it->second) {
             if (ExecuteCommand(*command, request, result, &command == &it->second.back())) {
+                slot.success = true;
                 return result;
             }
         }
@@ -18,6 +18,9 @@
 #include <univalue.h>
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
+//! -rpcbatchthreads default, 0 executes batch entries in order on the HTTP worker
+static const int DEFAULT_RPC_BATCH_THREADS = 0;
+static const int MAX_RPC_BATCH_THREADS = 64;
 
 class CRPCCommand;
 
@@ -178,6 +181,9 @@ bool IsDeprecatedRPCEnabled(const std::string& method);
 
 extern CRPCTable tableRPC;
 
+/** Apply -rpcmethodlimit=<method>:<n> values, returns false and sets error on an invalid value */
+bool SetRPCMethodLimits(const std::vector<std::string>& limits, std::string& error);
+
 void StartRPC();
 void InterruptRPC();
 void StopRPC();
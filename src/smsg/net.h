@@ -5,9 +5,13 @@
 #ifndef PARTICL_SMSG_NET_H
 #define PARTICL_SMSG_NET_H
 
+#include <streams.h>
 #include <sync.h>
 #include <threadsafety.h>
 
+#include <deque>
+#include <string>
+
 const uint32_t SMSG_RCVCOUNT_REDUCE = 200;
 
 namespace SMSGMsgType {
@@ -45,6 +49,9 @@ public:
     int m_version = 0;
     std::map<int64_t, PeerBucket> m_buckets GUARDED_BY(cs_smsg_net);
     std::map<int64_t, int64_t> m_buckets_last_shown;
+    /** Received smsg commands waiting for the smsg handler thread */
+    std::deque<std::pair<std::string, CDataStream> > m_recv_queue GUARDED_BY(cs_smsg_net);
+    size_t m_recv_queue_bytes GUARDED_BY(cs_smsg_net) = 0;
 
     void DecSmsgMisbehaving() {
         LOCK(cs_smsg_net);
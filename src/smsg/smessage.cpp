@@ -435,6 +435,8 @@ void AddOptions(ArgsManager& argsman)
     argsman.AddArg("-smsgsaddnewkeys", "Scan for incoming messages on new wallet keys. (default: false)", ArgsManager::ALLOW_ANY, OptionsCategory::SMSG);
     argsman.AddArg("-smsgbantime=<n>", strprintf("Number of seconds to ignore misbehaving peers for (default: %u)", SMSG_DEFAULT_BANTIME), ArgsManager::ALLOW_ANY, OptionsCategory::SMSG);
     argsman.AddArg("-smsgmaxreceive=<n>", strprintf("Max number of data messages to tolerate from peers, counter decreases over time (default: %u)", SMSG_DEFAULT_MAXRCV), ArgsManager::ALLOW_ANY, OptionsCategory::SMSG);
+    argsman.AddArg("-smsghandlerthread", strprintf("Process secure messages from peers on a dedicated thread instead of the peer's message handler thread (default: %u)", DEFAULT_SMSG_HANDLER_THREAD), ArgsManager::ALLOW_ANY, OptionsCategory::SMSG);
+    argsman.AddArg("-smsgmaxpeerqueue=<n>", strprintf("Maximum per-peer queue of received secure messages waiting for the smsg handler thread, <n>*1000 bytes. Further messages from the peer are held back until it drains (default: %u)", SMSG_DEFAULT_MAX_PEER_QUEUE), ArgsManager::ALLOW_ANY, OptionsCategory::SMSG);
     argsman.AddArg("-smsgsregtestadjust", "Adjust durations in regtest (default: true)", ArgsManager::ALLOW_ANY, OptionsCategory::HIDDEN);
     return;
 };
@@ -895,6 +897,7 @@ bool CSMSG::Start(std::shared_ptr<CWallet> pwalletIn, std::vector<std::shared_pt
     }
 
     m_smsg_max_receive_count = gArgs.GetArg("-smsgmaxreceive", SMSG_DEFAULT_MAXRCV);
+    m_max_peer_queue_bytes = std::max((int64_t)1, gArgs.GetArg("-smsgmaxpeerqueue", SMSG_DEFAULT_MAX_PEER_QUEUE)) * 1000;
 
 #ifdef ENABLE_WALLET
     UnloadAllWallets();
@@ -1214,6 +1217,8 @@ void CSMSG::GetNodesStats(int node_id, UniValue &result)
         obj.pushKV("ignoredcounter", (int) pnode->smsgData.m_ignored_counter);
         obj.pushKV("num_pending_inv", (int) pnode->smsgData.m_buckets.size());
         obj.pushKV("num_shown_buckets", (int) pnode->smsgData.m_buckets_last_shown.size());
+        obj.pushKV("num_queued", (int) pnode->smsgData.m_recv_queue.size());
+        obj.pushKV("queued_bytes", (int) pnode->smsgData.m_recv_queue_bytes);
         if (node_id > -1) {
             UniValue pending_inv_buckets(UniValue::VARR);
             for (auto it = pnode->smsgData.m_buckets.begin(); it != pnode->smsgData.m_buckets.end(); ++it) {
@@ -1276,8 +1281,8 @@ void CSMSG::ShowFundingTxns(UniValue &result)
     result.pushKV("txns", txns);
 };
 
-/** Called from ProcessMessage
-  * Runs in ThreadMessageHandler2
+/** Called from ProcessMessage, or from ProcessReceivedData with -smsghandlerthread
+  * Runs in ThreadMessageHandler2 or ThreadSmsgHandler
   */
 int CSMSG::ReceiveData(PeerManager *peerLogic, CNode *pfrom, const std::string &strCommand, CDataStream &vRecv)
 {
@@ -1315,6 +1320,7 @@ int CSMSG::ReceiveData(PeerManager *peerLogic, CNode *pfrom, const std::string &
 
     if (::ChainstateActive().IsInitialBlockDownload()) { // Wait until chain synced
         if (strCommand == SMSGMsgType::PING) {
+            LOCK(pfrom->smsgData.cs_smsg_net);
             pfrom->smsgData.lastSeen = -1; // Mark node as requiring a response once chain is synced
         }
         return SMSG_NO_ERROR;
@@ -1769,6 +1775,56 @@ int CSMSG::ReceiveData(PeerManager *peerLogic, CNode *pfrom, const std::string &
     return SMSG_NO_ERROR;
 };
 
+/** Called from ProcessMessage with -smsghandlerthread
+  * Runs in ThreadMessageHandler2
+  */
+bool CSMSG::QueueReceivedData(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv)
+{
+    if (std::find(std::begin(SMSGMsgType::allTypes), std::end(SMSGMsgType::allTypes), strCommand) == std::end(SMSGMsgType::allTypes)) {
+        return false;
+    }
+
+    LOCK(pfrom->smsgData.cs_smsg_net);
+    pfrom->smsgData.m_recv_queue_bytes += vRecv.size();
+    pfrom->smsgData.m_recv_queue.emplace_back(strCommand, std::move(vRecv));
+    return true;
+};
+
+bool CSMSG::ProcessReceivedData(PeerManager *peerLogic, CNode *pfrom)
+{
+    for (size_t n = 0; n < SMSG_RECV_QUEUE_BATCH; ++n) {
+        std::string strCommand;
+        CDataStream vRecv(SER_NETWORK, PROTOCOL_VERSION);
+        {
+            LOCK(pfrom->smsgData.cs_smsg_net);
+            if (pfrom->smsgData.m_recv_queue.empty()) {
+                return false;
+            }
+            strCommand = std::move(pfrom->smsgData.m_recv_queue.front().first);
+            vRecv = std::move(pfrom->smsgData.m_recv_queue.front().second);
+            pfrom->smsgData.m_recv_queue.pop_front();
+            pfrom->smsgData.m_recv_queue_bytes -= vRecv.size();
+        }
+        if (pfrom->fDisconnect) {
+            continue;
+        }
+        try {
+            ReceiveData(peerLogic, pfrom, strCommand, vRecv);
+        } catch (const std::exception &e) {
+            LogPrint(BCLog::SMSG, "%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand), vRecv.size(), e.what());
+        }
+    }
+
+    LOCK(pfrom->smsgData.cs_smsg_net);
+    return !pfrom->smsgData.m_recv_queue.empty();
+};
+
+bool CSMSG::IsPeerQueueFull(CNode *pfrom)
+{
+    LOCK(pfrom->smsgData.cs_smsg_net);
+    return pfrom->smsgData.m_recv_queue_bytes > m_max_peer_queue_bytes;
+};
+
 /** Called from ProcessMessage
   * Runs in ThreadMessageHandler2
   */
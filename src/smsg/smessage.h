@@ -94,6 +94,8 @@ const uint32_t SMSG_TIME_LEEWAY    = 24;
 const uint32_t SMSG_TIME_IGNORE    = 90;                // seconds a peer is ignored for if they fail to deliver messages for a smsgWant
 const uint32_t SMSG_DEFAULT_BANTIME = 8 * 60 * 60;
 const uint32_t SMSG_DEFAULT_MAXRCV = 4000;
+const uint32_t SMSG_DEFAULT_MAX_PEER_QUEUE = 5000;      // *1000 bytes, received data queued per peer for the smsg handler thread
+const size_t SMSG_RECV_QUEUE_BATCH = 16;                // queued commands processed from one peer before moving to the next
 
 const uint32_t SMSG_MAX_MSG_BYTES  = 24000;             // the user input part
 const uint32_t SMSG_MAX_AMSG_BYTES = 512;               // the user input part (ANON)
@@ -461,6 +463,12 @@ public:
     void ShowFundingTxns(UniValue &result);
 
     int ReceiveData(PeerManager *peerLogic, CNode *pfrom, const std::string &strCommand, CDataStream &vRecv);
+    /** Queue a received smsg command to be processed by ProcessReceivedData, returns false if strCommand isn't an smsg command */
+    bool QueueReceivedData(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv);
+    /** Process a batch of queued commands from pfrom, returns true if more are waiting */
+    bool ProcessReceivedData(PeerManager *peerLogic, CNode *pfrom);
+    /** True while pfrom has more than -smsgmaxpeerqueue bytes queued */
+    bool IsPeerQueueFull(CNode *pfrom);
     bool SendData(CNode *pto, bool fSendTrickle);
 
     bool ScanBlock(const CBlock &block);
@@ -558,6 +566,7 @@ public:
     int64_t nLastProcessedPurged = 0;
     CAmount m_absurd_smsg_fee = 500 * COIN;
     uint16_t m_smsg_max_receive_count = SMSG_DEFAULT_MAXRCV;
+    size_t m_max_peer_queue_bytes = SMSG_DEFAULT_MAX_PEER_QUEUE * 1000;
 
     std::map<int64_t, int64_t> m_show_requests;
 
@@ -0,0 +1,75 @@
+// Copyright (c) 2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockcache.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockcache_tests, BasicTestingSetup)
+
+static std::shared_ptr<const CBlock> MakeBlock(uint32_t nonce)
+{
+    std::shared_ptr<CBlock> block = std::make_shared<CBlock>();
+    block->nNonce = nonce;
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(blockcache_lru)
+{
+    // Room for two empty blocks
+    BlockCache cache(2 * sizeof(CBlock));
+
+    std::shared_ptr<const CBlock> block1 = MakeBlock(1), block2 = MakeBlock(2), block3 = MakeBlock(3);
+    cache.AddBlock(block1);
+    cache.AddBlock(block2);
+    BOOST_CHECK(cache.GetBlock(block1->GetHash()) == block1);
+
+    // block2 is now the least recently used
+    cache.AddBlock(block3);
+    BOOST_CHECK(cache.GetBlock(block1->GetHash()) == block1);
+    BOOST_CHECK(cache.GetBlock(block3->GetHash()) == block3);
+    BOOST_CHECK(!cache.GetBlock(block2->GetHash()));
+
+    // Adding the same block again doesn't change the usage
+    BlockCacheStats stats = cache.GetStats();
+    cache.AddBlock(block3);
+    BOOST_CHECK_EQUAL(cache.GetStats().bytes, stats.bytes);
+    BOOST_CHECK_EQUAL(stats.entries, 2U);
+    BOOST_CHECK_EQUAL(stats.block_hits, 3U);
+    BOOST_CHECK_EQUAL(stats.block_misses, 1U);
+
+    cache.SetMaxBytes(0);
+    stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.entries, 0U);
+    BOOST_CHECK_EQUAL(stats.bytes, 0U);
+    BOOST_CHECK(!cache.GetBlock(block1->GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(blockcache_raw)
+{
+    BlockCache cache(1 << 20);
+
+    std::shared_ptr<const CBlock> block = MakeBlock(1);
+    const uint256 hash = block->GetHash();
+    CSharedNetMsgDataRef raw = std::make_shared<const CSharedNetMsgData>(std::vector<unsigned char>(1000));
+
+    BOOST_CHECK(!cache.GetRawBlock(hash));
+    cache.AddBlock(block);
+    BOOST_CHECK(!cache.GetRawBlock(hash));
+    cache.AddRawBlock(hash, raw);
+    BOOST_CHECK(cache.GetRawBlock(hash) == raw);
+    BOOST_CHECK(!cache.GetCompactBlock(hash, true));
+
+    // Both forms are kept in one entry
+    BlockCacheStats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.entries, 1U);
+    BOOST_CHECK(stats.bytes >= sizeof(CBlock) + 1000);
+    BOOST_CHECK_EQUAL(stats.raw_hits, 1U);
+    BOOST_CHECK_EQUAL(stats.raw_misses, 2U);
+    BOOST_CHECK_EQUAL(stats.cmpct_misses, 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,10 +4,13 @@
 
 #include <dbwrapper.h>
 #include <test/util/setup_common.h>
+#include <txdb.h>
 #include <uint256.h>
 #include <util/memory.h>
 
+#include <atomic>
 #include <memory>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -242,6 +245,156 @@ BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_snapshot)
+{
+    // Perform tests both obfuscated and non-obfuscated.
+    for (const bool obfuscate : {false, true}) {
+        fs::path ph = GetDataDir() / (obfuscate ? "dbwrapper_snapshot_obfuscate_true" : "dbwrapper_snapshot_obfuscate_false");
+        CDBWrapper dbw(ph, (1 << 20), true, false, obfuscate);
+
+        char key = 'j';
+        uint256 in = InsecureRand256();
+        BOOST_CHECK(dbw.Write(key, in));
+
+        CDBSnapshot snapshot(dbw);
+
+        // Changes after the snapshot was taken must not be visible through it
+        uint256 in_new = InsecureRand256();
+        BOOST_CHECK(dbw.Write(key, in_new));
+        char key2 = 'k';
+        BOOST_CHECK(dbw.Write(key2, InsecureRand256()));
+
+        uint256 res;
+        BOOST_CHECK(dbw.Read(key, res));
+        BOOST_CHECK_EQUAL(res.ToString(), in_new.ToString());
+        BOOST_CHECK(snapshot.Read(key, res));
+        BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+        BOOST_CHECK(snapshot.Exists(key));
+        BOOST_CHECK(!snapshot.Exists(key2));
+
+        std::unique_ptr<CDBIterator> it(snapshot.NewIterator());
+        it->Seek(key);
+
+        char key_res;
+        BOOST_REQUIRE(it->GetKey(key_res));
+        BOOST_REQUIRE(it->GetValue(res));
+        BOOST_CHECK_EQUAL(key_res, key);
+        BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+
+        it->Next();
+        BOOST_CHECK_EQUAL(it->Valid(), false);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(coinsviewdb_resize_with_snapshot)
+{
+    CCoinsViewDB coinsdb(GetDataDir() / "coinsviewdb_resize", (1 << 20), false, false);
+    std::shared_ptr<const CCoinsViewDBSnapshot> snapshot = coinsdb.GetSnapshot();
+
+    // The resize must wait until the snapshot releases the database
+    std::atomic<bool> released{false};
+    std::thread reader([&] {
+        UninterruptibleSleep(std::chrono::milliseconds{100});
+        released = true;
+        snapshot.reset();
+    });
+    {
+        LOCK(cs_main);
+        coinsdb.ResizeCache(2 << 20);
+    }
+    BOOST_CHECK(released);
+    reader.join();
+
+    BOOST_CHECK(coinsdb.GetBestBlock().IsNull());
+    BOOST_CHECK(coinsdb.GetSnapshot()->GetBestBlock().IsNull());
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_move_records)
+{
+    // Move from a plain into an obfuscated database, values must be re-obfuscated
+    CDBWrapper src(GetDataDir() / "dbwrapper_move_src", (1 << 20), true, false, false);
+    CDBWrapper dst(GetDataDir() / "dbwrapper_move_dst", (1 << 20), true, false, true);
+
+    std::vector<uint256> values;
+    for (uint8_t k = 0; k < 10; ++k) {
+        values.push_back(InsecureRand256());
+        BOOST_CHECK(src.Write(std::make_pair('m', k), values.back()));
+    }
+    BOOST_CHECK(src.Write('n', uint256::ONE));
+
+    CDBBatch batch_dst(dst), batch_src(src);
+    std::unique_ptr<CDBIterator> it(src.NewIterator());
+    for (it->Seek('m'); it->Valid() && it->StartsWith('m'); it->Next()) {
+        batch_dst.WriteFromIterator(*it);
+        batch_src.EraseAtIterator(*it);
+    }
+    BOOST_CHECK(dst.WriteBatch(batch_dst));
+    BOOST_CHECK(src.WriteBatch(batch_src));
+
+    for (uint8_t k = 0; k < 10; ++k) {
+        uint256 res;
+        BOOST_CHECK(!src.Exists(std::make_pair('m', k)));
+        BOOST_CHECK(dst.Read(std::make_pair('m', k), res));
+        BOOST_CHECK_EQUAL(res.ToString(), values[k].ToString());
+    }
+    BOOST_CHECK(src.Exists('n'));
+    BOOST_CHECK(!dst.Exists('n'));
+
+    CDBStats stats;
+    BOOST_CHECK(dst.GetStats(stats));
+    BOOST_CHECK_EQUAL(stats.name, "dbwrapper_move_dst");
+    BOOST_CHECK(!stats.files_per_level.empty());
+}
+
+BOOST_AUTO_TEST_CASE(blocktree_split_migration)
+{
+    CBlockTreeDB db(1 << 20, true);
+
+    // Records as written by versions keeping everything in the block index database
+    CCmpPubKey pk;
+    const char DB_BLOCKHASHINDEX = 'z';
+    uint256 block_hash = InsecureRand256();
+    BOOST_CHECK(db.Write(std::make_pair(DB_RCTOUTPUT_LINK, pk), (int64_t)7));
+    BOOST_CHECK(db.Write(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0), (int64_t)100));
+    BOOST_CHECK(db.Write(std::make_pair(DB_BLOCKHASHINDEX, block_hash), CTimestampBlockIndexValue(1234)));
+    BOOST_CHECK(db.WriteReindexing(true));
+
+    int64_t index, height;
+    unsigned int ltimestamp;
+    BOOST_CHECK(!db.ReadRCTOutputLink(pk, index));
+
+    BOOST_CHECK(db.MigrateSubsystemDBs());
+    bool fSplit = false;
+    BOOST_CHECK(db.ReadFlag("splitdbs", fSplit) && fSplit);
+
+    BOOST_CHECK(db.ReadRCTOutputLink(pk, index));
+    BOOST_CHECK_EQUAL(index, 7);
+    BOOST_CHECK(db.ReadLastTrackedHeight(height));
+    BOOST_CHECK_EQUAL(height, 100);
+    BOOST_CHECK(db.ReadTimestampBlockIndex(block_hash, ltimestamp));
+    BOOST_CHECK_EQUAL(ltimestamp, 1234U);
+
+    BOOST_CHECK(!db.Exists(std::make_pair(DB_RCTOUTPUT_LINK, pk)));
+    BOOST_CHECK(!db.Exists(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0)));
+    BOOST_CHECK(!db.Exists(std::make_pair(DB_BLOCKHASHINDEX, block_hash)));
+    bool fReindexing = false;
+    db.ReadReindexing(fReindexing);
+    BOOST_CHECK(fReindexing);
+
+    // Only runs once
+    BOOST_CHECK(db.Write(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0), (int64_t)200));
+    BOOST_CHECK(db.MigrateSubsystemDBs());
+    BOOST_CHECK(db.ReadLastTrackedHeight(height));
+    BOOST_CHECK_EQUAL(height, 100);
+
+    std::vector<CDBStats> stats = db.GetDBStats();
+    BOOST_REQUIRE_EQUAL(stats.size(), 4U);
+    BOOST_CHECK_EQUAL(stats[0].name, "index");
+    BOOST_CHECK_EQUAL(stats[1].name, "rct");
+    BOOST_CHECK_EQUAL(stats[2].name, "insight");
+    BOOST_CHECK_EQUAL(stats[3].name, "gvr");
+}
+
 // Test that we do not obfuscation if there is existing data.
 BOOST_AUTO_TEST_CASE(existing_data_no_obfuscate)
 {
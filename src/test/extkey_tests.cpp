@@ -558,6 +558,76 @@ BOOST_AUTO_TEST_CASE(extkey_account)
     BOOST_CHECK(pak->nKey == 3);
 }
 
+BOOST_AUTO_TEST_CASE(extkey_lookahead_index)
+{
+    KeyIDHashMap<uint32_t> map;
+    std::vector<CKeyID> ids;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        uint160 v;
+        InsecureRandBytes(v.begin(), v.size());
+        ids.push_back(CKeyID(v));
+        BOOST_CHECK(map.insert(ids.back(), i));
+    }
+    BOOST_CHECK(!map.insert(ids[0], 0));
+    BOOST_CHECK(map.size() == 1000);
+    BOOST_CHECK(map.capacity() * 3 >= map.size() * 4);
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        BOOST_CHECK(map.erase(ids[i]) == 1);
+    }
+    BOOST_CHECK(map.erase(ids[0]) == 0);
+    BOOST_CHECK(map.size() == 500);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        const uint32_t *p = map.find(ids[i]);
+        BOOST_CHECK(i % 2 ? p && *p == i : !p);
+    }
+    BOOST_CHECK(map.erase_if([](const CKeyID &id, uint32_t v) { return v % 4 == 1; }) == 250);
+    BOOST_CHECK(map.count(ids[3]) && !map.count(ids[5]));
+
+    // Lookahead keys of two accounts in one index
+    AccLookAheadMap index;
+    CExtKeyAccount *accounts[2] = {new CExtKeyAccount(), new CExtKeyAccount()};
+    for (auto *pa : accounts) {
+        for (size_t k = 0; k < 2; ++k) { // Account key and one chain
+            CStoredExtKey *sek = new CStoredExtKey();
+            uint8_t seed[32];
+            InsecureRandBytes(seed, 32);
+            sek->kp.SetSeed(seed, 32);
+            sek->nFlags |= EAF_ACTIVE | EAF_RECEIVE_ON;
+            pa->InsertChain(sek);
+        }
+        pa->AddLookAhead(1, 5); // Keys in a not yet shared index move on SetLookAheadIndex
+        pa->SetLookAheadIndex(&index);
+        pa->QueueLookAhead(1, 10);
+        BOOST_CHECK(pa->NumPendingLookAhead() == 10);
+        BOOST_CHECK(pa->AddPendingLookAhead() == 0);
+        BOOST_CHECK(pa->NumLookAhead() == 15);
+    }
+    BOOST_CHECK(index.size() == 30);
+
+    CPubKey pk;
+    BOOST_CHECK(accounts[0]->GetChain(1)->kp.Derive(pk, 3));
+    CKeyID idk = pk.GetID();
+    const CEKAKey *pak = nullptr;
+    const CEKASCKey *pasc = nullptr;
+    isminetype ismine;
+    BOOST_CHECK(HK_LOOKAHEAD == accounts[0]->HaveKey(idk, false, pak, pasc, ismine));
+    BOOST_CHECK(HK_NO == accounts[1]->HaveKey(idk, false, pak, pasc, ismine));
+    BOOST_CHECK(index.find(idk)->pa == accounts[0]);
+    BOOST_CHECK(!accounts[1]->EraseLookAhead(idk));
+
+    BOOST_CHECK(accounts[0]->SaveKey(idk, CEKAKey(1, 3)));
+    BOOST_CHECK(HK_YES == accounts[0]->HaveKey(idk, false, pak, pasc, ismine));
+    BOOST_CHECK(accounts[0]->NumLookAhead() == 15); // Saved key replaced by a new lookahead key
+
+    accounts[0]->FreeChains();
+    delete accounts[0];
+    BOOST_CHECK(index.size() == 15);
+    accounts[1]->ClearLookAhead();
+    BOOST_CHECK(index.empty());
+    accounts[1]->FreeChains();
+    delete accounts[1];
+}
+
 BOOST_AUTO_TEST_CASE(extkey_misc_keys)
 {
     uint32_t nTest = 1;
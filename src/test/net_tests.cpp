@@ -766,4 +766,31 @@ BOOST_AUTO_TEST_CASE(PoissonNextSend)
     g_mock_deterministic_tests = false;
 }
 
+BOOST_AUTO_TEST_CASE(shared_payload_header)
+{
+    const std::vector<unsigned char> payload{0x01, 0x02, 0x03, 0x04, 0x05};
+    V1TransportSerializer serializer;
+
+    CSerializedNetMsg owned_msg;
+    owned_msg.m_type = NetMsgType::BLOCK;
+    owned_msg.data = payload;
+    std::vector<unsigned char> owned_header;
+    serializer.prepareForTransport(owned_msg, owned_header);
+
+    CSerializedNetMsg shared_msg;
+    shared_msg.m_type = NetMsgType::BLOCK;
+    shared_msg.shared_data = std::make_shared<const CSharedNetMsgData>(std::vector<unsigned char>(payload));
+    std::vector<unsigned char> shared_header;
+    serializer.prepareForTransport(shared_msg, shared_header);
+
+    BOOST_CHECK(shared_msg.data.empty());
+    BOOST_CHECK_EQUAL(shared_msg.PayloadSize(), payload.size());
+    BOOST_CHECK(owned_header == shared_header);
+
+    // Queued buffers point at the shared payload instead of copying it
+    CSendBuffer send_buffer(shared_msg.shared_data);
+    BOOST_CHECK(send_buffer.data() == shared_msg.shared_data->data.data());
+    BOOST_CHECK_EQUAL(send_buffer.size(), payload.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
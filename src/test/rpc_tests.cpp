@@ -423,4 +423,44 @@ BOOST_AUTO_TEST_CASE(rpc_getblockstats_calculate_percentiles_by_weight)
     }
 }
 
+BOOST_AUTO_TEST_CASE(rpc_batch_more_threads_than_entries)
+{
+    // Pool threads can still be woken for a batch after its entries are
+    // done and the request is gone, the batch is kept on the heap so a
+    // sanitizer catches any access after JSONRPCExecBatch returned.
+    gArgs.ForceSetArg("-rpcbatchthreads", "8");
+    StartRPC();
+    if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
+
+    util::Ref context{m_node};
+    for (int n = 0; n < 200; ++n) {
+        auto jreq = MakeUnique<JSONRPCRequest>(context);
+        auto batch = MakeUnique<UniValue>(UniValue::VARR);
+        for (int i = 0; i < 2; ++i) {
+            UniValue params(UniValue::VARR);
+            params.push_back(strprintf("%d-%d", n, i));
+            UniValue req(UniValue::VOBJ);
+            req.pushKV("method", "echo");
+            req.pushKV("params", params);
+            req.pushKV("id", i);
+            batch->push_back(req);
+        }
+        std::string reply_str = JSONRPCExecBatch(*jreq, *batch);
+        jreq.reset();
+        batch.reset();
+
+        UniValue reply;
+        BOOST_REQUIRE(reply.read(reply_str));
+        BOOST_REQUIRE_EQUAL(reply.size(), 2U);
+        for (int i = 0; i < 2; ++i) {
+            BOOST_CHECK_EQUAL(find_value(reply[i], "id").get_int(), i);
+            BOOST_CHECK_EQUAL(find_value(reply[i], "result")[0].get_str(), strprintf("%d-%d", n, i));
+        }
+    }
+
+    InterruptRPC();
+    StopRPC();
+    gArgs.ForceSetArg("-rpcbatchthreads", "0");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -19,6 +19,7 @@
 #include <insight/insight.h>
 #include <chainparams.h>
 
+#include <condition_variable>
 #include <stdint.h>
 
 static const char DB_COIN = 'C';
@@ -59,18 +60,71 @@ struct CoinEntry {
 
 }
 
+struct CCoinsViewDB::DBClosedSignal
+{
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_closed GUARDED_BY(m_mutex){false};
+};
+
 CCoinsViewDB::CCoinsViewDB(fs::path ldb_path, size_t nCacheSize, bool fMemory, bool fWipe) :
-    m_db(MakeUnique<CDBWrapper>(ldb_path, nCacheSize, fMemory, fWipe, true, false, 64)),
     m_ldb_path(ldb_path),
-    m_is_memory(fMemory) { }
+    m_is_memory(fMemory)
+{
+    OpenDB(nCacheSize, fWipe);
+}
+
+void CCoinsViewDB::OpenDB(size_t cache_size, bool wipe)
+{
+    std::shared_ptr<DBClosedSignal> closed = std::make_shared<DBClosedSignal>();
+    m_db = std::shared_ptr<CDBWrapper>(
+        new CDBWrapper(m_ldb_path, cache_size, m_is_memory, wipe, /*obfuscate*/ true),
+        [closed](CDBWrapper *db) {
+            delete db;
+            LOCK(closed->m_mutex);
+            closed->m_closed = true;
+            closed->m_cond.notify_all();
+        });
+    m_db_closed = closed;
+}
 
 void CCoinsViewDB::ResizeCache(size_t new_cache_size)
 {
     // Have to do a reset first to get the original `m_db` state to release its
-    // filesystem lock.
+    // filesystem lock. Readers may still hold snapshots of the database, the
+    // lock is only released with the last of them.
     m_db.reset();
-    m_db = MakeUnique<CDBWrapper>(
-        m_ldb_path, new_cache_size, m_is_memory, /*fWipe*/ false, /*obfuscate*/ true);
+    {
+        WAIT_LOCK(m_db_closed->m_mutex, lock);
+        while (!m_db_closed->m_closed) {
+            m_db_closed->m_cond.wait(lock);
+        }
+    }
+    OpenDB(new_cache_size, /*fWipe*/ false);
+}
+
+std::shared_ptr<const CCoinsViewDBSnapshot> CCoinsViewDB::GetSnapshot() const
+{
+    return std::make_shared<const CCoinsViewDBSnapshot>(m_db);
+}
+
+CCoinsViewDBSnapshot::CCoinsViewDBSnapshot(std::shared_ptr<CDBWrapper> db) :
+    m_db(std::move(db)),
+    m_snapshot(*m_db) { }
+
+bool CCoinsViewDBSnapshot::GetCoin(const COutPoint &outpoint, Coin &coin) const {
+    return m_snapshot.Read(CoinEntry(&outpoint), coin);
+}
+
+bool CCoinsViewDBSnapshot::HaveCoin(const COutPoint &outpoint) const {
+    return m_snapshot.Exists(CoinEntry(&outpoint));
+}
+
+uint256 CCoinsViewDBSnapshot::GetBestBlock() const {
+    uint256 hashBestChain;
+    if (!m_snapshot.Read(DB_BEST_BLOCK, hashBestChain))
+        return uint256();
+    return hashBestChain;
 }
 
 bool CCoinsViewDB::GetCoin(const COutPoint &outpoint, Coin &coin) const {
@@ -162,7 +216,107 @@ size_t CCoinsViewDB::EstimateSize() const
     return m_db->EstimateSize(DB_COIN, (char)(DB_COIN+1));
 }
 
-CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe, false, compression, maxOpenFiles) {
+static BlockTreeDBCacheSizes UniformCacheSizes(size_t nCacheSize)
+{
+    BlockTreeDBCacheSizes cache_sizes;
+    cache_sizes.index = nCacheSize;
+    cache_sizes.rct = nCacheSize;
+    cache_sizes.insight = nCacheSize;
+    cache_sizes.gvr = nCacheSize;
+    return cache_sizes;
+}
+
+CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles)
+    : CBlockTreeDB(UniformCacheSizes(nCacheSize), fMemory, fWipe, compression, maxOpenFiles) {
+}
+
+CBlockTreeDB::CBlockTreeDB(const BlockTreeDBCacheSizes &cache_sizes, bool fMemory, bool fWipe, bool compression, int maxOpenFiles)
+    : CDBWrapper(GetDataDir() / "blocks" / "index", cache_sizes.index, fMemory, fWipe, false, compression, maxOpenFiles),
+      m_rct_db(MakeUnique<CDBWrapper>(GetDataDir() / "blocks" / "rct", cache_sizes.rct, fMemory, fWipe, false, compression, maxOpenFiles)),
+      m_insight_db(std::make_shared<CDBWrapper>(GetDataDir() / "blocks" / "insight", cache_sizes.insight, fMemory, fWipe, false, compression, maxOpenFiles)),
+      m_gvr_db(std::make_shared<CDBWrapper>(GetDataDir() / "blocks" / "gvr", cache_sizes.gvr, fMemory, fWipe, false, compression, maxOpenFiles)) {
+}
+
+bool CBlockTreeDB::MigrateSubsystemDBs()
+{
+    bool fSplit = false;
+    if (ReadFlag("splitdbs", fSplit) && fSplit) {
+        return true;
+    }
+
+    // Record types moved out of the block index database and where they go
+    const std::vector<std::pair<char, CDBWrapper*> > moves = {
+        {DB_RCTOUTPUT, m_rct_db.get()},
+        {DB_RCTOUTPUT_LINK, m_rct_db.get()},
+        {DB_RCTKEYIMAGE, m_rct_db.get()},
+        {DB_SPENTCACHE, m_rct_db.get()},
+        {DB_ADDRESSINDEX, m_insight_db.get()},
+        {DB_ADDRESSUNSPENTINDEX, m_insight_db.get()},
+        {DB_TIMESTAMPINDEX, m_insight_db.get()},
+        {DB_BLOCKHASHINDEX, m_insight_db.get()},
+        {DB_SPENTINDEX, m_insight_db.get()},
+        {DB_BALANCESINDEX, m_insight_db.get()},
+        {DB_GVR_RANGE, m_gvr_db.get()},
+        {DB_GVR_BALANCE, m_gvr_db.get()},
+        {DB_GVR_CHECKPOINT, m_gvr_db.get()},
+        {DB_TRACKER_INPUTS_UNDO, m_gvr_db.get()},
+        {DB_TRACKER_OUTPUTS_UNDO, m_gvr_db.get()},
+        {DB_LAST_TRACKED_HEIGHT, m_gvr_db.get()},
+    };
+
+    const size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+    size_t num_moved = 0;
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    for (const auto &move : moves) {
+        const char prefix = move.first;
+        CDBWrapper &dest = *move.second;
+        CDBBatch batch_dest(dest), batch_erase(*this);
+
+        pcursor->Seek(prefix);
+        if (!pcursor->Valid() || !pcursor->StartsWith(prefix)) {
+            continue;
+        }
+        if (num_moved == 0) {
+            uiInterface.InitMessage(_("Splitting block index database...").translated);
+            LogPrintf("Moving subsystem records out of the block index database...\n");
+        }
+        while (pcursor->Valid() && pcursor->StartsWith(prefix)) {
+            if (ShutdownRequested()) {
+                // Records are only erased once copied, the migration resumes at the next start
+                return false;
+            }
+            batch_dest.WriteFromIterator(*pcursor);
+            batch_erase.EraseAtIterator(*pcursor);
+            num_moved++;
+            if (batch_dest.SizeEstimate() > batch_size) {
+                dest.WriteBatch(batch_dest, true);
+                WriteBatch(batch_erase);
+                batch_dest.Clear();
+                batch_erase.Clear();
+            }
+            pcursor->Next();
+        }
+        dest.WriteBatch(batch_dest, true);
+        WriteBatch(batch_erase);
+        CompactRange(prefix, (char)(prefix + 1));
+        LogPrintf("Moved records of type '%c' to %s, %d total.\n", prefix, dest.GetName(), num_moved);
+    }
+
+    return WriteFlag("splitdbs", true);
+}
+
+std::vector<CDBStats> CBlockTreeDB::GetDBStats() const
+{
+    const std::vector<const CDBWrapper*> dbs = {this, m_rct_db.get(), m_insight_db.get(), m_gvr_db.get()};
+    std::vector<CDBStats> rv;
+    for (const CDBWrapper *db : dbs) {
+        CDBStats stats;
+        if (!db->GetStats(stats)) {
+            LogPrint(BCLog::LEVELDB, "%s: Failed to read stats for %s\n", __func__, stats.name);
+        }
+        rv.push_back(stats);
+    }
+    return rv;
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
@@ -250,37 +404,17 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     return WriteBatch(batch, true);
 }
 
-bool CBlockTreeDB::ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) {
-    return Read(std::make_pair(DB_SPENTINDEX, key), value);
-}
-
-bool CBlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CSpentIndexKey,CSpentIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_SPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_SPENTINDEX, it->first), it->second);
-        }
-    }
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first), it->second);
-        }
-    }
-    return WriteBatch(batch);
+namespace {
+// Index readers shared by CBlockTreeDB and CBlockTreeSnapshot.
+template <typename DB>
+bool ReadSpentIndexImpl(DB &db, const CSpentIndexKey &key, CSpentIndexValue &value) {
+    return db.Read(std::make_pair(DB_SPENTINDEX, key), value);
 }
 
-bool CBlockTreeDB::ReadAddressUnspentIndex(uint256 addressHash, int type,
-                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
-    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
+template <typename DB>
+bool ReadAddressUnspentIndexImpl(DB &db, uint256 addressHash, int type,
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
+    const std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
 
     pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
 
@@ -303,24 +437,11 @@ bool CBlockTreeDB::ReadAddressUnspentIndex(uint256 addressHash, int type,
     return true;
 }
 
-bool CBlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::ReadAddressIndex(uint256 addressHash, int type,
-                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                                    int start, int end) {
-    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
+template <typename DB>
+bool ReadAddressIndexImpl(DB &db, uint256 addressHash, int type,
+                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                          int start, int end) {
+    const std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
 
     if (start > 0 && end > 0) {
         pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
@@ -350,16 +471,75 @@ bool CBlockTreeDB::ReadAddressIndex(uint256 addressHash, int type,
     return true;
 }
 
+template <typename DB>
+bool ReadBlockBalancesIndexImpl(DB &db, const uint256 &key, BlockBalances &value) {
+    return db.Read(std::make_pair(DB_BALANCESINDEX, key), value);
+}
+} // namespace
+
+bool CBlockTreeDB::ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) {
+    return ReadSpentIndexImpl(*m_insight_db, key, value);
+}
+
+bool CBlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
+    CDBBatch batch(*m_insight_db);
+    for (std::vector<std::pair<CSpentIndexKey,CSpentIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(std::make_pair(DB_SPENTINDEX, it->first));
+        } else {
+            batch.Write(std::make_pair(DB_SPENTINDEX, it->first), it->second);
+        }
+    }
+    return m_insight_db->WriteBatch(batch);
+}
+
+bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
+    CDBBatch batch(*m_insight_db);
+    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first), it->second);
+        }
+    }
+    return m_insight_db->WriteBatch(batch);
+}
+
+bool CBlockTreeDB::ReadAddressUnspentIndex(uint256 addressHash, int type,
+                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
+    return ReadAddressUnspentIndexImpl(*m_insight_db, addressHash, type, unspentOutputs);
+}
+
+bool CBlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+    CDBBatch batch(*m_insight_db);
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
+        batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
+    return m_insight_db->WriteBatch(batch);
+}
+
+bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+    CDBBatch batch(*m_insight_db);
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
+        batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
+    return m_insight_db->WriteBatch(batch);
+}
+
+bool CBlockTreeDB::ReadAddressIndex(uint256 addressHash, int type,
+                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                    int start, int end) {
+    return ReadAddressIndexImpl(*m_insight_db, addressHash, type, addressIndex, start, end);
+}
+
 bool CBlockTreeDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_insight_db);
     batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
-    return WriteBatch(batch);
+    return m_insight_db->WriteBatch(batch);
 }
 
 bool CBlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes)
 {
-    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    const std::unique_ptr<CDBIterator> pcursor(m_insight_db->NewIterator());
 
     pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
 
@@ -393,15 +573,15 @@ bool CBlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned i
 }
 
 bool CBlockTreeDB::WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex, const CTimestampBlockIndexValue &logicalts) {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_insight_db);
     batch.Write(std::make_pair(DB_BLOCKHASHINDEX, blockhashIndex), logicalts);
-    return WriteBatch(batch);
+    return m_insight_db->WriteBatch(batch);
 }
 
 bool CBlockTreeDB::ReadTimestampBlockIndex(const uint256 &hash, unsigned int &ltimestamp) {
 
     CTimestampBlockIndexValue lts;
-    if (!Read(std::make_pair(DB_BLOCKHASHINDEX, hash), lts)) {
+    if (!m_insight_db->Read(std::make_pair(DB_BLOCKHASHINDEX, hash), lts)) {
         return false;
     }
 
@@ -411,14 +591,48 @@ bool CBlockTreeDB::ReadTimestampBlockIndex(const uint256 &hash, unsigned int &lt
 
 bool CBlockTreeDB::WriteBlockBalancesIndex(const uint256 &key, const BlockBalances &value)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_insight_db);
     batch.Write(std::make_pair(DB_BALANCESINDEX, key), value);
-    return WriteBatch(batch);
+    return m_insight_db->WriteBatch(batch);
 }
 
 bool CBlockTreeDB::ReadBlockBalancesIndex(const uint256 &key, BlockBalances &value)
 {
-    return Read(std::make_pair(DB_BALANCESINDEX, key), value);
+    return ReadBlockBalancesIndexImpl(*m_insight_db, key, value);
+}
+
+CBlockTreeSnapshot::CBlockTreeSnapshot(const CBlockTreeDB &db) :
+    m_insight_db(db.m_insight_db),
+    m_gvr_db(db.m_gvr_db),
+    m_insight(*m_insight_db),
+    m_gvr(*m_gvr_db) { }
+
+bool CBlockTreeSnapshot::ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) const
+{
+    return ReadSpentIndexImpl(m_insight, key, value);
+}
+
+bool CBlockTreeSnapshot::ReadAddressUnspentIndex(uint256 addressHash, int type,
+                                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) const
+{
+    return ReadAddressUnspentIndexImpl(m_insight, addressHash, type, unspentOutputs);
+}
+
+bool CBlockTreeSnapshot::ReadAddressIndex(uint256 addressHash, int type,
+                                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                          int start, int end) const
+{
+    return ReadAddressIndexImpl(m_insight, addressHash, type, addressIndex, start, end);
+}
+
+bool CBlockTreeSnapshot::ReadBlockBalancesIndex(const uint256 &key, BlockBalances &value) const
+{
+    return ReadBlockBalancesIndexImpl(m_insight, key, value);
+}
+
+bool CBlockTreeSnapshot::ReadLastTrackedHeight(std::int64_t& rv) const
+{
+    return m_gvr.Read(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0), rv);
 }
 
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
@@ -499,48 +713,48 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
 
 bool CBlockTreeDB::ReadRCTOutput(int64_t i, CAnonOutput &ao)
 {
-    return Read(std::make_pair(DB_RCTOUTPUT, i), ao);
+    return m_rct_db->Read(std::make_pair(DB_RCTOUTPUT, i), ao);
 };
 
 bool CBlockTreeDB::WriteRCTOutput(int64_t i, const CAnonOutput &ao)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_rct_db);
     batch.Write(std::make_pair(DB_RCTOUTPUT, i), ao);
-    return WriteBatch(batch);
+    return m_rct_db->WriteBatch(batch);
 };
 
 bool CBlockTreeDB::EraseRCTOutput(int64_t i)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_rct_db);
     batch.Erase(std::make_pair(DB_RCTOUTPUT, i));
-    return WriteBatch(batch);
+    return m_rct_db->WriteBatch(batch);
 };
 
 
 bool CBlockTreeDB::ReadRCTOutputLink(const CCmpPubKey &pk, int64_t &i)
 {
-    return Read(std::make_pair(DB_RCTOUTPUT_LINK, pk), i);
+    return m_rct_db->Read(std::make_pair(DB_RCTOUTPUT_LINK, pk), i);
 };
 
 bool CBlockTreeDB::WriteRCTOutputLink(const CCmpPubKey &pk, int64_t i)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_rct_db);
     batch.Write(std::make_pair(DB_RCTOUTPUT_LINK, pk), i);
-    return WriteBatch(batch);
+    return m_rct_db->WriteBatch(batch);
 };
 
 bool CBlockTreeDB::EraseRCTOutputLink(const CCmpPubKey &pk)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_rct_db);
     batch.Erase(std::make_pair(DB_RCTOUTPUT_LINK, pk));
-    return WriteBatch(batch);
+    return m_rct_db->WriteBatch(batch);
 };
 
 bool CBlockTreeDB::ReadRCTKeyImage(const CCmpPubKey &ki, CAnonKeyImageInfo &data)
 {
     // Versions before 0.19.2.15 store only the txid
     CDataStream ssValue(SER_DISK, CLIENT_VERSION);
-    if (!ReadStream(std::make_pair(DB_RCTKEYIMAGE, ki), ssValue)) {
+    if (!m_rct_db->ReadStream(std::make_pair(DB_RCTKEYIMAGE, ki), ssValue)) {
         return false;
     }
     try {
@@ -558,16 +772,16 @@ bool CBlockTreeDB::ReadRCTKeyImage(const CCmpPubKey &ki, CAnonKeyImageInfo &data
 
 bool CBlockTreeDB::EraseRCTKeyImage(const CCmpPubKey &ki)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_rct_db);
     batch.Erase(std::make_pair(DB_RCTKEYIMAGE, ki));
-    return WriteBatch(batch);
+    return m_rct_db->WriteBatch(batch);
 };
 
 bool CBlockTreeDB::EraseRCTKeyImagesAfterHeight(int height)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_rct_db);
     size_t total = 0, removing = 0;
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    std::unique_ptr<CDBIterator> pcursor(m_rct_db->NewIterator());
     pcursor->Seek(std::make_pair(DB_RCTKEYIMAGE, CCmpPubKey()));
 
     while (pcursor->Valid()) {
@@ -596,33 +810,33 @@ bool CBlockTreeDB::EraseRCTKeyImagesAfterHeight(int height)
     if (removing < 1) {
         return true;
     }
-    return WriteBatch(batch);
+    return m_rct_db->WriteBatch(batch);
 };
 
 bool CBlockTreeDB::ReadSpentCache(const COutPoint &outpoint, SpentCoin &coin)
 {
-    return Read(std::make_pair(DB_SPENTCACHE, outpoint), coin);
+    return m_rct_db->Read(std::make_pair(DB_SPENTCACHE, outpoint), coin);
 };
 
 bool CBlockTreeDB::EraseSpentCache(const COutPoint &outpoint)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_rct_db);
     batch.Erase(std::make_pair(DB_SPENTCACHE, outpoint));
-    return WriteBatch(batch);
+    return m_rct_db->WriteBatch(batch);
 };
 
 bool CBlockTreeDB::EraseRewardTrackerUndo(int nHeight)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_gvr_db);
     batch.Erase(std::make_pair(DB_TRACKER_INPUTS_UNDO, nHeight));
     batch.Erase(std::make_pair(DB_TRACKER_OUTPUTS_UNDO, nHeight));
-    return WriteBatch(batch);
+    return m_gvr_db->WriteBatch(batch);
 }
 
 bool CBlockTreeDB::ReadRewardTrackerUndo(ColdRewardUndo& rewardUndo, int nHeight)
 {
 
-    const std::unique_ptr<CDBIterator> pcursor(pblocktree->NewIterator());
+    const std::unique_ptr<CDBIterator> pcursor(m_gvr_db->NewIterator());
 
     pcursor->Seek(std::make_pair(DB_TRACKER_INPUTS_UNDO, std::vector<std::pair<AddressType, CAmount>>()));
 
@@ -664,7 +878,7 @@ bool CBlockTreeDB::ReadRewardTrackerUndo(ColdRewardUndo& rewardUndo, int nHeight
 
 bool CBlockTreeDB::WriteRewardTrackerUndo(const ColdRewardUndo& rewardUndo)
 {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_gvr_db);
 
     for (const auto& inputs: rewardUndo.inputs) {
         batch.Write(std::make_pair(DB_TRACKER_INPUTS_UNDO, inputs.first), inputs.second);
@@ -674,26 +888,26 @@ bool CBlockTreeDB::WriteRewardTrackerUndo(const ColdRewardUndo& rewardUndo)
         batch.Write(std::make_pair(DB_TRACKER_OUTPUTS_UNDO, outputs.first), outputs.second);
     }
 
-    return WriteBatch(batch);
+    return m_gvr_db->WriteBatch(batch);
 }
 
 bool CBlockTreeDB::WriteLastTrackedHeight(std::int64_t lastHeight) {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_gvr_db);
     LogPrintf("%s Writting last tracked height %d\n", __func__, lastHeight);
 
     batch.Write(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0), lastHeight);
-    return WriteBatch(batch);
+    return m_gvr_db->WriteBatch(batch);
 }
 
 bool CBlockTreeDB::ReadLastTrackedHeight(std::int64_t& rv) {
-    return Read(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0), rv);
+    return m_gvr_db->Read(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0), rv);
 }
 
 bool CBlockTreeDB::EraseLastTrackedHeight() {
-    CDBBatch batch(*this);
+    CDBBatch batch(*m_gvr_db);
     LogPrintf("%s Erasing last tracked height\n", __func__);
     batch.Erase(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0));
-    return WriteBatch(batch);
+    return m_gvr_db->WriteBatch(batch);
 }
 
 
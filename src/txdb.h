@@ -24,6 +24,7 @@
 
 class CBlockIndex;
 class CCoinsViewDBCursor;
+class CCoinsViewDBSnapshot;
 class uint256;
 
 const char DB_RCTOUTPUT = 'A';
@@ -55,6 +56,8 @@ static const int64_t nMaxTxIndexCache = 1024;
 static const int64_t max_filter_index_cache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! Min memory allocated to each database split out of the block tree DB (MiB)
+static const int64_t nMinBlockTreeSubDBCache = 1;
 
 // Actually declared in validation.cpp; can't include because of circular dependency.
 extern RecursiveMutex cs_main;
@@ -63,9 +66,15 @@ extern RecursiveMutex cs_main;
 class CCoinsViewDB final : public CCoinsView
 {
 protected:
-    std::unique_ptr<CDBWrapper> m_db;
+    std::shared_ptr<CDBWrapper> m_db;
     fs::path m_ldb_path;
     bool m_is_memory;
+
+    //! Signalled when the last reference to m_db, possibly held by a snapshot, is released
+    struct DBClosedSignal;
+    std::shared_ptr<DBClosedSignal> m_db_closed;
+
+    void OpenDB(size_t cache_size, bool wipe);
 public:
     /**
      * @param[in] ldb_path    Location in the filesystem where leveldb data will be stored.
@@ -85,6 +94,27 @@ public:
 
     //! Dynamically alter the underlying leveldb cache size.
     void ResizeCache(size_t new_cache_size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    //! Return a read-only view of the coin database as currently written.
+    std::shared_ptr<const CCoinsViewDBSnapshot> GetSnapshot() const;
+};
+
+/**
+ * CCoinsView over a snapshot of the coin database. It only sees coins flushed
+ * before it was created, and may be read without holding cs_main.
+ */
+class CCoinsViewDBSnapshot final : public CCoinsView
+{
+private:
+    //! Keeps the database open for as long as the snapshot is alive.
+    std::shared_ptr<CDBWrapper> m_db;
+    CDBSnapshot m_snapshot;
+public:
+    explicit CCoinsViewDBSnapshot(std::shared_ptr<CDBWrapper> db);
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    uint256 GetBestBlock() const override;
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -109,11 +139,46 @@ private:
     friend class CCoinsViewDB;
 };
 
-/** Access to the block database (blocks/index/) */
+/** Cache sizes in bytes for the block index and the databases split out of it */
+struct BlockTreeDBCacheSizes
+{
+    size_t index{0};
+    size_t rct{0};
+    size_t insight{0};
+    size_t gvr{0};
+};
+
+/**
+ * Access to the block database (blocks/index/)
+ *
+ * The anon output, key image and spent cache records (blocks/rct/), the
+ * insight indexes (blocks/insight/) and the cold reward tracker data
+ * (blocks/gvr/) are kept in separate databases, so compactions of one don't
+ * stall reads of the others and each can be given its own cache.
+ */
 class CBlockTreeDB : public CDBWrapper
 {
+private:
+    std::unique_ptr<CDBWrapper> m_rct_db;
+    //! Shared with the snapshots, which keep them open
+    std::shared_ptr<CDBWrapper> m_insight_db;
+    std::shared_ptr<CDBWrapper> m_gvr_db;
+
+    friend class CBlockTreeSnapshot;
+
 public:
     explicit CBlockTreeDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool compression = true, int maxOpenFiles = 1000);
+    CBlockTreeDB(const BlockTreeDBCacheSizes &cache_sizes, bool fMemory, bool fWipe, bool compression = true, int maxOpenFiles = 1000);
+
+    CDBWrapper &RCTDB() const { return *m_rct_db; }
+    CDBWrapper &InsightDB() const { return *m_insight_db; }
+    CDBWrapper &GVRDB() const { return *m_gvr_db; }
+
+    /** Move records written by versions using a single database into the subsystem databases, once. */
+    bool MigrateSubsystemDBs();
+
+    /** Stats for the block index and each subsystem database */
+    std::vector<CDBStats> GetDBStats() const;
 
     bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &info);
@@ -170,4 +235,32 @@ public:
     //bool WriteRCTOutputBatch(std::vector<std::pair<int64_t, CAnonOutput> > &vao);
 };
 
+/**
+ * Read-only snapshot of the block database, for readers of the insight and
+ * GVR indexes that should not wait on cs_main.
+ */
+class CBlockTreeSnapshot
+{
+private:
+    //! Keep the databases open for as long as the snapshot is alive.
+    std::shared_ptr<CDBWrapper> m_insight_db;
+    std::shared_ptr<CDBWrapper> m_gvr_db;
+    CDBSnapshot m_insight;
+    CDBSnapshot m_gvr;
+
+public:
+    explicit CBlockTreeSnapshot(const CBlockTreeDB &db);
+
+    const CDBSnapshot &GVR() const { return m_gvr; }
+
+    bool ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) const;
+    bool ReadAddressUnspentIndex(uint256 addressHash, int type,
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect) const;
+    bool ReadAddressIndex(uint256 addressHash, int type,
+                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                          int start = 0, int end = 0) const;
+    bool ReadBlockBalancesIndex(const uint256 &key, BlockBalances &value) const;
+    bool ReadLastTrackedHeight(std::int64_t& rv) const;
+};
+
 #endif // BITCOIN_TXDB_H
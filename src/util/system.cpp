@@ -1168,6 +1168,18 @@ void AllocateFileRange(FILE *file, unsigned int offset, unsigned int length) {
 #endif
 }
 
+/**
+ * this function hints to the OS that the file will be read sequentially from the start,
+ * so that it can be prefetched ahead of the reads. It is advisory only.
+ */
+void PrefetchFile(FILE *file) {
+#if !defined(WIN32) && !defined(MAC_OSX) && defined(POSIX_FADV_SEQUENTIAL)
+    int fd = fileno(file);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+}
+
 #ifdef WIN32
 fs::path GetSpecialFolderPath(int nFolder, bool fCreate)
 {
@@ -148,6 +148,97 @@ std::map<COutPoint, uint256> mapStakeSeen;
 std::list<COutPoint> listStakeSeen;
 ColdRewardTracker rewardTracker;
 
+/**
+ * Write-back cache for the GVR tracker data.
+ *
+ * Balances, ranges and the checkpoint persisted by the tracker, and the undo
+ * data and last tracked height of connected blocks are kept here and written
+ * to the block tree db in a single batch, ahead of the chainstate flush.
+ * Outside of IBD this happens after every block.
+ *
+ * Written before the coins, the persisted GVR data is never older than the
+ * coins tip, and blocks reconnected after a crash are skipped by the last
+ * tracked height check in ConnectBlock.
+ */
+namespace {
+using RewardUndoEntry = std::pair<std::vector<std::pair<AddressType, CAmount>>, std::vector<std::pair<AddressType, CAmount>>>;
+
+struct GvrWriteCache {
+    std::map<AddressType, CAmount> balances;
+    std::map<AddressType, std::vector<BlockHeightRange>> ranges;
+    boost::optional<int> checkpoint;
+    //! Undo inputs and outputs by height, unset entries are erased on flush
+    std::map<int, boost::optional<RewardUndoEntry>> undo;
+    boost::optional<std::int64_t> last_tracked_height;
+
+    size_t GetCount() const
+    {
+        return balances.size() + ranges.size() + undo.size();
+    }
+
+    bool IsEmpty() const
+    {
+        return GetCount() == 0 && !checkpoint && !last_tracked_height;
+    }
+
+    void Clear()
+    {
+        balances.clear();
+        ranges.clear();
+        checkpoint.reset();
+        undo.clear();
+        last_tracked_height.reset();
+    }
+};
+} // namespace
+
+static GvrWriteCache gvrWriteCache GUARDED_BY(cs_main);
+//! Flush the GVR write cache ahead of the chainstate during IBD when it holds more entries
+static const size_t MAX_GVR_WRITE_CACHE_ENTRIES = 200000;
+
+static void StageGvrUndo(const ColdRewardUndo& rewardUndo, int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    RewardUndoEntry entry;
+    const auto it_inputs = rewardUndo.inputs.find(nHeight);
+    const auto it_outputs = rewardUndo.outputs.find(nHeight);
+    entry.first = it_inputs != rewardUndo.inputs.end() ? it_inputs->second : std::vector<std::pair<AddressType, CAmount>>();
+    entry.second = it_outputs != rewardUndo.outputs.end() ? it_outputs->second : std::vector<std::pair<AddressType, CAmount>>();
+    gvrWriteCache.undo[nHeight] = std::move(entry);
+}
+
+static void EraseGvrUndo(int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    gvrWriteCache.undo[nHeight] = boost::none;
+}
+
+/** Read the GVR undo data of a tracked block, false if there is no record for the height. */
+static bool ReadGvrUndo(ColdRewardUndo& rewardUndo, int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    RewardUndoEntry entry;
+    const auto it = gvrWriteCache.undo.find(nHeight);
+    if (it != gvrWriteCache.undo.end()) {
+        if (!it->second) {
+            return false;
+        }
+        entry = *it->second;
+    } else if (!pblocktree->GVRDB().Read(std::make_pair(DB_TRACKER_INPUTS_UNDO, nHeight), entry.first) ||
+               !pblocktree->GVRDB().Read(std::make_pair(DB_TRACKER_OUTPUTS_UNDO, nHeight), entry.second)) {
+        return false;
+    }
+    rewardUndo.inputs[nHeight] = std::move(entry.first);
+    rewardUndo.outputs[nHeight] = std::move(entry.second);
+    return true;
+}
+
+static bool ReadGvrLastTrackedHeight(std::int64_t& nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    if (gvrWriteCache.last_tracked_height) {
+        nHeight = *gvrWriteCache.last_tracked_height;
+        return true;
+    }
+    return pblocktree->ReadLastTrackedHeight(nHeight);
+}
+
 CoinStakeCache coinStakeCache GUARDED_BY(cs_main);
 
 CBlockIndex *pindexBestHeader = nullptr;
@@ -1998,9 +2089,8 @@ static bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const
     return true;
 }
 
-bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
+bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& hash_prev_block)
 {
-    FlatFilePos pos = pindex->GetUndoPos();
     if (pos.IsNull()) {
         return error("%s: no undo data available", __func__);
     }
@@ -2011,10 +2101,10 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
         return error("%s: OpenUndoFile failed", __func__);
 
     // Read block
-    uint256 hashChecksum, nullHash;
+    uint256 hashChecksum;
     CHashVerifier<CAutoFile> verifier(&filein); // We need a CHashVerifier as reserializing may lose data
     try {
-        verifier << (pindex->pprev ? pindex->pprev->GetBlockHash() : nullHash);
+        verifier << hash_prev_block;
         verifier >> blockundo;
         filein >> hashChecksum;
     }
@@ -2029,6 +2119,11 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
     return true;
 }
 
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    return UndoReadFromDisk(blockundo, pindex->GetUndoPos(), pindex->pprev ? pindex->pprev->GetBlockHash() : uint256());
+}
+
 /** Abort with a message */
 static bool AbortNode(const std::string& strMessage, bilingual_str user_message = bilingual_str())
 {
@@ -2104,7 +2199,7 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
         return DISCONNECT_FAILED;
     }
 
-    if (pindex->nHeight >= consensus.automatedGvrActivationHeight && !pblocktree->ReadRewardTrackerUndo(rewardUndo, pindex->nHeight)) {
+    if (pindex->nHeight >= consensus.automatedGvrActivationHeight && !ReadGvrUndo(rewardUndo, pindex->nHeight)) {
         error("DisconnectBlock(): failure reading coldreward undo data");
         return DISCONNECT_FAILED;
     }
@@ -2382,10 +2477,10 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
             }
         }
 
-        if (pindex->nHeight >= consensus.automatedGvrActivationHeight &&
-            !pblocktree->WriteLastTrackedHeight(pindex->pprev->nHeight)) {
-            return DISCONNECT_FAILED;
-        } else {
+        if (pindex->nHeight >= consensus.automatedGvrActivationHeight) {
+            // The undo data of the disconnected block is erased with the next flush
+            EraseGvrUndo(pindex->nHeight);
+            gvrWriteCache.last_tracked_height = pindex->pprev->nHeight;
             LogPrintf("%s Writting last tracked height %d\n", __func__, pindex->pprev->nHeight);
         }
 
@@ -2609,6 +2704,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     const Consensus::Params &consensus = Params().GetConsensus();
     state.SetStateInfo(block.nTime, pindex->nHeight, consensus, fParticlMode, (fBusyImporting && fSkipRangeproof), true);
+    state.m_erase_cached_proofs = !fJustCheck;
 
     // Check it again in case a previous version let a bad block in
     // NOTE: We don't currently (re-)invoke ContextualCheckBlock() or
@@ -2802,6 +2898,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
         TxValidationState tx_state;
         tx_state.SetStateInfo(block.nTime, pindex->nHeight, consensus, fParticlMode, (fBusyImporting && fSkipRangeproof), true);
+        tx_state.m_erase_cached_proofs = !fJustCheck;
         if (!tx.IsCoinBase())
         {
             CAmount txfee = 0;
@@ -3389,8 +3486,9 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     }
 
     std::int64_t readHeight;
+    bool fTrackedBlock = false;
 
-    if (pindex->nHeight >= 1 && pindex->nHeight >= consensus.automatedGvrActivationHeight && !pblocktree->ReadLastTrackedHeight(readHeight)) {
+    if (pindex->nHeight >= 1 && pindex->nHeight >= consensus.automatedGvrActivationHeight && !ReadGvrLastTrackedHeight(readHeight)) {
         if (pindex->nHeight == 1 || pindex->nHeight == consensus.automatedGvrActivationHeight) {
             readHeight = 0;
         } else {
@@ -3408,6 +3506,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
             LogPrintf("%s Last tracked Height %d, Current connecting height %d\n", __func__, readHeight, pindex->nHeight);
 
             rewardTracker.startPersistedTransaction();
+            fTrackedBlock = true;
 
             for (const auto& txs: block.vtx) {
                 for (const auto& txout: txs->vpout) {
@@ -3459,10 +3558,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                     return error("ConnectBlock(): Can't extract destination address for inputs\n");
                 }
             }
-            if (!pblocktree->WriteLastTrackedHeight(pindex->nHeight)) {
-                LogPrintf("%s Impossible to write last tracked height attempted height %d\n", __func__, pindex->nHeight);
-                return false;
-            }
         }
     }
     
@@ -3470,8 +3565,13 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
     LogPrint(BCLog::BENCH, "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n", nInputs - 1, MILLI * (nTime4 - nTime2), nInputs <= 1 ? 0 : MILLI * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * MICRO, nTimeVerify * MILLI / nBlocksTotal);
 
-    if (fJustCheck)
+    if (fJustCheck) {
+        // Leave the tracked balances as they were
+        if (fTrackedBlock) {
+            rewardTracker.revertPersistedTransaction();
+        }
         return true;
+    }
 
     if (consensus.exploit_fix_2_height && pindex->nHeight == (int)consensus.exploit_fix_2_height) {
         // Set moneysupply to utxoset sum
@@ -3489,8 +3589,9 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
      && !WriteUndoDataForBlock(blockundo, state, pindex, chainparams))
         return false;
 
-    if (pindex->nHeight >= consensus.automatedGvrActivationHeight && !pblocktree->WriteRewardTrackerUndo(rewardUndo)) {
-        return false;
+    if (fTrackedBlock) {
+        StageGvrUndo(rewardUndo, pindex->nHeight);
+        gvrWriteCache.last_tracked_height = pindex->nHeight;
     }
 
     if (!pindex->IsValid(BLOCK_VALID_SCRIPTS)) {
@@ -3572,6 +3673,46 @@ CoinsCacheSizeState CChainState::GetCoinsCacheSizeState(
     return CoinsCacheSizeState::OK;
 }
 
+namespace {
+//! Accessed through std::atomic_load/std::atomic_store only.
+std::shared_ptr<const ChainstateReadView> g_chainstate_read_view;
+} // namespace
+
+std::shared_ptr<const ChainstateReadView> GetChainstateReadView()
+{
+    return std::atomic_load(&g_chainstate_read_view);
+}
+
+void ClearChainstateReadView()
+{
+    std::atomic_store(&g_chainstate_read_view, std::shared_ptr<const ChainstateReadView>());
+}
+
+/** Publish a read view for the chainstate tip, refresh_coins takes a new snapshot of the coins db. */
+static void PublishChainstateReadView(CChainState& chainstate, const CBlockIndex* tip, bool refresh_coins)
+    EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+{
+    if (!tip || !pblocktree) {
+        return;
+    }
+    std::shared_ptr<ChainstateReadView> view = std::make_shared<ChainstateReadView>();
+    view->tip_hash = tip->GetBlockHash();
+    view->tip_height = tip->nHeight;
+    view->tip_time = tip->GetBlockTime();
+    view->tip_median_time_past = tip->GetMedianTimePast();
+    view->block_tree = std::make_shared<const CBlockTreeSnapshot>(*pblocktree);
+
+    std::shared_ptr<const ChainstateReadView> prev = GetChainstateReadView();
+    if (!refresh_coins && prev && prev->coins) {
+        view->coins = prev->coins;
+        view->coins_best_block = prev->coins_best_block;
+    } else {
+        view->coins = chainstate.CoinsDB().GetSnapshot();
+        view->coins_best_block = view->coins->GetBestBlock();
+    }
+    std::atomic_store(&g_chainstate_read_view, std::shared_ptr<const ChainstateReadView>(std::move(view)));
+}
+
 bool CChainState::FlushStateToDisk(
     const CChainParams& chainparams,
     BlockValidationState &state,
@@ -3687,6 +3828,10 @@ bool CChainState::FlushStateToDisk(
             if (!CheckDiskSpace(GetDataDir(), 48 * 2 * 2 * CoinsTip().GetCacheSize())) {
                 return AbortNode(state, "Disk space is too low!", _("Disk space is too low!"));
             }
+            // Write the GVR tracker data before the coins it was built from.
+            if (!FlushRewardTracker(true)) {
+                return AbortNode(state, "Failed to write GVR tracker data");
+            }
             // Flush the chainstate (which may refer to block index entries).
             if (!CoinsTip().Flush())
                 return AbortNode(state, "Failed to write to coin database");
@@ -3695,6 +3840,7 @@ bool CChainState::FlushStateToDisk(
         }
     }
     if (full_flush_completed) {
+        PublishChainstateReadView(*this, m_chain.Tip(), true);
         // Update best block in wallet (so we can detect restored wallets).
         GetMainSignals().ChainStateFlushed(m_chain.GetLocator());
     }
@@ -3753,36 +3899,71 @@ static void ClearSpentCache(CDBBatch &batch, int height)
     }
 }
 
-void balanceSetter(const AddressType& addr, const CAmount& amount) {
-    CDBBatch batch(*pblocktree);
-    batch.Write(std::make_pair(DB_GVR_BALANCE, addr), amount);
+void balanceSetter(const AddressType& addr, const CAmount& amount) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    gvrWriteCache.balances[addr] = amount;
+}
 
-    if (!pblocktree->WriteBatch(batch)) {
-        LogPrintf("%s: Write index data failed.", __func__);
-    }
+void rangesSetter(const AddressType& addr, const std::vector<BlockHeightRange>& vranges) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    gvrWriteCache.ranges[addr] = vranges;
 }
 
-void rangesSetter(const AddressType& addr, const std::vector<BlockHeightRange>& vranges) {
-    CDBBatch batch(*pblocktree);
-    batch.Write(std::make_pair(DB_GVR_RANGE, addr), vranges);
+void checkpointSetter(int newCheckpoint) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    gvrWriteCache.checkpoint = newCheckpoint;
+}
 
-    if (!pblocktree->WriteBatch(batch)) {
-        LogPrintf("%s: Write index data failed.", __func__);
+bool FlushRewardTracker(bool fSync)
+{
+    AssertLockHeld(cs_main);
+    if (gvrWriteCache.IsEmpty()) {
+        return true;
     }
-}
+    LOG_TIME_MILLIS_WITH_CATEGORY(strprintf("write GVR tracker data (%u entries)", gvrWriteCache.GetCount()), BCLog::BENCH);
 
-void checkpointSetter(int newCheckpoint) {
-    CDBBatch batch(*pblocktree);
-    batch.Write(std::make_pair(DB_GVR_CHECKPOINT, 0), newCheckpoint);
+    CDBWrapper& gvr_db = pblocktree->GVRDB();
+    CDBBatch batch(gvr_db);
+    for (const auto& p : gvrWriteCache.balances) {
+        batch.Write(std::make_pair(DB_GVR_BALANCE, p.first), p.second);
+    }
+    for (const auto& p : gvrWriteCache.ranges) {
+        batch.Write(std::make_pair(DB_GVR_RANGE, p.first), p.second);
+    }
+    if (gvrWriteCache.checkpoint) {
+        batch.Write(std::make_pair(DB_GVR_CHECKPOINT, 0), *gvrWriteCache.checkpoint);
+    }
+    // Empty records are written too, a tracked height without one can't be disconnected
+    for (const auto& p : gvrWriteCache.undo) {
+        if (!p.second) {
+            batch.Erase(std::make_pair(DB_TRACKER_INPUTS_UNDO, p.first));
+            batch.Erase(std::make_pair(DB_TRACKER_OUTPUTS_UNDO, p.first));
+            continue;
+        }
+        batch.Write(std::make_pair(DB_TRACKER_INPUTS_UNDO, p.first), p.second->first);
+        batch.Write(std::make_pair(DB_TRACKER_OUTPUTS_UNDO, p.first), p.second->second);
+    }
+    if (gvrWriteCache.last_tracked_height) {
+        batch.Write(std::make_pair(DB_LAST_TRACKED_HEIGHT, 0), *gvrWriteCache.last_tracked_height);
+    }
 
-    if (!pblocktree->WriteBatch(batch)) {
-        LogPrintf("%s: Write index data failed.", __func__);
+    if (!gvr_db.WriteBatch(batch, fSync)) {
+        return error("%s: Write GVR tracker data failed.", __func__);
     }
+    gvrWriteCache.Clear();
+    return true;
 }
 
-std::map<AddressType, std::vector<BlockHeightRange>> allRangesGetter() {
+/** Outside of IBD write the GVR tracker data after every block, during IBD when the cache grows too large. */
+static bool FlushRewardTrackerIfNeeded() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    if (!::ChainstateActive().IsInitialBlockDownload() || gvrWriteCache.GetCount() > MAX_GVR_WRITE_CACHE_ENTRIES) {
+        return FlushRewardTracker(false);
+    }
+    return true;
+}
+
+template <typename DB>
+static std::map<AddressType, std::vector<BlockHeightRange>> ReadAllGVRRanges(DB& db) {
     std::map<AddressType, std::vector<BlockHeightRange>> ranges;
-    const std::unique_ptr<CDBIterator> pcursor(pblocktree->NewIterator());
+    const std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
 
     pcursor->Seek(std::make_pair(DB_GVR_RANGE, std::vector<BlockHeightRange>()));
 
@@ -3804,12 +3985,24 @@ std::map<AddressType, std::vector<BlockHeightRange>> allRangesGetter() {
     return ranges;
 }
 
+std::map<AddressType, std::vector<BlockHeightRange>> allRangesGetter() EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    std::map<AddressType, std::vector<BlockHeightRange>> ranges = ReadAllGVRRanges(pblocktree->GVRDB());
+    for (const auto& p : gvrWriteCache.ranges) {
+        ranges[p.first] = p.second;
+    }
+    return ranges;
+}
+
 void clearTrackedData() {
+    LOCK(cs_main);
+    gvrWriteCache.Clear();
+    pblocktree->EraseLastTrackedHeight();
+
     auto allRanges = allRangesGetter();
 
     for (auto& range: allRanges) {
-        pblocktree->Erase(std::make_pair(DB_GVR_RANGE, range.first));
-        pblocktree->Erase(std::make_pair(DB_GVR_BALANCE, range.first));
+        pblocktree->GVRDB().Erase(std::make_pair(DB_GVR_RANGE, range.first));
+        pblocktree->GVRDB().Erase(std::make_pair(DB_GVR_BALANCE, range.first));
     }
 
     allRanges = allRangesGetter();
@@ -3819,11 +4012,11 @@ void clearTrackedData() {
     pblocktree->ReadRewardTrackerUndo(undoData, 1);
 
     for(auto& inputs: undoData.inputs) {
-        pblocktree->Erase(std::make_pair(DB_TRACKER_INPUTS_UNDO, inputs.first));
+        pblocktree->GVRDB().Erase(std::make_pair(DB_TRACKER_INPUTS_UNDO, inputs.first));
     }
 
     for(auto& outputs: undoData.outputs) {
-        pblocktree->Erase(std::make_pair(DB_TRACKER_OUTPUTS_UNDO, outputs.first));
+        pblocktree->GVRDB().Erase(std::make_pair(DB_TRACKER_OUTPUTS_UNDO, outputs.first));
     }
 
     undoData.inputs.clear();
@@ -3834,21 +4027,32 @@ void clearTrackedData() {
     assert(undoData.outputs.size() == 0 && "Undo outputs tracked data not reset during -reindex-chainstate or -reindex");
 }
 
-CAmount balanceGetter(const AddressType& addr) {
+CAmount balanceGetter(const AddressType& addr) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    const auto it = gvrWriteCache.balances.find(addr);
+    if (it != gvrWriteCache.balances.end()) {
+        return it->second;
+    }
     CAmount balance{0};
-    pblocktree->Read(std::make_pair(DB_GVR_BALANCE, addr), balance);
+    pblocktree->GVRDB().Read(std::make_pair(DB_GVR_BALANCE, addr), balance);
     return balance;
 }
 
-std::vector<BlockHeightRange> rangesGetter(const AddressType& addr) {
+std::vector<BlockHeightRange> rangesGetter(const AddressType& addr) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    const auto it = gvrWriteCache.ranges.find(addr);
+    if (it != gvrWriteCache.ranges.end()) {
+        return it->second;
+    }
     std::vector<BlockHeightRange> vBlockHeightRanges;
-    pblocktree->Read(std::make_pair(DB_GVR_RANGE, addr), vBlockHeightRanges);
+    pblocktree->GVRDB().Read(std::make_pair(DB_GVR_RANGE, addr), vBlockHeightRanges);
     return vBlockHeightRanges;
 }
 
-int checkpointGetter() {
+int checkpointGetter() EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+    if (gvrWriteCache.checkpoint) {
+        return *gvrWriteCache.checkpoint;
+    }
     int checkpoint{0};
-    pblocktree->Read(std::make_pair(DB_GVR_CHECKPOINT, 0), checkpoint);
+    pblocktree->GVRDB().Read(std::make_pair(DB_GVR_CHECKPOINT, 0), checkpoint);
     return checkpoint;
 }
 
@@ -3872,6 +4076,31 @@ ColdRewardTracker& initColdReward() {
     return rewardTracker;
 }
 
+ColdRewardTracker ColdRewardTrackerFromSnapshot(std::shared_ptr<const CBlockTreeSnapshot> snapshot)
+{
+    ColdRewardTracker tracker(::Params().GetConsensus().gvrThreshold, ::Params().GetConsensus().minRewardRangeSpan);
+
+    tracker.setPersistedRangesGetter([snapshot](const AddressType& addr) -> std::vector<BlockHeightRange> {
+        std::vector<BlockHeightRange> vBlockHeightRanges;
+        snapshot->GVR().Read(std::make_pair(DB_GVR_RANGE, addr), vBlockHeightRanges);
+        return vBlockHeightRanges;
+    });
+    tracker.setPersistedBalanceGetter([snapshot](const AddressType& addr) -> CAmount {
+        CAmount balance{0};
+        snapshot->GVR().Read(std::make_pair(DB_GVR_BALANCE, addr), balance);
+        return balance;
+    });
+    tracker.setPersistedCheckpointGetter([snapshot]() -> int {
+        int checkpoint{0};
+        snapshot->GVR().Read(std::make_pair(DB_GVR_CHECKPOINT, 0), checkpoint);
+        return checkpoint;
+    });
+    tracker.setAllRangesGetter([snapshot]() -> std::map<AddressType, std::vector<BlockHeightRange>> {
+        return ReadAllGVRRanges(snapshot->GVR());
+    });
+    return tracker;
+}
+
 bool FlushView(CCoinsViewCache *view, BlockValidationState& state, bool fDisconnecting)
 {
     if (!view->Flush())
@@ -3922,7 +4151,8 @@ bool FlushView(CCoinsViewCache *view, BlockValidationState& state, bool fDisconn
             }
         }
     } else {
-        CDBBatch batch(*pblocktree);
+        CDBWrapper &rct_db = pblocktree->RCTDB();
+        CDBBatch batch(rct_db);
 
         for (const auto &it : view->keyImages) {
             CAnonKeyImageInfo data(it.second, state.m_spend_height);
@@ -3940,7 +4170,7 @@ bool FlushView(CCoinsViewCache *view, BlockValidationState& state, bool fDisconn
         if (state.m_spend_height > (int)MIN_BLOCKS_TO_KEEP) {
             ClearSpentCache(batch, state.m_spend_height - (MIN_BLOCKS_TO_KEEP+1));
         }
-        if (!pblocktree->WriteBatch(batch)) {
+        if (!rct_db.WriteBatch(batch)) {
             return error("%s: Write index data failed.", __func__);
         }
         if (0 != smsgModule.WriteCache(view->smsg_cache)) {
@@ -4020,6 +4250,8 @@ void UpdateTip(CTxMemPool& mempool, const CBlockIndex* pindexNew, const CChainPa
     if (num_unexpected_version > 0) {
         LogPrint(BCLog::VALIDATION, "%d of last 100 blocks have unexpected version\n", num_unexpected_version);
     }
+
+    PublishChainstateReadView(::ChainstateActive(), pindexNew, false);
 }
 
 /** Disconnect m_chain's tip.
@@ -4057,6 +4289,9 @@ bool CChainState::DisconnectTip(BlockValidationState& state, const CChainParams&
 
         tracker.endPersistedTransaction();
         assert(flushed);
+        if (!FlushRewardTrackerIfNeeded()) {
+            return AbortNode(state, "Failed to write GVR tracker data");
+        }
     }
     LogPrint(BCLog::BENCH, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * MILLI);
     // Write the chain state to disk, if necessary.
@@ -4169,6 +4404,7 @@ bool CChainState::ConnectTip(BlockValidationState& state, const CChainParams& ch
             state.nFlags |= BLOCK_FAILED_DUPLICATE_STAKE;
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
+            tracker.revertPersistedTransaction();
             if (state.IsInvalid())
                 InvalidBlockFound(pindexNew, blockConnecting, state);
             return error("%s: ConnectBlock %s failed, %s", __func__, pindexNew->GetBlockHash().ToString(), state.ToString());
@@ -4180,6 +4416,9 @@ bool CChainState::ConnectTip(BlockValidationState& state, const CChainParams& ch
 
         tracker.endPersistedTransaction();
         assert(flushed);
+        if (!FlushRewardTrackerIfNeeded()) {
+            return AbortNode(state, "Failed to write GVR tracker data");
+        }
     }
     int64_t nTime4 = GetTimeMicros(); nTimeFlush += nTime4 - nTime3;
     LogPrint(BCLog::BENCH, "  - Flush: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime4 - nTime3) * MILLI, nTimeFlush * MICRO, nTimeFlush * MILLI / nBlocksTotal);
@@ -5085,6 +5324,7 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
     for (const auto& tx : block.vtx) {
         TxValidationState tx_state;
         tx_state.SetStateInfo(block.nTime, -1, consensusParams, fParticlMode, (fBusyImporting && fSkipRangeproof), true);
+        tx_state.m_erase_cached_proofs = state.m_erase_cached_proofs;
         if (!CheckTransaction(*tx, tx_state)) {
             // CheckBlock() does context-free validation checks. The only
             // possible failures are consensus failures.
@@ -6823,6 +7063,8 @@ void CChainState::UnloadBlockIndex() {
 void UnloadBlockIndex(CTxMemPool* mempool, ChainstateManager& chainman)
 {
     LOCK(cs_main);
+    ClearChainstateReadView();
+    gvrWriteCache.Clear();
     chainman.Unload();
     pindexBestInvalid = nullptr;
     pindexBestHeader = nullptr;
@@ -7008,6 +7250,143 @@ bool LoadGenesisBlock(const CChainParams& chainparams)
     return ::ChainstateActive().LoadGenesisBlock(chainparams);
 }
 
+namespace {
+/** A block read from a block file, deserialized and hashed off the import thread. */
+struct BlockFileItem
+{
+    std::vector<unsigned char> data;
+    uint64_t header_pos = 0; //!< Position of the message start
+    uint64_t block_pos = 0;
+    std::shared_ptr<CBlock> block;
+    uint256 hash;
+    size_t consumed = 0;     //!< Bytes of data the block deserialized from
+    std::string error;
+    bool started = false;
+    bool done = false;
+};
+
+void DecodeBlockFileItem(BlockFileItem& item)
+{
+    try {
+        VectorReader reader(SER_DISK, CLIENT_VERSION, item.data, 0);
+        std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        reader >> *pblock;
+        item.consumed = item.data.size() - reader.size();
+        item.hash = pblock->GetHash();
+        item.block = std::move(pblock);
+    } catch (const std::exception& e) {
+        item.error = e.what();
+    }
+}
+
+/**
+ * Deserializes and hashes blocks on worker threads while the import thread
+ * reads ahead in the block file. Items are returned in the order they were
+ * submitted, with no workers items are decoded inline by Submit.
+ */
+class BlockFileDecoder
+{
+private:
+    Mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::deque<std::shared_ptr<BlockFileItem>> m_queue GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex) = false;
+    //! Submitted items in file order, only accessed from the import thread
+    std::deque<std::shared_ptr<BlockFileItem>> m_items;
+    std::vector<std::thread> m_threads;
+
+    void ThreadDecode()
+    {
+        while (true) {
+            std::shared_ptr<BlockFileItem> item;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                while (!m_stop && m_queue.empty()) {
+                    m_work_cv.wait(lock);
+                }
+                if (m_stop) {
+                    return;
+                }
+                item = m_queue.front();
+                m_queue.pop_front();
+                item->started = true;
+            }
+            DecodeBlockFileItem(*item);
+            {
+                LOCK(m_mutex);
+                item->done = true;
+            }
+            m_done_cv.notify_all();
+        }
+    }
+
+public:
+    explicit BlockFileDecoder(int num_threads)
+    {
+        for (int i = 0; i < num_threads; ++i) {
+            m_threads.emplace_back(&TraceThread<std::function<void()>>, "loadblk", std::function<void()>(std::bind(&BlockFileDecoder::ThreadDecode, this)));
+        }
+    }
+
+    ~BlockFileDecoder()
+    {
+        {
+            LOCK(m_mutex);
+            m_stop = true;
+        }
+        m_work_cv.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    size_t MaxPending() const { return m_threads.empty() ? 1 : 16 * m_threads.size(); }
+    size_t Pending() const { return m_items.size(); }
+    uint64_t OldestPos() const { return m_items.front()->header_pos; }
+
+    void Submit(std::shared_ptr<BlockFileItem> item)
+    {
+        m_items.push_back(item);
+        if (m_threads.empty()) {
+            DecodeBlockFileItem(*item);
+            item->done = true;
+            return;
+        }
+        {
+            LOCK(m_mutex);
+            m_queue.push_back(std::move(item));
+        }
+        m_work_cv.notify_one();
+    }
+
+    /** Wait for and return the oldest submitted item */
+    std::shared_ptr<BlockFileItem> Next()
+    {
+        std::shared_ptr<BlockFileItem> item = m_items.front();
+        m_items.pop_front();
+        WAIT_LOCK(m_mutex, lock);
+        while (!item->done) {
+            m_done_cv.wait(lock);
+        }
+        return item;
+    }
+
+    /** Drop all submitted items, waiting for those being decoded to finish */
+    void Clear()
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_queue.clear();
+        for (const auto& item : m_items) {
+            while (item->started && !item->done) {
+                m_done_cv.wait(lock);
+            }
+        }
+        m_items.clear();
+    }
+};
+} // namespace
+
 void LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, FlatFilePos* dbp)
 {
     // Map of disk positions for blocks with unknown parent (only used for reindex)
@@ -7020,22 +7399,147 @@ void LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, FlatFi
     fBalancesIndex = gArgs.GetBoolArg("-balancesindex", DEFAULT_BALANCESINDEX);
 
     int nLoaded = 0;
+    uint64_t nBytesRead = 0;
     try {
+        PrefetchFile(fileIn);
         // This takes over fileIn and calls fclose() on it in the CBufferedFile destructor
-        CBufferedFile blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
+        // The reader runs up to MAX_BLOCK_SERIALIZED_SIZE ahead of the oldest block being
+        // decoded, and must be able to rewind back to it if that block turns out shorter.
+        CBufferedFile blkdat(fileIn, 4*MAX_BLOCK_SERIALIZED_SIZE, 2*MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
+        int num_threads = std::max(0, std::min((int)gArgs.GetArg("-loadblockthreads", DEFAULT_LOADBLOCK_THREADS), MAX_LOADBLOCK_THREADS));
+        BlockFileDecoder decoder(num_threads);
         uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
+        bool fReadDone = false;
+        while (true) {
             if (ShutdownRequested()) return;
 
+            // Hand decoded blocks to validation in file order
+            bool fAbort = false;
+            while (decoder.Pending() > 0 &&
+                   (fReadDone || decoder.Pending() >= decoder.MaxPending() ||
+                    blkdat.GetPos() - decoder.OldestPos() >= MAX_BLOCK_SERIALIZED_SIZE)) {
+                std::shared_ptr<BlockFileItem> item = decoder.Next();
+                if (!item->error.empty()) {
+                    LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, item->error);
+                    // Read ahead assumed the block was valid, scan again from the byte after its header
+                    decoder.Clear();
+                    nRewind = item->header_pos + 1;
+                    blkdat.SetPos(nRewind);
+                    fReadDone = false;
+                    break;
+                }
+                bool fRescan = item->consumed != item->data.size();
+                if (fRescan) {
+                    // Block ended before the size in its header, scan again from where it ended
+                    decoder.Clear();
+                    nRewind = item->block_pos + item->consumed;
+                    blkdat.SetPos(nRewind);
+                    fReadDone = false;
+                }
+                nBytesRead += item->consumed;
+
+                try {
+                    if (dbp)
+                        dbp->nPos = item->block_pos;
+                    std::shared_ptr<CBlock> pblock = item->block;
+                    CBlock& block = *pblock;
+                    const uint256& hash = item->hash;
+                    {
+                        LOCK(cs_main);
+                        // detect out of order blocks, and store them for later
+                        if (hash != chainparams.GetConsensus().hashGenesisBlock && !LookupBlockIndex(block.hashPrevBlock)) {
+                            LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
+                                    block.hashPrevBlock.ToString());
+                            if (dbp)
+                                mapBlocksUnknownParent.insert(std::make_pair(block.hashPrevBlock, *dbp));
+                            if (fRescan) break;
+                            continue;
+                        }
+
+                        // process in case the block isn't known yet
+                        CBlockIndex* pindex = LookupBlockIndex(hash);
+                        if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
+                          BlockValidationState state;
+                          if (::ChainstateActive().AcceptBlock(pblock, state, chainparams, nullptr, true, dbp, nullptr)) {
+                              nLoaded++;
+                          }
+                          if (state.IsError()) {
+                              fAbort = true;
+                              break;
+                          }
+                        } else if (hash != chainparams.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
+                          LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
+                        }
+                    }
+
+                    // Activate the genesis block so normal node progress can continue
+                    if (hash == chainparams.GetConsensus().hashGenesisBlock) {
+                        BlockValidationState state;
+                        if (!ActivateBestChain(state, chainparams, nullptr)) {
+                            fAbort = true;
+                            break;
+                        }
+                    }
+
+                    NotifyHeaderTip();
+
+                    // Recursively process earlier encountered successors of this block
+                    std::deque<uint256> queue;
+                    queue.push_back(hash);
+                    while (!queue.empty()) {
+                        uint256 head = queue.front();
+                        queue.pop_front();
+                        std::pair<std::multimap<uint256, FlatFilePos>::iterator, std::multimap<uint256, FlatFilePos>::iterator> range = mapBlocksUnknownParent.equal_range(head);
+                        while (range.first != range.second) {
+                            std::multimap<uint256, FlatFilePos>::iterator it = range.first;
+                            std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
+                            if (ReadBlockFromDisk(*pblockrecursive, it->second, chainparams.GetConsensus()))
+                            {
+                                LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
+                                        head.ToString());
+                                LOCK(cs_main);
+                                BlockValidationState dummy;
+                                if (::ChainstateActive().AcceptBlock(pblockrecursive, dummy, chainparams, nullptr, true, &it->second, nullptr))
+                                {
+                                    nLoaded++;
+                                    queue.push_back(pblockrecursive->GetHash());
+                                }
+                            }
+                            range.first++;
+                            mapBlocksUnknownParent.erase(it);
+                            NotifyHeaderTip();
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, e.what());
+                }
+                if (fRescan) break;
+            }
+            if (fAbort) break;
+            if (fReadDone) {
+                if (decoder.Pending() == 0) break;
+                continue;
+            }
+            if (decoder.Pending() >= decoder.MaxPending() ||
+                (decoder.Pending() > 0 && blkdat.GetPos() - decoder.OldestPos() >= MAX_BLOCK_SERIALIZED_SIZE)) {
+                continue;
+            }
+            if (blkdat.eof()) {
+                fReadDone = true;
+                continue;
+            }
+
             blkdat.SetPos(nRewind);
             nRewind++; // start one byte further next time, in case of failure
             blkdat.SetLimit(); // remove former limit
             unsigned int nSize = 0;
+            uint64_t nHeaderPos = 0;
             try {
                 // locate a header
                 unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
                 blkdat.FindByte(chainparams.MessageStart()[0]);
-                nRewind = blkdat.GetPos()+1;
+                nHeaderPos = blkdat.GetPos();
+                nRewind = nHeaderPos+1;
                 blkdat >> buf;
                 if (memcmp(buf, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE))
                     continue;
@@ -7045,83 +7549,19 @@ void LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, FlatFi
                     continue;
             } catch (const std::exception&) {
                 // no valid block header found; don't complain
-                break;
+                fReadDone = true;
+                continue;
             }
             try {
-                // read block
-                uint64_t nBlockPos = blkdat.GetPos();
-                if (dbp)
-                    dbp->nPos = nBlockPos;
-                blkdat.SetLimit(nBlockPos + nSize);
-                std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-                CBlock& block = *pblock;
-                blkdat >> block;
+                // read block, it is deserialized by the decoder
+                std::shared_ptr<BlockFileItem> item = std::make_shared<BlockFileItem>();
+                item->header_pos = nHeaderPos;
+                item->block_pos = blkdat.GetPos();
+                blkdat.SetLimit(item->block_pos + nSize);
+                item->data.resize(nSize);
+                blkdat.read((char*)item->data.data(), nSize);
                 nRewind = blkdat.GetPos();
-
-                uint256 hash = block.GetHash();
-                {
-                    LOCK(cs_main);
-                    // detect out of order blocks, and store them for later
-                    if (hash != chainparams.GetConsensus().hashGenesisBlock && !LookupBlockIndex(block.hashPrevBlock)) {
-                        LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                                block.hashPrevBlock.ToString());
-                        if (dbp)
-                            mapBlocksUnknownParent.insert(std::make_pair(block.hashPrevBlock, *dbp));
-                        continue;
-                    }
-
-                    // process in case the block isn't known yet
-                    CBlockIndex* pindex = LookupBlockIndex(hash);
-                    if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
-                      BlockValidationState state;
-                      if (::ChainstateActive().AcceptBlock(pblock, state, chainparams, nullptr, true, dbp, nullptr)) {
-                          nLoaded++;
-                      }
-                      if (state.IsError()) {
-                          break;
-                      }
-                    } else if (hash != chainparams.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
-                      LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
-                    }
-                }
-
-                // Activate the genesis block so normal node progress can continue
-                if (hash == chainparams.GetConsensus().hashGenesisBlock) {
-                    BlockValidationState state;
-                    if (!ActivateBestChain(state, chainparams, nullptr)) {
-                        break;
-                    }
-                }
-
-                NotifyHeaderTip();
-
-                // Recursively process earlier encountered successors of this block
-                std::deque<uint256> queue;
-                queue.push_back(hash);
-                while (!queue.empty()) {
-                    uint256 head = queue.front();
-                    queue.pop_front();
-                    std::pair<std::multimap<uint256, FlatFilePos>::iterator, std::multimap<uint256, FlatFilePos>::iterator> range = mapBlocksUnknownParent.equal_range(head);
-                    while (range.first != range.second) {
-                        std::multimap<uint256, FlatFilePos>::iterator it = range.first;
-                        std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
-                        if (ReadBlockFromDisk(*pblockrecursive, it->second, chainparams.GetConsensus()))
-                        {
-                            LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
-                                    head.ToString());
-                            LOCK(cs_main);
-                            BlockValidationState dummy;
-                            if (::ChainstateActive().AcceptBlock(pblockrecursive, dummy, chainparams, nullptr, true, &it->second, nullptr))
-                            {
-                                nLoaded++;
-                                queue.push_back(pblockrecursive->GetHash());
-                            }
-                        }
-                        range.first++;
-                        mapBlocksUnknownParent.erase(it);
-                        NotifyHeaderTip();
-                    }
-                }
+                decoder.Submit(std::move(item));
             } catch (const std::exception& e) {
                 LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, e.what());
             }
@@ -7129,7 +7569,8 @@ void LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, FlatFi
     } catch (const std::runtime_error& e) {
         AbortNode(std::string("System error: ") + e.what());
     }
-    LogPrintf("Loaded %i blocks from external file in %dms\n", nLoaded, GetTimeMillis() - nStart);
+    int64_t nElapsed = std::max(GetTimeMillis() - nStart, (int64_t)1);
+    LogPrintf("Loaded %i blocks from external file in %dms (%.2f MiB/s)\n", nLoaded, nElapsed, (nBytesRead / 1048576.0) / (nElapsed / 1000.0));
 }
 
 void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
@@ -7334,6 +7775,7 @@ bool CChainState::ResizeCoinsCaches(size_t coinstip_size, size_t coinsdb_size)
     size_t old_coinstip_size = m_coinstip_cache_size_bytes;
     m_coinstip_cache_size_bytes = coinstip_size;
     m_coinsdb_cache_size_bytes = coinsdb_size;
+    ClearChainstateReadView();
     CoinsDB().ResizeCache(coinsdb_size);
 
     LogPrintf("[%s] resized coinsdb cache to %.1f MiB\n",
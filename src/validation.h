@@ -73,6 +73,10 @@ static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 static const int MAX_SCRIPTCHECK_THREADS = 15;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Maximum number of threads deserializing blocks during -reindex and -loadblock */
+static const int MAX_LOADBLOCK_THREADS = 8;
+/** -loadblockthreads default */
+static const int DEFAULT_LOADBLOCK_THREADS = 2;
 static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = false;
@@ -381,6 +385,7 @@ bool ReadTransactionFromDiskBlock(const CBlockIndex *pindex, int nIndex, CTransa
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start);
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start);
 
+bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& hash_prev_block);
 bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
 
 /** Functions for validating blocks and updating the block tree */
@@ -1056,6 +1061,33 @@ ChainstateManager& ChainstateManagerActive();
 /** Global variable that points to the active block tree (protected by cs_main) */
 extern std::unique_ptr<CBlockTreeDB> pblocktree;
 
+/**
+ * Immutable description of the active chain tip together with database
+ * snapshots taken when it was connected. Read-only RPC and REST handlers use
+ * it to serve requests without taking cs_main while blocks are connected.
+ *
+ * The block tree snapshot holds the index entries written when the view was
+ * published. Data still held in write-back caches, such as the GVR tracker
+ * cache which is only written with the chainstate flush, may lag the tip.
+ * The coins snapshot only advances when the coins cache is flushed, check
+ * coins_best_block before treating it as the state at the tip.
+ */
+struct ChainstateReadView
+{
+    uint256 tip_hash;
+    int tip_height{-1};
+    int64_t tip_time{0};
+    int64_t tip_median_time_past{0};
+    std::shared_ptr<const CBlockTreeSnapshot> block_tree;
+    std::shared_ptr<const CCoinsViewDBSnapshot> coins;
+    uint256 coins_best_block;
+};
+
+/** Return the most recently published read view, or nullptr if there is none. */
+std::shared_ptr<const ChainstateReadView> GetChainstateReadView();
+/** Drop the published read view, must be called before the databases it refers to are closed. */
+void ClearChainstateReadView();
+
 /**
  * Return the spend height, which is one more than the inputs.GetBestBlock().
  * While checking, GetBestBlock() refers to the parent block. (protected by cs_main)
@@ -1123,6 +1155,10 @@ bool FlushView(CCoinsViewCache *view, BlockValidationState& state, bool fDisconn
 void UpdateTip(CTxMemPool& mempool, const CBlockIndex *pindexNew, const CChainParams& chainParams);
 
 ColdRewardTracker& initColdReward();
+/** Read-only tracker over the GVR data in a block tree snapshot, setters are not available. */
+ColdRewardTracker ColdRewardTrackerFromSnapshot(std::shared_ptr<const CBlockTreeSnapshot> snapshot);
 void clearTrackedData();
+/** Write the cached GVR tracker data to the block tree db in one batch. */
+bool FlushRewardTracker(bool fSync) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 #endif // BITCOIN_VALIDATION_H
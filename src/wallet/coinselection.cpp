@@ -170,6 +170,101 @@ bool SelectCoinsBnB(std::vector<OutputGroup>& utxo_pool, const CAmount& target_v
     return true;
 }
 
+bool SelectCoinsBnBRing(const std::vector<CAmount>& values, const CAmount& target_value, const RingCoinSelectionParams& params, std::vector<size_t>& out_indices, CAmount& value_ret)
+{
+    out_indices.clear();
+    value_ret = 0;
+    assert(params.inputs_per_sig > 0);
+    CAmount actual_target = params.not_input_fees + target_value;
+
+    // Coins that don't cover their own input fee are never worth selecting
+    std::vector<size_t> pool;
+    CAmount curr_available_value = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] > params.input_fee) {
+            pool.push_back(i);
+            curr_available_value += values[i] - params.input_fee;
+        }
+    }
+    if (curr_available_value < actual_target) {
+        return false;
+    }
+
+    // Largest first exploration
+    std::sort(pool.begin(), pool.end(), [&values](size_t a, size_t b) {
+        return values[a] > values[b];
+    });
+
+    CAmount curr_value = 0;
+    size_t curr_inputs = 0;
+    std::vector<bool> curr_selection;
+    curr_selection.reserve(pool.size());
+    std::vector<bool> best_selection;
+    CAmount best_waste = MAX_MONEY;
+    size_t best_inputs = 0;
+
+    for (size_t i = 0; i < TOTAL_TRIES; ++i) {
+        // curr_available_value ignores signature fees, so it stays an upper bound of what the remaining coins can add
+        CAmount curr_fees = params.GetInputFees(curr_inputs);
+        CAmount curr_net = curr_value - curr_fees;
+        bool backtrack = false;
+        if (curr_net + curr_available_value < actual_target || // Cannot reach the target with the remaining coins
+            curr_net > actual_target + params.cost_of_change || // Selected value is out of range
+            curr_fees > best_waste) {                            // Already more wasteful than the best selection
+            backtrack = true;
+        } else if (curr_net >= actual_target) { // Selected value is within range
+            CAmount curr_waste = curr_net - actual_target + curr_fees;
+            if (curr_waste < best_waste || (curr_waste == best_waste && curr_inputs < best_inputs)) {
+                best_selection = curr_selection;
+                best_selection.resize(pool.size());
+                best_waste = curr_waste;
+                best_inputs = curr_inputs;
+            }
+            backtrack = true;
+        }
+
+        if (backtrack) {
+            while (!curr_selection.empty() && !curr_selection.back()) {
+                curr_selection.pop_back();
+                curr_available_value += values[pool[curr_selection.size()]] - params.input_fee;
+            }
+            if (curr_selection.empty()) { // All branches searched
+                break;
+            }
+            // Output was included on previous iterations, try excluding now.
+            curr_selection.back() = false;
+            curr_value -= values[pool[curr_selection.size() - 1]];
+            curr_inputs--;
+        } else {
+            CAmount value = values[pool[curr_selection.size()]];
+            curr_available_value -= value - params.input_fee;
+
+            // Skip the inclusion branch of a coin with the same value as an excluded predecessor
+            if (!curr_selection.empty() && !curr_selection.back() &&
+                value == values[pool[curr_selection.size() - 1]]) {
+                curr_selection.push_back(false);
+            } else {
+                curr_selection.push_back(true);
+                curr_value += value;
+                curr_inputs++;
+            }
+        }
+    }
+
+    if (best_selection.empty()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < best_selection.size(); ++i) {
+        if (best_selection[i]) {
+            out_indices.push_back(pool[i]);
+            value_ret += values[pool[i]];
+        }
+    }
+
+    return true;
+}
+
 static void ApproximateBestSubset(const std::vector<OutputGroup>& groups, const CAmount& nTotalLower, const CAmount& nTargetValue,
                                   std::vector<char>& vfBest, CAmount& nBest, int iterations = 1000)
 {
@@ -117,6 +117,37 @@ struct OutputGroup
 
 bool SelectCoinsBnB(std::vector<OutputGroup>& utxo_pool, const CAmount& target_value, const CAmount& cost_of_change, std::set<CInputCoin>& out_set, CAmount& value_ret, CAmount not_input_fees);
 
+/** Parameters for selecting blinded or anon coins, where every input is spent through a signature */
+struct RingCoinSelectionParams
+{
+    //! Fee for each input, for anon inputs this covers the key image and ring members
+    CAmount input_fee{0};
+    //! Fee for each signature, anon inputs are signed in groups of inputs_per_sig
+    CAmount sig_fee{0};
+    size_t inputs_per_sig{1};
+    //! Fee for the parts of the transaction that aren't inputs
+    CAmount not_input_fees{0};
+    //! Excess that may be dropped into the fee instead of going to a change output
+    CAmount cost_of_change{0};
+
+    CAmount GetInputFees(size_t num_inputs) const
+    {
+        return num_inputs * input_fee + ((num_inputs + inputs_per_sig - 1) / inputs_per_sig) * sig_fee;
+    }
+};
+
+/**
+ * Branch and bound search over blinded or anon coin values, see SelectCoinsBnB.
+ * Input fees are charged per signature as well as per input. The waste of a
+ * selection is its excess plus the input fees it pays, ties go to the selection
+ * with fewer inputs.
+ *
+ * @param values The values of the coins to choose from.
+ * @param target_value The value to select, excluding all fees.
+ * @param out_indices Indices into values of the selected coins.
+ */
+bool SelectCoinsBnBRing(const std::vector<CAmount>& values, const CAmount& target_value, const RingCoinSelectionParams& params, std::vector<size_t>& out_indices, CAmount& value_ret);
+
 // Original coin selection algorithm as a fallback
 bool KnapsackSolver(const CAmount& nTargetValue, std::vector<OutputGroup>& groups, std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet);
 
@@ -37,6 +37,7 @@
 #include <wallet/fees.h>
 #include <node/ui_interface.h>
 #include <pos/diffalgo.h>
+#include <threadinterrupt.h>
 
 #if ENABLE_USBDEVICE
 #include <usbdevice/usbdevice.h>
@@ -145,8 +146,11 @@ int CHDWallet::FreeExtKeyMaps()
 {
     LogPrint(BCLog::HDWALLET, "%s %s\n", GetDisplayName(), __func__);
 
+    m_lookahead_index.clear();
+    m_lookahead_pending = false;
     for (auto it = mapExtAccounts.begin(); it != mapExtAccounts.end(); ++it) {
         if (it->second) {
+            it->second->nLookAhead = 0; // Index is cleared
             delete it->second;
         }
     }
@@ -172,6 +176,8 @@ void CHDWallet::AddOptions(ArgsManager& argsman)
     argsman.AddArg("-stealthv2lookaheadsize=<n>", strprintf("Number of V2 stealth keys to look ahead during a rescan. (default: %u)", DEFAULT_STEALTH_LOOKAHEAD_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
     argsman.AddArg("-extkeysaveancestors", strprintf("On saving a key from the lookahead pool, save all unsaved keys leading up to it too. (default: %s)", "true"), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
     argsman.AddArg("-createdefaultmasterkey", strprintf("Generate a random master key and main account if no master key exists. (default: %s)", "false"), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
+    argsman.AddArg("-blindsignthreads=<n>", strprintf("Number of threads creating MLSAG signatures and range proofs for a blinded or anon transaction (0 = number of cores, max: %d, default: %d)", MAX_BLIND_SIGN_THREADS, DEFAULT_BLIND_SIGN_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
+    argsman.AddArg("-checkbalances", "Compare the incrementally maintained wallet balances against a full scan of the wallet on every request. (default: false, regtest: true)", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::PART_WALLET);
 
     argsman.AddArg("-staking", "Stake your coins to support network and gain reward (default: true)", ArgsManager::ALLOW_ANY, OptionsCategory::PART_STAKING);
     argsman.AddArg("-stakingthreads", "Number of threads to start for staking, max 1 per active wallet, will divide wallets evenly between threads (default: 1)", ArgsManager::ALLOW_ANY, OptionsCategory::PART_STAKING);
@@ -301,6 +307,9 @@ bool CHDWallet::ProcessStakingSettings(std::string &sError)
         nWalletTreasuryFundCedePercent = 100;
     }
 
+    // Rebuild the stakeable coins, minstakeablevalue may have changed
+    m_stake_coins_valid = false;
+
     return true;
 };
 
@@ -313,6 +322,11 @@ bool CHDWallet::ProcessWalletSettings(std::string &sError)
     m_min_collapse_depth = 3;
     m_mixin_selection_mode_default = MIXIN_SEL_RECENT;
     m_min_owned_value = 0;
+    m_lazy_load_records = false;
+    m_lazy_load_min_depth = 100;
+    m_stake_archive_enabled = false;
+    m_stake_archive_min_depth = 1000;
+    ConsolidationSettings consolidation;
 
     UniValue json;
     if (GetSetting("unloadspent", json)) {
@@ -330,6 +344,127 @@ bool CHDWallet::ProcessWalletSettings(std::string &sError)
         }
     }
 
+    if (GetSetting("lazyload", json)) {
+        if (!json["records"].isNull()) {
+            try { m_lazy_load_records = json["records"].get_bool();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"records\" not boolean.");
+            }
+        }
+        if (!json["mindepth"].isNull()) {
+            try { m_lazy_load_min_depth = json["mindepth"].get_int();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"mindepth\" not integer.");
+            }
+        }
+    }
+
+    if (GetSetting("stakearchive", json)) {
+        if (!json["enabled"].isNull()) {
+            try { m_stake_archive_enabled = json["enabled"].get_bool();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"enabled\" not boolean.");
+            }
+        }
+        if (!json["mindepth"].isNull()) {
+            try { m_stake_archive_min_depth = json["mindepth"].get_int();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"mindepth\" not integer.");
+            }
+            // Archived coinstakes and their spent inputs must not be undone by a reorg
+            if (m_stake_archive_min_depth < (int)Params().GetStakeMinConfirmations()) {
+                AppendError(sError, "\"mindepth\" below the stake maturity depth.");
+                m_stake_archive_min_depth = Params().GetStakeMinConfirmations();
+            }
+        }
+    }
+
+    if (GetSetting("consolidation", json)) {
+        if (!json["enabled"].isNull()) {
+            try { consolidation.enabled = json["enabled"].get_bool();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"enabled\" not boolean.");
+            }
+        }
+        if (!json["types"].isNull()) {
+            try {
+                const UniValue &types = json["types"].get_array();
+                for (size_t k = 0; k < 3; ++k) {
+                    consolidation.types[k] = false;
+                }
+                for (size_t i = 0; i < types.size(); ++i) {
+                    const std::string &type = types[i].get_str();
+                    size_t k = 0;
+                    for (; k < 3; ++k) {
+                        if (type == CONSOLIDATION_TYPES[k]) {
+                            consolidation.types[k] = true;
+                            break;
+                        }
+                    }
+                    if (k == 3) {
+                        AppendError(sError, "Unknown \"types\" entry.");
+                    }
+                }
+            } catch (std::exception &e) {
+                AppendError(sError, "\"types\" not an array of strings.");
+            }
+        }
+        if (!json["threshold"].isNull()) {
+            try { consolidation.threshold = AmountFromValue(json["threshold"]);
+            } catch (std::exception &e) {
+                AppendError(sError, "\"threshold\" not an amount.");
+            }
+        }
+        if (!json["mininputs"].isNull()) {
+            try { consolidation.min_inputs = json["mininputs"].get_int();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"mininputs\" not integer.");
+            }
+        }
+        if (!json["maxinputs"].isNull()) {
+            try { consolidation.max_inputs = json["maxinputs"].get_int();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"maxinputs\" not integer.");
+            }
+        }
+        if (!json["maxfeerate"].isNull()) {
+            try { consolidation.max_fee_rate = CFeeRate(AmountFromValue(json["maxfeerate"]));
+            } catch (std::exception &e) {
+                AppendError(sError, "\"maxfeerate\" not an amount.");
+            }
+        }
+        if (!json["interval"].isNull()) {
+            try { consolidation.interval = json["interval"].get_int64();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"interval\" not integer.");
+            }
+        }
+        if (!json["ringsize"].isNull()) {
+            try { consolidation.ring_size = json["ringsize"].get_int();
+            } catch (std::exception &e) {
+                AppendError(sError, "\"ringsize\" not integer.");
+            }
+        }
+        if (consolidation.min_inputs < 2 || consolidation.max_inputs < consolidation.min_inputs) {
+            AppendError(sError, "\"mininputs\" must be >= 2 and <= \"maxinputs\".");
+            consolidation.min_inputs = DEFAULT_CONSOLIDATE_MIN_INPUTS;
+            consolidation.max_inputs = DEFAULT_CONSOLIDATE_MAX_INPUTS;
+        }
+        if (consolidation.ring_size < MIN_RINGSIZE || consolidation.ring_size > MAX_RINGSIZE) {
+            AppendError(sError, "\"ringsize\" out of range.");
+            consolidation.ring_size = DEFAULT_RING_SIZE;
+        }
+        if (consolidation.interval < 60) {
+            AppendError(sError, "\"interval\" must be >= 60.");
+            consolidation.interval = 60;
+        }
+    }
+    {
+        LOCK(cs_wallet);
+        m_consolidation = consolidation;
+        m_consolidation_stats.next_check = 0;
+    }
+
     if (GetSetting("anonoptions", json)) {
         if (!json["mixinselection"].isNull()) {
             try { m_mixin_selection_mode_default = json["mixinselection"].get_int();
@@ -759,12 +894,33 @@ bool CHDWallet::GetVote(int nHeight, uint32_t &token)
     return false;
 };
 
+static void GetRecordFilterIndexData(const CTransactionRecord &rtx, uint32_t &sets, std::vector<CScript> &scripts)
+{
+    sets = 1 << CTxFilterIndex::TFI_RTX;
+    if (rtx.nFlags & ORF_BLIND_IN) {
+        sets |= 1 << CTxFilterIndex::TFI_RTX_BLIND;
+    }
+    if (rtx.nFlags & ORF_ANON_IN) {
+        sets |= 1 << CTxFilterIndex::TFI_RTX_ANON;
+    }
+    for (const auto &r : rtx.vout) {
+        switch (r.nType) {
+            case OUTPUT_STANDARD: sets |= 1 << CTxFilterIndex::TFI_RTX_STANDARD; break;
+            case OUTPUT_CT: sets |= 1 << CTxFilterIndex::TFI_RTX_BLIND; break;
+            case OUTPUT_RINGCT: sets |= 1 << CTxFilterIndex::TFI_RTX_ANON; break;
+            default: break;
+        }
+        scripts.push_back(r.scriptPubKey);
+    }
+}
+
 bool CHDWallet::LoadTxRecords(CHDWalletDB *pwdb)
 {
     LogPrint(BCLog::HDWALLET, "Loading transaction records for %s.\n", GetName());
 
     assert(pwdb);
     LOCK(cs_wallet);
+    int64_t nTimeStart = GetTimeMillis();
 
     Dbc *pcursor;
     if (!(pcursor = pwdb->GetCursor())) {
@@ -794,6 +950,59 @@ bool CHDWallet::LoadTxRecords(CHDWalletDB *pwdb)
 
     pcursor->close();
 
+    // Records archived in lazy load mode are read as stubs, only their spends
+    // and filtertransactions index entries are kept in memory.
+    std::vector<uint256> vStale, vRestore;
+    if (!(pcursor = pwdb->GetCursor())) {
+        throw std::runtime_error(strprintf("%s: cannot create DB cursor", __func__).c_str());
+    }
+    sPrefix = "rtxs";
+    ssKey.clear();
+    ssKey << sPrefix;
+    fFlags = DB_SET_RANGE;
+    while (pwdb->ReadAtCursor(pcursor, ssKey, ssValue, fFlags) == 0) {
+        fFlags = DB_NEXT;
+        ssKey >> strType;
+        if (strType != sPrefix) {
+            break;
+        }
+
+        ssKey >> txhash;
+        if (mapRecords.count(txhash)) {
+            vStale.push_back(txhash); // Record was rewritten after being archived
+            continue;
+        }
+        if (!m_lazy_load_records) {
+            vRestore.push_back(txhash);
+            continue;
+        }
+        CTransactionRecordStub stub;
+        ssValue >> stub;
+        m_archived_records.insert(txhash);
+        m_collapsed_txn_inputs.insert(stub.vin.begin(), stub.vin.end());
+        for (const auto &v : stub.vOutputValues) {
+            m_collapsed_output_values[COutPoint(txhash, v.first)] = v.second;
+        }
+        m_tx_filter_index.Insert(txhash, stub.nTime, stub.nFilterSets, stub.vScripts);
+    }
+
+    pcursor->close();
+
+    for (const auto &hash : vStale) {
+        pwdb->EraseArchivedTxRecord(hash);
+    }
+    for (const auto &hash : vRestore) {
+        CTransactionRecord data;
+        if (!pwdb->ReadArchivedTxRecord(hash, data) ||
+            !pwdb->WriteTxRecord(hash, data) ||
+            !pwdb->EraseArchivedTxRecord(hash)) {
+            WalletLogPrintf("Error: %s - Failed to restore archived record %s.\n", __func__, hash.ToString());
+            continue;
+        }
+        LoadToWallet(hash, data);
+    }
+    m_load_stats.records_restored = vRestore.size();
+
     int32_t flag;
     if (!pwdb->ReadFlag("anon_vin_v2", flag)) {
         WalletLogPrintf("Upgrading TransactionRecord format.\n");
@@ -848,7 +1057,418 @@ bool CHDWallet::LoadTxRecords(CHDWalletDB *pwdb)
         }
     }
 
-    WalletLogPrintf("mapRecords.size() = %u\n", mapRecords.size());
+    m_load_stats.records_loaded = mapRecords.size();
+    m_load_stats.records_time_ms = GetTimeMillis() - nTimeStart;
+
+    WalletLogPrintf("mapRecords.size() = %u, archived %u\n", mapRecords.size(), m_archived_records.size());
+
+    return true;
+};
+
+void CHDWallet::ArchiveSpentTxns()
+{
+    // Depths are only known once the wallet has caught up with the chain
+    LOCK(cs_wallet);
+    CHDWalletDB wdb(GetDBHandle());
+    if (m_lazy_load_records) {
+        m_load_stats.records_archived = ArchiveSpentRecords(&wdb);
+        m_load_stats.records_loaded = mapRecords.size();
+        WalletLogPrintf("Archived %u spent records.\n", m_load_stats.records_archived);
+    }
+    if (m_stake_archive_enabled) {
+        m_load_stats.stakes_archived = ArchiveSpentStakes(&wdb);
+        WalletLogPrintf("Archived %u spent coinstakes.\n", m_load_stats.stakes_archived);
+    }
+};
+
+bool CHDWallet::IsSpentDeep(const COutPoint &op, int min_depth) const
+{
+    AssertLockHeld(cs_wallet);
+    if (m_collapsed_txn_inputs.count(op)) {
+        return true;
+    }
+    // The spend must be deep enough that it can't be reorged out either
+    std::pair<TxSpends::const_iterator, TxSpends::const_iterator> range = mapTxSpends.equal_range(op);
+    for (auto it = range.first; it != range.second; ++it) {
+        MapWallet_t::const_iterator mwi;
+        MapRecords_t::const_iterator mri;
+        if ((mwi = mapWallet.find(it->second)) != mapWallet.end()) {
+            if (mwi->second.GetDepthInMainChain() >= min_depth) {
+                return true;
+            }
+        } else
+        if ((mri = mapRecords.find(it->second)) != mapRecords.end()) {
+            if (GetDepthInMainChain(mri->second) >= min_depth) {
+                return true;
+            }
+        }
+    }
+    return false;
+};
+
+bool CHDWallet::CanArchiveRecord(const uint256 &hash, const CTransactionRecord &rtx) const
+{
+    AssertLockHeld(cs_wallet);
+    if (rtx.IsAbandoned() || GetDepthInMainChain(rtx) < m_lazy_load_min_depth) {
+        return false;
+    }
+    for (const auto &r : rtx.vout) {
+        if (r.nFlags & ORF_LOCKED) {
+            return false; // Needs processing when the wallet is unlocked
+        }
+        if (!(r.nFlags & ORF_OWN_ANY) || r.n == OR_PLACEHOLDER_N) {
+            continue;
+        }
+        if (!IsSpentDeep(COutPoint(hash, r.n), m_lazy_load_min_depth)) {
+            return false;
+        }
+    }
+    return true;
+};
+
+size_t CHDWallet::ArchiveSpentRecords(CHDWalletDB *pwdb)
+{
+    AssertLockHeld(cs_wallet);
+    if (!m_chain) {
+        return 0;
+    }
+
+    std::vector<uint256> vArchive;
+    for (const auto &ri : mapRecords) {
+        if (CanArchiveRecord(ri.first, ri.second)) {
+            vArchive.push_back(ri.first);
+        }
+    }
+    if (vArchive.empty()) {
+        return 0;
+    }
+
+    if (!pwdb->TxnBegin()) {
+        WalletLogPrintf("%s: TxnBegin failed.\n", __func__);
+        return 0;
+    }
+    for (const auto &hash : vArchive) {
+        const CTransactionRecord &rtx = mapRecords.at(hash);
+        CTransactionRecordStub stub;
+        stub.nTime = rtx.GetTxTime();
+        stub.vin = rtx.vin;
+        GetRecordFilterIndexData(rtx, stub.nFilterSets, stub.vScripts);
+        for (const auto &r : rtx.vout) {
+            if ((r.nFlags & ORF_OWN_ANY) && r.n != OR_PLACEHOLDER_N) {
+                stub.vOutputValues.emplace_back(r.n, r.nValue);
+            }
+        }
+        if (!pwdb->WriteArchivedTxRecord(hash, rtx, stub) ||
+            !pwdb->EraseTxRecord(hash)) {
+            WalletLogPrintf("%s: Failed to archive record %s.\n", __func__, hash.ToString());
+            pwdb->TxnAbort();
+            return 0;
+        }
+    }
+    if (!pwdb->TxnCommit()) {
+        WalletLogPrintf("%s: TxnCommit failed.\n", __func__);
+        return 0;
+    }
+
+    for (const auto &hash : vArchive) {
+        MapRecords_t::iterator mri = mapRecords.find(hash);
+        const CTransactionRecord &rtx = mri->second;
+
+        // Outputs spent by archived records are tracked as for unloaded spent txns
+        for (const auto &r : rtx.vout) {
+            if ((r.nFlags & ORF_OWN_ANY) && r.n != OR_PLACEHOLDER_N) {
+                m_collapsed_output_values[COutPoint(hash, r.n)] = r.nValue;
+            }
+        }
+        for (const auto &prevout : rtx.vin) {
+            m_collapsed_txn_inputs.insert(prevout);
+            std::pair<TxSpends::iterator, TxSpends::iterator> range = mapTxSpends.equal_range(prevout);
+            for (auto it = range.first; it != range.second; ) {
+                if (it->second == hash) {
+                    mapTxSpends.erase(it++);
+                    continue;
+                }
+                ++it;
+            }
+        }
+        for (auto it = rtxOrdered.begin(); it != rtxOrdered.end(); ++it) {
+            if (it->second == mri) {
+                rtxOrdered.erase(it);
+                break;
+            }
+        }
+        mapRecords.erase(mri);
+        m_archived_records.insert(hash);
+    }
+
+    return vArchive.size();
+};
+
+bool CHDWallet::LoadArchivedRecord(const uint256 &hash, bool with_inputs)
+{
+    AssertLockHeld(cs_wallet);
+    if (!m_archived_records.count(hash)) {
+        return mapRecords.count(hash);
+    }
+
+    CTransactionRecord rtx;
+    if (!CHDWalletDB(*database).ReadArchivedTxRecord(hash, rtx)) {
+        WalletLogPrintf("%s: ReadArchivedTxRecord failed for %s.\n", __func__, hash.ToString());
+        return false;
+    }
+    // The record stays archived in the wallet file until it's rewritten
+    m_archived_records.erase(hash);
+    LoadToWallet(hash, rtx);
+    MarkBalanceDirty(hash);
+
+    if (with_inputs) {
+        for (const auto &prevout : rtx.vin) {
+            LoadArchivedRecord(prevout.hash, false);
+        }
+    }
+    return true;
+};
+
+static std::string GetStakeArchiveMonth(int64_t nTime)
+{
+    return FormatISO8601Date(nTime).substr(0, 7);
+};
+
+bool CHDWallet::LoadStakeArchive(CHDWalletDB *pwdb)
+{
+    AssertLockHeld(cs_wallet);
+
+    // The outputs spent by archived coinstakes stay in the wallet file
+    Dbc *pcursor;
+    if (!(pcursor = pwdb->GetCursor())) {
+        throw std::runtime_error(strprintf("%s: cannot create DB cursor", __func__).c_str());
+    }
+
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+
+    std::string strType, sPrefix = "stka";
+    uint256 txhash;
+    std::vector<uint256> vStale;
+
+    unsigned int fFlags = DB_SET_RANGE;
+    ssKey << sPrefix;
+    while (pwdb->ReadAtCursor(pcursor, ssKey, ssValue, fFlags) == 0) {
+        fFlags = DB_NEXT;
+        ssKey >> strType;
+        if (strType != sPrefix) {
+            break;
+        }
+
+        ssKey >> txhash;
+        if (mapWallet.count(txhash)) {
+            vStale.push_back(txhash); // Txn was rewritten after being archived
+            continue;
+        }
+        CArchivedStakeStub stub;
+        ssValue >> stub;
+        m_archived_stakes.insert(txhash);
+        m_collapsed_txn_inputs.insert(stub.vin.begin(), stub.vin.end());
+        for (const auto &v : stub.vOutputValues) {
+            m_collapsed_output_values[COutPoint(txhash, v.first)] = v.second;
+        }
+    }
+
+    pcursor->close();
+
+    for (const auto &hash : vStale) {
+        pwdb->EraseArchivedStake(hash);
+    }
+
+    m_stake_archive_months.clear();
+    m_stake_archive = MakeUnique<CStakeArchive>(fs::path(database->Filename()).parent_path() / "stakearchive.dat");
+    std::set<uint256> setFound;
+    if (!m_stake_archive->Load([&](const CStakeArchiveEntry &entry) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+            if (!m_archived_stakes.count(entry.txid) || !setFound.insert(entry.txid).second) {
+                return; // Restored to the wallet file, or archived again after being restored
+            }
+            m_stake_archive_months[GetStakeArchiveMonth(entry.nTime)].Add(entry);
+            uint32_t sets = (1 << CTxFilterIndex::TFI_WTX) | (1 << CTxFilterIndex::TFI_STAKE);
+            m_tx_filter_index.Insert(entry.txid, entry.nTime, sets, entry.vScripts);
+        })) {
+        WalletLogPrintf("Error: %s - Failed to read %s.\n", __func__, m_stake_archive->GetPath().string());
+        m_stake_archive.reset(); // Don't append to a file that can't be read
+        return false;
+    }
+    if (setFound.size() < m_archived_stakes.size()) {
+        WalletLogPrintf("Warning: %u archived coinstakes are missing from %s.\n",
+            m_archived_stakes.size() - setFound.size(), m_stake_archive->GetPath().string());
+    }
+
+    return true;
+};
+
+bool CHDWallet::CanArchiveStake(const CWalletTx &wtx) const
+{
+    AssertLockHeld(cs_wallet);
+    if (!wtx.IsCoinStake() || wtx.isAbandoned() || wtx.GetDepthInMainChain() < m_stake_archive_min_depth) {
+        return false;
+    }
+    const uint256 &hash = wtx.GetHash();
+    for (size_t i = 0; i < wtx.tx->vpout.size(); ++i) {
+        if (!IsMine(wtx.tx->vpout[i].get())) {
+            continue;
+        }
+        if (!IsSpentDeep(COutPoint(hash, i), m_stake_archive_min_depth)) {
+            return false;
+        }
+    }
+    return true;
+};
+
+size_t CHDWallet::ArchiveSpentStakes(CHDWalletDB *pwdb)
+{
+    AssertLockHeld(cs_wallet);
+    if (!m_chain || !m_stake_archive) {
+        return 0;
+    }
+
+    std::vector<const CWalletTx*> vArchive;
+    for (const auto &item : mapWallet) {
+        if (CanArchiveStake(item.second)) {
+            vArchive.push_back(&item.second);
+        }
+    }
+    if (vArchive.empty()) {
+        return 0;
+    }
+
+    // Values of the spent outputs are kept for the reward totals, the inputs
+    // of a coinstake are often archived or collapsed txns themselves.
+    auto get_prevout_value = [&](const COutPoint &prevout) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+        MapWallet_t::const_iterator mwi;
+        MapRecords_t::const_iterator mri;
+        std::map<COutPoint, CAmount>::const_iterator mci;
+        if ((mwi = mapWallet.find(prevout.hash)) != mapWallet.end()) {
+            if (prevout.n < mwi->second.tx->vpout.size()) {
+                return mwi->second.tx->vpout[prevout.n]->GetValue();
+            }
+        } else
+        if ((mri = mapRecords.find(prevout.hash)) != mapRecords.end()) {
+            const COutputRecord *pout = mri->second.GetOutput(prevout.n);
+            if (pout) {
+                return pout->nValue;
+            }
+        } else
+        if ((mci = m_collapsed_output_values.find(prevout)) != m_collapsed_output_values.end()) {
+            return mci->second;
+        }
+        return CAmount(0);
+    };
+
+    std::vector<std::pair<CStakeArchiveEntry, std::vector<uint8_t> > > vEntries;
+    std::vector<CArchivedStakeStub> vStubs;
+    for (const auto *pwtx : vArchive) {
+        const CWalletTx &wtx = *pwtx;
+        CStakeArchiveEntry entry;
+        CArchivedStakeStub stub;
+        entry.txid = wtx.GetHash();
+        entry.nTime = wtx.GetTxTime();
+        entry.nHeight = wtx.m_confirm.block_height;
+        for (const auto &txin : wtx.tx->vin) {
+            entry.vin.push_back(txin.prevout);
+            entry.nValueIn += get_prevout_value(txin.prevout);
+        }
+        for (size_t i = 0; i < wtx.tx->vpout.size(); ++i) {
+            const auto &txout = wtx.tx->vpout[i];
+            const CScript *pscript = txout->GetPScriptPubKey();
+            if (pscript) {
+                entry.vScripts.push_back(*pscript);
+            }
+            if (IsMine(txout.get())) {
+                entry.nValueOut += txout->GetValue();
+                stub.vOutputValues.emplace_back(i, txout->GetValue());
+            }
+        }
+        stub.vin = entry.vin;
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << wtx;
+        vEntries.emplace_back(entry, std::vector<uint8_t>(ss.begin(), ss.end()));
+        vStubs.push_back(std::move(stub));
+    }
+
+    // Write the archive first, a txn in both is read from the wallet file
+    if (!m_stake_archive->Append(vEntries)) {
+        WalletLogPrintf("%s: Failed to write %s.\n", __func__, m_stake_archive->GetPath().string());
+        return 0;
+    }
+
+    if (!pwdb->TxnBegin()) {
+        WalletLogPrintf("%s: TxnBegin failed.\n", __func__);
+        return 0;
+    }
+    for (size_t i = 0; i < vEntries.size(); ++i) {
+        const auto &e = vEntries[i];
+        if (!pwdb->WriteArchivedStake(e.first.txid, vStubs[i]) ||
+            !pwdb->EraseTx(e.first.txid)) {
+            WalletLogPrintf("%s: Failed to archive coinstake %s.\n", __func__, e.first.txid.ToString());
+            pwdb->TxnAbort();
+            return 0;
+        }
+    }
+    if (!pwdb->TxnCommit()) {
+        WalletLogPrintf("%s: TxnCommit failed.\n", __func__);
+        return 0;
+    }
+
+    uint32_t sets = (1 << CTxFilterIndex::TFI_WTX) | (1 << CTxFilterIndex::TFI_STAKE);
+    for (size_t i = 0; i < vEntries.size(); ++i) {
+        const CStakeArchiveEntry &entry = vEntries[i].first;
+        // Outputs spent by archived coinstakes are tracked as for unloaded spent txns
+        m_collapsed_txn_inputs.insert(entry.vin.begin(), entry.vin.end());
+        for (const auto &v : vStubs[i].vOutputValues) {
+            m_collapsed_output_values[COutPoint(entry.txid, v.first)] = v.second;
+        }
+        UnloadTransaction(entry.txid);
+        m_archived_stakes.insert(entry.txid);
+        m_stake_archive_months[GetStakeArchiveMonth(entry.nTime)].Add(entry);
+        m_tx_filter_index.Insert(entry.txid, entry.nTime, sets, entry.vScripts);
+    }
+
+    return vEntries.size();
+};
+
+bool CHDWallet::LoadArchivedStake(const uint256 &hash, bool with_inputs)
+{
+    AssertLockHeld(cs_wallet);
+    if (!m_archived_stakes.count(hash) || mapWallet.count(hash)) {
+        return mapWallet.count(hash);
+    }
+
+    std::vector<uint8_t> data;
+    if (!m_stake_archive || !m_stake_archive->ReadTx(hash, data)) {
+        WalletLogPrintf("%s: Failed to read archived coinstake %s.\n", __func__, hash.ToString());
+        return false;
+    }
+    CDataStream ss(data, SER_DISK, CLIENT_VERSION);
+    bool fLoaded = false;
+    LoadToWallet(hash, [&](CWalletTx &wtx, bool new_tx) {
+        try {
+            ss >> wtx;
+        } catch (const std::exception &e) {
+            return false;
+        }
+        return (fLoaded = (wtx.GetHash() == hash));
+    });
+    if (!fLoaded) {
+        WalletLogPrintf("%s: Failed to load archived coinstake %s.\n", __func__, hash.ToString());
+        mapWallet.erase(hash);
+        return false;
+    }
+    // The coinstake stays archived until the wallet file is rewritten
+    m_archived_stakes.erase(hash);
+    MarkBalanceDirty(hash);
+
+    if (with_inputs) {
+        for (const auto &txin : mapWallet.at(hash).tx->vin) {
+            LoadArchivedStake(txin.prevout.hash, false);
+        }
+    }
 
     return true;
 };
@@ -1089,29 +1709,39 @@ isminetype CHDWallet::HaveKey(const CKeyID &address, const CEKAKey *&pak, const
 
     pak = nullptr;
     pasc = nullptr;
+    DerivePendingLookahead();
+
+    // One lookup covers the lookahead keys of all accounts
+    const CEKALookAheadKey *plak = m_lookahead_index.find(address);
+    if (plak) {
+        pa = plak->pa;
+        CEKAKey ak = plak->ak; // Must copy CEKAKey, ExtKeySaveKey modifies the index
+        isminetype ismine = pa->IsMine(ak.nParent);
+        if (LogAcceptCategory(BCLog::HDWALLET)) {
+            WalletLogPrintf("HaveKey in lookAhead %s\n", EncodeDestination(PKHash(address)));
+        }
+        if (0 != ExtKeySaveKey(pa, address, ak)) {
+            WalletLogPrintf("%s: ExtKeySaveKey failed.\n", __func__);
+            return ISMINE_NO;
+        }
+        // pak moved from the lookahead index to mapKeys
+        AccKeyMap::const_iterator mi = pa->mapKeys.find(address);
+        if (mi != pa->mapKeys.end()) {
+            pak = &mi->second;
+        } else {
+            WalletLogPrintf("%s: Key not moved.\n", __func__);
+        }
+        return ismine;
+    }
+
     int rv;
     for (auto it = mapExtAccounts.cbegin(); it != mapExtAccounts.cend(); ++it) {
         pa = it->second;
         isminetype ismine = ISMINE_NO;
-        rv = pa->HaveKey(address, true, pak, pasc, ismine);
+        rv = pa->HaveKey(address, true, pak, pasc, ismine, false);
         if (rv == HK_NO) {
             continue;
         }
-
-        if (rv == HK_LOOKAHEAD_DO_UPDATE) {
-            CEKAKey ak = *pak; // Must copy CEKAKey, ExtKeySaveKey modifies CExtKeyAccount
-            if (0 != ExtKeySaveKey(pa, address, ak)) {
-                WalletLogPrintf("%s: ExtKeySaveKey failed.\n", __func__);
-                return ISMINE_NO;
-            }
-            // pak moved from mapLookAhead to mapKeys
-            AccKeyMap::const_iterator mi = pa->mapKeys.find(address);
-            if (mi != pa->mapKeys.end()) {
-                pak = &mi->second;
-            } else {
-                WalletLogPrintf("%s: Key not moved.\n", __func__);
-            }
-        }
         return ismine;
     }
 
@@ -1516,6 +2146,7 @@ bool CHDWallet::AddressBookChangedNotify(const CTxDestination &address, ChangeTy
 
 DBErrors CHDWallet::LoadWallet(bool& fFirstRunRet)
 {
+    int64_t nTimeStart = GetTimeMillis();
     if (!ParseMoney(gArgs.GetArg("-reservebalance", "0"), nReserveBalance)) {
         InitError(_("Invalid amount for -reservebalance=<amount>"));
         return DBErrors::LOAD_FAIL;
@@ -1524,6 +2155,12 @@ DBErrors CHDWallet::LoadWallet(bool& fFirstRunRet)
     m_rescan_stealth_v1_lookahead = gArgs.GetArg("-stealthv1lookaheadsize", DEFAULT_STEALTH_LOOKAHEAD_SIZE);
     m_rescan_stealth_v2_lookahead = gArgs.GetArg("-stealthv2lookaheadsize", DEFAULT_STEALTH_LOOKAHEAD_SIZE);
     m_default_lookahead = gArgs.GetArg("-defaultlookaheadsize", DEFAULT_LOOKAHEAD_SIZE);
+    m_check_balance_ledger = gArgs.GetBoolArg("-checkbalances", Params().DefaultConsistencyChecks());
+    m_blind_sign_threads = gArgs.GetArg("-blindsignthreads", DEFAULT_BLIND_SIGN_THREADS);
+    if (m_blind_sign_threads <= 0) {
+        m_blind_sign_threads = GetNumCores();
+    }
+    m_blind_sign_threads = std::max(1, std::min(m_blind_sign_threads, MAX_BLIND_SIGN_THREADS));
 
     std::string sError;
     ProcessStakingSettings(sError);
@@ -1567,6 +2204,7 @@ DBErrors CHDWallet::LoadWallet(bool& fFirstRunRet)
 
         LoadAddressBook(&wdb);
         LoadTxRecords(&wdb);
+        LoadStakeArchive(&wdb);
         LoadVoteTokens(&wdb);
     }
 
@@ -1598,6 +2236,8 @@ DBErrors CHDWallet::LoadWallet(bool& fFirstRunRet)
 #endif
         LogPrintf("%s\n", sWarning);
     }
+    m_load_stats.load_time_ms = GetTimeMillis() - nTimeStart;
+    WalletLogPrintf("Loaded in %dms, transaction records in %dms.\n", m_load_stats.load_time_ms, m_load_stats.records_time_ms);
     return DBErrors::LOAD_OK;
 }
 
@@ -2705,159 +3345,309 @@ CWallet::Balance CHDWallet::GetBalance(const int min_depth, bool avoid_reuse) co
         }
     }
 
-    Balance ret = CWallet::GetBalance(min_depth, avoid_reuse);
-
-    ret.m_mine_trusted += bal_records.m_mine_trusted;
-    ret.m_watchonly_trusted += bal_records.m_watchonly_trusted;
-    ret.m_mine_untrusted_pending += bal_records.m_mine_untrusted_pending;
-    ret.m_watchonly_untrusted_pending += bal_records.m_watchonly_untrusted_pending;
-
-    return ret;
-}
+    Balance ret = CWallet::GetBalance(min_depth, avoid_reuse);
+
+    ret.m_mine_trusted += bal_records.m_mine_trusted;
+    ret.m_watchonly_trusted += bal_records.m_watchonly_trusted;
+    ret.m_mine_untrusted_pending += bal_records.m_mine_untrusted_pending;
+    ret.m_watchonly_untrusted_pending += bal_records.m_watchonly_untrusted_pending;
+
+    return ret;
+}
+
+void CHDWallet::AddWalletTxBalances(const CWalletTx &wtx, CHDWalletBalances &bal, isminefilter reuse_filter, bool &is_volatile) const
+{
+
+    bal.nPartImmature += wtx.GetImmatureCredit();
+    //bal.nPartWatchOnlyImmature += wtx.GetImmatureWatchOnlyCredit(*locked_chain);
+
+    int depth;
+    if (wtx.IsCoinStake() &&
+        (depth = wtx.GetDepthInMainChain()) > 0 && // checks for hashunset
+         wtx.GetBlocksToMaturity() > 0) {
+        CAmount nSpendable, nWatchOnly;
+        CHDWallet::GetCredit(*wtx.tx, nSpendable, nWatchOnly);
+        bal.nPartStaked += nSpendable;
+        bal.nPartWatchOnlyStaked += nWatchOnly;
+    }
+
+    if (wtx.IsTrusted()) {
+        bal.nPart += wtx.GetAvailableCredit(true, ISMINE_SPENDABLE | reuse_filter);
+        bal.nPartWatchOnly += wtx.GetAvailableCredit(true, ISMINE_WATCH_ONLY | reuse_filter);
+    } else if (wtx.GetDepthInMainChain() == 0 && wtx.InMempool()) {
+        bal.nPartUnconf += wtx.GetAvailableCredit(true, ISMINE_SPENDABLE | reuse_filter);
+        bal.nPartWatchOnlyUnconf += wtx.GetAvailableCredit(true, ISMINE_WATCH_ONLY | reuse_filter);
+    }
+
+    // Immature coinstakes and unconfirmed txns change with the chain tip and mempool
+    is_volatile = wtx.GetDepthInMainChain() < 1 || wtx.GetBlocksToMaturity() > 0;
+};
+
+void CHDWallet::AddRecordBalances(const uint256 &txhash, const CTransactionRecord &rtx, CHDWalletBalances &bal, bool allow_used_addresses, bool &is_volatile) const
+{
+    const Consensus::Params &consensusParams = Params().GetConsensus();
+
+    int depth;
+    bool fTrusted = IsTrusted(txhash, rtx, &depth);
+    bool fInMempool = false;
+    if (!fTrusted) {
+        CTransactionRef ptx = nullptr;
+        if (HaveChain()) {
+            ptx = chain().transactionFromMempool(txhash);
+        }
+        fInMempool = !ptx ? false : true;
+    }
+
+    for (const auto &r : rtx.vout) {
+        if (!(r.nFlags & ORF_OWN_ANY)
+            || IsSpent(txhash, r.n)) {
+            continue;
+        }
+        bool watch_only = r.nFlags & ORF_OWN_WATCH;
+        bool force_watch_only = false;
+#if !ENABLE_USBDEVICE
+        bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
+        if (fNeedHardwareKey) {
+            watch_only = true;
+            force_watch_only = true;
+        }
+#endif
+        switch (r.nType) {
+            case OUTPUT_RINGCT:
+                if (!(r.nFlags & ORF_OWNED || r.nFlags & ORF_OWN_WATCH)) {
+                    continue;
+                }
+                if (fTrusted) {
+                    if (depth >= consensusParams.nMinRCTOutputDepth) {
+                        if (watch_only) {
+                            bal.nAnonWatchOnly += r.nValue;
+                        } else {
+                            bal.nAnon += r.nValue;
+                        }
+                    } else {
+                        if (watch_only) {
+                            bal.nAnonWatchOnlyImmature += r.nValue;
+                        } else {
+                            bal.nAnonImmature += r.nValue;
+                        }
+                    }
+                } else
+                if (fInMempool) {
+                    if (watch_only) {
+                        bal.nAnonWatchOnlyUnconf += r.nValue;
+                    } else {
+                        bal.nAnonUnconf += r.nValue;
+                    }
+                }
+                break;
+            case OUTPUT_CT:
+                if (!(r.nFlags & ORF_OWNED || r.nFlags & ORF_OWN_WATCH)) {
+                    continue;
+                }
+                if (!allow_used_addresses && IsSpentKey(&r.scriptPubKey)) {
+                    continue;
+                }
+                if (fTrusted) {
+                    if (watch_only) {
+                        bal.nBlindWatchOnly += r.nValue;
+                    } else {
+                        bal.nBlind += r.nValue;
+                    }
+                } else
+                if (fInMempool) {
+                    if (watch_only) {
+                        bal.nBlindWatchOnlyUnconf += r.nValue;
+                    } else {
+                        bal.nBlindUnconf += r.nValue;
+                    }
+                }
+                break;
+            case OUTPUT_STANDARD:
+                if (!force_watch_only && (r.nFlags & ORF_OWNED)) {
+                    if (!allow_used_addresses && IsSpentKey(&r.scriptPubKey)) {
+                        continue;
+                    }
+                    if (fTrusted) {
+                        bal.nPart += r.nValue;
+                    } else
+                    if (fInMempool) {
+                        bal.nPartUnconf += r.nValue;
+                    }
+                } else
+                if (watch_only) {
+                    if (fTrusted) {
+                        bal.nPartWatchOnly += r.nValue;
+                    } else
+                    if (fInMempool) {
+                        bal.nPartWatchOnlyUnconf += r.nValue;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Anon outputs mature at nMinRCTOutputDepth
+    is_volatile = depth < std::max(1, consensusParams.nMinRCTOutputDepth);
+};
 
-bool CHDWallet::GetBalances(CHDWalletBalances &bal, bool avoid_reuse) const
+bool CHDWallet::GetBalancesFullScan(CHDWalletBalances &bal, bool avoid_reuse) const
 {
+    AssertLockHeld(cs_wallet);
     bal = CHDWalletBalances();
 
     isminefilter reuse_filter = avoid_reuse ? 0 : ISMINE_USED;
 
     bool allow_used_addresses = !IsWalletFlagSet(WALLET_FLAG_AVOID_REUSE) || (!avoid_reuse);
 
-    LOCK(cs_wallet);
-
+    bool is_volatile;
     for (const auto &item : mapWallet) {
-        const CWalletTx &wtx = item.second;
+        AddWalletTxBalances(item.second, bal, reuse_filter, is_volatile);
+    }
+    for (const auto &ri : mapRecords) {
+        AddRecordBalances(ri.first, ri.second, bal, allow_used_addresses, is_volatile);
+    }
+    //if (!MoneyRange(nBalance))
+    //    throw std::runtime_error(std::string(__func__) + ": value out of range");
+
+    return true;
+};
 
-        bal.nPartImmature += wtx.GetImmatureCredit();
-        //bal.nPartWatchOnlyImmature += wtx.GetImmatureWatchOnlyCredit(*locked_chain);
+void CHDWallet::UpdateBalanceLedgerEntry(const uint256 &txhash) const
+{
+    AssertLockHeld(cs_wallet);
+    CHDWalletBalances bal;
+    bool is_volatile = false, found = false;
 
-        int depth;
-        if (wtx.IsCoinStake() &&
-            (depth = wtx.GetDepthInMainChain()) > 0 && // checks for hashunset
-             wtx.GetBlocksToMaturity() > 0) {
-            CAmount nSpendable, nWatchOnly;
-            CHDWallet::GetCredit(*wtx.tx, nSpendable, nWatchOnly);
-            bal.nPartStaked += nSpendable;
-            bal.nPartWatchOnlyStaked += nWatchOnly;
-        }
+    MapWallet_t::const_iterator mwi = mapWallet.find(txhash);
+    if (mwi != mapWallet.end()) {
+        AddWalletTxBalances(mwi->second, bal, 0, is_volatile);
+        found = true;
+    }
+    MapRecords_t::const_iterator mri = mapRecords.find(txhash);
+    if (mri != mapRecords.end()) {
+        bool rtx_volatile = false;
+        AddRecordBalances(txhash, mri->second, bal, true, rtx_volatile);
+        is_volatile |= rtx_volatile;
+        found = true;
+    }
+
+    auto it = m_balance_ledger.find(txhash);
+    if (it != m_balance_ledger.end()) {
+        m_balance_ledger_total -= it->second;
+        m_balance_ledger.erase(it);
+    }
+    m_balance_ledger_volatile.erase(txhash);
+    if (!found) {
+        return;
+    }
+    // Spent txns contribute nothing, don't keep entries for them
+    if (!bal.IsNull()) {
+        m_balance_ledger_total += bal;
+        m_balance_ledger.emplace(txhash, bal);
+    }
+    if (is_volatile) {
+        m_balance_ledger_volatile.insert(txhash);
+    }
+};
+
+void CHDWallet::UpdateBalanceLedger() const
+{
+    AssertLockHeld(cs_wallet);
 
-        if (wtx.IsTrusted()) {
-            bal.nPart += wtx.GetAvailableCredit(true, ISMINE_SPENDABLE | reuse_filter);
-            bal.nPartWatchOnly += wtx.GetAvailableCredit(true, ISMINE_WATCH_ONLY | reuse_filter);
-        } else if (wtx.GetDepthInMainChain() == 0 && wtx.InMempool()) {
-            bal.nPartUnconf += wtx.GetAvailableCredit(true, ISMINE_SPENDABLE | reuse_filter);
-            bal.nPartWatchOnlyUnconf += wtx.GetAvailableCredit(true, ISMINE_WATCH_ONLY | reuse_filter);
+    int nHeight = GetLastBlockHeight();
+    if (!m_balance_ledger_valid || nHeight < m_balance_ledger_height) {
+        // Depths only grow while blocks are connected, after a disconnect any
+        // txn can fall back below a maturity depth.
+        m_balance_ledger.clear();
+        m_balance_ledger_total = CHDWalletBalances();
+        m_balance_ledger_volatile.clear();
+        m_balance_ledger_dirty.clear();
+        for (const auto &item : mapWallet) {
+            m_balance_ledger_dirty.insert(item.first);
+        }
+        for (const auto &ri : mapRecords) {
+            m_balance_ledger_dirty.insert(ri.first);
         }
+        m_balance_ledger_valid = true;
+    } else
+    if (nHeight != m_balance_ledger_height || m_balance_ledger_refresh_volatile) {
+        m_balance_ledger_dirty.insert(m_balance_ledger_volatile.begin(), m_balance_ledger_volatile.end());
     }
+    m_balance_ledger_height = nHeight;
+    m_balance_ledger_refresh_volatile = false;
 
-    const Consensus::Params &consensusParams = Params().GetConsensus();
-    for (const auto &ri : mapRecords) {
-        const auto &txhash = ri.first;
-        const auto &rtx = ri.second;
+    for (const auto &txhash : m_balance_ledger_dirty) {
+        UpdateBalanceLedgerEntry(txhash);
+    }
+    m_balance_ledger_dirty.clear();
+};
 
-        int depth;
-        bool fTrusted = IsTrusted(txhash, rtx, &depth);
-        bool fInMempool = false;
-        if (!fTrusted) {
-            CTransactionRef ptx = nullptr;
-            if (HaveChain()) {
-                ptx = chain().transactionFromMempool(txhash);
-            }
-            fInMempool = !ptx ? false : true;
+void CHDWallet::MarkBalanceDirty(const uint256 &hash) const
+{
+    AssertLockHeld(cs_wallet);
+    if (m_balance_ledger_valid) {
+        m_balance_ledger_dirty.insert(hash);
+    }
+    if (m_stake_coins_valid) {
+        m_stake_dirty.insert(hash);
+    }
+};
+
+void CHDWallet::IndexWalletTx(const CWalletTx &wtx)
+{
+    AssertLockHeld(cs_wallet);
+    uint32_t sets = 1 << CTxFilterIndex::TFI_WTX;
+    if (wtx.IsCoinStake()) {
+        sets |= 1 << CTxFilterIndex::TFI_STAKE;
+    }
+    std::vector<CScript> scripts;
+    for (const auto &txout : wtx.tx->vpout) {
+        const CScript *pscript = txout->GetPScriptPubKey();
+        if (pscript) {
+            scripts.push_back(*pscript);
         }
+    }
+    m_tx_filter_index.Insert(wtx.GetHash(), wtx.GetTxTime(), sets, scripts);
+};
 
-        for (const auto &r : rtx.vout) {
-            if (!(r.nFlags & ORF_OWN_ANY)
-                || IsSpent(txhash, r.n)) {
-                continue;
-            }
-            bool watch_only = r.nFlags & ORF_OWN_WATCH;
-            bool force_watch_only = false;
-#if !ENABLE_USBDEVICE
-            bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
-            if (fNeedHardwareKey) {
-                watch_only = true;
-                force_watch_only = true;
-            }
-#endif
-            switch (r.nType) {
-                case OUTPUT_RINGCT:
-                    if (!(r.nFlags & ORF_OWNED || r.nFlags & ORF_OWN_WATCH)) {
-                        continue;
-                    }
-                    if (fTrusted) {
-                        if (depth >= consensusParams.nMinRCTOutputDepth) {
-                            if (watch_only) {
-                                bal.nAnonWatchOnly += r.nValue;
-                            } else {
-                                bal.nAnon += r.nValue;
-                            }
-                        } else {
-                            if (watch_only) {
-                                bal.nAnonWatchOnlyImmature += r.nValue;
-                            } else {
-                                bal.nAnonImmature += r.nValue;
-                            }
-                        }
-                    } else
-                    if (fInMempool) {
-                        if (watch_only) {
-                            bal.nAnonWatchOnlyUnconf += r.nValue;
-                        } else {
-                            bal.nAnonUnconf += r.nValue;
-                        }
-                    }
-                    break;
-                case OUTPUT_CT:
-                    if (!(r.nFlags & ORF_OWNED || r.nFlags & ORF_OWN_WATCH)) {
-                        continue;
-                    }
-                    if (!allow_used_addresses && IsSpentKey(&r.scriptPubKey)) {
-                        continue;
-                    }
-                    if (fTrusted) {
-                        if (watch_only) {
-                            bal.nBlindWatchOnly += r.nValue;
-                        } else {
-                            bal.nBlind += r.nValue;
-                        }
-                    } else
-                    if (fInMempool) {
-                        if (watch_only) {
-                            bal.nBlindWatchOnlyUnconf += r.nValue;
-                        } else {
-                            bal.nBlindUnconf += r.nValue;
-                        }
-                    }
-                    break;
-                case OUTPUT_STANDARD:
-                    if (!force_watch_only && (r.nFlags & ORF_OWNED)) {
-                        if (!allow_used_addresses && IsSpentKey(&r.scriptPubKey)) {
-                            continue;
-                        }
-                        if (fTrusted) {
-                            bal.nPart += r.nValue;
-                        } else
-                        if (fInMempool) {
-                            bal.nPartUnconf += r.nValue;
-                        }
-                    } else
-                    if (watch_only) {
-                        if (fTrusted) {
-                            bal.nPartWatchOnly += r.nValue;
-                        } else
-                        if (fInMempool) {
-                            bal.nPartWatchOnlyUnconf += r.nValue;
-                        }
-                    }
-                    break;
-                default:
-                    break;
-            }
+void CHDWallet::UnindexTx(const uint256 &hash)
+{
+    AssertLockHeld(cs_wallet);
+    m_tx_filter_index.Erase(hash);
+};
+
+void CHDWallet::IndexRecord(const uint256 &hash, const CTransactionRecord &rtx)
+{
+    AssertLockHeld(cs_wallet);
+    uint32_t sets;
+    std::vector<CScript> scripts;
+    GetRecordFilterIndexData(rtx, sets, scripts);
+    m_tx_filter_index.Insert(hash, rtx.GetTxTime(), sets, scripts);
+};
+
+bool CHDWallet::GetBalances(CHDWalletBalances &bal, bool avoid_reuse) const
+{
+    LOCK(cs_wallet);
+
+    if (IsWalletFlagSet(WALLET_FLAG_AVOID_REUSE)) {
+        // Reusing an address changes the balance of all outputs to it, the ledger doesn't track that
+        return GetBalancesFullScan(bal, avoid_reuse);
+    }
+
+    UpdateBalanceLedger();
+    bal = m_balance_ledger_total;
+
+    if (m_check_balance_ledger) {
+        CHDWalletBalances bal_check;
+        GetBalancesFullScan(bal_check, avoid_reuse);
+        if (!(bal_check == bal)) {
+            WalletLogPrintf("%s: ERROR - Balance ledger is inconsistent with a full scan.\n", __func__);
         }
+        // As -checkmempool, a consistency check failure is fatal so tests can't miss it
+        assert(bal_check == bal);
     }
-    //if (!MoneyRange(nBalance))
-    //    throw std::runtime_error(std::string(__func__) + ": value out of range");
 
     return true;
 };
@@ -3355,16 +4145,145 @@ int CHDWallet::ExpandTempRecipients(std::vector<CTempRecipient> &vecSend, CStore
     return 0;
 };
 
+/**
+ * Run fn for each index in [0, n) on up to num_threads threads, fn is passed the index and the worker number.
+ * Returns the result of the lowest failing index, so the outcome doesn't depend on scheduling.
+ */
+static int ParallelForEach(size_t n, size_t num_threads, const std::function<int(size_t, size_t)> &fn)
+{
+    num_threads = std::max((size_t)1, std::min(num_threads, n));
+    std::vector<int> results(n, 0);
+    std::atomic<size_t> next{0};
+    auto worker = [&](size_t w) {
+        for (size_t i = next++; i < n; i = next++) {
+            results[i] = fn(i, w);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < num_threads; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (const auto rv : results) {
+        if (rv != 0) {
+            return rv;
+        }
+    }
+    return 0;
+};
+
 int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, std::string &sError)
 {
-    secp256k1_pedersen_commitment *pCommitment = txout->GetPCommitment();
-    std::vector<uint8_t> *pvRangeproof = txout->GetPRangeproof();
+    return AddCTData(coinControl, txout, r, m_blind_scratch, sError);
+};
+
+int CHDWallet::AddCTDataParallel(const CCoinControl *coinControl, CMutableTransaction &txNew, std::vector<CTempRecipient> &vecSend,
+    const std::vector<size_t> &vIndices, int nSeparate, std::string &sError)
+{
+    // Runs of adjacent blinded outputs share a bulletproof, in groups of a power of two outputs
+    std::vector<std::vector<size_t> > vJobs;
+    int64_t now = GetTime();
+    bool fAggregate = now >= Params().GetConsensus().bulletproof_time && now >= Params().GetConsensus().aggregate_bulletproof_time;
+    for (size_t k = 0; k < vIndices.size();) {
+        size_t nRun = 1;
+        if (fAggregate && (int)vIndices[k] != nSeparate) {
+            while (k + nRun < vIndices.size() &&
+                   (int)vIndices[k + nRun] != nSeparate &&
+                   vecSend[vIndices[k + nRun]].n == vecSend[vIndices[k + nRun - 1]].n + 1) {
+                nRun++;
+            }
+        }
+        while (nRun > 0) {
+            size_t nGroup = 1;
+            while (nGroup * 2 <= nRun && nGroup * 2 <= MAX_AGGREGATED_RANGEPROOF_OUTPUTS) {
+                nGroup *= 2;
+            }
+            vJobs.emplace_back(vIndices.begin() + k, vIndices.begin() + k + nGroup);
+            k += nGroup;
+            nRun -= nGroup;
+        }
+    }
+
+    std::vector<uint256> vProofNonces(vJobs.size());
+    for (size_t j = 0; j < vJobs.size(); ++j) {
+        if (vJobs[j].size() > 1) {
+            GetStrongRandBytes(vProofNonces[j].begin(), 32);
+        }
+    }
+
+    size_t num_threads = std::min((size_t)m_blind_sign_threads, vJobs.size());
+    // Bulletproofs can't share a scratch space between threads
+    std::vector<secp256k1_scratch_space*> vScratch(std::max(num_threads, (size_t)1), m_blind_scratch);
+    for (size_t w = 1; w < num_threads; ++w) {
+        vScratch[w] = secp256k1_scratch_space_create(secp256k1_ctx_blind, 1024 * 1024);
+        assert(vScratch[w]);
+    }
+
+    std::vector<std::string> vErrors(vJobs.size());
+    int rv = ParallelForEach(vJobs.size(), num_threads, [&](size_t j, size_t w) {
+        const std::vector<size_t> &vGroup = vJobs[j];
+        if (vGroup.size() > 1) {
+            return AddAggregatedCTData(coinControl, txNew, vecSend, vGroup, vProofNonces[j], vScratch[w], vErrors[j]);
+        }
+        CTempRecipient &r = vecSend[vGroup[0]];
+        assert(r.n < (int)txNew.vpout.size());
+        return AddCTData(coinControl, txNew.vpout[r.n].get(), r, vScratch[w], vErrors[j]);
+    });
 
-    if (!pCommitment || !pvRangeproof) {
+    for (size_t w = 1; w < num_threads; ++w) {
+        secp256k1_scratch_space_destroy(secp256k1_ctx_blind, vScratch[w]);
+    }
+
+    if (rv != 0) {
+        for (const auto &e : vErrors) {
+            if (!e.empty()) {
+                sError = e;
+                break;
+            }
+        }
+        return 1;
+    }
+    return 0;
+};
+
+/** Bulletproofs don't carry a message, the narration is appended to the output data */
+static int AppendEncryptedNarration(CTxOutBase *txout, const CTempRecipient &r, std::string &sError)
+{
+    if (r.sNarration.size() < 1) {
+        return 0;
+    }
+    std::vector<uint8_t> vchNarr, &vData = *txout->GetPData();
+    CPubKey pkEphem = r.sEphem.GetPubKey();
+    SecMsgCrypter crypter;
+    crypter.SetKey(r.nonce.begin(), pkEphem.begin());
+
+    if (!crypter.Encrypt((uint8_t*)r.sNarration.data(), r.sNarration.length(), vchNarr)) {
+        return errorN(1, sError, __func__, "Narration encryption failed.");
+    }
+    if (vchNarr.size() > MAX_STEALTH_NARRATION_SIZE) {
+        return errorN(1, sError, __func__, "Encrypted narration is too long.");
+    }
+
+    size_t o = vData.size();
+    vData.resize(o + vchNarr.size() + 1);
+    vData[o++] = DO_NARR_CRYPT;
+    memcpy(&vData[o], vchNarr.data(), vchNarr.size());
+    return 0;
+};
+
+int CHDWallet::SetCTCommitment(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, uint64_t &nValue, std::string &sError) const
+{
+    secp256k1_pedersen_commitment *pCommitment = txout->GetPCommitment();
+    if (!pCommitment || !txout->GetPRangeproof()) {
         return wserrorN(1, sError, __func__, "Unable to get CT pointers for output type %d", txout->GetType());
     }
 
-    uint64_t nValue = r.nAmount;
+    nValue = r.nAmount;
     if (coinControl && coinControl->m_debug_exploit_anon > 0) {
         nValue += coinControl->m_debug_exploit_anon;
     }
@@ -3396,6 +4315,20 @@ int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTe
         CSHA256().Write(nonce.begin(), 32).Finalize(nonce.begin());
         r.nonce = nonce;
     }
+
+    return 0;
+};
+
+int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, secp256k1_scratch_space *scratch, std::string &sError) const
+{
+    uint64_t nValue;
+    if (0 != SetCTCommitment(coinControl, txout, r, nValue, sError)) {
+        return 1; // sError will be set
+    }
+    secp256k1_pedersen_commitment *pCommitment = txout->GetPCommitment();
+    std::vector<uint8_t> *pvRangeproof = txout->GetPRangeproof();
+    const uint256 &nonce = r.nonce;
+
     size_t nRangeProofLen = 5134;
     pvRangeproof->resize(nRangeProofLen);
 
@@ -3404,34 +4337,19 @@ int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTe
         bp[0] = r.vBlind.data();
         assert(r.vBlind.size() == 32);
 
-        if (1 != secp256k1_bulletproof_rangeproof_prove(secp256k1_ctx_blind, m_blind_scratch, blind_gens,
+        if (1 != secp256k1_bulletproof_rangeproof_prove(secp256k1_ctx_blind, scratch, blind_gens,
             pvRangeproof->data(), &nRangeProofLen, &nValue, nullptr, bp, 1,
             &secp256k1_generator_const_h, 64, nonce.begin(), nullptr, 0)) {
             return wserrorN(1, sError, __func__, "secp256k1_bulletproof_rangeproof_prove failed.");
         }
 
-        if (1 != secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind, m_blind_scratch, blind_gens,
+        if (1 != secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind, scratch, blind_gens,
             pvRangeproof->data(), nRangeProofLen, nullptr, pCommitment, 1, 64, &secp256k1_generator_const_h, nullptr, 0)) {
             return wserrorN(1, sError, __func__, "secp256k1_bulletproof_rangeproof_verify failed.");
         }
 
-        if (r.sNarration.size() > 0) {
-            std::vector<uint8_t> vchNarr, &vData = *txout->GetPData();
-            CPubKey pkEphem = r.sEphem.GetPubKey();
-            SecMsgCrypter crypter;
-            crypter.SetKey(r.nonce.begin(), pkEphem.begin());
-
-            if (!crypter.Encrypt((uint8_t*)r.sNarration.data(), r.sNarration.length(), vchNarr)) {
-                return errorN(1, sError, __func__, "Narration encryption failed.");
-            }
-            if (vchNarr.size() > MAX_STEALTH_NARRATION_SIZE) {
-                return errorN(1, sError, __func__, "Encrypted narration is too long.");
-            }
-
-            size_t o = vData.size();
-            vData.resize(o + vchNarr.size() + 1);
-            vData[o++] = DO_NARR_CRYPT;
-            memcpy(&vData[o], vchNarr.data(), vchNarr.size());
+        if (0 != AppendEncryptedNarration(txout, r, sError)) {
+            return 1; // sError will be set
         }
     } else {
         uint64_t min_value = 0;
@@ -3469,6 +4387,60 @@ int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTe
     return 0;
 };
 
+int CHDWallet::AddAggregatedCTData(const CCoinControl *coinControl, CMutableTransaction &txNew, std::vector<CTempRecipient> &vecSend,
+    const std::vector<size_t> &vGroup, const uint256 &proof_nonce, secp256k1_scratch_space *scratch, std::string &sError) const
+{
+    size_t nOutputs = vGroup.size();
+    std::vector<uint64_t> vValues(nOutputs);
+    std::vector<const uint8_t*> vpBlinds(nOutputs);
+    std::vector<CTxOutBase*> vpOut(nOutputs);
+
+    for (size_t k = 0; k < nOutputs; ++k) {
+        CTempRecipient &r = vecSend[vGroup[k]];
+        assert(r.n < (int)txNew.vpout.size());
+        assert(k == 0 || r.n == vecSend[vGroup[k - 1]].n + 1);
+        vpOut[k] = txNew.vpout[r.n].get();
+        if (0 != SetCTCommitment(coinControl, vpOut[k], r, vValues[k], sError)) {
+            return 1; // sError will be set
+        }
+        vpBlinds[k] = r.vBlind.data();
+    }
+
+    // The proof nonce is random, an output's nonce is shared with its recipient
+    std::vector<uint8_t> vProof(SECP256K1_BULLETPROOF_MAX_PROOF);
+    size_t nProofLen = vProof.size();
+    if (1 != secp256k1_bulletproof_rangeproof_prove(secp256k1_ctx_blind, scratch, blind_gens_aggregated,
+        vProof.data(), &nProofLen, vValues.data(), nullptr, vpBlinds.data(), nOutputs,
+        &secp256k1_generator_const_h, 64, proof_nonce.begin(), nullptr, 0)) {
+        return wserrorN(1, sError, __func__, "secp256k1_bulletproof_rangeproof_prove failed for %d outputs.", nOutputs);
+    }
+    vProof.resize(nProofLen);
+
+    std::vector<secp256k1_pedersen_commitment> vCommitments(nOutputs);
+    for (size_t k = 0; k < nOutputs; ++k) {
+        vCommitments[k] = *vpOut[k]->GetPCommitment();
+    }
+    if (1 != secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind, scratch, blind_gens_aggregated,
+        vProof.data(), vProof.size(), nullptr, vCommitments.data(), nOutputs, 64, &secp256k1_generator_const_h, nullptr, 0)) {
+        return wserrorN(1, sError, __func__, "secp256k1_bulletproof_rangeproof_verify failed for %d outputs.", nOutputs);
+    }
+
+    for (size_t k = 0; k < nOutputs; ++k) {
+        CTempRecipient &r = vecSend[vGroup[k]];
+        std::vector<uint8_t> &vRangeproof = *vpOut[k]->GetPRangeproof();
+        vRangeproof = k == 0 ? vProof : std::vector<uint8_t>();
+        size_t o = vRangeproof.size();
+        vRangeproof.resize(o + AGGREGATED_AMOUNT_SIZE);
+        EncryptAggregatedAmount(r.nonce, vValues[k], r.vBlind.data(), &vRangeproof[o]);
+
+        if (0 != AppendEncryptedNarration(vpOut[k], r, sError)) {
+            return 1; // sError will be set
+        }
+    }
+
+    return 0;
+};
+
 int CHDWallet::PostProcessTempRecipients(std::vector<CTempRecipient> &vecSend)
 {
     LOCK(cs_wallet);
@@ -3806,6 +4778,52 @@ static bool InsertChangeAddress(CTempRecipient &r, std::vector<CTempRecipient> &
     return true;
 };
 
+/** Rough virtual size of an output, blinded outputs are assumed to carry a single output bulletproof */
+static size_t EstimateOutputSize(const CTempRecipient &r)
+{
+    const size_t nRangeProofSize = 3 + 675;
+    switch (r.nType) {
+        case OUTPUT_DATA:
+            return 2 + r.vData.size();
+        case OUTPUT_CT:
+            return 1 + 33 + 34 + 1 + r.scriptPubKey.size() + nRangeProofSize;
+        case OUTPUT_RINGCT:
+            return 1 + 33 + 33 + 34 + nRangeProofSize;
+        default:
+            return 1 + 8 + 1 + r.scriptPubKey.size();
+    }
+};
+
+/** Fee of the parts of a transaction that aren't inputs, with num_change change outputs of type change_type */
+static CAmount EstimateNotInputFees(const CFeeRate &fee_rate, const std::vector<CTempRecipient> &vecSend, uint8_t change_type, size_t num_change)
+{
+    size_t nBytes = 4 + 4 + 2 + 2 + 12; // version, locktime, counts and the fee output
+    for (const auto &r : vecSend) {
+        nBytes += EstimateOutputSize(r);
+    }
+    CTempRecipient change;
+    change.nType = change_type;
+    change.scriptPubKey = CScript() << OP_DUP << OP_HASH160 << std::vector<uint8_t>(20) << OP_EQUALVERIFY << OP_CHECKSIG;
+    nBytes += num_change * (EstimateOutputSize(change) + 2 + 33); // Change outputs carry an ephemeral pubkey data output
+    return fee_rate.GetFee(nBytes);
+};
+
+/** Input fees of blinded inputs, each is signed separately */
+static void SetBlindedInputFees(RingCoinSelectionParams &params, const CFeeRate &fee_rate)
+{
+    params.input_fee = fee_rate.GetFee(41 + (1 + 73 + 34 + WITNESS_SCALE_FACTOR - 1) / WITNESS_SCALE_FACTOR);
+    params.sig_fee = 0;
+    params.inputs_per_sig = 1;
+};
+
+/** Input fees of anon inputs, per input a key image and a column of each ring, per signature the commitment row */
+static void SetAnonInputFees(RingCoinSelectionParams &params, const CFeeRate &fee_rate, size_t nRingSize, size_t nInputsPerSig)
+{
+    params.input_fee = fee_rate.GetFee(33 + (nRingSize * (3 + 32) + WITNESS_SCALE_FACTOR - 1) / WITNESS_SCALE_FACTOR);
+    params.sig_fee = fee_rate.GetFee(44 + ((1 + nRingSize) * 32 + 33 + 4 + WITNESS_SCALE_FACTOR - 1) / WITNESS_SCALE_FACTOR);
+    params.inputs_per_sig = nInputsPerSig;
+};
+
 int PreAcceptMempoolTx(CHDWallet *wallet, CWalletTx &wtx, std::string &sError)
 {
     // Check if wtx can get into the mempool
@@ -4029,6 +5047,7 @@ int CHDWallet::AddStandardInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                 }
             }
 
+            std::vector<size_t> vBlindedOutputs;
             for (size_t i = 0; i < vecSend.size(); ++i) {
                 auto &r = vecSend[i];
 
@@ -4047,13 +5066,12 @@ int CHDWallet::AddStandardInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                         } // else already prefilled
                         vpBlinds.push_back(&r.vBlind[0]);
                     }
-
-                    assert(r.n < (int)txNew.vpout.size());
-                    if (0 != AddCTData(coinControl, txNew.vpout[r.n].get(), r, sError)) {
-                        return 1; // sError will be set
-                    }
+                    vBlindedOutputs.push_back(i);
                 }
             }
+            if (0 != AddCTDataParallel(coinControl, txNew, vecSend, vBlindedOutputs, -1, sError)) {
+                return 1; // sError will be set
+            }
 
             // Fill in dummy signatures for fee calculation.
             int nIn = 0;
@@ -4478,6 +5496,16 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
         CAmount nValueOutPlain = 0;
         int nChangePosInOut = -1;
 
+        // Branch and bound is only tried on the first pass, the selection must cover the estimated fee
+        bool use_bnb = nSubtractFeeFromAmount == 0 && coinControl->m_addChangeOutput && !coinControl->m_spend_frozen_blinded;
+        RingCoinSelectionParams bnb_params;
+        if (use_bnb) {
+            CFeeRate fee_rate = GetMinimumFeeRate(*this, *coinControl, &feeCalc);
+            SetBlindedInputFees(bnb_params, fee_rate);
+            bnb_params.not_input_fees = EstimateNotInputFees(fee_rate, vecSend, OUTPUT_CT, fOnlyStandardOutputs ? 2 : 1);
+            bnb_params.cost_of_change = ::minRelayTxFee.GetFee(2048); // Below this the change output is left empty
+        }
+
         nFeeRet = 0;
         size_t nSubFeeTries = 100;
         bool pick_new_inputs = true;
@@ -4494,12 +5522,19 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             }
 
             // Choose coins to use
+            bool bnb_used = false;
             if (pick_new_inputs) {
                 nValueIn = 0;
                 setCoins.clear();
-                if (!SelectBlindedCoins(vAvailableCoins, nValueToSelect, setCoins, nValueIn, coinControl)) {
+                if (!SelectBlindedCoins(vAvailableCoins, nValueToSelect, setCoins, nValueIn, coinControl, false, use_bnb ? &bnb_params : nullptr, &bnb_used)) {
                     return wserrorN(1, sError, __func__, _("Insufficient funds.").translated);
                 }
+                use_bnb = false;
+                if (bnb_used) {
+                    // The selection is changeless, the excess over the outputs is all fee
+                    nFeeRet = nValueIn - nValue;
+                    nValueToSelect = nValueIn;
+                }
             }
 
             const CAmount nChange = nValueIn - nValueToSelect;
@@ -4581,6 +5616,7 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             txNew.vpout.push_back(outFee);
 
             bool fFirst = true;
+            std::vector<size_t> vBlindedOutputs;
             for (size_t i = 0; i < vecSend.size(); ++i) {
                 auto &r = vecSend[i];
 
@@ -4612,12 +5648,14 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                         r.vBlind.resize(32);
                         GetStrongRandBytes(&r.vBlind[0], 32);
                     } // else already prefilled
-
-                    if (0 != AddCTData(coinControl, txbout.get(), r, sError)) {
-                        return 1; // sError will be set
-                    }
+                    vBlindedOutputs.push_back(i);
                 }
             }
+            // The last blinded output is reblinded once the fee is known
+            int nSeparate = nChangePosInOut != -1 ? nChangePosInOut : (vBlindedOutputs.empty() ? -1 : (int)vBlindedOutputs.back());
+            if (0 != AddCTDataParallel(coinControl, txNew, vecSend, vBlindedOutputs, nSeparate, sError)) {
+                return 1; // sError will be set
+            }
 
             // Fill in dummy signatures for fee calculation.
             int nIn = 0;
@@ -4658,8 +5696,9 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                 // prevents potential overpayment in fees if the coins
                 // selected to meet nFeeNeeded result in a transaction that
                 // requires less fee than the prior iteration.
+                // A changeless selection pays its excess as fee rather than create a dust change output.
                 if (nFeeRet > nFeeNeeded && nChangePosInOut != -1
-                    && nSubtractFeeFromAmount == 0) {
+                    && nSubtractFeeFromAmount == 0 && !bnb_used) {
                     auto &r = vecSend[nChangePosInOut];
 
                     CAmount extraFeePaid = nFeeRet - nFeeNeeded;
@@ -5299,6 +6338,16 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
         std::vector<std::vector<uint8_t> > vInputBlinds;
         std::vector<size_t> vSecretColumns;
 
+        // Branch and bound is only tried on the first pass, the selection must cover the estimated fee
+        bool use_bnb = nSubtractFeeFromAmount == 0 && coinControl->m_addChangeOutput && !coinControl->m_spend_frozen_blinded;
+        RingCoinSelectionParams bnb_params;
+        if (use_bnb) {
+            CFeeRate fee_rate = GetMinimumFeeRate(*this, *coinControl, &feeCalc);
+            SetAnonInputFees(bnb_params, fee_rate, nRingSize, nInputsPerSig);
+            bnb_params.not_input_fees = EstimateNotInputFees(fee_rate, vecSend, OUTPUT_RINGCT, 1);
+            bnb_params.cost_of_change = ::minRelayTxFee.GetFee(2048); // Below this the change output is left empty
+        }
+
         size_t nSubFeeTries = 100;
         bool pick_new_inputs = true;
         CAmount nValueIn = 0;
@@ -5314,12 +6363,19 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             }
 
             // Choose coins to use
+            bool bnb_used = false;
             if (pick_new_inputs) {
                 nValueIn = 0;
                 setCoins.clear();
-                if (!SelectBlindedCoins(vAvailableCoins, nValueToSelect, setCoins, nValueIn, coinControl, true)) {
+                if (!SelectBlindedCoins(vAvailableCoins, nValueToSelect, setCoins, nValueIn, coinControl, true, use_bnb ? &bnb_params : nullptr, &bnb_used)) {
                     return wserrorN(1, sError, __func__, _("Insufficient funds.").translated);
                 }
+                use_bnb = false;
+                if (bnb_used) {
+                    // The selection is changeless, the excess over the outputs is all fee
+                    nFeeRet = nValueIn - nValue;
+                    nValueToSelect = nValueIn;
+                }
             }
 
             const CAmount nChange = nValueIn - nValueToSelect;
@@ -5391,6 +6447,7 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             txNew.vpout.push_back(outFee);
 
             bool fFirst = true;
+            std::vector<size_t> vBlindedOutputs;
             for (size_t i = 0; i < vecSend.size(); ++i) {
                 auto &r = vecSend[i];
 
@@ -5418,12 +6475,12 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                         r.vBlind.resize(32);
                         GetStrongRandBytes(&r.vBlind[0], 32);
                     } // else prefilled already
-
-                    if (0 != AddCTData(coinControl, txbout.get(), r, sError)) {
-                        return 1; // sError will be set
-                    }
+                    vBlindedOutputs.push_back(i);
                 }
             }
+            if (0 != AddCTDataParallel(coinControl, txNew, vecSend, vBlindedOutputs, nChangePosInOut, sError)) {
+                return 1; // sError will be set
+            }
 
             std::set<int64_t> setHave; // Anon prev-outputs can only be used once per transaction.
             size_t nTotalInputs = 0;
@@ -5483,8 +6540,9 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                 // prevents potential overpayment in fees if the coins
                 // selected to meet nFeeNeeded result in a transaction that
                 // requires less fee than the prior iteration.
+                // A changeless selection pays its excess as fee rather than create a dust change output.
                 if (nFeeRet > nFeeNeeded && nChangePosInOut != -1
-                    && nSubtractFeeFromAmount == 0) {
+                    && nSubtractFeeFromAmount == 0 && !bnb_used) {
                     auto &r = vecSend[nChangePosInOut];
 
                     CAmount extraFeePaid = nFeeRet - nFeeNeeded;
@@ -5628,22 +6686,38 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                 }
             }
 
+            // Prepare the MLSAGs in order, the split commitments chain through vSplitCommitBlindingKeys.
+            // Only generating the signatures is independent between inputs.
+            struct MLSAGSigningData {
+                size_t nCols = 0;
+                size_t nRows = 0;
+                uint8_t randSeed[32];
+                uint8_t blindSum[32] = {0};
+                std::vector<CKey> vsk;
+                std::vector<const uint8_t*> vpsk;
+                std::vector<uint8_t> vm;
+            };
+            std::vector<MLSAGSigningData> vSigning(txNew.vin.size());
+
             for (size_t l = 0; l < txNew.vin.size(); ++l) {
                 auto &txin = txNew.vin[l];
+                MLSAGSigningData &sd = vSigning[l];
 
                 uint32_t nSigInputs, nSigRingSize;
                 txin.GetAnonInfo(nSigInputs, nSigRingSize);
 
-                size_t nCols = nSigRingSize;
-                size_t nRows = nSigInputs + 1;
+                size_t nCols = sd.nCols = nSigRingSize;
+                size_t nRows = sd.nRows = nSigInputs + 1;
 
-                uint8_t randSeed[32];
-                GetStrongRandBytes(randSeed, 32);
+                GetStrongRandBytes(sd.randSeed, 32);
 
-                std::vector<CKey> vsk(nSigInputs);
-                std::vector<const uint8_t*> vpsk(nRows), vpBlinds, vpInCommits(nCols * nSigInputs);
-                std::vector<uint8_t> vm(nCols * nRows * 33);
-                std::vector<uint8_t> &vKeyImages = txin.scriptData.stack[0];
+                std::vector<CKey> &vsk = sd.vsk;
+                std::vector<const uint8_t*> &vpsk = sd.vpsk;
+                std::vector<uint8_t> &vm = sd.vm;
+                vsk.resize(nSigInputs);
+                vpsk.resize(nRows);
+                vm.resize(nCols * nRows * 33);
+                std::vector<const uint8_t*> vpBlinds, vpInCommits(nCols * nSigInputs);
                 std::vector<uint8_t> &vDL = txin.scriptWitness.stack[1];
                 std::vector<secp256k1_pedersen_commitment> vCommitments;
                 vCommitments.reserve(nCols * nSigInputs);
@@ -5671,7 +6745,7 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                     }
                 }
 
-                uint8_t blindSum[32] = {0};
+                uint8_t *blindSum = sd.blindSum;
                 vpsk[nRows-1] = blindSum;
                 if (txNew.vin.size() == 1) {
                     vDL.resize((1 + (nSigInputs+1) * nSigRingSize) * 32); // extra element for C, extra row for commitment row
@@ -5730,13 +6804,33 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
 
                     vpBlinds.pop_back();
                 }
+            }
+
+            // The txn hash doesn't cover the signatures, all MLSAGs sign the same hash
+            uint256 txhash = txNew.GetHash();
+            std::vector<std::string> vErrors(txNew.vin.size());
+            size_t num_threads = std::min((size_t)m_blind_sign_threads, txNew.vin.size());
+            if (0 != ParallelForEach(txNew.vin.size(), num_threads, [&](size_t l, size_t w) {
+                auto &txin = txNew.vin[l];
+                MLSAGSigningData &sd = vSigning[l];
+                std::vector<uint8_t> &vKeyImages = txin.scriptData.stack[0];
+                std::vector<uint8_t> &vDL = txin.scriptWitness.stack[1];
 
-                uint256 txhash = txNew.GetHash();
-                if (0 != (rv = secp256k1_generate_mlsag(secp256k1_ctx_blind, vKeyImages.data(), &vDL[0], &vDL[32],
-                    randSeed, txhash.begin(), nCols, nRows, vSecretColumns[l],
-                    &vpsk[0], &vm[0]))) {
-                    return wserrorN(1, sError, __func__, "secp256k1_generate_mlsag failed %d", rv);
+                int mlsag_rv;
+                if (0 != (mlsag_rv = secp256k1_generate_mlsag(secp256k1_ctx_blind, vKeyImages.data(), &vDL[0], &vDL[32],
+                    sd.randSeed, txhash.begin(), sd.nCols, sd.nRows, vSecretColumns[l],
+                    &sd.vpsk[0], &sd.vm[0]))) {
+                    return wserrorN(1, vErrors[l], "AddAnonInputs", "secp256k1_generate_mlsag failed %d", mlsag_rv);
+                }
+                return 0;
+            })) {
+                for (const auto &e : vErrors) {
+                    if (!e.empty()) {
+                        sError = e;
+                        break;
+                    }
                 }
+                return 1;
             }
         }
 
@@ -5828,11 +6922,162 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
     return 0;
 };
 
+int CHDWallet::ConsolidateCoins(OutputTypes type, const CFeeRate &fee_rate, std::string &sError)
+{
+    AssertLockHeld(cs_wallet);
+    const size_t k = type - 1;
+    int min_depth = type == OUTPUT_RINGCT ? std::max(1, Params().GetConsensus().nMinRCTOutputDepth) : 1;
+
+    // Collect the smallest confirmed outputs below the threshold
+    std::vector<std::pair<CAmount, COutPoint> > vSmall;
+    if (type == OUTPUT_STANDARD) {
+        std::vector<COutput> vCoins;
+        AvailableCoins(vCoins, true, nullptr, 1, m_consolidation.threshold - 1);
+        for (const auto &out : vCoins) {
+            if (!out.fSpendable || out.nDepth < min_depth) {
+                continue;
+            }
+            vSmall.emplace_back(out.tx->tx->vpout[out.i]->GetValue(), COutPoint(out.tx->GetHash(), out.i));
+        }
+    } else {
+        std::vector<COutputR> vCoins;
+        if (type == OUTPUT_CT) {
+            AvailableBlindedCoins(vCoins, true, nullptr, 1, m_consolidation.threshold - 1);
+        } else {
+            AvailableAnonCoins(vCoins, true, nullptr, 1, m_consolidation.threshold - 1);
+        }
+        for (const auto &r : vCoins) {
+            if (!r.fSpendable || r.nDepth < min_depth) {
+                continue;
+            }
+            const COutputRecord *oR = r.rtx->second.GetOutput(r.i);
+            if (!oR) {
+                continue;
+            }
+            vSmall.emplace_back(oR->nValue, COutPoint(r.txhash, r.i));
+        }
+    }
+
+    if (vSmall.size() < m_consolidation.min_inputs) {
+        return 0;
+    }
+    std::sort(vSmall.begin(), vSmall.end());
+    if (vSmall.size() > m_consolidation.max_inputs) {
+        vSmall.resize(m_consolidation.max_inputs);
+    }
+
+    CCoinControl cctl;
+    cctl.fAllowOtherInputs = false;
+    cctl.m_feerate = fee_rate;
+    cctl.m_mixin_selection_mode = m_mixin_selection_mode_default;
+    CAmount nTotal = 0;
+    for (const auto &coin : vSmall) {
+        cctl.Select(coin.second);
+        nTotal += coin.first;
+    }
+    m_consolidation_stats.planned[k]++;
+    m_consolidation_stats.planned_inputs[k] += vSmall.size();
+
+    CTempRecipient r;
+    r.nType = type;
+    r.SetAmount(nTotal);
+    r.fSubtractFeeFromAmount = true;
+    if (type == OUTPUT_RINGCT) {
+        // Anon outputs can only be sent to a stealth address
+        ExtKeyAccountMap::const_iterator mi = mapExtAccounts.find(idDefaultAccount);
+        if (mi == mapExtAccounts.end() || mi->second->mapStealthKeys.empty()) {
+            m_consolidation_stats.failed[k]++;
+            return wserrorN(1, sError, __func__, "No stealth address in the default account.");
+        }
+        CStealthAddress sx;
+        mi->second->mapStealthKeys.begin()->second.SetSxAddr(sx);
+        r.address = sx;
+    } else {
+        if (!SetChangeDest(&cctl, r, sError)) {
+            m_consolidation_stats.failed[k]++;
+            return 1; // sError will be set
+        }
+        r.fScriptSet = true;
+    }
+    std::vector<CTempRecipient> vecSend;
+    vecSend.push_back(r);
+
+    CTransactionRef tx_new;
+    CWalletTx wtx(this, tx_new);
+    CTransactionRecord rtx;
+    CAmount nFee;
+    int rv;
+    if (type == OUTPUT_STANDARD) {
+        rv = AddStandardInputs(wtx, rtx, vecSend, true, nFee, &cctl, sError);
+    } else
+    if (type == OUTPUT_CT) {
+        rv = AddBlindedInputs(wtx, rtx, vecSend, true, nFee, &cctl, sError);
+    } else {
+        rv = AddAnonInputs(wtx, rtx, vecSend, true, m_consolidation.ring_size, DEFAULT_INPUTS_PER_SIG, nFee, &cctl, sError);
+    }
+    if (rv != 0) {
+        m_consolidation_stats.failed[k]++;
+        return 1; // sError will be set
+    }
+
+    TxValidationState state;
+    if (!CommitTransaction(wtx, rtx, state, wtx.mapValue, wtx.vOrderForm, type != OUTPUT_STANDARD)) {
+        m_consolidation_stats.failed[k]++;
+        return wserrorN(1, sError, __func__, "Transaction commit failed: %s", state.ToString());
+    }
+
+    m_consolidation_stats.executed[k]++;
+    m_consolidation_stats.executed_inputs[k] += vSmall.size();
+    m_consolidation_stats.last_txid = wtx.GetHash();
+    WalletLogPrintf("%s: Joined %d %s outputs in %s, fee %s.\n", __func__,
+        vSmall.size(), CONSOLIDATION_TYPES[type - 1], wtx.GetHash().ToString(), FormatMoney(nFee));
+    return 0;
+};
+
+void CHDWallet::MaybeConsolidateCoins()
+{
+    if (!WITH_LOCK(cs_wallet, return m_consolidation.enabled) || !GetBroadcastTransactions()
+        || !chain().isReadyToBroadcast()) {
+        return;
+    }
+
+    int64_t nNow = GetTime();
+    LOCK(cs_wallet);
+    if (nNow < m_consolidation_stats.next_check
+        || IsLocked() || fUnlockForStakingOnly) {
+        return;
+    }
+    m_consolidation_stats.last_check = nNow;
+
+    // Only consolidate while fees are low, recheck sooner when they are not
+    CCoinControl cctl;
+    FeeCalculation feeCalc;
+    CFeeRate fee_rate = GetMinimumFeeRate(*this, cctl, &feeCalc);
+    if (fee_rate > m_consolidation.max_fee_rate) {
+        m_consolidation_stats.skipped_fee++;
+        m_consolidation_stats.next_check = nNow + std::min(m_consolidation.interval, (int64_t)10 * 60);
+        return;
+    }
+    m_consolidation_stats.next_check = nNow + m_consolidation.interval;
+
+    for (OutputTypes type : {OUTPUT_STANDARD, OUTPUT_CT, OUTPUT_RINGCT}) {
+        if (!m_consolidation.types[type - 1]) {
+            continue;
+        }
+        std::string sError;
+        if (0 != ConsolidateCoins(type, fee_rate, sError)) {
+            m_consolidation_stats.last_error = sError;
+            WalletLogPrintf("%s: Consolidating %s outputs failed: %s\n", __func__, CONSOLIDATION_TYPES[type - 1], sError);
+        }
+    }
+};
+
 void CHDWallet::ClearCachedBalances()
 {
     // Clear cache when a new txn is added to the wallet or a block is added or removed from the chain.
     m_have_spendable_balance_cached = false;
-    m_have_cached_stakeable_coins = false;
+    m_stake_coins_refresh_unconfirmed = true;
+    m_balance_ledger_refresh_volatile = true;
     return;
 }
 
@@ -5871,6 +7116,7 @@ void CHDWallet::LoadToWallet(const uint256 &hash, CTransactionRecord &rtx)
 
     MapRecords_t::iterator mri = ret.first;
     rtxOrdered.insert(std::make_pair(rtx.GetTxTime(), mri));
+    IndexRecord(hash, mri->second);
 
     // TODO: Spend only owned inputs?
 
@@ -5905,8 +7151,12 @@ int CHDWallet::UnloadTransaction(const uint256 &hash)
         CWalletTx *pcoin = &itw->second;
 
         RemoveFromTxSpends(hash, pcoin->tx);
+        for (const auto &txin : pcoin->tx->vin) {
+            MarkBalanceDirty(txin.prevout.hash);
+        }
 
         wtxOrdered.erase(pcoin->m_it_wtxOrdered);
+        UnindexTx(hash);
 
         mapWallet.erase(itw);
     } else
@@ -5916,6 +7166,12 @@ int CHDWallet::UnloadTransaction(const uint256 &hash)
             WalletLogPrintf("%s: ReadStoredTx failed for %s.\n", __func__, hash.ToString());
         } else {
             RemoveFromTxSpends(hash, stx.tx);
+            for (const auto &txin : stx.tx->vin) {
+                MarkBalanceDirty(txin.prevout.hash);
+            }
+        }
+        for (const auto &prevout : itr->second.vin) {
+            MarkBalanceDirty(prevout.hash);
         }
 
         for (auto it = rtxOrdered.cbegin(); it != rtxOrdered.cend(); ) {
@@ -5927,11 +7183,13 @@ int CHDWallet::UnloadTransaction(const uint256 &hash)
             ++it;
         }
 
+        UnindexTx(hash);
         mapRecords.erase(itr);
     } else {
         WalletLogPrintf("Warning: %s - tx not found in wallet! %s.\n", __func__, hash.ToString());
         return 1;
     }
+    MarkBalanceDirty(hash);
 
     NotifyTransactionChanged(this, hash, CT_DELETED);
     return 0;
@@ -7381,13 +8639,15 @@ int CHDWallet::ExtKeyAddAccountToMaps(const CKeyID &idAccount, CExtKeyAccount *s
             }
 
             if (fAddToLookAhead) {
-                sea->AddLookAhead(i, (uint32_t)nLookAhead);
+                sea->QueueLookAhead(i, (uint32_t)nLookAhead);
+                m_lookahead_pending = true;
             }
         }
 
         mapExtKeys[sea->vExtKeyIDs[i]] = sek;
     }
 
+    sea->SetLookAheadIndex(&m_lookahead_index);
     mapExtAccounts[idAccount] = sea;
     return 0;
 };
@@ -7406,6 +8666,7 @@ int CHDWallet::ExtKeyRemoveAccountFromMapsAndFree(CExtKeyAccount *sea)
     }
 
     mapExtAccounts.erase(idAccount);
+    sea->EraseLookAheadKeys();
     sea->FreeChains();
     delete sea;
     return 0;
@@ -7571,8 +8832,10 @@ int CHDWallet::PrepareLookahead()
 {
     WalletLogPrintf("Preparing Lookahead pools.\n");
 
+    m_lookahead_index.clear();
     for (auto it = mapExtAccounts.cbegin(); it != mapExtAccounts.cend(); ++it) {
         CExtKeyAccount *sea = it->second;
+        sea->nLookAhead = 0; // Index is cleared
         sea->ClearLookAhead();
         for (size_t i = 0; i < sea->vExtKeys.size(); ++i) {
             CStoredExtKey *sek = sea->vExtKeys[i];
@@ -7585,7 +8848,8 @@ int CHDWallet::PrepareLookahead()
                     nLookAhead = GetCompressedInt64(itV->second, nLookAhead);
                 }
 
-                sea->AddLookAhead(i, (uint32_t)nLookAhead);
+                sea->QueueLookAhead(i, (uint32_t)nLookAhead);
+                m_lookahead_pending = true;
             }
         }
     }
@@ -7593,6 +8857,31 @@ int CHDWallet::PrepareLookahead()
     return 0;
 };
 
+void CHDWallet::DerivePendingLookahead() const
+{
+    if (!m_lookahead_pending) {
+        return;
+    }
+    m_lookahead_pending = false;
+
+    int64_t nTimeStart = GetTimeMicros();
+    size_t nPending = 0;
+    for (auto it = mapExtAccounts.cbegin(); it != mapExtAccounts.cend(); ++it) {
+        nPending += it->second->NumPendingLookAhead();
+    }
+    if (nPending == 0) {
+        return;
+    }
+    m_lookahead_index.reserve(m_lookahead_index.size() + nPending);
+    for (auto it = mapExtAccounts.cbegin(); it != mapExtAccounts.cend(); ++it) {
+        if (0 != it->second->AddPendingLookAhead()) {
+            WalletLogPrintf("%s: AddPendingLookAhead failed for account %s.\n", __func__, it->second->GetIDString58());
+        }
+    }
+    WalletLogPrintf("Derived %u lookahead keys in %.2fms, index size %u, %u bytes.\n",
+        nPending, (GetTimeMicros() - nTimeStart) * 0.001, m_lookahead_index.size(), m_lookahead_index.DynamicMemoryUsage());
+};
+
 int CHDWallet::ExtKeyAppendToPack(CHDWalletDB *pwdb, CExtKeyAccount *sea, const CKeyID &idKey, const CEKAKey &ak, bool &fUpdateAcc) const
 {
     // Must call WriteExtAccount after
@@ -7657,6 +8946,7 @@ int CHDWallet::ExtKeyAppendToPack(CHDWalletDB *pwdb, CExtKeyAccount *sea, const
 int CHDWallet::ExtKeySaveKey(CHDWalletDB *pwdb, CExtKeyAccount *sea, const CKeyID &keyId, const CEKAKey &ak) const
 {
     LogPrint(BCLog::HDWALLET, "%s %s %s.\n", __func__, sea->GetIDString58(), EncodeDestination(PKHash(keyId)));
+    DerivePendingLookahead();
 
     size_t nChain = ak.nParent;
     bool fUpdateAccTmp, fUpdateAcc = false;
@@ -7667,7 +8957,7 @@ int CHDWallet::ExtKeySaveKey(CHDWalletDB *pwdb, CExtKeyAccount *sea, const CKeyI
             return false; // already saved
         }
 
-        if (sea->mapLookAhead.erase(keyId) != 1) {
+        if (!sea->EraseLookAhead(keyId)) {
             WalletLogPrintf("Warning: SaveKey %s key not found in look ahead %s.\n", sea->GetIDString58(), EncodeDestination(PKHash(keyId)));
         }
 
@@ -7696,7 +8986,7 @@ int CHDWallet::ExtKeySaveKey(CHDWalletDB *pwdb, CExtKeyAccount *sea, const CKeyI
                     }
 
                     CKeyID idkExtra = pk.GetID();
-                    if (sea->mapLookAhead.erase(idkExtra) != 1) {
+                    if (!sea->EraseLookAhead(idkExtra)) {
                         WalletLogPrintf("Warning: SaveKey %s key not found in look ahead %s.\n", sea->GetIDString58(), EncodeDestination(PKHash(idkExtra)));
                     }
 
@@ -8006,6 +9296,7 @@ int CHDWallet::NewKeyFromAccount(CHDWalletDB *pwdb, const CKeyID &idAccount, CPu
         }
     }
 
+    DerivePendingLookahead();
     sea->SaveKey(idKey, ks); // remove from lookahead, add to pool, add new lookahead
 
     if (plabel) {
@@ -8596,7 +9887,8 @@ int CHDWallet::NewExtKeyFromAccount(CHDWalletDB *pwdb, const CKeyID &idAccount,
     if (mvi != sekOut->mapValue.end()) {
         nLookAhead = GetCompressedInt64(mvi->second, nLookAhead);
     }
-    sea->AddLookAhead(chainNo, nLookAhead);
+    sea->QueueLookAhead(chainNo, nLookAhead);
+    m_lookahead_pending = true;
 
     mapExtKeys[idNewChain] = sekOut;
 
@@ -10248,6 +11540,13 @@ int CHDWallet::UnloadSpent(const uint256 &wtxid, int depth, const uint256 &wtxid
         }
     }
 
+    for (unsigned int i = 0; i < thisTx.tx->GetNumVOuts(); i++) {
+        const auto &txout = thisTx.tx->vpout[i];
+        if (IsMine(txout.get())) {
+            m_collapsed_output_values[COutPoint(wtxid, i)] = txout->GetValue();
+        }
+    }
+
     m_collapsed_txns.insert(wtxid);
     UnloadTransaction(wtxid);
 
@@ -10322,6 +11621,7 @@ void CHDWallet::AddToSpends(const uint256& wtxid)
 
     for (const CTxIn& txin : thisTx.tx->vin) {
         AddToSpends(txin.prevout, wtxid);
+        MarkBalanceDirty(txin.prevout.hash);
         if (m_collapse_spent_mode > 0) {
             UnloadSpent(txin.prevout.hash, 1, wtxid);
         }
@@ -10698,9 +11998,7 @@ int CHDWallet::OwnBlindOut(CHDWalletDB *pwdb, const uint256 &txhash, const CTxOu
     if (pout->vRangeproof.size() < 1000) {
         int rewind_rv = 0;
         if (!nonce.IsNull()) {
-            rewind_rv = secp256k1_bulletproof_rangeproof_rewind(secp256k1_ctx_blind, blind_gens,
-                &amountOut, blindOut, pout->vRangeproof.data(), pout->vRangeproof.size(),
-                0, &pout->commitment, &secp256k1_generator_const_h, nonce.begin(), nullptr, 0);
+            rewind_rv = RewindBulletproof(pout->vRangeproof, &pout->commitment, nonce, amountOut, blindOut) ? 1 : 0;
         }
 
         // Try again with the watch_only_nonce
@@ -10730,13 +12028,11 @@ int CHDWallet::OwnBlindOut(CHDWalletDB *pwdb, const uint256 &txhash, const CTxOu
                 watch_only_nonce = scan_secret.ECDH(pk_tweaked);
                 CSHA256().Write(watch_only_nonce.begin(), 32).Finalize(watch_only_nonce.begin());
 
-                rewind_rv = secp256k1_bulletproof_rangeproof_rewind(secp256k1_ctx_blind, blind_gens,
-                    &amountOut, blindOut, pout->vRangeproof.data(), pout->vRangeproof.size(),
-                    0, &pout->commitment, &secp256k1_generator_const_h, watch_only_nonce.begin(), nullptr, 0);
+                rewind_rv = RewindBulletproof(pout->vRangeproof, &pout->commitment, watch_only_nonce, amountOut, blindOut) ? 1 : 0;
             }
         }
         if (rewind_rv != 1) {
-            return werrorN(0, "%s: secp256k1_bulletproof_rangeproof_rewind failed.", __func__);
+            return werrorN(0, "%s: RewindBulletproof failed.", __func__);
         }
 
         ExtractNarration(nonce, pout->vData, rout.sNarration);
@@ -10836,9 +12132,7 @@ int CHDWallet::OwnAnonOut(CHDWalletDB *pwdb, const uint256 &txhash, const CTxOut
     if (pout->vRangeproof.size() < 1000) {
         int rewind_rv = 0;
         if (!nonce.IsNull()) {
-            rewind_rv = secp256k1_bulletproof_rangeproof_rewind(secp256k1_ctx_blind, blind_gens,
-                &amountOut, blindOut, pout->vRangeproof.data(), pout->vRangeproof.size(),
-                0, &pout->commitment, &secp256k1_generator_const_h, nonce.begin(), nullptr, 0);
+            rewind_rv = RewindBulletproof(pout->vRangeproof, &pout->commitment, nonce, amountOut, blindOut) ? 1 : 0;
         }
 
         // Try again with the watch_only_nonce
@@ -10867,13 +12161,11 @@ int CHDWallet::OwnAnonOut(CHDWalletDB *pwdb, const uint256 &txhash, const CTxOut
                 watch_only_nonce = scan_secret.ECDH(pk_tweaked);
                 CSHA256().Write(watch_only_nonce.begin(), 32).Finalize(watch_only_nonce.begin());
 
-                rewind_rv = secp256k1_bulletproof_rangeproof_rewind(secp256k1_ctx_blind, blind_gens,
-                    &amountOut, blindOut, pout->vRangeproof.data(), pout->vRangeproof.size(),
-                    0, &pout->commitment, &secp256k1_generator_const_h, watch_only_nonce.begin(), nullptr, 0);
+                rewind_rv = RewindBulletproof(pout->vRangeproof, &pout->commitment, watch_only_nonce, amountOut, blindOut) ? 1 : 0;
             }
         }
         if (rewind_rv != 1) {
-            return werrorN(0, "%s: secp256k1_bulletproof_rangeproof_rewind failed.", __func__);
+            return werrorN(0, "%s: RewindBulletproof failed.", __func__);
         }
 
         ExtractNarration(nonce, pout->vData, rout.sNarration);
@@ -10974,6 +12266,10 @@ bool CHDWallet::AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx, C
 
     const uint256 &txhash = tx.GetHash();
 
+    if (IsArchivedRecord(txhash)) {
+        LoadArchivedRecord(txhash, false);
+    }
+
     // Inserts only if not exists, returns tx inserted or tx found
     std::pair<MapRecords_t::iterator, bool> ret = mapRecords.insert(std::make_pair(txhash, rtxIn));
     CTransactionRecord &rtx = ret.first->second;
@@ -11230,6 +12526,19 @@ bool CHDWallet::AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx, C
     }
 #endif
 
+    IndexRecord(txhash, rtx);
+
+    // Outputs spent by the txn change the balances of their txns
+    MarkBalanceDirty(txhash);
+    for (const auto &prevout : rtx.vin) {
+        MarkBalanceDirty(prevout.hash);
+    }
+    for (const auto &txin : tx.vin) {
+        if (!txin.IsAnonInput()) {
+            MarkBalanceDirty(txin.prevout.hash);
+        }
+    }
+
     std::string sName = GetName();
     GetMainSignals().TransactionAddedToWallet(sName, MakeTransactionRef(tx));
     ClearCachedBalances();
@@ -11875,9 +13184,13 @@ void CHDWallet::AvailableBlindedCoins(std::vector<COutputR>& vCoins, bool fOnlyS
     return;
 };
 
-bool CHDWallet::SelectBlindedCoins(const std::vector<COutputR> &vAvailableCoins, const CAmount &nTargetValue, std::vector<std::pair<MapRecords_t::const_iterator,unsigned int> > &setCoinsRet, CAmount &nValueRet, const CCoinControl *coinControl, bool random_selection) const
+bool CHDWallet::SelectBlindedCoins(const std::vector<COutputR> &vAvailableCoins, const CAmount &nTargetValue, std::vector<std::pair<MapRecords_t::const_iterator,unsigned int> > &setCoinsRet, CAmount &nValueRet, const CCoinControl *coinControl, bool random_selection,
+    const RingCoinSelectionParams *bnb_params, bool *bnb_used) const
 {
     std::vector<COutputR> vCoins(vAvailableCoins);
+    if (bnb_used) {
+        *bnb_used = false;
+    }
 
     // calculate value from preset inputs and store them
     std::vector<std::pair<MapRecords_t::const_iterator,unsigned int> > vPresetCoins;
@@ -11936,6 +13249,34 @@ bool CHDWallet::SelectBlindedCoins(const std::vector<COutputR> &vAvailableCoins,
     size_t max_descendants = (size_t)std::max<int64_t>(1, gArgs.GetArg("-limitdescendantcount", DEFAULT_DESCENDANT_LIMIT));
     bool fRejectLongChains = gArgs.GetBoolArg("-walletrejectlongchains", DEFAULT_WALLET_REJECT_LONG_CHAINS);
     bool res = nTargetValue <= nValueFromPresetInputs;
+    if (!res && bnb_params && vPresetCoins.empty()) {
+        // Only confirmed coins, the fee of unconfirmed parents isn't accounted for
+        std::vector<size_t> vCoinIndices;
+        std::vector<CAmount> vValues;
+        for (size_t i = 0; i < vCoins.size(); ++i) {
+            const COutputR &r = vCoins[i];
+            if (r.nDepth < 1) {
+                continue;
+            }
+            const COutputRecord *oR = r.rtx->second.GetOutput(r.i);
+            if (!oR) {
+                return werror("%s: GetOutput failed, %s, %d.\n", r.txhash.ToString(), r.i);
+            }
+            vCoinIndices.push_back(i);
+            vValues.push_back(oR->nValue);
+        }
+        std::vector<size_t> vSelected;
+        if (SelectCoinsBnBRing(vValues, nTargetValue, *bnb_params, vSelected, nValueRet)) {
+            for (const auto i : vSelected) {
+                const COutputR &r = vCoins[vCoinIndices[i]];
+                setCoinsRet.push_back(std::make_pair(r.rtx, r.i));
+            }
+            if (bnb_used) {
+                *bnb_used = true;
+            }
+            res = true;
+        }
+    }
     if (!res) {
         if (random_selection) {
             Shuffle(vCoins.begin(), vCoins.end(), FastRandomContext());
@@ -12689,6 +14030,10 @@ bool CHDWallet::AbandonTransaction(const uint256 &hashTx)
         return false;
     }
 
+    // Abandoned txns no longer spend their inputs
+    m_balance_ledger_valid = false;
+    m_stake_coins_valid = false;
+
     todo.insert(hashTx);
 
     while (!todo.empty()) {
@@ -12711,6 +14056,7 @@ bool CHDWallet::AbandonTransaction(const uint256 &hashTx)
                 rtx.nIndex = -1;
                 rtx.SetAbandoned();
                 walletdb.WriteTxRecord(now, rtx);
+                IndexRecord(now, rtx);
                 NotifyTransactionChanged(this, now, CT_UPDATED);
             }
 
@@ -12779,6 +14125,10 @@ void CHDWallet::MarkConflicted(const uint256 &hashBlock, int conflicting_height,
     // Do not flush the wallet here for performance reasons
     CHDWalletDB walletdb(*database, false);
 
+    // Conflicted txns no longer spend their inputs
+    m_balance_ledger_valid = false;
+    m_stake_coins_valid = false;
+
     MapRecords_t::iterator mri;
     MapWallet_t::iterator mwi;
     std::set<uint256> todo, done;
@@ -12802,6 +14152,7 @@ void CHDWallet::MarkConflicted(const uint256 &hashBlock, int conflicting_height,
                 rtx.blockHash = hashBlock;
                 rtx.block_height = conflicting_height;
                 walletdb.WriteTxRecord(now, rtx);
+                IndexRecord(now, rtx);
 
                 // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
                 TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -13121,147 +14472,228 @@ uint64_t CHDWallet::GetStakeWeight() const
     return nWeight;
 };
 
-void CHDWallet::AvailableCoinsForStaking(std::vector<COutput> &vCoins, int64_t nTime, int nHeight) const
+/** Lowest chain height at which a txn confirmed at block_height can be staked. */
+static int GetStakeMatureHeight(int block_height, bool is_coinstake)
 {
-    vCoins.clear();
-    m_greatest_txn_depth = 0;
+    int min_stake_confirmations = Params().GetStakeMinConfirmations();
+    // Depth and the required depth only increase with the chain height, search
+    // for the first height where the depth is enough.
+    auto is_mature = [&](int nHeight) {
+        int nDepth = nHeight - block_height + 1;
+        int nRequiredDepth = std::min(min_stake_confirmations-1, (int)(nHeight / 2));
+        if (nDepth < nRequiredDepth) {
+            return false;
+        }
+        if (is_coinstake && min_stake_confirmations < COINBASE_MATURITY) {
+            // min_stake_confirmations is only less than COINBASE_MATURITY in regtest mode
+            if (nDepth < std::min(COINBASE_MATURITY, (int)(nHeight / 2))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    int lo = block_height, hi = block_height + std::max(min_stake_confirmations, COINBASE_MATURITY);
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (is_mature(mid)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+};
 
-    {
-        LOCK(cs_wallet);
+void CHDWallet::UpdateStakeCandidate(const uint256 &txhash) const
+{
+    AssertLockHeld(cs_wallet);
 
-        int nHeight = ::ChainActive().Tip()->nHeight;
-        int min_stake_confirmations = Params().GetStakeMinConfirmations();
-        int nRequiredDepth = std::min(min_stake_confirmations-1, (int)(nHeight / 2));
+    auto it = m_stake_candidates.find(txhash);
+    if (it != m_stake_candidates.end()) {
+        m_stake_maturity_queue.erase(std::make_pair(it->second.mature_height, txhash));
+        if (m_stake_mature.erase(std::make_pair(it->second.block_height, txhash))) {
+            m_have_cached_stakeable_coins = false;
+        }
+        m_stake_candidates.erase(it);
+    }
+    m_stake_unconfirmed.erase(txhash);
 
-        for (const auto &walletEntry : mapWallet) {
-            const CWalletTx *pcoin = &walletEntry.second;
-            CTransactionRef tx = pcoin->tx;
+    // Depth is checked through the maturity queue, locked and already staked
+    // outputs when selecting coins.
+    StakeCandidate candidate;
+    int nDepth = 0;
+    bool is_coinstake = false;
 
-            int nDepth = pcoin->GetDepthInMainChain();
-            if (nDepth > m_greatest_txn_depth) {
-                m_greatest_txn_depth = nDepth;
+    MapWallet_t::const_iterator mwi;
+    MapRecords_t::const_iterator mri;
+    if ((mwi = mapWallet.find(txhash)) != mapWallet.end()) {
+        const CWalletTx *pcoin = &mwi->second;
+        CTransactionRef tx = pcoin->tx;
+        nDepth = pcoin->GetDepthInMainChain();
+        is_coinstake = pcoin->IsCoinStake();
+
+        for (size_t i = 0; i < tx->vpout.size(); ++i) {
+            const auto &txout = tx->vpout[i];
+            if (!txout->IsType(OUTPUT_STANDARD)) {
+                continue;
             }
-            if (nDepth < nRequiredDepth) {
+            if (txout->GetValue() < m_min_stakeable_value) {
                 continue;
             }
-            if (pcoin->IsCoinStake() && min_stake_confirmations < COINBASE_MATURITY) {
-                // min_stake_confirmations is only less than COINBASE_MATURITY in regtest mode
-                if (nDepth < std::min(COINBASE_MATURITY, (int)(nHeight / 2))) {
-                    continue;
-                }
+            if (IsSpent(txhash, i)) {
+                continue;
             }
 
-            const uint256 &wtxid = walletEntry.first;
-            for (size_t i = 0; i < tx->vpout.size(); ++i) {
-                const auto &txout = tx->vpout[i];
-                if (!txout->IsType(OUTPUT_STANDARD)) {
-                    continue;
-                }
-                if (txout->GetValue() < m_min_stakeable_value) {
-                    continue;
-                }
-                COutPoint kernel(wtxid, i);
-                if (!CheckStakeUnused(kernel)
-                     || IsSpent(wtxid, i)
-                     || IsLockedCoin(wtxid, i)) {
-                    continue;
-                }
-
-                const CScript *pscriptPubKey = txout->GetPScriptPubKey();
-                CKeyID keyID;
-                if (!particl::ExtractStakingKeyID(*pscriptPubKey, keyID)) {
-                    continue;
-                }
-
-                isminetype mine = IsMine(keyID);
-                if (!(mine & ISMINE_SPENDABLE)) {
-                    continue;
-                }
+            const CScript *pscriptPubKey = txout->GetPScriptPubKey();
+            CKeyID keyID;
+            if (!particl::ExtractStakingKeyID(*pscriptPubKey, keyID)) {
+                continue;
+            }
 
-                bool fSpendableIn = true;
-                bool fSolvableIn = true;
-                bool fNeedHardwareKey = (mine & ISMINE_HARDWARE_DEVICE);
-                if (fNeedHardwareKey) {
-                    continue;
-                }
+            isminetype mine = IsMine(keyID);
+            if (!(mine & ISMINE_SPENDABLE)) {
+                continue;
+            }
 
-                vCoins.emplace_back(pcoin, i, nDepth, fSpendableIn, fSolvableIn, true, true, fNeedHardwareKey, false);
+            bool fSpendableIn = true;
+            bool fSolvableIn = true;
+            bool fNeedHardwareKey = (mine & ISMINE_HARDWARE_DEVICE);
+            if (fNeedHardwareKey) {
+                continue;
             }
+
+            candidate.outputs.emplace_back(pcoin, i, nDepth, fSpendableIn, fSolvableIn, true, true, fNeedHardwareKey, false);
         }
+    } else
+    if ((mri = mapRecords.find(txhash)) != mapRecords.end()) {
+        const CTransactionRecord &rtx = mri->second;
+        nDepth = GetDepthInMainChain(rtx);
 
-        for (const auto &ri : mapRecords) {
-            const uint256 &txid = ri.first;
-            const CTransactionRecord &rtx = ri.second;
+        MapWallet_t::const_iterator twi = mapTempWallet.end();
+        for (const auto &r : rtx.vout) {
+            if (r.nType != OUTPUT_STANDARD) {
+                continue;
+            }
+            if (r.nValue < m_min_stakeable_value) {
+                continue;
+            }
+            if (!(r.nFlags & ORF_OWNED || r.nFlags & ORF_STAKEONLY)) {
+                continue;
+            }
+            if (IsSpent(txhash, r.n)) {
+                continue;
+            }
 
-            int nDepth = GetDepthInMainChain(rtx);
-            if (nDepth > m_greatest_txn_depth) {
-                m_greatest_txn_depth = nDepth;
+            CKeyID keyID;
+            if (!particl::ExtractStakingKeyID(r.scriptPubKey, keyID)) {
+                continue;
             }
 
-            if (nDepth < nRequiredDepth) {
+            isminetype mine = IsMine(keyID);
+            if (!(mine & ISMINE_SPENDABLE)) {
+                continue;
+            }
+            if ((mine & ISMINE_HARDWARE_DEVICE)) {
                 continue;
             }
 
-            MapWallet_t::const_iterator twi = mapTempWallet.end();
-            for (const auto &r : rtx.vout) {
-                if (r.nType != OUTPUT_STANDARD) {
-                    continue;
-                }
-                if (r.nValue < m_min_stakeable_value) {
-                    continue;
-                }
-                if (!(r.nFlags & ORF_OWNED || r.nFlags & ORF_STAKEONLY)) {
-                    continue;
-                }
-                COutPoint kernel(txid, r.n);
-                if (!CheckStakeUnused(kernel)
-                    || IsSpent(txid, r.n)
-                    || IsLockedCoin(txid, r.n)) {
-                    continue;
+            if (twi == mapTempWallet.end()
+                && (twi = mapTempWallet.find(txhash)) == mapTempWallet.end()) {
+                if (0 != InsertTempTxn(txhash, &rtx)
+                    || (twi = mapTempWallet.find(txhash)) == mapTempWallet.end()) {
+                    WalletLogPrintf("ERROR: %s - InsertTempTxn failed %s.\n", __func__, txhash.ToString());
+                    return;
                 }
+            }
 
-                CKeyID keyID;
-                if (!particl::ExtractStakingKeyID(r.scriptPubKey, keyID)) {
-                    continue;
-                }
+            bool fSpendableIn = true;
+            bool fNeedHardwareKey = false;
+            candidate.outputs.emplace_back(&twi->second, r.n, nDepth, fSpendableIn, true, true, true, fNeedHardwareKey, false);
+        }
+    }
 
-                isminetype mine = IsMine(keyID);
-                if (!(mine & ISMINE_SPENDABLE)) {
-                    continue;
-                }
-                if ((mine & ISMINE_HARDWARE_DEVICE)) {
-                    continue;
-                }
+    if (candidate.outputs.empty()) {
+        return;
+    }
+    if (nDepth < 1) {
+        // Reevaluated when the chain tip changes
+        m_stake_unconfirmed.insert(txhash);
+        return;
+    }
 
-                if (twi == mapTempWallet.end()
-                    && (twi = mapTempWallet.find(txid)) == mapTempWallet.end()) {
-                    if (0 != InsertTempTxn(txid, &rtx)
-                        || (twi = mapTempWallet.find(txid)) == mapTempWallet.end()) {
-                        WalletLogPrintf("ERROR: %s - InsertTempTxn failed %s.\n", __func__, txid.ToString());
-                        return;
-                    }
-                }
+    candidate.block_height = GetLastBlockHeight() - nDepth + 1;
+    candidate.mature_height = GetStakeMatureHeight(candidate.block_height, is_coinstake);
+    m_stake_maturity_queue.insert(std::make_pair(candidate.mature_height, txhash));
+    m_stake_candidates.emplace(txhash, std::move(candidate));
+};
 
-                bool fSpendableIn = true;
-                bool fNeedHardwareKey = false;
-                vCoins.emplace_back(&twi->second, r.n, nDepth, fSpendableIn, true, true, true, fNeedHardwareKey, false);
-            }
+void CHDWallet::UpdateStakeableCoins() const
+{
+    AssertLockHeld(cs_wallet);
+
+    int nHeight = GetLastBlockHeight();
+    if (!m_stake_coins_valid || nHeight < m_stake_coins_height) {
+        // Rebuild from the whole wallet, after a disconnect txns can lose their depth
+        m_stake_coins_valid = true;
+        m_stake_candidates.clear();
+        m_stake_maturity_queue.clear();
+        m_stake_mature.clear();
+        m_stake_unconfirmed.clear();
+        m_stake_dirty.clear();
+        for (const auto &item : mapWallet) {
+            m_stake_dirty.insert(item.first);
         }
+        for (const auto &ri : mapRecords) {
+            m_stake_dirty.insert(ri.first);
+        }
+        m_have_cached_stakeable_coins = false;
+    } else
+    if (nHeight != m_stake_coins_height || m_stake_coins_refresh_unconfirmed) {
+        m_stake_dirty.insert(m_stake_unconfirmed.begin(), m_stake_unconfirmed.end());
     }
+    m_stake_coins_height = nHeight;
+    m_stake_coins_refresh_unconfirmed = false;
 
-    Shuffle(vCoins.begin(), vCoins.end(), FastRandomContext());
-    return;
-};
+    for (const auto &txhash : m_stake_dirty) {
+        UpdateStakeCandidate(txhash);
+    }
+    m_stake_dirty.clear();
 
-bool CHDWallet::SelectCoinsForStaking(int64_t nTargetValue, int64_t nTime, int nHeight, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet, int64_t& nValueRet) const
-{
-    if (m_have_cached_stakeable_coins) {
-        Shuffle(m_cached_stakeable_coins.begin(), m_cached_stakeable_coins.end(), FastRandomContext());
+    while (!m_stake_maturity_queue.empty()
+           && m_stake_maturity_queue.begin()->first <= nHeight) {
+        const uint256 &txhash = m_stake_maturity_queue.begin()->second;
+        auto it = m_stake_candidates.find(txhash);
+        if (it != m_stake_candidates.end()) {
+            m_stake_mature.insert(std::make_pair(it->second.block_height, txhash));
+            m_have_cached_stakeable_coins = false;
+        }
+        m_stake_maturity_queue.erase(m_stake_maturity_queue.begin());
+    }
+
+    if (!m_stake_mature.empty()) {
+        m_greatest_txn_depth = nHeight - m_stake_mature.begin()->first + 1;
+    } else
+    if (!m_stake_maturity_queue.empty()) {
+        m_greatest_txn_depth = nHeight - m_stake_candidates[m_stake_maturity_queue.begin()->second].block_height + 1;
     } else {
+        m_greatest_txn_depth = 0;
+    }
+
+    if (!m_have_cached_stakeable_coins) {
         m_cached_stakeable_coins.clear();
-        AvailableCoinsForStaking(m_cached_stakeable_coins, nTime, nHeight);
+        for (const auto &item : m_stake_mature) {
+            const std::vector<COutput> &outputs = m_stake_candidates[item.second].outputs;
+            m_cached_stakeable_coins.insert(m_cached_stakeable_coins.end(), outputs.begin(), outputs.end());
+        }
         m_have_cached_stakeable_coins = true;
     }
+};
+
+bool CHDWallet::SelectCoinsForStaking(int64_t nTargetValue, int64_t nTime, int nHeight, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet, int64_t& nValueRet) const
+{
+    LOCK(cs_wallet);
+    UpdateStakeableCoins();
+    Shuffle(m_cached_stakeable_coins.begin(), m_cached_stakeable_coins.end(), FastRandomContext());
 
     std::vector<COutput> &vCoins = m_cached_stakeable_coins;
 
@@ -13272,6 +14704,12 @@ bool CHDWallet::SelectCoinsForStaking(int64_t nTargetValue, int64_t nTime, int n
         const CWalletTx *pcoin = output.tx;
         int i = output.i;
 
+        const uint256 &txhash = pcoin->GetHash();
+        if (!CheckStakeUnused(COutPoint(txhash, i))
+            || IsLockedCoin(txhash, i)) {
+            continue;
+        }
+
         // Stop if we've chosen enough inputs
         if (nValueRet >= nTargetValue) {
             break;
@@ -14246,6 +15684,39 @@ void RestartStakingThreads()
     StartThreadStakeMiner();
 };
 
+static void MaybeConsolidateWallets()
+{
+    for (const auto &pwallet : GetWallets()) {
+        if (!IsParticlWallet(pwallet.get())) {
+            continue;
+        }
+        GetParticlWallet(pwallet.get())->MaybeConsolidateCoins();
+    }
+};
+
+// Consolidation builds and signs txns under cs_wallet, which would hold up the shared scheduler thread
+static std::thread g_consolidation_thread;
+static CThreadInterrupt g_consolidation_interrupt;
+
+void StartThreadConsolidation()
+{
+    g_consolidation_interrupt.reset();
+    g_consolidation_thread = std::thread(&TraceThread<std::function<void()> >, "consolidate", std::function<void()>([] {
+        while (g_consolidation_interrupt.sleep_for(std::chrono::seconds{10})) {
+            MaybeConsolidateWallets();
+        }
+    }));
+};
+
+void StopThreadConsolidation()
+{
+    if (!g_consolidation_thread.joinable()) {
+        return;
+    }
+    g_consolidation_interrupt();
+    g_consolidation_thread.join();
+};
+
 bool IsParticlWallet(const WalletStorage *win)
 {
     return win && dynamic_cast<const CHDWallet*>(win);
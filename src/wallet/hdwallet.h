@@ -8,16 +8,30 @@
 #include <wallet/wallet.h>
 #include <wallet/hdwalletdb.h>
 #include <wallet/hdwallettypes.h>
+#include <wallet/stakearchive.h>
 
+#include <anon.h>
 #include <key_io.h>
 #include <key/extkey.h>
 #include <key/stealth.h>
 
 static const size_t DEFAULT_STEALTH_LOOKAHEAD_SIZE = 5;
+//! -blindsignthreads default, 0 = number of cores
+static const int DEFAULT_BLIND_SIGN_THREADS = 0;
+//! Maximum number of threads creating MLSAGs and range proofs for one transaction
+static const int MAX_BLIND_SIGN_THREADS = 16;
 
 //! -fallbackfee default
 static const CAmount DEFAULT_FALLBACK_FEE_PART = 20000;
 
+//! Consolidation defaults, see the "consolidation" wallet setting
+static const CAmount DEFAULT_CONSOLIDATE_THRESHOLD = 1 * COIN;
+static const size_t DEFAULT_CONSOLIDATE_MIN_INPUTS = 20;
+static const size_t DEFAULT_CONSOLIDATE_MAX_INPUTS = 50;
+static const int64_t DEFAULT_CONSOLIDATE_INTERVAL = 60 * 60;
+//! Output type names used by the "consolidation" setting, indexed by OutputTypes - 1
+static const char *const CONSOLIDATION_TYPES[3] = {"part", "blind", "anon"};
+
 typedef std::map<CKeyID, CStealthKeyMetadata> StealthKeyMetaMap;
 typedef std::map<CKeyID, CExtKeyAccount*> ExtKeyAccountMap;
 typedef std::map<CKeyID, CStoredExtKey*> ExtKeyMap;
@@ -82,6 +96,28 @@ public:
     bool GetVote(int nHeight, uint32_t &token);
 
     bool LoadTxRecords(CHDWalletDB *pwdb);
+    /** Move spent records deeper than m_lazy_load_min_depth out of memory, leaving a stub in the wallet file */
+    size_t ArchiveSpentRecords(CHDWalletDB *pwdb) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Return true if op is spent by a txn at least min_depth deep */
+    bool IsSpentDeep(const COutPoint &op, int min_depth) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    bool CanArchiveRecord(const uint256 &hash, const CTransactionRecord &rtx) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    bool IsArchivedRecord(const uint256 &hash) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { return m_archived_records.count(hash); }
+    /** Materialise an archived record and, if with_inputs is set, the archived records it spends */
+    bool LoadArchivedRecord(const uint256 &hash, bool with_inputs) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /** Index the stake archive file and track the coinstakes moved into it */
+    bool LoadStakeArchive(CHDWalletDB *pwdb) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Move spent coinstakes deeper than m_stake_archive_min_depth from the wallet file to the stake archive */
+    size_t ArchiveSpentStakes(CHDWalletDB *pwdb) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    bool CanArchiveStake(const CWalletTx &wtx) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    bool IsArchivedStake(const uint256 &hash) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { return m_archived_stakes.count(hash); }
+    /** Materialise an archived coinstake and, if with_inputs is set, the archived coinstakes it spends */
+    bool LoadArchivedStake(const uint256 &hash, bool with_inputs) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /** Consolidate small outputs if enabled and the fee rate is low, rate limited to once per interval. */
+    void MaybeConsolidateCoins();
+    /** Join up to max_inputs of the smallest confirmed outputs of type below the threshold into one output. */
+    int ConsolidateCoins(OutputTypes type, const CFeeRate &fee_rate, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     bool IsLocked() const override;
     bool EncryptWallet(const SecureString &strWalletPassphrase) override;
@@ -171,6 +207,8 @@ public:
 
     Balance GetBalance(int min_depth = 0, bool avoid_reuse = true) const override;
     bool GetBalances(CHDWalletBalances &bal, bool avoid_reuse = true) const;
+    /** Sum the balances of every txn in mapWallet and mapRecords, the balance ledger is checked against this. */
+    bool GetBalancesFullScan(CHDWalletBalances &bal, bool avoid_reuse = true) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     CAmount GetAvailableBalance(const CCoinControl* coinControl = nullptr) const override;
     CAmount GetAvailableAnonBalance(const CCoinControl* coinControl = nullptr) const;
     CAmount GetAvailableBlindBalance(const CCoinControl* coinControl = nullptr) const;
@@ -186,6 +224,19 @@ public:
     int ExpandTempRecipients(std::vector<CTempRecipient> &vecSend, CStoredExtKey *pc, std::string &sError);
 
     int AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Set the commitment and nonce of a blinded output */
+    int SetCTCommitment(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, uint64_t &nValue, std::string &sError) const;
+    /** AddCTData without wallet state, bulletproofs are created in the provided scratch space */
+    int AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, secp256k1_scratch_space *scratch, std::string &sError) const;
+    /** Add CT data for adjacent outputs covered by one aggregated bulletproof */
+    int AddAggregatedCTData(const CCoinControl *coinControl, CMutableTransaction &txNew, std::vector<CTempRecipient> &vecSend,
+        const std::vector<size_t> &vGroup, const uint256 &proof_nonce, secp256k1_scratch_space *scratch, std::string &sError) const;
+    /**
+     * Add CT data for the recipients in vecSend at the given indices, spread over the signing threads.
+     * Adjacent outputs share aggregated bulletproofs once active, except nSeparate which gets its own proof.
+     */
+    int AddCTDataParallel(const CCoinControl *coinControl, CMutableTransaction &txNew, std::vector<CTempRecipient> &vecSend,
+        const std::vector<size_t> &vIndices, int nSeparate, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     bool SetChangeDest(const CCoinControl *coinControl, CTempRecipient &r, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
@@ -220,6 +271,11 @@ public:
 
 
     void ClearCachedBalances() override;
+    void MarkBalanceDirty(const uint256 &hash) const override;
+    void IndexWalletTx(const CWalletTx &wtx) override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void UnindexTx(const uint256 &hash) override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void ArchiveSpentTxns() override;
+    void IndexRecord(const uint256 &hash, const CTransactionRecord &rtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool LoadToWallet(const uint256& hash, const UpdateWalletTxFn& fill_wtx) override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void LoadToWallet(const uint256 &hash, CTransactionRecord &rtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
@@ -284,6 +340,9 @@ public:
     int ExtKeyRemoveAccountFromMapsAndFree(const CKeyID &idAccount) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     int ExtKeyLoadAccountPacks();
     int PrepareLookahead();
+    /** Derive queued account lookahead keys in one pass, cs_wallet must be held
+     *  fake const for IsMine */
+    void DerivePendingLookahead() const;
 
     int ExtKeyAppendToPack(CHDWalletDB *pwdb, CExtKeyAccount *sea, const CKeyID &idKey, const CEKAKey &ak, bool &fUpdateAcc) const;
     int ExtKeyAppendToPack(CHDWalletDB *pwdb, CExtKeyAccount *sea, const CKeyID &idKey, const CEKASCKey &asck, bool &fUpdateAcc) const;
@@ -424,7 +483,9 @@ public:
         const CCoinControl& coin_control, CoinSelectionParams& coin_selection_params, bool& bnb_used) const override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     void AvailableBlindedCoins(std::vector<COutputR>& vCoins, bool fOnlySafe=true, const CCoinControl *coinControl = nullptr, const CAmount& nMinimumAmount = 1, const CAmount& nMaximumAmount = MAX_MONEY, const CAmount& nMinimumSumAmount = MAX_MONEY, const uint64_t& nMaximumCount = 0) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
-    bool SelectBlindedCoins(const std::vector<COutputR>& vAvailableCoins, const CAmount& nTargetValue, std::vector<std::pair<MapRecords_t::const_iterator,unsigned int> > &setCoinsRet, CAmount &nValueRet, const CCoinControl *coinControl = nullptr, bool random_selection = false) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** bnb_params enables a changeless branch and bound search, tried before the other selectors. */
+    bool SelectBlindedCoins(const std::vector<COutputR>& vAvailableCoins, const CAmount& nTargetValue, std::vector<std::pair<MapRecords_t::const_iterator,unsigned int> > &setCoinsRet, CAmount &nValueRet, const CCoinControl *coinControl = nullptr, bool random_selection = false,
+        const RingCoinSelectionParams *bnb_params = nullptr, bool *bnb_used = nullptr) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     void AvailableAnonCoins(std::vector<COutputR> &vCoins, bool fOnlySafe=true, const CCoinControl *coinControl = nullptr, const CAmount& nMinimumAmount = 1, const CAmount& nMaximumAmount = MAX_MONEY, const CAmount& nMinimumSumAmount = MAX_MONEY, const uint64_t& nMaximumCount = 0) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
@@ -479,7 +540,8 @@ public:
     bool SetReserveBalance(CAmount nNewReserveBalance);
     void SetStakeLimitHeight(int stake_limit);
     uint64_t GetStakeWeight() const;
-    void AvailableCoinsForStaking(std::vector<COutput> &vCoins, int64_t nTime, int nHeight) const;
+    void UpdateStakeCandidate(const uint256 &txhash) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void UpdateStakeableCoins() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool SelectCoinsForStaking(int64_t nTargetValue, int64_t nTime, int nHeight, std::set<std::pair<const CWalletTx*,unsigned int> > &setCoinsRet, int64_t &nValueRet) const;
     bool CreateCoinStake(unsigned int nBits, int64_t nTime, int nBlockHeight, int64_t nFees, CMutableTransaction &txNew, CKey &key);
     bool SignBlock(CBlockTemplate *pblocktemplate, int nHeight, int64_t nSearchTime);
@@ -499,6 +561,21 @@ public:
     mutable std::atomic_bool m_have_spendable_balance_cached {false};
     mutable CAmount m_spendable_balance_cached = 0;
 
+    /**
+     * Balance ledger, the contribution of each txn to GetBalances and their sum.
+     * Txns are recalculated when marked dirty, volatile txns (unconfirmed,
+     * immature or below nMinRCTOutputDepth) also when the chain tip or the
+     * mempool changes.
+     */
+    mutable std::map<uint256, CHDWalletBalances> m_balance_ledger GUARDED_BY(cs_wallet);
+    mutable CHDWalletBalances m_balance_ledger_total GUARDED_BY(cs_wallet);
+    mutable std::set<uint256> m_balance_ledger_volatile GUARDED_BY(cs_wallet);
+    mutable std::set<uint256> m_balance_ledger_dirty GUARDED_BY(cs_wallet);
+    mutable bool m_balance_ledger_valid GUARDED_BY(cs_wallet) = false;
+    mutable int m_balance_ledger_height GUARDED_BY(cs_wallet) = -1;
+    mutable std::atomic_bool m_balance_ledger_refresh_volatile {false};
+    bool m_check_balance_ledger = false; // Compare the ledger to a full scan on every GetBalances call
+
     enum eStakingState {
         NOT_STAKING = 0,
         IS_STAKING = 1,
@@ -518,11 +595,14 @@ public:
     ExtKeyMap mapExtKeys;
     mutable LooseKeyMap mapLooseKeys;       // Keys derived from extkeys not attached to an account
     mutable LooseKeyMap mapLooseLookAhead;
+    mutable AccLookAheadMap m_lookahead_index; // Lookahead keys of all accounts
+    mutable bool m_lookahead_pending = false;  // Some accounts have queued lookahead keys
 
     mutable MapWallet_t mapTempWallet;
 
     MapRecords_t mapRecords;
     RtxOrdered_t rtxOrdered;
+    CTxFilterIndex m_tx_filter_index GUARDED_BY(cs_wallet);
     mutable MapRecords_t mapTempRecords; // Hack for sending unmined inputs through fundrawtransactionfrom
 
     std::vector<CVoteToken> vVoteTokens;
@@ -536,6 +616,27 @@ public:
     CTxDestination m_reward_address = CNoDestination();
     int nStakeLimitHeight = 0; // for regtest, don't stake above nStakeLimitHeight
 
+    /**
+     * Stakeable coins, maintained incrementally.
+     * Txns with unspent stakeable outputs are queued by the height at which they
+     * reach the staking depth and move to m_stake_mature when the chain gets there.
+     * Txns marked dirty are reevaluated before the next staking round, unconfirmed
+     * txns also when the chain tip changes.
+     * m_cached_stakeable_coins is rebuilt only when the set of mature txns changes.
+     */
+    struct StakeCandidate {
+        int block_height = 0;
+        int mature_height = 0;
+        std::vector<COutput> outputs;
+    };
+    mutable std::map<uint256, StakeCandidate> m_stake_candidates GUARDED_BY(cs_wallet);
+    mutable std::set<std::pair<int, uint256> > m_stake_maturity_queue GUARDED_BY(cs_wallet); // (mature_height, txid)
+    mutable std::set<std::pair<int, uint256> > m_stake_mature GUARDED_BY(cs_wallet); // (block_height, txid)
+    mutable std::set<uint256> m_stake_unconfirmed GUARDED_BY(cs_wallet);
+    mutable std::set<uint256> m_stake_dirty GUARDED_BY(cs_wallet);
+    mutable int m_stake_coins_height GUARDED_BY(cs_wallet) = -1;
+    mutable std::atomic_bool m_stake_coins_valid {false};
+    mutable std::atomic_bool m_stake_coins_refresh_unconfirmed {false};
     mutable std::atomic_bool m_have_cached_stakeable_coins {false};
     mutable std::vector<COutput> m_cached_stakeable_coins;
 
@@ -546,12 +647,58 @@ public:
     size_t prefer_max_num_anon_inputs = 5; // if > x anon inputs are randomly selected attempt to reduce
     int m_mixin_selection_mode_default = 1;
     secp256k1_scratch_space *m_blind_scratch = nullptr;
+    int m_blind_sign_threads = 1; // Threads creating MLSAGs and range proofs, set from -blindsignthreads
 
     int m_collapse_spent_mode = 0;
     int m_min_collapse_depth = 3;
     std::map<uint256, std::set<uint256> > mapTxCollapsedSpends;
     std::set<uint256> m_collapsed_txns;
     std::set<COutPoint> m_collapsed_txn_inputs;
+    //! Values of owned outputs of txns no longer loaded, for the inputs of coinstakes archived later
+    std::map<COutPoint, CAmount> m_collapsed_output_values;
+
+    bool m_lazy_load_records = false;
+    int m_lazy_load_min_depth = 100;
+    std::set<uint256> m_archived_records GUARDED_BY(cs_wallet); // Records in the wallet file only as a stub
+
+    bool m_stake_archive_enabled = false;
+    int m_stake_archive_min_depth = 1000;
+    std::unique_ptr<CStakeArchive> m_stake_archive GUARDED_BY(cs_wallet);
+    std::set<uint256> m_archived_stakes GUARDED_BY(cs_wallet); // Coinstakes only in the stake archive
+    std::map<std::string, CStakeArchiveTotals> m_stake_archive_months GUARDED_BY(cs_wallet); // By "YYYY-MM"
+
+    struct LoadStats {
+        int64_t load_time_ms = 0;
+        int64_t records_time_ms = 0;
+        size_t records_loaded = 0;
+        size_t records_archived = 0;
+        size_t records_restored = 0;
+        size_t stakes_archived = 0;
+    } m_load_stats;
+
+    struct ConsolidationSettings {
+        bool enabled = false;
+        bool types[3] = {true, true, true}; // Standard, blind and anon, indexed by OutputTypes - 1
+        CAmount threshold = DEFAULT_CONSOLIDATE_THRESHOLD; // Outputs below this value are joined
+        size_t min_inputs = DEFAULT_CONSOLIDATE_MIN_INPUTS;
+        size_t max_inputs = DEFAULT_CONSOLIDATE_MAX_INPUTS;
+        CFeeRate max_fee_rate{DEFAULT_TRANSACTION_MINFEE};
+        int64_t interval = DEFAULT_CONSOLIDATE_INTERVAL;
+        size_t ring_size = DEFAULT_RING_SIZE;
+    } m_consolidation GUARDED_BY(cs_wallet);
+
+    struct ConsolidationStats {
+        int64_t last_check = 0;
+        int64_t next_check = 0;
+        size_t skipped_fee = 0; // Checks skipped as the fee rate was above max_fee_rate
+        size_t planned[3] = {0, 0, 0};
+        size_t planned_inputs[3] = {0, 0, 0};
+        size_t executed[3] = {0, 0, 0};
+        size_t executed_inputs[3] = {0, 0, 0};
+        size_t failed[3] = {0, 0, 0};
+        uint256 last_txid;
+        std::string last_error;
+    } m_consolidation_stats GUARDED_BY(cs_wallet);
 
     int64_t m_smsg_fee_rate_target = 0;
     uint32_t m_smsg_difficulty_target = 0; // 0 = auto
@@ -570,6 +717,11 @@ public:
 private:
     void ParseAddressForMetaData(const CTxDestination &addr, COutputRecord &rec);
 
+    void AddWalletTxBalances(const CWalletTx &wtx, CHDWalletBalances &bal, isminefilter reuse_filter, bool &is_volatile) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void AddRecordBalances(const uint256 &txhash, const CTransactionRecord &rtx, CHDWalletBalances &bal, bool allow_used_addresses, bool &is_volatile) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void UpdateBalanceLedgerEntry(const uint256 &txhash) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void UpdateBalanceLedger() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     template<typename... Params>
     bool werror(std::string fmt, Params... parameters) const {
         return error(("%s " + fmt).c_str(), GetDisplayName(), parameters...);
@@ -610,6 +762,9 @@ int64_t CalculateMaximumSignedTxSize(const CTransaction &tx, const CHDWallet *wa
 int64_t CalculateMaximumSignedTxSize(const CTransaction &tx, const CHDWallet *wallet, const std::vector<CTxOutBaseRef>& txouts);
 
 void RestartStakingThreads();
+/** Periodically consolidate the outputs of wallets with consolidation enabled, on a thread of its own */
+void StartThreadConsolidation();
+void StopThreadConsolidation();
 
 bool IsParticlWallet(const WalletStorage *win);
 CHDWallet *GetParticlWallet(WalletStorage *win);
@@ -230,6 +230,33 @@ bool CHDWalletDB::EraseTxRecord(const uint256 &hash)
     return EraseIC(std::make_pair(std::string("rtx"), hash));
 };
 
+bool CHDWalletDB::ReadArchivedTxRecord(const uint256 &hash, CTransactionRecord &rtx, uint32_t nFlags)
+{
+    return m_batch->Read(std::make_pair(std::string("rtxa"), hash), rtx, nFlags);
+};
+
+bool CHDWalletDB::WriteArchivedTxRecord(const uint256 &hash, const CTransactionRecord &rtx, const CTransactionRecordStub &stub)
+{
+    return WriteIC(std::make_pair(std::string("rtxa"), hash), rtx, true)
+        && WriteIC(std::make_pair(std::string("rtxs"), hash), stub, true);
+};
+
+bool CHDWalletDB::EraseArchivedTxRecord(const uint256 &hash)
+{
+    return EraseIC(std::make_pair(std::string("rtxa"), hash))
+        && EraseIC(std::make_pair(std::string("rtxs"), hash));
+};
+
+bool CHDWalletDB::WriteArchivedStake(const uint256 &hash, const CArchivedStakeStub &stub)
+{
+    return WriteIC(std::make_pair(std::string("stka"), hash), stub, true);
+};
+
+bool CHDWalletDB::EraseArchivedStake(const uint256 &hash)
+{
+    return EraseIC(std::make_pair(std::string("stka"), hash));
+};
+
 
 bool CHDWalletDB::ReadStoredTx(const uint256 &hash, CStoredTransaction &stx, uint32_t nFlags)
 {
@@ -72,7 +72,10 @@ prefixes
 
     ris                 - reverse stealth index key: hashed raw stealth address bytes, value: uint32_t
     rtx                 - CTransactionRecord
+    rtxa                - CTransactionRecord, archived by lazy load mode
+    rtxs                - CTransactionRecordStub, loaded in place of the archived record
 
+    stka                - CArchivedStakeStub, kept for a coinstake moved to the stake archive
     stx                 - CStoredTransaction
     sxad                - loose stealth address
     sxkm                - key meta data for keys received on stealth while wallet locked
@@ -87,6 +90,8 @@ prefixes
 */
 
 class CTransactionRecord;
+class CTransactionRecordStub;
+class CArchivedStakeStub;
 class CStoredTransaction;
 
 
@@ -391,6 +396,13 @@ public:
     bool WriteTxRecord(const uint256 &hash, const CTransactionRecord &rtx);
     bool EraseTxRecord(const uint256 &hash);
 
+    bool ReadArchivedTxRecord(const uint256 &hash, CTransactionRecord &rtx, uint32_t nFlags=DB_READ_UNCOMMITTED);
+    bool WriteArchivedTxRecord(const uint256 &hash, const CTransactionRecord &rtx, const CTransactionRecordStub &stub);
+    bool EraseArchivedTxRecord(const uint256 &hash);
+
+    bool WriteArchivedStake(const uint256 &hash, const CArchivedStakeStub &stub);
+    bool EraseArchivedStake(const uint256 &hash);
+
 
     bool ReadStoredTx(const uint256 &hash, CStoredTransaction &stx, uint32_t nFlags=DB_READ_UNCOMMITTED);
     bool WriteStoredTx(const uint256 &hash, const CStoredTransaction &stx);
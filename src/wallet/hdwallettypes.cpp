@@ -4,6 +4,11 @@
 
 #include <wallet/hdwallettypes.h>
 
+#include <hash.h>
+#include <script/standard.h>
+
+#include <algorithm>
+
 int CTransactionRecord::InsertOutput(COutputRecord &r)
 {
     for (size_t i = 0; i < vout.size(); ++i) {
@@ -110,3 +115,105 @@ bool CStoredTransaction::GetAnonPubkey(int n, CCmpPubKey &anon_pubkey) const
     anon_pubkey = ((CTxOutRingCT*)pout)->pk;
     return true;
 }
+
+bool CTxFilterIndex::GetAddressKey(const CTxDestination &dest, uint160 &key)
+{
+    // Addresses are indexed in the form filtertransactions displays them
+    if (!IsValidDestination(dest) ||
+        dest.type() == typeid(CStealthAddress) ||
+        dest.type() == typeid(CExtPubKey)) {
+        return false;
+    }
+    CScript script = GetScriptForDestination(dest);
+    key = Hash160(script);
+    return true;
+}
+
+void CTxFilterIndex::Insert(const uint256 &hash, int64_t time, uint32_t sets, const std::vector<CScript> &scripts)
+{
+    std::vector<uint160> addresses;
+    for (const auto &script : scripts) {
+        CTxDestination dest;
+        uint160 id;
+        if (!ExtractDestination(script, dest) ||
+            !GetAddressKey(dest, id) ||
+            std::find(addresses.begin(), addresses.end(), id) != addresses.end()) {
+            continue;
+        }
+        addresses.push_back(id);
+    }
+
+    // Leave unchanged entries in place, callers may be iterating the sets
+    auto it = m_entries.find(hash);
+    if (it != m_entries.end() &&
+        it->second.time == time &&
+        it->second.sets == sets &&
+        it->second.addresses == addresses) {
+        return;
+    }
+    Erase(hash);
+
+    const Key k(time, hash);
+    for (int i = 0; i < TFI_MAX; ++i) {
+        if (sets & (1 << i)) {
+            m_sets[i].insert(k);
+        }
+    }
+    for (const auto &id : addresses) {
+        m_address[id].insert(k);
+    }
+
+    Entry &entry = m_entries[hash];
+    entry.time = time;
+    entry.sets = sets;
+    entry.addresses = std::move(addresses);
+}
+
+void CTxFilterIndex::Erase(const uint256 &hash)
+{
+    auto it = m_entries.find(hash);
+    if (it == m_entries.end()) {
+        return;
+    }
+    const Entry &entry = it->second;
+    const Key k(entry.time, hash);
+    for (int i = 0; i < TFI_MAX; ++i) {
+        if (entry.sets & (1 << i)) {
+            m_sets[i].erase(k);
+        }
+    }
+    for (const auto &id : entry.addresses) {
+        auto mi = m_address.find(id);
+        if (mi == m_address.end()) {
+            continue;
+        }
+        mi->second.erase(k);
+        if (mi->second.empty()) {
+            m_address.erase(mi);
+        }
+    }
+    m_entries.erase(it);
+}
+
+void CTxFilterIndex::Clear()
+{
+    m_entries.clear();
+    for (int i = 0; i < TFI_MAX; ++i) {
+        m_sets[i].clear();
+    }
+    m_address.clear();
+}
+
+bool CTxFilterIndex::GetAddressSet(const CTxDestination &dest, const KeySet *&set) const
+{
+    set = nullptr;
+    uint160 id;
+    if (!GetAddressKey(dest, id)) {
+        return false;
+    }
+    auto mi = m_address.find(id);
+    if (mi != m_address.end()) {
+        set = &mi->second;
+    }
+    return true;
+}
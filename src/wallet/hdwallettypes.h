@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -295,6 +296,131 @@ public:
     CAmount nAnonWatchOnly = 0;
     CAmount nAnonWatchOnlyUnconf = 0;
     CAmount nAnonWatchOnlyImmature = 0;
+
+    CHDWalletBalances &operator+=(const CHDWalletBalances &b)
+    {
+        nPart += b.nPart;
+        nPartUnconf += b.nPartUnconf;
+        nPartStaked += b.nPartStaked;
+        nPartImmature += b.nPartImmature;
+        nPartWatchOnly += b.nPartWatchOnly;
+        nPartWatchOnlyUnconf += b.nPartWatchOnlyUnconf;
+        nPartWatchOnlyStaked += b.nPartWatchOnlyStaked;
+        nPartWatchOnlyImmature += b.nPartWatchOnlyImmature;
+        nBlind += b.nBlind;
+        nBlindUnconf += b.nBlindUnconf;
+        nBlindWatchOnly += b.nBlindWatchOnly;
+        nBlindWatchOnlyUnconf += b.nBlindWatchOnlyUnconf;
+        nAnon += b.nAnon;
+        nAnonUnconf += b.nAnonUnconf;
+        nAnonImmature += b.nAnonImmature;
+        nAnonWatchOnly += b.nAnonWatchOnly;
+        nAnonWatchOnlyUnconf += b.nAnonWatchOnlyUnconf;
+        nAnonWatchOnlyImmature += b.nAnonWatchOnlyImmature;
+        return *this;
+    }
+
+    CHDWalletBalances &operator-=(const CHDWalletBalances &b)
+    {
+        nPart -= b.nPart;
+        nPartUnconf -= b.nPartUnconf;
+        nPartStaked -= b.nPartStaked;
+        nPartImmature -= b.nPartImmature;
+        nPartWatchOnly -= b.nPartWatchOnly;
+        nPartWatchOnlyUnconf -= b.nPartWatchOnlyUnconf;
+        nPartWatchOnlyStaked -= b.nPartWatchOnlyStaked;
+        nPartWatchOnlyImmature -= b.nPartWatchOnlyImmature;
+        nBlind -= b.nBlind;
+        nBlindUnconf -= b.nBlindUnconf;
+        nBlindWatchOnly -= b.nBlindWatchOnly;
+        nBlindWatchOnlyUnconf -= b.nBlindWatchOnlyUnconf;
+        nAnon -= b.nAnon;
+        nAnonUnconf -= b.nAnonUnconf;
+        nAnonImmature -= b.nAnonImmature;
+        nAnonWatchOnly -= b.nAnonWatchOnly;
+        nAnonWatchOnlyUnconf -= b.nAnonWatchOnlyUnconf;
+        nAnonWatchOnlyImmature -= b.nAnonWatchOnlyImmature;
+        return *this;
+    }
+
+    bool IsNull() const
+    {
+        return nPart == 0
+            && nPartUnconf == 0
+            && nPartStaked == 0
+            && nPartImmature == 0
+            && nPartWatchOnly == 0
+            && nPartWatchOnlyUnconf == 0
+            && nPartWatchOnlyStaked == 0
+            && nPartWatchOnlyImmature == 0
+            && nBlind == 0
+            && nBlindUnconf == 0
+            && nBlindWatchOnly == 0
+            && nBlindWatchOnlyUnconf == 0
+            && nAnon == 0
+            && nAnonUnconf == 0
+            && nAnonImmature == 0
+            && nAnonWatchOnly == 0
+            && nAnonWatchOnlyUnconf == 0
+            && nAnonWatchOnlyImmature == 0;
+    }
+
+    friend bool operator==(const CHDWalletBalances &a, const CHDWalletBalances &b)
+    {
+        return a.nPart == b.nPart
+            && a.nPartUnconf == b.nPartUnconf
+            && a.nPartStaked == b.nPartStaked
+            && a.nPartImmature == b.nPartImmature
+            && a.nPartWatchOnly == b.nPartWatchOnly
+            && a.nPartWatchOnlyUnconf == b.nPartWatchOnlyUnconf
+            && a.nPartWatchOnlyStaked == b.nPartWatchOnlyStaked
+            && a.nPartWatchOnlyImmature == b.nPartWatchOnlyImmature
+            && a.nBlind == b.nBlind
+            && a.nBlindUnconf == b.nBlindUnconf
+            && a.nBlindWatchOnly == b.nBlindWatchOnly
+            && a.nBlindWatchOnlyUnconf == b.nBlindWatchOnlyUnconf
+            && a.nAnon == b.nAnon
+            && a.nAnonUnconf == b.nAnonUnconf
+            && a.nAnonImmature == b.nAnonImmature
+            && a.nAnonWatchOnly == b.nAnonWatchOnly
+            && a.nAnonWatchOnlyUnconf == b.nAnonWatchOnlyUnconf
+            && a.nAnonWatchOnlyImmature == b.nAnonWatchOnlyImmature;
+    }
+};
+
+/** Compact form of a spent CTransactionRecord, loaded in place of the full
+ *  record when the wallet lazy loads records. */
+class CTransactionRecordStub
+{
+public:
+    int64_t nTime = 0;
+    uint32_t nFilterSets = 0;
+    std::vector<COutPoint> vin;
+    std::vector<CScript> vScripts;
+    std::vector<std::pair<uint32_t, CAmount> > vOutputValues; // Owned outputs, for the inputs of txns archived later
+
+    SERIALIZE_METHODS(CTransactionRecordStub, obj)
+    {
+        READWRITE(obj.nTime);
+        READWRITE(obj.nFilterSets);
+        READWRITE(obj.vin);
+        READWRITE(obj.vScripts);
+        READWRITE(obj.vOutputValues);
+    }
+};
+
+/** Kept in the wallet file for a coinstake moved to the stake archive */
+class CArchivedStakeStub
+{
+public:
+    std::vector<COutPoint> vin;
+    std::vector<std::pair<uint32_t, CAmount> > vOutputValues; // Owned outputs, for the inputs of txns archived later
+
+    SERIALIZE_METHODS(CArchivedStakeStub, obj)
+    {
+        READWRITE(obj.vin);
+        READWRITE(obj.vOutputValues);
+    }
 };
 
 class CStoredTransaction
@@ -314,4 +440,51 @@ public:
     }
 };
 
+/** Secondary indexes over the wallet transactions and records, used by
+ *  filtertransactions to visit only the entries a query can match.
+ *  Every set is ordered by (time, txid).
+ */
+class CTxFilterIndex
+{
+public:
+    typedef std::pair<int64_t, uint256> Key;
+    typedef std::set<Key> KeySet;
+
+    enum IndexType
+    {
+        TFI_WTX = 0,            // All wallet transactions
+        TFI_RTX,                // All transaction records
+        TFI_STAKE,              // Coinstake wallet transactions
+        TFI_RTX_STANDARD,       // Records with plain outputs
+        TFI_RTX_BLIND,          // Records with blind outputs or inputs
+        TFI_RTX_ANON,           // Records with anon outputs or inputs
+        TFI_MAX,
+    };
+
+    /** Index hash at time in the sets given by the IndexType bitmask, replaces any previous entry. */
+    void Insert(const uint256 &hash, int64_t time, uint32_t sets, const std::vector<CScript> &scripts);
+    void Erase(const uint256 &hash);
+    void Clear();
+
+    const KeySet &GetSet(IndexType type) const { return m_sets[type]; }
+    /** Return false if dest is not indexed by address, else set points to the
+     *  entries with an output to dest, nullptr if there are none. */
+    bool GetAddressSet(const CTxDestination &dest, const KeySet *&set) const;
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry
+    {
+        int64_t time;
+        uint32_t sets;
+        std::vector<uint160> addresses;
+    };
+    static bool GetAddressKey(const CTxDestination &dest, uint160 &key);
+
+    std::map<uint256, Entry> m_entries;
+    KeySet m_sets[TFI_MAX];
+    std::map<uint160, KeySet> m_address;
+};
+
 #endif // PARTICL_WALLET_HDWALLETTYPES_H
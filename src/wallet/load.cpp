@@ -144,6 +144,9 @@ void StartWallets(CScheduler& scheduler, const ArgsManager& args)
         scheduler.scheduleEvery(MaybeCompactWalletDB, std::chrono::milliseconds{500});
     }
     scheduler.scheduleEvery(MaybeResendWalletTxs, std::chrono::milliseconds{1000});
+    if (fParticlMode) {
+        StartThreadConsolidation();
+    }
 }
 
 void FlushWallets()
@@ -155,6 +158,7 @@ void FlushWallets()
 
 void StopWallets()
 {
+    StopThreadConsolidation();
     for (const std::shared_ptr<CWallet>& pwallet : GetWallets()) {
         pwallet->Close();
     }
@@ -293,6 +293,15 @@ static int AccountInfo(CHDWallet *pwallet, CExtKeyAccount *pa, int nShowKeys, bo
     if (nShowKeys > 2) { // dumpwallet
         obj.pushKV("stealth_address_pack", (int)pa->nPackStealth);
         obj.pushKV("stealth_keys_received_pack", (int)pa->nPackStealthKeys);
+    } else {
+        // The lookahead index is shared by all accounts in the wallet
+        UniValue objL(UniValue::VOBJ);
+        objL.pushKV("num_keys", (uint64_t)pa->NumLookAhead());
+        objL.pushKV("num_pending", (uint64_t)pa->NumPendingLookAhead());
+        objL.pushKV("index_size", (uint64_t)pwallet->m_lookahead_index.size());
+        objL.pushKV("index_capacity", (uint64_t)pwallet->m_lookahead_index.capacity());
+        objL.pushKV("index_memory_bytes", (uint64_t)pwallet->m_lookahead_index.DynamicMemoryUsage());
+        obj.pushKV("lookahead", objL);
     }
 
 
@@ -3698,6 +3707,9 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
                             {"show_anon_spends", RPCArg::Type::BOOL, /* default */ "false", "Display inputs for anon transactions"},
                             {"show_change", RPCArg::Type::BOOL, /* default */ "false", "Display change outputs (for anon and blind txns)"},
                             {"show_smsg_fees", RPCArg::Type::BOOL, /* default */ "false", "List the smsgids funded by the transactions"},
+                            {"cursor", RPCArg::Type::STR, /* default */ "", "Continue after the last transaction of a previous page, \"\" to start at the first page.\n"
+                    "                  Only valid when sorting by time, the result is returned as an object with the\n"
+                    "                  transactions in \"tx\" and the cursor for the next page in \"next_cursor\""},
                         },
                         "options"},
                 },
@@ -3740,6 +3752,8 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
     bool show_anon_spends = false;
     bool show_change = false;
     bool show_smsg_fees = false;
+    bool fHaveCursor = false;
+    CTxFilterIndex::Key cursor_key;
 
     if (!request.params[0].isNull()) {
         const UniValue &options = request.params[0].get_obj();
@@ -3759,7 +3773,8 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
                 {"show_blinding_factors",   UniValueType(UniValue::VBOOL)},
                 {"show_anon_spends",        UniValueType(UniValue::VBOOL)},
                 {"show_change",             UniValueType(UniValue::VBOOL)},
-                {"show_smsg_fees",       UniValueType(UniValue::VBOOL)},
+                {"show_smsg_fees",          UniValueType(UniValue::VBOOL)},
+                {"cursor",                  UniValueType(UniValue::VSTR)},
             },
             true, // allow null
             false // strict
@@ -3873,6 +3888,24 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
         if (options["show_smsg_fees"].isBool()) {
             show_smsg_fees = options["show_smsg_fees"].get_bool();
         }
+        if (options["cursor"].isStr()) {
+            if (sort != "time") {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "cursor requires sort by time.");
+            }
+            // Format is "time:txid" of the last transaction on the previous page
+            fHaveCursor = true;
+            cursor_key.first = std::numeric_limits<int64_t>::max();
+            const std::string &sCursor = options["cursor"].get_str();
+            if (!sCursor.empty()) {
+                size_t p = sCursor.find(':');
+                if (p == std::string::npos ||
+                    !ParseInt64(sCursor.substr(0, p), &cursor_key.first) ||
+                    sCursor.size() - (p + 1) != 64 || !IsHex(sCursor.substr(p + 1))) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid cursor: %s.", sCursor));
+                }
+                cursor_key.second = uint256S(sCursor.substr(p + 1));
+            }
+        }
     }
 
     if (show_blinding_factors || show_anon_spends) {
@@ -3892,21 +3925,88 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
         }
     }
 
+    // Pick the indexes covering the query, entries from all are visited in
+    // (time, txid) order, most recent first.
+    const CTxFilterIndex &index = pwallet->m_tx_filter_index;
+    std::vector<const CTxFilterIndex::KeySet*> sources;
+    bool fIncludeWtx = type == "all" || type == "standard";
+    const CTxFilterIndex::KeySet *address_set = nullptr;
+    if (search != "" &&
+        index.GetAddressSet(DecodeDestination(search), address_set)) {
+        if (address_set) {
+            sources.push_back(address_set);
+        }
+    } else
+    if (category == "stake" || category == "orphaned_stake") {
+        // Records are never coinstakes
+        if (fIncludeWtx) {
+            sources.push_back(&index.GetSet(CTxFilterIndex::TFI_STAKE));
+        }
+    } else {
+        if (fIncludeWtx) {
+            sources.push_back(&index.GetSet(CTxFilterIndex::TFI_WTX));
+        }
+        sources.push_back(&index.GetSet(
+              type == "standard" ? CTxFilterIndex::TFI_RTX_STANDARD
+            : type == "blind"    ? CTxFilterIndex::TFI_RTX_BLIND
+            : type == "anon"     ? CTxFilterIndex::TFI_RTX_ANON
+            : CTxFilterIndex::TFI_RTX));
+    }
+
+    // Start below the cursor or timeTo, whichever is lower
+    static const uint256 max_txid = uint256S("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    CTxFilterIndex::Key start_key(timeTo, max_txid);
+    bool fStartInclusive = true;
+    if (fHaveCursor && cursor_key < start_key) {
+        start_key = cursor_key;
+        fStartInclusive = false;
+    }
+    typedef CTxFilterIndex::KeySet::const_reverse_iterator KeyIt;
+    std::vector<std::pair<KeyIt, KeyIt> > heads;
+    for (const auto *set : sources) {
+        auto it = fStartInclusive ? set->upper_bound(start_key) : set->lower_bound(start_key);
+        heads.emplace_back(KeyIt(it), set->rend());
+    }
+
+    // With the default sort only the requested page is parsed
+    bool fPageOnly = sort == "time" && count > 0;
+    const size_t nPageStart = skip;
+    size_t nPageEnd = nPageStart + count;
+
     // for transactions and records
     UniValue transactions(UniValue::VARR);
+    std::vector<CTxFilterIndex::Key> entry_keys;
+    int type_i = WordToType(type);
+    bool fExhausted = false;
+    while (!fPageOnly || transactions.size() < nPageEnd) {
+        // Next most recent entry of all sources
+        std::pair<KeyIt, KeyIt> *next = nullptr;
+        for (auto &c : heads) {
+            if (c.first != c.second &&
+                (!next || *next->first < *c.first)) {
+                next = &c;
+            }
+        }
+        if (!next || next->first->first < timeFrom) {
+            fExhausted = true;
+            break;
+        }
+        const CTxFilterIndex::Key &key = *next->first;
+        ++next->first;
 
-    // transaction processing
-    const CHDWallet::TxItems &txOrdered = pwallet->wtxOrdered;
-    CWallet::TxItems::const_reverse_iterator tit = txOrdered.rbegin();
-    if (type == "all" || type == "standard")
-    while (tit != txOrdered.rend()) {
-        CWalletTx *const pwtx = tit->second;
-        int64_t txTime = pwtx->GetTxTime();
-        if (txTime < timeFrom) break;
-        if (txTime <= timeTo)
+        size_t nBefore = transactions.size();
+        MapWallet_t::iterator mwi;
+        MapRecords_t::const_iterator mri;
+        if (pwallet->IsArchivedStake(key.second)) {
+            pwallet->LoadArchivedStake(key.second, true);
+        }
+        if ((mwi = pwallet->mapWallet.find(key.second)) != pwallet->mapWallet.end()) {
+            if (!fIncludeWtx) {
+                continue;
+            }
             ParseOutputs(
                 transactions,
-                *pwtx,
+                mwi->second,
                 pwallet,
                 watchonly,
                 search,
@@ -3917,23 +4017,14 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
                 vTreasuryFundScripts,
                 show_change,
                 show_smsg_fees);
-        tit++;
-    }
-
-    int type_i = WordToType(type);
-    // records processing
-    const RtxOrdered_t &rtxOrdered = pwallet->rtxOrdered;
-    RtxOrdered_t::const_reverse_iterator rit = rtxOrdered.rbegin();
-    while (rit != rtxOrdered.rend()) {
-        const uint256 &hash = rit->second->first;
-        const CTransactionRecord &rtx = rit->second->second;
-        int64_t txTime = rtx.GetTxTime();
-        if (txTime < timeFrom) break;
-        if (txTime <= timeTo)
+        } else
+        if ((pwallet->IsArchivedRecord(key.second) && pwallet->LoadArchivedRecord(key.second, true)) ||
+            pwallet->mapRecords.count(key.second)) {
+            mri = pwallet->mapRecords.find(key.second);
             ParseRecords(
                 transactions,
-                hash,
-                rtx,
+                mri->first,
+                mri->second,
                 pwallet,
                 watchonly,
                 search,
@@ -3943,31 +4034,36 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
                 show_anon_spends,
                 show_change,
                 show_smsg_fees);
-        rit++;
+        }
+        if (transactions.size() > nBefore) {
+            entry_keys.push_back(key);
+        }
     }
 
-    // Sort
+    // Sort, entries are visited most recent first
     std::vector<UniValue> values = transactions.getValues();
-    std::sort(values.begin(), values.end(), [sort] (UniValue a, UniValue b) -> bool {
-        std::string a_address = getAddress(a);
-        std::string b_address = getAddress(b);
-        double a_amount =   a["category"].get_str() == "send"
-                        ? -(a["amount"  ].get_real())
-                        :   a["amount"  ].get_real();
-        double b_amount =   b["category"].get_str() == "send"
-                        ? -(b["amount"  ].get_real())
-                        :   b["amount"  ].get_real();
-        return (
-              sort == "address"
-                ? a_address < b_address
-            : sort == "category" || sort == "txid"
-                ? a[sort].get_str() < b[sort].get_str()
-            : sort == "time" || sort == "confirmations"
-                ? a[sort].get_real() > b[sort].get_real()
-            : sort == "amount"
-                ? a_amount > b_amount
-            : false);
-    });
+    if (sort != "time") {
+        std::sort(values.begin(), values.end(), [sort] (UniValue a, UniValue b) -> bool {
+            std::string a_address = getAddress(a);
+            std::string b_address = getAddress(b);
+            double a_amount =   a["category"].get_str() == "send"
+                            ? -(a["amount"  ].get_real())
+                            :   a["amount"  ].get_real();
+            double b_amount =   b["category"].get_str() == "send"
+                            ? -(b["amount"  ].get_real())
+                            :   b["amount"  ].get_real();
+            return (
+                  sort == "address"
+                    ? a_address < b_address
+                : sort == "category" || sort == "txid"
+                    ? a[sort].get_str() < b[sort].get_str()
+                : sort == "time" || sort == "confirmations"
+                    ? a[sort].get_real() > b[sort].get_real()
+                : sort == "amount"
+                    ? a_amount > b_amount
+                : false);
+        });
+    }
 
     // Filter, skip, count and sum
     CAmount nTotalAmount = 0, nTotalReward = 0;
@@ -3993,16 +4089,27 @@ static UniValue filtertransactions(const JSONRPCRequest &request)
         }
     }
 
-    if (fCollate) {
+    if (fCollate || fHaveCursor) {
         UniValue retObj(UniValue::VOBJ);
-        UniValue stats(UniValue::VOBJ);
-        stats.pushKV("records", (int)result.size());
-        stats.pushKV("total_amount", ValueFromAmount(nTotalAmount));
-        if (fWithReward) {
-            stats.pushKV("total_reward", ValueFromAmount(nTotalReward));
-        }
         retObj.pushKV("tx", result);
-        retObj.pushKV("collated", stats);
+        if (fCollate) {
+            UniValue stats(UniValue::VOBJ);
+            stats.pushKV("records", (int)result.size());
+            stats.pushKV("total_amount", ValueFromAmount(nTotalAmount));
+            if (fWithReward) {
+                stats.pushKV("total_reward", ValueFromAmount(nTotalReward));
+            }
+            retObj.pushKV("collated", stats);
+        }
+        if (fHaveCursor) {
+            // Empty when the last page was returned
+            std::string next_cursor;
+            if (!fExhausted && result.size() > 0) {
+                const CTxFilterIndex::Key &last = entry_keys[nPageStart + result.size() - 1];
+                next_cursor = strprintf("%d:%s", last.first, last.second.ToString());
+            }
+            retObj.pushKV("next_cursor", next_cursor);
+        }
         return retObj;
     }
 
@@ -4424,6 +4531,20 @@ static UniValue getstakinginfo(const JSONRPCRequest &request)
                         {RPCResult::Type::NUM, "weight", "The current stake weight of this wallet"},
                         {RPCResult::Type::NUM, "netstakeweight", "The current stake weight of the network"},
                         {RPCResult::Type::NUM, "expectedtime", "Estimated time for next stake"},
+                        {RPCResult::Type::OBJ, "stakearchive", /* optional */ true, "Coinstakes moved to the stake archive",
+                        {
+                            {RPCResult::Type::NUM, "stakes", "Number of archived coinstakes"},
+                            {RPCResult::Type::STR_AMOUNT, "reward", "Total reward of the archived coinstakes"},
+                            {RPCResult::Type::NUM, "filesize", "Size of the archive file in bytes"},
+                            {RPCResult::Type::ARR, "months", "Totals per month", {
+                                {RPCResult::Type::OBJ, "", "", {
+                                    {RPCResult::Type::STR, "month", "YYYY-MM"},
+                                    {RPCResult::Type::NUM, "stakes", "Number of archived coinstakes"},
+                                    {RPCResult::Type::STR_AMOUNT, "staked", "Value of the outputs staked"},
+                                    {RPCResult::Type::STR_AMOUNT, "reward", "Reward of the archived coinstakes"},
+                                }},
+                            }},
+                        }},
                 }},
                 RPCExamples{
             HelpExampleCli("getstakinginfo", "") +
@@ -4527,6 +4648,30 @@ static UniValue getstakinginfo(const JSONRPCRequest &request)
 
     obj.pushKV("expectedtime", nExpectedTime);
 
+    {
+        LOCK(pwallet->cs_wallet);
+        if (!pwallet->m_stake_archive_months.empty()) {
+            UniValue archive(UniValue::VOBJ), months(UniValue::VARR);
+            size_t nStakes = 0;
+            CAmount nReward = 0;
+            for (const auto &mi : pwallet->m_stake_archive_months) {
+                UniValue month(UniValue::VOBJ);
+                month.pushKV("month", mi.first);
+                month.pushKV("stakes", (uint64_t)mi.second.nStakes);
+                month.pushKV("staked", ValueFromAmount(mi.second.nStaked));
+                month.pushKV("reward", ValueFromAmount(mi.second.nReward));
+                months.push_back(month);
+                nStakes += mi.second.nStakes;
+                nReward += mi.second.nReward;
+            }
+            archive.pushKV("stakes", (uint64_t)nStakes);
+            archive.pushKV("reward", ValueFromAmount(nReward));
+            archive.pushKV("filesize", pwallet->m_stake_archive ? pwallet->m_stake_archive->GetFileSize() : 0);
+            archive.pushKV("months", months);
+            obj.pushKV("stakearchive", archive);
+        }
+    }
+
     return obj;
 };
 
@@ -6999,6 +7144,8 @@ static UniValue debugwallet(const JSONRPCRequest &request)
         result.pushKV("map_ext_keys_size", (int)pwallet->mapExtKeys.size());                    // Includes account keys
         result.pushKV("map_loose_keys_size", (int)pwallet->mapLooseKeys.size());                // Child keys derived from ext keys not in accounts
         result.pushKV("map_loose_lookahead_size", (int)pwallet->mapLooseLookAhead.size());      // Includes account keys
+        result.pushKV("lookahead_index_size", (uint64_t)pwallet->m_lookahead_index.size());     // Account lookahead keys
+        result.pushKV("lookahead_index_memory_bytes", (uint64_t)pwallet->m_lookahead_index.DynamicMemoryUsage());
 
         for (auto it = pwallet->mapWallet.cbegin(); it != pwallet->mapWallet.cend(); ++it) {
             const uint256 &wtxid = it->first;
@@ -7266,6 +7413,28 @@ static UniValue walletsettings(const JSONRPCRequest &request)
                 "  \"mode\"                      (int, optional, default=0) Mode, 0 disabled, 1 coinstake only, 2 all txns.\n"
                 "  \"mindepth\"                  (int, optional, default=3) Number of spends before outputs are unloaded.\n"
                 "}\n"
+                "\"lazyload\" Keep spent transaction records in the wallet file only, loaded on demand. Applied when the wallet is loaded.\n"
+                "{\n"
+                "  \"records\"                   (bool, optional, default=false) Archive records with all owned outputs spent.\n"
+                "  \"mindepth\"                  (int, optional, default=100) Depth the record and its spends must be buried before archiving.\n"
+                "}\n"
+                "\"stakearchive\" Move spent coinstakes from the wallet file to stakearchive.dat in the wallet directory, loaded on demand. Applied when the wallet is loaded.\n"
+                "The archive is part of the wallet, back it up with the wallet file.\n"
+                "{\n"
+                "  \"enabled\"                   (bool, optional, default=false) Archive coinstakes with all owned outputs spent.\n"
+                "  \"mindepth\"                  (int, optional, default=1000) Depth the coinstake and its spends must be buried before archiving, at least the stake maturity depth.\n"
+                "}\n"
+                "\"consolidation\" Periodically join small outputs into one output of the same type while fees are low.\n"
+                "{\n"
+                "  \"enabled\"                   (bool, optional, default=false) Toggle consolidation on this wallet.\n"
+                "  \"types\"                     (array, optional, default=[\"part\",\"blind\",\"anon\"]) Output types to consolidate.\n"
+                "  \"threshold\"                 (amount, optional, default=1) Join confirmed outputs below this value.\n"
+                "  \"mininputs\"                 (int, optional, default=" + ToString(DEFAULT_CONSOLIDATE_MIN_INPUTS) + ") Wait until at least this many small outputs exist.\n"
+                "  \"maxinputs\"                 (int, optional, default=" + ToString(DEFAULT_CONSOLIDATE_MAX_INPUTS) + ") Maximum number of outputs joined per transaction.\n"
+                "  \"maxfeerate\"                (amount, optional, default=" + FormatMoney(DEFAULT_TRANSACTION_MINFEE) + ") Skip consolidating while the fee rate in " + CURRENCY_UNIT + "/kB is above this value.\n"
+                "  \"interval\"                  (int, optional, default=" + ToString(DEFAULT_CONSOLIDATE_INTERVAL) + ") Minimum number of seconds between consolidations.\n"
+                "  \"ringsize\"                  (int, optional, default=" + ToString(DEFAULT_RING_SIZE) + ") Ring size for anon consolidations.\n"
+                "}\n"
                 "\"other\" {\n"
                 "  \"onlyinstance\"              (bool, optional, default=true) Set to false if other wallets spending from the same keys exist.\n"
                 "  \"smsgenabled\"               (bool, optional, default=true) Set to false to have smsg ignore the wallet.\n"
@@ -7355,6 +7524,9 @@ static UniValue walletsettings(const JSONRPCRequest &request)
         sSetting != "stakingoptions" &&
         sSetting != "anonoptions" &&
         sSetting != "unloadspent" &&
+        sSetting != "lazyload" &&
+        sSetting != "stakearchive" &&
+        sSetting != "consolidation" &&
         sSetting != "other") {
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown setting");
     }
@@ -7500,6 +7672,79 @@ static UniValue walletsettings(const JSONRPCRequest &request)
             }
         }
     } else
+    if (sSetting == "lazyload") {
+        for (const auto &sKey : vKeys) {
+            if (sKey == "records") {
+                if (!json["records"].isBool()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "records must be boolean.");
+                }
+            } else
+            if (sKey == "mindepth") {
+                if (!json["mindepth"].isNum()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "mindepth must be a number.");
+                }
+                if (json["mindepth"].get_int() < 1) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "mindepth must be positive.");
+                }
+            } else {
+                warnings.push_back("Unknown key " + sKey);
+            }
+        }
+    } else
+    if (sSetting == "stakearchive") {
+        for (const auto &sKey : vKeys) {
+            if (sKey == "enabled") {
+                if (!json["enabled"].isBool()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "enabled must be boolean.");
+                }
+            } else
+            if (sKey == "mindepth") {
+                if (!json["mindepth"].isNum()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "mindepth must be a number.");
+                }
+                // Archived coinstakes and their spent inputs must not be undone by a reorg
+                if (json["mindepth"].get_int() < (int)Params().GetStakeMinConfirmations()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("mindepth must be at least the stake maturity depth, %d.", Params().GetStakeMinConfirmations()));
+                }
+            } else {
+                warnings.push_back("Unknown key " + sKey);
+            }
+        }
+    } else
+    if (sSetting == "consolidation") {
+        for (const auto &sKey : vKeys) {
+            if (sKey == "enabled") {
+                if (!json["enabled"].isBool()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "enabled must be boolean.");
+                }
+            } else
+            if (sKey == "types") {
+                if (!json["types"].isArray()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "types must be an array.");
+                }
+                for (const auto &type : json["types"].getValues()) {
+                    if (!type.isStr() || std::find(std::begin(CONSOLIDATION_TYPES), std::end(CONSOLIDATION_TYPES), type.get_str()) == std::end(CONSOLIDATION_TYPES)) {
+                        throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown type, expected part, blind or anon.");
+                    }
+                }
+            } else
+            if (sKey == "threshold" || sKey == "maxfeerate") {
+                if (AmountFromValue(json[sKey]) < 1) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, sKey + " must be positive.");
+                }
+            } else
+            if (sKey == "mininputs" || sKey == "maxinputs" || sKey == "interval" || sKey == "ringsize") {
+                if (!json[sKey].isNum()) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, sKey + " must be a number.");
+                }
+                if (json[sKey].get_int64() < 1) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, sKey + " must be positive.");
+                }
+            } else {
+                warnings.push_back("Unknown key " + sKey);
+            }
+        }
+    } else
     if (sSetting == "other") {
         for (const auto &sKey : vKeys) {
             if (sKey == "onlyinstance") {
@@ -8881,10 +9126,8 @@ static UniValue fundrawtransactionfrom(const JSONRPCRequest& request)
             uint64_t amountOut;
             uint256 blind;
             if (txout->GetPRangeproof()->size() < 1000) {
-                if (1 != secp256k1_bulletproof_rangeproof_rewind(secp256k1_ctx_blind, blind_gens,
-                    &amountOut, blindOut, txout->GetPRangeproof()->data(), txout->GetPRangeproof()->size(),
-                    0, txout->GetPCommitment(), &secp256k1_generator_const_h, r.nonce.begin(), NULL, 0)) {
-                    throw JSONRPCError(RPC_MISC_ERROR, strprintf("secp256k1_bulletproof_rangeproof_rewind failed, output %d.", n));
+                if (!RewindBulletproof(*txout->GetPRangeproof(), txout->GetPCommitment(), r.nonce, amountOut, blindOut)) {
+                    throw JSONRPCError(RPC_MISC_ERROR, strprintf("RewindBulletproof failed, output %d.", n));
                 }
 
                 ExtractNarration(r.nonce, r.vData, r.sNarration);
@@ -9862,7 +10105,11 @@ static UniValue geteligibleaddresses(const JSONRPCRequest& request)
     
     UniValue result(UniValue::VARR);
 
-    int height{::ChainActive().Tip()->nHeight};
+    // Read the tracked data from the last connected block's snapshot, so the
+    // call neither races nor waits on blocks being connected.
+    std::shared_ptr<const ChainstateReadView> view = GetChainstateReadView();
+
+    int height{-1};
     bool eligibleonly{true};
     bool flushState{false};
 
@@ -9878,18 +10125,36 @@ static UniValue geteligibleaddresses(const JSONRPCRequest& request)
         flushState = request.params[2].get_bool();
     }
 
-    auto& tracker = initColdReward();
-
     if (flushState) {
-        tracker.endPersistedTransaction();
+        LOCK(cs_main);
+        initColdReward().endPersistedTransaction();
+        if (!FlushRewardTracker(true)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to write GVR tracker data");
+        }
+        view.reset();
     }
 
-    std::vector<std::pair<ColdRewardTracker::AddressType, CAmount>> addresses;
+    // The snapshot is only used if it is of the tip and the tracker data was written up to it,
+    // the GVR write cache may hold blocks the snapshot doesn't have.
+    if (view) {
+        std::int64_t last_tracked_height{-1};
+        if (WITH_LOCK(g_best_block_mutex, return g_best_block) != view->tip_hash ||
+            !view->block_tree->ReadLastTrackedHeight(last_tracked_height) ||
+            last_tracked_height != view->tip_height) {
+            view.reset();
+        }
+    }
 
-    if (!eligibleonly) {
-        height = ::ChainActive().Tip()->nHeight;
-        addresses = rewardTracker.getBalances();
-    } else {
+    std::vector<std::pair<ColdRewardTracker::AddressType, CAmount>> addresses;
+    auto get_addresses = [&](ColdRewardTracker& tracker, int tip_height) {
+        if (!eligibleonly) {
+            height = tip_height;
+            addresses = tracker.getBalances();
+            return;
+        }
+        if (height < 0) {
+            height = tip_height;
+        }
         const auto addrMul = tracker.getEligibleAddresses(height);
         const auto balances = tracker.getBalances();
 
@@ -9902,6 +10167,14 @@ static UniValue geteligibleaddresses(const JSONRPCRequest& request)
                 addresses.push_back(std::make_pair(res->first, b.second));
             }
         }
+    };
+
+    if (view) {
+        ColdRewardTracker snapshot_tracker = ColdRewardTrackerFromSnapshot(view->block_tree);
+        get_addresses(snapshot_tracker, view->tip_height);
+    } else {
+        LOCK(cs_main);
+        get_addresses(initColdReward(), ::ChainActive().Tip()->nHeight);
     }
 
     for (const auto& trackedAddr : addresses) {
@@ -2319,11 +2319,21 @@ UniValue gettransaction_inner(JSONRPCRequest const &request)
     bool verbose = request.params[2].isNull() ? false : request.params[2].get_bool();
 
     UniValue entry(UniValue::VOBJ);
+    if (IsParticlWallet(pwallet)) {
+        CHDWallet *phdw = GetParticlWallet(pwallet);
+        LOCK_ASSERTION(phdw->cs_wallet);
+        if (phdw->IsArchivedStake(hash)) {
+            phdw->LoadArchivedStake(hash, true);
+        }
+    }
     auto it = pwallet->mapWallet.find(hash);
     if (it == pwallet->mapWallet.end()) {
         if (IsParticlWallet(pwallet)) {
             CHDWallet *phdw = GetParticlWallet(pwallet);
             LOCK_ASSERTION(phdw->cs_wallet);
+            if (phdw->IsArchivedRecord(hash)) {
+                phdw->LoadArchivedRecord(hash, true);
+            }
             MapRecords_t::const_iterator mri = phdw->mapRecords.find(hash);
 
             if (mri != phdw->mapRecords.end()) {
@@ -3268,6 +3278,22 @@ static RPCHelpMan getwalletinfo()
                             {RPCResult::Type::NUM, "progress", "scanning progress percentage [0.0, 1.0]"},
                         }},
                         {RPCResult::Type::BOOL, "descriptors", "whether this wallet uses descriptors for scriptPubKey management"},
+                        {RPCResult::Type::OBJ, "consolidation", /* optional */ true, "small output consolidation, only present when enabled in walletsettings",
+                        {
+                            {RPCResult::Type::NUM_TIME, "last_check", "the " + UNIX_EPOCH_TIME + " of the last check"},
+                            {RPCResult::Type::NUM_TIME, "next_check", "the " + UNIX_EPOCH_TIME + " of the next check"},
+                            {RPCResult::Type::NUM, "skipped_fee", "checks skipped as the fee rate was above maxfeerate"},
+                            {RPCResult::Type::OBJ, "part|blind|anon", "per output type",
+                            {
+                                {RPCResult::Type::NUM, "planned", "consolidations planned"},
+                                {RPCResult::Type::NUM, "planned_inputs", "outputs in planned consolidations"},
+                                {RPCResult::Type::NUM, "executed", "consolidations sent"},
+                                {RPCResult::Type::NUM, "executed_inputs", "outputs joined in sent consolidations"},
+                                {RPCResult::Type::NUM, "failed", "consolidations that failed"},
+                            }},
+                            {RPCResult::Type::STR_HEX, "last_txid", /* optional */ true, "the last consolidation txid"},
+                            {RPCResult::Type::STR, "last_error", /* optional */ true, "the last error"},
+                        }},
                     }},
                 },
                 RPCExamples{
@@ -3380,6 +3406,34 @@ static RPCHelpMan getwalletinfo()
         obj.pushKV("scanning", false);
     }
     obj.pushKV("descriptors", pwallet->IsWalletFlagSet(WALLET_FLAG_DESCRIPTORS));
+
+    if (IsParticlWallet(pwallet)) {
+        const CHDWallet *pwhd = GetParticlWallet(pwallet);
+        AssertLockHeld(pwhd->cs_wallet);
+        if (pwhd->m_consolidation.enabled) {
+            const CHDWallet::ConsolidationStats &stats = pwhd->m_consolidation_stats;
+            UniValue consolidation(UniValue::VOBJ);
+            consolidation.pushKV("last_check", stats.last_check);
+            consolidation.pushKV("next_check", stats.next_check);
+            consolidation.pushKV("skipped_fee", (uint64_t)stats.skipped_fee);
+            for (size_t k = 0; k < 3; ++k) {
+                UniValue type(UniValue::VOBJ);
+                type.pushKV("planned", (uint64_t)stats.planned[k]);
+                type.pushKV("planned_inputs", (uint64_t)stats.planned_inputs[k]);
+                type.pushKV("executed", (uint64_t)stats.executed[k]);
+                type.pushKV("executed_inputs", (uint64_t)stats.executed_inputs[k]);
+                type.pushKV("failed", (uint64_t)stats.failed[k]);
+                consolidation.pushKV(CONSOLIDATION_TYPES[k], type);
+            }
+            if (!stats.last_txid.IsNull()) {
+                consolidation.pushKV("last_txid", stats.last_txid.ToString());
+            }
+            if (!stats.last_error.empty()) {
+                consolidation.pushKV("last_error", stats.last_error);
+            }
+            obj.pushKV("consolidation", consolidation);
+        }
+    }
     return obj;
 },
     };
@@ -3467,6 +3521,18 @@ static RPCHelpMan loadwallet()
                     {
                         {RPCResult::Type::STR, "name", "The wallet name if loaded successfully."},
                         {RPCResult::Type::STR, "warning", "Warning message if wallet was not loaded cleanly."},
+                        {RPCResult::Type::OBJ, "load_stats", /* optional */ true, "Particl wallets only",
+                        {
+                            {RPCResult::Type::NUM, "load_time_ms", "Time taken to load the wallet file"},
+                            {RPCResult::Type::NUM, "records_time_ms", "Time taken to load the transaction records"},
+                            {RPCResult::Type::NUM, "transactions", "Number of wallet transactions in memory"},
+                            {RPCResult::Type::NUM, "records", "Number of transaction records in memory"},
+                            {RPCResult::Type::NUM, "records_archived", "Number of records held as stubs only"},
+                            {RPCResult::Type::NUM, "records_newly_archived", "Number of records archived while loading"},
+                            {RPCResult::Type::NUM, "records_restored", "Number of archived records restored as lazy loading is disabled"},
+                            {RPCResult::Type::NUM, "stakes_archived", "Number of coinstakes in the stake archive"},
+                            {RPCResult::Type::NUM, "stakes_newly_archived", "Number of coinstakes moved to the stake archive while loading"},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -3496,6 +3562,22 @@ static RPCHelpMan loadwallet()
     obj.pushKV("name", wallet->GetName());
     obj.pushKV("warning", Join(warnings, Untranslated("\n")).original);
 
+    if (IsParticlWallet(wallet.get())) {
+        const CHDWallet *phdw = GetParticlWallet(wallet.get());
+        LOCK(phdw->cs_wallet);
+        UniValue stats(UniValue::VOBJ);
+        stats.pushKV("load_time_ms", phdw->m_load_stats.load_time_ms);
+        stats.pushKV("records_time_ms", phdw->m_load_stats.records_time_ms);
+        stats.pushKV("transactions", (uint64_t)phdw->mapWallet.size());
+        stats.pushKV("records", (uint64_t)phdw->mapRecords.size());
+        stats.pushKV("records_archived", (uint64_t)phdw->m_archived_records.size());
+        stats.pushKV("records_newly_archived", (uint64_t)phdw->m_load_stats.records_archived);
+        stats.pushKV("records_restored", (uint64_t)phdw->m_load_stats.records_restored);
+        stats.pushKV("stakes_archived", (uint64_t)phdw->m_archived_stakes.size());
+        stats.pushKV("stakes_newly_archived", (uint64_t)phdw->m_load_stats.stakes_archived);
+        obj.pushKV("load_stats", stats);
+    }
+
     return obj;
 },
     };
@@ -0,0 +1,180 @@
+// Copyright (c) 2017-2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/stakearchive.h>
+
+#include <clientversion.h>
+#include <lz4/lz4.h>
+#include <streams.h>
+#include <util/system.h>
+
+#include <string.h>
+
+static const uint8_t STAKE_ARCHIVE_MAGIC[4] = {'s', 't', 'k', 'a'};
+static const uint32_t STAKE_ARCHIVE_VERSION = 1;
+static const uint32_t STAKE_ARCHIVE_FILE_HEADER_SIZE = 8;
+static const uint32_t MAX_STAKE_ARCHIVE_ENTRY_SIZE = 4 * 1000 * 1000;
+
+bool CStakeArchive::Load(const std::function<void(const CStakeArchiveEntry&)> &fn)
+{
+    m_index.clear();
+    m_file_size = 0;
+
+    FILE *fp = fsbridge::fopen(m_path, "rb+");
+    if (!fp) {
+        return !fs::exists(m_path);
+    }
+    CAutoFile file(fp, SER_DISK, CLIENT_VERSION);
+
+    uint8_t magic[4];
+    uint32_t version;
+    try {
+        file.read((char*)magic, 4);
+        file >> version;
+    } catch (const std::exception &e) {
+        LogPrintf("%s: Empty or truncated file %s.\n", __func__, m_path.string());
+        return TruncateFile(file.Get(), 0);
+    }
+    if (memcmp(magic, STAKE_ARCHIVE_MAGIC, 4) != 0 || version != STAKE_ARCHIVE_VERSION) {
+        return error("%s: Unknown file format %s.", __func__, m_path.string());
+    }
+
+    uint64_t nPos = STAKE_ARCHIVE_FILE_HEADER_SIZE;
+    for (;;) {
+        CStakeArchiveEntry entry;
+        Position pos;
+        try {
+            uint32_t nHeaderSize;
+            file >> nHeaderSize;
+            if (nHeaderSize > MAX_STAKE_ARCHIVE_ENTRY_SIZE) {
+                throw std::ios_base::failure("Header too large");
+            }
+            file >> entry;
+            file >> pos.nRawSize;
+            file >> pos.nCompressedSize;
+            if (pos.nRawSize > MAX_STAKE_ARCHIVE_ENTRY_SIZE || pos.nCompressedSize > pos.nRawSize) {
+                throw std::ios_base::failure("Body too large");
+            }
+            pos.nPos = nPos + 4 + nHeaderSize + 8;
+            if (fseek(file.Get(), pos.nCompressedSize, SEEK_CUR) != 0) {
+                throw std::ios_base::failure("Seek failed");
+            }
+            // fseek doesn't fail when seeking past the end of the file
+            long nEnd = ftell(file.Get());
+            if (fseek(file.Get(), 0, SEEK_END) != 0 || ftell(file.Get()) < nEnd) {
+                throw std::ios_base::failure("Body truncated");
+            }
+            fseek(file.Get(), nEnd, SEEK_SET);
+            if (nEnd != (long)(pos.nPos + pos.nCompressedSize)) {
+                throw std::ios_base::failure("Header size mismatch");
+            }
+            nPos = nEnd;
+        } catch (const std::exception &e) {
+            if (feof(file.Get()) && ftell(file.Get()) == (long)nPos) {
+                break; // Clean end of file
+            }
+            LogPrintf("%s: Truncating torn entry at %d in %s.\n", __func__, nPos, m_path.string());
+            if (!TruncateFile(file.Get(), nPos)) {
+                return error("%s: TruncateFile failed.", __func__);
+            }
+            break;
+        }
+        m_index[entry.txid] = pos;
+        fn(entry);
+    }
+    m_file_size = nPos;
+
+    return true;
+};
+
+bool CStakeArchive::Append(const std::vector<std::pair<CStakeArchiveEntry, std::vector<uint8_t> > > &entries)
+{
+    FILE *fp = fsbridge::fopen(m_path, "ab");
+    if (!fp) {
+        return error("%s: Failed to open %s.", __func__, m_path.string());
+    }
+    CAutoFile file(fp, SER_DISK, CLIENT_VERSION);
+
+    std::vector<std::pair<CStakeArchiveEntry, Position> > vAdded;
+    uint64_t nPos = m_file_size;
+    try {
+        if (nPos == 0) {
+            file.write((const char*)STAKE_ARCHIVE_MAGIC, 4);
+            file << STAKE_ARCHIVE_VERSION;
+            nPos = STAKE_ARCHIVE_FILE_HEADER_SIZE;
+        }
+        for (const auto &e : entries) {
+            const CStakeArchiveEntry &entry = e.first;
+            const std::vector<uint8_t> &data = e.second;
+
+            std::vector<uint8_t> vCompressed(LZ4_compressBound(data.size()));
+            int nCompressed = LZ4_compress_default((const char*)data.data(), (char*)vCompressed.data(), data.size(), vCompressed.size());
+            if (nCompressed <= 0 || (size_t)nCompressed >= data.size()) {
+                vCompressed = data; // Store raw when compression doesn't help
+            } else {
+                vCompressed.resize(nCompressed);
+            }
+
+            Position pos;
+            uint32_t nHeaderSize = GetSerializeSize(entry, CLIENT_VERSION);
+            pos.nRawSize = data.size();
+            pos.nCompressedSize = vCompressed.size();
+            pos.nPos = nPos + 4 + nHeaderSize + 8;
+
+            file << nHeaderSize << entry << pos.nRawSize << pos.nCompressedSize;
+            file.write((const char*)vCompressed.data(), vCompressed.size());
+            nPos = pos.nPos + pos.nCompressedSize;
+            vAdded.emplace_back(entry, pos);
+        }
+    } catch (const std::exception &e) {
+        TruncateFile(file.Get(), m_file_size); // Keep the file in sync with the index
+        return error("%s: Write failed %s.", __func__, e.what());
+    }
+    if (fflush(file.Get()) != 0 || !FileCommit(file.Get())) {
+        TruncateFile(file.Get(), m_file_size);
+        return error("%s: Failed to sync %s.", __func__, m_path.string());
+    }
+
+    for (const auto &added : vAdded) {
+        m_index[added.first.txid] = added.second;
+    }
+    m_file_size = nPos;
+
+    return true;
+};
+
+bool CStakeArchive::ReadTx(const uint256 &txid, std::vector<uint8_t> &data) const
+{
+    auto it = m_index.find(txid);
+    if (it == m_index.end()) {
+        return false;
+    }
+    const Position &pos = it->second;
+
+    FILE *fp = fsbridge::fopen(m_path, "rb");
+    if (!fp) {
+        return error("%s: Failed to open %s.", __func__, m_path.string());
+    }
+    CAutoFile file(fp, SER_DISK, CLIENT_VERSION);
+    if (fseek(file.Get(), pos.nPos, SEEK_SET) != 0) {
+        return error("%s: Seek failed.", __func__);
+    }
+
+    std::vector<uint8_t> vCompressed(pos.nCompressedSize);
+    try {
+        file.read((char*)vCompressed.data(), vCompressed.size());
+    } catch (const std::exception &e) {
+        return error("%s: Read failed %s.", __func__, e.what());
+    }
+
+    if (pos.nCompressedSize == pos.nRawSize) {
+        data = std::move(vCompressed);
+        return true;
+    }
+    data.resize(pos.nRawSize);
+    if (LZ4_decompress_safe((const char*)vCompressed.data(), (char*)data.data(), vCompressed.size(), data.size()) != (int)pos.nRawSize) {
+        return error("%s: Decompression failed for %s.", __func__, txid.ToString());
+    }
+    return true;
+};
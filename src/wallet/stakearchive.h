@@ -0,0 +1,103 @@
+// Copyright (c) 2017-2021 The Particl Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PARTICL_WALLET_STAKEARCHIVE_H
+#define PARTICL_WALLET_STAKEARCHIVE_H
+
+#include <amount.h>
+#include <fs.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+/**
+ * Summary of an archived coinstake, kept in front of the compressed wallet
+ * txn so the archive can be indexed without decompressing it.
+ */
+class CStakeArchiveEntry
+{
+public:
+    uint256 txid;
+    int64_t nTime = 0;
+    int nHeight = 0;
+    CAmount nValueIn = 0;  // Value of the owned outputs spent
+    CAmount nValueOut = 0; // Value of the owned outputs created
+    std::vector<COutPoint> vin;
+    std::vector<CScript> vScripts; // Output scripts, for the filtertransactions index
+
+    CAmount GetReward() const { return nValueOut - nValueIn; }
+
+    SERIALIZE_METHODS(CStakeArchiveEntry, obj)
+    {
+        READWRITE(obj.txid);
+        READWRITE(obj.nTime);
+        READWRITE(obj.nHeight);
+        READWRITE(obj.nValueIn);
+        READWRITE(obj.nValueOut);
+        READWRITE(obj.vin);
+        READWRITE(obj.vScripts);
+    }
+};
+
+/** Coinstake totals reported per month */
+struct CStakeArchiveTotals
+{
+    size_t nStakes = 0;
+    CAmount nStaked = 0;
+    CAmount nReward = 0;
+
+    void Add(const CStakeArchiveEntry &entry)
+    {
+        nStakes++;
+        nStaked += entry.nValueIn;
+        nReward += entry.GetReward();
+    }
+};
+
+/**
+ * Append only archive of fully spent coinstake txns.
+ *
+ * File layout: magic, version, then per entry
+ *   uint32 header size, CStakeArchiveEntry, uint32 raw size, uint32 compressed size,
+ *   LZ4 compressed serialised CWalletTx.
+ * Entries are never rewritten, a txn archived twice is indexed at its last position.
+ * A torn entry at the end of the file is truncated away on load.
+ */
+class CStakeArchive
+{
+public:
+    explicit CStakeArchive(const fs::path &path) : m_path(path) {};
+
+    const fs::path &GetPath() const { return m_path; }
+
+    /** Index the archive file, fn is called for every entry. A missing file is an empty archive. */
+    bool Load(const std::function<void(const CStakeArchiveEntry&)> &fn);
+
+    /** Append entries with their serialised wallet txns and sync the file. */
+    bool Append(const std::vector<std::pair<CStakeArchiveEntry, std::vector<uint8_t> > > &entries);
+
+    /** Read and decompress the serialised wallet txn archived for txid. */
+    bool ReadTx(const uint256 &txid, std::vector<uint8_t> &data) const;
+
+    bool Contains(const uint256 &txid) const { return m_index.count(txid); }
+    size_t size() const { return m_index.size(); }
+    uint64_t GetFileSize() const { return m_file_size; }
+
+private:
+    struct Position {
+        uint64_t nPos = 0;
+        uint32_t nRawSize = 0;
+        uint32_t nCompressedSize = 0;
+    };
+
+    fs::path m_path;
+    uint64_t m_file_size = 0;
+    std::map<uint256, Position> m_index;
+};
+
+#endif // PARTICL_WALLET_STAKEARCHIVE_H
@@ -307,6 +307,55 @@ BOOST_AUTO_TEST_CASE(bnb_search_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(bnb_ring_search_test)
+{
+    std::vector<size_t> selection;
+    CAmount value_ret = 0;
+
+    RingCoinSelectionParams params;
+    params.input_fee = 1000;
+    params.cost_of_change = 500;
+
+    // Input fees count towards the target
+    std::vector<CAmount> values{10000, 20000, 30000, 50000};
+    BOOST_CHECK(SelectCoinsBnBRing(values, 28000, params, selection, value_ret));
+    BOOST_CHECK(value_ret == 30000);
+    BOOST_CHECK(selection.size() == 2);
+    BOOST_CHECK(std::count(selection.begin(), selection.end(), 0) == 1);
+    BOOST_CHECK(std::count(selection.begin(), selection.end(), 1) == 1);
+
+    // Out of range of any combination
+    BOOST_CHECK(!SelectCoinsBnBRing(values, 27000, params, selection, value_ret));
+    BOOST_CHECK(selection.empty());
+
+    // Not enough after input fees
+    BOOST_CHECK(!SelectCoinsBnBRing(values, 107000, params, selection, value_ret));
+
+    // Not input fees are added to the target
+    params.not_input_fees = 2000;
+    BOOST_CHECK(SelectCoinsBnBRing(values, 26000, params, selection, value_ret));
+    BOOST_CHECK(value_ret == 30000);
+    params.not_input_fees = 0;
+
+    // Signature fees are charged per group of inputs_per_sig inputs
+    params.sig_fee = 5000;
+    params.inputs_per_sig = 2;
+    params.cost_of_change = 2000;
+    values = {50000, 25000, 25000};
+    BOOST_CHECK(SelectCoinsBnBRing(values, 43000, params, selection, value_ret));
+    BOOST_CHECK(value_ret == 50000);
+    BOOST_CHECK(selection.size() == 1); // Same waste as both 25000 coins, fewer inputs wins
+    BOOST_CHECK(selection[0] == 0);
+
+    values = {24000, 24000, 24000};
+    BOOST_CHECK(SelectCoinsBnBRing(values, 41000, params, selection, value_ret));
+    BOOST_CHECK(selection.size() == 2);
+    // A third input needs another signature
+    BOOST_CHECK(!SelectCoinsBnBRing(values, 60000, params, selection, value_ret));
+    BOOST_CHECK(SelectCoinsBnBRing(values, 59000, params, selection, value_ret));
+    BOOST_CHECK(selection.size() == 3);
+}
+
 BOOST_AUTO_TEST_CASE(knapsack_solver_test)
 {
     CoinSet setCoinsRet, setCoinsRet2;
@@ -19,7 +19,7 @@
 
 #include <boost/test/unit_test.hpp>
 
-extern bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p);
+extern bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p, const uint256 &wtxid, uint32_t n, bool aggregated);
 extern void SetCTOutVData(std::vector<uint8_t> &vData, CPubKey &pkEphem, const CTempRecipient &r);
 
 BOOST_FIXTURE_TEST_SUITE(hdwallet_tests, HDWalletTestingSetup)
@@ -346,7 +346,7 @@ BOOST_AUTO_TEST_CASE(test_TxOutRingCT)
     BOOST_MESSAGE("---------------- Checking RingCT Output---------------------\n");
     TxValidationState state;
     state.rct_active = true;
-    BOOST_CHECK_MESSAGE(CheckAnonOutput(state, (CTxOutRingCT*)txout.get()), "failed to check ringct output");
+    BOOST_CHECK_MESSAGE(CheckAnonOutput(state, (CTxOutRingCT*)txout.get(), uint256(), 0, false), "failed to check ringct output");
 
     BOOST_MESSAGE("---------------- Serialize Transaction with No Segwit ---------------------\n");
     CMutableTransaction tx;
@@ -366,7 +366,7 @@ BOOST_AUTO_TEST_CASE(test_TxOutRingCT)
     BOOST_CHECK_MESSAGE(txout_check->GetType() == OUTPUT_RINGCT, "deserialized output is not ringct");
 
     BOOST_MESSAGE("---------------- Check RingCT Output ---------------------\n");
-    BOOST_CHECK_MESSAGE(!CheckAnonOutput(state, (CTxOutRingCT*)txout_check.get()), "passed check ringct output");
+    BOOST_CHECK_MESSAGE(!CheckAnonOutput(state, (CTxOutRingCT*)txout_check.get(), CTransaction(txCheck).GetWitnessHash(), 0, false), "passed check ringct output");
     }
 
     SetMockTime(0);
@@ -458,6 +458,96 @@ BOOST_AUTO_TEST_CASE(rct_test)
     SetNumBlocksOfPeers(peer_blocks);
 }
 
+BOOST_AUTO_TEST_CASE(rct_aggregated_bulletproofs)
+{
+    SeedInsecureRand();
+    CHDWallet *pwallet = pwalletMain.get();
+    util::Ref context{m_node};
+    UniValue rv;
+    std::string sError;
+
+    // Import the regtest genesis coinbase keys
+    BOOST_CHECK_NO_THROW(rv = CallRPC("extkeyimportmaster tprv8ZgxMBicQKsPeK5mCpvMsd1cwyT1JZsrBN82XkoYuZY1EVK7EwDaiL9sDfqUU5SntTfbRfnRedFWjg5xkDG5i3iwd3yP7neX5F2dtdCojk4", context));
+    BOOST_CHECK_NO_THROW(rv = CallRPC("getnewextaddress lblHDKey", context));
+
+    CTxDestination stealth_address;
+    {
+        LOCK(pwallet->cs_wallet);
+        pwallet->SetBroadcastTransactions(true);
+        BOOST_CHECK_NO_THROW(rv = CallRPC("getnewstealthaddress", context));
+        stealth_address = DecodeDestination(part::StripQuotes(rv.write()));
+    }
+
+    // Four blinded outputs should share one range proof
+    CMutableTransaction mtx;
+    {
+        LOCK(pwallet->cs_wallet);
+        std::vector<CTempRecipient> vecSend;
+        for (int i = 0; i < 4; ++i) {
+            vecSend.emplace_back(OUTPUT_CT, (i + 1) * COIN, stealth_address);
+        }
+        CTransactionRef tx_new;
+        CWalletTx wtx(pwallet, tx_new);
+        CTransactionRecord rtx;
+        CAmount nFee;
+        CCoinControl coinControl;
+        coinControl.nChangePos = 4; // Keep the blinded outputs adjacent
+        BOOST_REQUIRE(0 == pwallet->AddStandardInputs(wtx, rtx, vecSend, true, nFee, &coinControl, sError));
+        mtx = CMutableTransaction(*wtx.tx);
+
+        size_t nCarriers = 0, nMembers = 0;
+        for (const auto &txout : mtx.vpout) {
+            if (!txout->IsType(OUTPUT_CT)) {
+                continue;
+            }
+            size_t nProofSize = ((CTxOutCT*)txout.get())->vRangeproof.size();
+            if (nProofSize == AGGREGATED_AMOUNT_SIZE) {
+                nMembers++;
+            } else {
+                BOOST_CHECK(nProofSize < 1000);
+                nCarriers++;
+            }
+        }
+        BOOST_CHECK(nCarriers == 1);
+        BOOST_CHECK(nMembers == 3);
+
+        BOOST_REQUIRE(wtx.SubmitMemoryPoolAndRelay(sError, true) == 1);
+    }
+    SyncWithValidationInterfaceQueue();
+
+    {
+        LOCK(pwallet->cs_wallet);
+        CHDWalletBalances bal;
+        BOOST_REQUIRE(pwallet->GetBalances(bal));
+        BOOST_CHECK(bal.nBlind + bal.nBlindUnconf == 10 * COIN);
+    }
+
+    int nSpendHeight = WITH_LOCK(cs_main, return ::ChainActive().Height());
+    TxValidationState state;
+    state.SetStateInfo(GetTime(), nSpendHeight, Params().GetConsensus(), true /* particl_mode */, false /* skip_rangeproof */);
+    BOOST_CHECK(CheckTransaction(CTransaction(mtx), state));
+
+    // Aggregated proofs are invalid before aggregate_bulletproof_time
+    state = TxValidationState();
+    state.SetStateInfo(GetTime(), nSpendHeight, Params().GetConsensus(), true /* particl_mode */, false /* skip_rangeproof */);
+    state.m_aggregate_bulletproofs = false;
+    BOOST_CHECK(!CheckTransaction(CTransaction(mtx), state));
+
+    // Groups must be a power of two
+    CMutableTransaction mtx_odd = mtx;
+    for (size_t i = mtx_odd.vpout.size(); i-- > 0;) {
+        if (mtx_odd.vpout[i]->IsType(OUTPUT_CT) &&
+            ((CTxOutCT*)mtx_odd.vpout[i].get())->vRangeproof.size() == AGGREGATED_AMOUNT_SIZE) {
+            mtx_odd.vpout.erase(mtx_odd.vpout.begin() + i);
+            break;
+        }
+    }
+    state = TxValidationState();
+    state.SetStateInfo(GetTime(), nSpendHeight, Params().GetConsensus(), true /* particl_mode */, false /* skip_rangeproof */);
+    BOOST_CHECK(!CheckTransaction(CTransaction(mtx_odd), state));
+    BOOST_CHECK(state.GetRejectReason() == "bad-rangeproof-aggregate-size");
+}
+
 BOOST_AUTO_TEST_CASE(rct_disabled) {
 
     // Anon disabled in the following tests
@@ -82,6 +82,37 @@ static void TryAddBadTxn(CHDWallet *pwallet, CTxDestination &dest, OutputTypes o
     SyncWithValidationInterfaceQueue();
 }
 
+static void CheckBalanceLedger(CHDWallet *pwallet)
+{
+    // Balances maintained by the ledger must match a full scan of the wallet
+    pwallet->BlockUntilSyncedToCurrentChain();
+    CHDWalletBalances bal, bal_scan;
+    BOOST_REQUIRE(pwallet->GetBalances(bal));
+    LOCK(pwallet->cs_wallet);
+    BOOST_REQUIRE(pwallet->GetBalancesFullScan(bal_scan));
+    BOOST_CHECK(bal == bal_scan);
+}
+
+static void CheckStakeableCoins(CHDWallet *pwallet)
+{
+    // The incrementally maintained stakeable coins must match a rebuild
+    pwallet->BlockUntilSyncedToCurrentChain();
+    LOCK(pwallet->cs_wallet);
+    auto get_coins = [&]() {
+        std::set<COutPoint> coins;
+        pwallet->UpdateStakeableCoins();
+        for (const auto &output : pwallet->m_cached_stakeable_coins) {
+            coins.insert(COutPoint(output.tx->GetHash(), output.i));
+        }
+        return coins;
+    };
+    std::set<COutPoint> coins = get_coins();
+    int greatest_depth = pwallet->m_greatest_txn_depth;
+    pwallet->m_stake_coins_valid = false;
+    BOOST_CHECK(coins == get_coins());
+    BOOST_CHECK(greatest_depth == pwallet->m_greatest_txn_depth);
+}
+
 static void DisconnectTip(CTxMemPool& mempool, CBlock &block, CBlockIndex *pindexDelete, CCoinsViewCache &view, const CChainParams &chainparams)
 {
     BlockValidationState state;
@@ -103,6 +134,7 @@ BOOST_AUTO_TEST_CASE(stake_test)
 
     SeedInsecureRand();
     CHDWallet *pwallet = pwalletMain.get();
+    pwallet->m_check_balance_ledger = false;
     util::Ref context{m_node};
     {
         int last_height = WITH_LOCK(cs_main, return ::ChainActive().Height());
@@ -188,6 +220,8 @@ BOOST_AUTO_TEST_CASE(stake_test)
     LOCK(pwallet->cs_wallet);
     BOOST_REQUIRE(!pwallet->IsSpent(txin.prevout.hash, txin.prevout.n));
     }
+    CheckBalanceLedger(pwallet);
+    CheckStakeableCoins(pwallet);
 
     {
     LOCK(cs_main);
@@ -346,6 +380,8 @@ BOOST_AUTO_TEST_CASE(stake_test)
         CCoinControl coinControl;
         BOOST_CHECK(30 * COIN == pwallet->GetAvailableAnonBalance(&coinControl));
         BOOST_CHECK(30 * COIN == pwallet->GetAvailableBlindBalance(&coinControl));
+        CheckBalanceLedger(pwallet);
+        CheckStakeableCoins(pwallet);
 
         BOOST_CHECK(::ChainActive().Tip()->nAnonOutputs == 4);
         BOOST_CHECK(::ChainActive().Tip()->nMoneySupply == base_supply + stake_reward * 5);
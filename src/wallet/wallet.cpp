@@ -768,6 +768,19 @@ int64_t CWallet::IncOrderPosNext(WalletBatch* batch)
     return nRet;
 }
 
+void CWalletTx::MarkDirty()
+{
+    m_amounts[DEBIT].Reset();
+    m_amounts[CREDIT].Reset();
+    m_amounts[IMMATURE_CREDIT].Reset();
+    m_amounts[AVAILABLE_CREDIT].Reset();
+    fChangeCached = false;
+    m_is_cache_empty = true;
+    if (pwallet) {
+        pwallet->MarkBalanceDirty(GetHash());
+    }
+}
+
 void CWallet::MarkDirty()
 {
     {
@@ -881,6 +894,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const CWalletTx::Confirmatio
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
         wtx.nTimeSmart = ComputeTimeSmart(wtx);
         AddToSpends(hash);
+        IndexWalletTx(wtx);
     }
 
     if (IsWalletFlagSet(WALLET_FLAG_AVOID_REUSE)
@@ -990,6 +1004,7 @@ bool CWallet::LoadToWallet(const uint256& hash, const UpdateWalletTxFn& fill_wtx
     if (/* insertion took place */ ins.second) {
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
     }
+    IndexWalletTx(wtx);
     AddToSpends(hash);
     for (const CTxIn& txin : wtx.tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
@@ -3428,9 +3443,13 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
     for (const uint256& hash : vHashOut) {
         const auto& it = mapWallet.find(hash);
         wtxOrdered.erase(it->second.m_it_wtxOrdered);
-        for (const auto& txin : it->second.tx->vin)
+        UnindexTx(hash);
+        for (const auto& txin : it->second.tx->vin) {
             mapTxSpends.erase(txin.prevout);
+            MarkBalanceDirty(txin.prevout.hash);
+        }
         mapWallet.erase(it);
+        MarkBalanceDirty(hash);
         NotifyTransactionChanged(this, hash, CT_DELETED);
     }
 
@@ -4311,6 +4330,10 @@ std::shared_ptr<CWallet> CWallet::Create(interfaces::Chain& chain, const std::st
         walletInstance->database->IncrementUpdateCounter();
     }
 
+    if (tip_height) {
+        walletInstance->ArchiveSpentTxns();
+    }
+
     {
         LOCK(cs_wallets);
         for (auto& load_wallet : g_load_wallet_fns) {
@@ -511,15 +511,7 @@ public:
     }
 
     //! make sure balances are recalculated
-    void MarkDirty()
-    {
-        m_amounts[DEBIT].Reset();
-        m_amounts[CREDIT].Reset();
-        m_amounts[IMMATURE_CREDIT].Reset();
-        m_amounts[AVAILABLE_CREDIT].Reset();
-        fChangeCached = false;
-        m_is_cache_empty = true;
-    }
+    void MarkDirty();
 
     //! filter decides which addresses will count towards the debit
     CAmount GetDebit(const isminefilter& filter) const;
@@ -974,6 +966,13 @@ public:
 
     //! For ParticlWallet, clear cached balances from wallet called at new block and adding new transaction
     virtual void ClearCachedBalances() {};
+    //! For ParticlWallet, balances of txn hash must be recalculated
+    virtual void MarkBalanceDirty(const uint256 &hash) const {};
+    //! For ParticlWallet, keep the filtertransactions indexes in sync with mapWallet
+    virtual void IndexWalletTx(const CWalletTx &wtx) {};
+    virtual void UnindexTx(const uint256 &hash) {};
+    //! For ParticlWallet, archive spent txns once the wallet is synced to the chain on load
+    virtual void ArchiveSpentTxns() {};
     void MarkDirty();
 
     //! Callback for updating transaction metadata in mapWallet.
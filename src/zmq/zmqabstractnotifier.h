@@ -7,6 +7,7 @@
 
 #include <util/memory.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -44,6 +45,7 @@ public:
             outbound_message_high_water_mark = sndhwm;
         }
     }
+    uint64_t GetDroppedMessages() const { return dropped_messages; }
 
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
@@ -69,6 +71,7 @@ protected:
     std::string type;
     std::string address;
     int outbound_message_high_water_mark; // aka SNDHWM
+    std::atomic<uint64_t> dropped_messages{0}; //!< messages not handed to the socket
 };
 
 #endif // BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
@@ -4,10 +4,12 @@
 
 #include <zmq/zmqpublishnotifier.h>
 
+#include <blockcache.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <rpc/server.h>
 #include <streams.h>
+#include <sync.h>
 #include <util/system.h>
 #include <util/strencodings.h>
 #include <smsg/smessage.h>
@@ -16,10 +18,16 @@
 
 #include <zmq.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstddef>
+#include <functional>
+#include <list>
 #include <map>
 #include <string>
+#include <thread>
 #include <utility>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
@@ -33,7 +41,7 @@ static const char *MSG_HASHWTX   = "hashwtx";
 static const char *MSG_SMSG      = "smsg";
 
 // Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
+static int zmq_send_multipart(void *sock, int flags, const void* data, size_t size, ...)
 {
     va_list args;
     va_start(args, size);
@@ -55,10 +63,13 @@ static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
 
         data = va_arg(args, const void*);
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
+        rc = zmq_msg_send(&msg, sock, flags | (data ? ZMQ_SNDMORE : 0));
         if (rc == -1)
         {
-            zmqError("Unable to send ZMQ msg");
+            // A full subscriber queue is reported by the caller as a dropped message
+            if (zmq_errno() != EAGAIN) {
+                zmqError("Unable to send ZMQ msg");
+            }
             zmq_msg_close(&msg);
             va_end(args);
             return -1;
@@ -76,6 +87,126 @@ static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
     return 0;
 }
 
+struct CZMQQueuedMessage
+{
+    CZMQAbstractPublishNotifier *notifier{nullptr};
+    const char *command{nullptr};
+    std::vector<unsigned char> data;
+    uint32_t skipped{0}; //!< sequence numbers dropped before this message
+};
+
+/**
+ * Messages of all publish notifiers waiting to be sent.
+ * The sockets are only written to from the publish thread, so
+ * notifications from validation never wait on ZMQ.
+ */
+class CZMQPublishQueue
+{
+public:
+    void Register();
+    void Unregister(CZMQAbstractPublishNotifier *notifier);
+    void Push(CZMQAbstractPublishNotifier *notifier, const char *command, const void *data, size_t size, size_t max_batch);
+
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::list<CZMQQueuedMessage> m_messages GUARDED_BY(m_mutex);
+    size_t m_num_notifiers GUARDED_BY(m_mutex){0};
+    const CZMQAbstractPublishNotifier *m_sending GUARDED_BY(m_mutex){nullptr};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+
+    void ThreadPublish();
+};
+
+static CZMQPublishQueue g_publish_queue;
+
+void CZMQPublishQueue::Register()
+{
+    LOCK(m_mutex);
+    if (m_num_notifiers++ == 0) {
+        m_stop = false;
+        m_thread = std::thread(&TraceThread<std::function<void()> >, "zmqpub", std::function<void()>(std::bind(&CZMQPublishQueue::ThreadPublish, this)));
+    }
+}
+
+void CZMQPublishQueue::Unregister(CZMQAbstractPublishNotifier *notifier)
+{
+    {
+        // Flush the notifier's messages before its socket can be closed
+        WAIT_LOCK(m_mutex, lock);
+        while (notifier->nQueued > 0 || m_sending == notifier) {
+            m_cond.wait(lock);
+        }
+        if (--m_num_notifiers > 0) {
+            return;
+        }
+        m_stop = true;
+        m_cond.notify_all();
+    }
+    m_thread.join();
+}
+
+void CZMQPublishQueue::Push(CZMQAbstractPublishNotifier *notifier, const char *command, const void *data, size_t size, size_t max_batch)
+{
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+
+    LOCK(m_mutex);
+    if (notifier->pBatch && notifier->nBatched < max_batch) {
+        notifier->pBatch->data.insert(notifier->pBatch->data.end(), p, p + size);
+        notifier->nBatched++;
+        return;
+    }
+
+    // A high water mark of 0 means no limit, as for the socket
+    const int hwm = notifier->GetOutboundMessageHighWaterMark();
+    if (hwm > 0 && notifier->nQueued >= (size_t)hwm) {
+        notifier->nSkipped++;
+        notifier->dropped_messages++;
+        return;
+    }
+
+    m_messages.emplace_back();
+    CZMQQueuedMessage &msg = m_messages.back();
+    msg.notifier = notifier;
+    msg.command = command;
+    msg.data.assign(p, p + size);
+    msg.skipped = notifier->nSkipped;
+    notifier->nSkipped = 0;
+    notifier->nQueued++;
+    notifier->pBatch = max_batch > 1 ? &msg : nullptr;
+    notifier->nBatched = 1;
+    m_cond.notify_all();
+}
+
+void CZMQPublishQueue::ThreadPublish()
+{
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        while (!m_stop && m_messages.empty()) {
+            m_cond.wait(lock);
+        }
+        if (m_messages.empty()) {
+            break;
+        }
+
+        CZMQAbstractPublishNotifier *notifier = m_messages.front().notifier;
+        if (notifier->pBatch == &m_messages.front()) {
+            notifier->pBatch = nullptr;
+        }
+        CZMQQueuedMessage msg = std::move(m_messages.front());
+        m_messages.pop_front();
+        notifier->nQueued--;
+        m_sending = notifier;
+        {
+            REVERSE_LOCK(lock);
+            notifier->SendQueuedMessage(msg.command, msg.data, msg.skipped);
+        }
+        m_sending = nullptr;
+        m_cond.notify_all();
+    }
+}
+
 bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
 {
     assert(!psocket);
@@ -85,13 +216,24 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
 
     if (i==mapPublishNotifiers.end())
     {
-        psocket = zmq_socket(pcontext, ZMQ_PUB);
+        // XPUB behaves as PUB for subscribers, but with ZMQ_XPUB_NODROP a
+        // subscriber at its high water mark fails the send instead of
+        // silently losing the message, so drops can be counted
+        psocket = zmq_socket(pcontext, ZMQ_XPUB);
         if (!psocket)
         {
             zmqError("Failed to create socket");
             return false;
         }
 
+        const int xpub_nodrop {1};
+        if (zmq_setsockopt(psocket, ZMQ_XPUB_NODROP, &xpub_nodrop, sizeof(xpub_nodrop)) != 0) {
+            zmqError("Failed to set ZMQ_XPUB_NODROP");
+            zmq_close(psocket);
+            psocket = nullptr;
+            return false;
+        }
+
         std::string sServerKey64 = gArgs.GetArg("-serverkeyzmq", "");
         if (sServerKey64.length() > 1)
         {
@@ -100,6 +242,7 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
             {
                 zmqError("No curve support.");
                 zmq_close(psocket);
+                psocket = nullptr;
                 return false;
             };
 
@@ -108,6 +251,7 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
             {
                 zmqError("Failed to decode server key");
                 zmq_close(psocket);
+                psocket = nullptr;
                 return false;
             };
 
@@ -123,6 +267,7 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
         {
             zmqError("Failed to set outbound message high water mark");
             zmq_close(psocket);
+            psocket = nullptr;
             return false;
         }
 
@@ -131,6 +276,7 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
         if (rc != 0) {
             zmqError("Failed to set SO_KEEPALIVE");
             zmq_close(psocket);
+            psocket = nullptr;
             return false;
         }
 
@@ -139,11 +285,13 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
         {
             zmqError("Failed to bind address");
             zmq_close(psocket);
+            psocket = nullptr;
             return false;
         }
 
         // register this notifier for the address, so it can be reused for other publish notifier
         mapPublishNotifiers.insert(std::make_pair(address, this));
+        g_publish_queue.Register();
         return true;
     }
     else
@@ -153,6 +301,7 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
 
         psocket = i->second->psocket;
         mapPublishNotifiers.insert(std::make_pair(address, this));
+        g_publish_queue.Register();
 
         return true;
     }
@@ -163,6 +312,8 @@ void CZMQAbstractPublishNotifier::Shutdown()
     // Early return if Initialize was not called
     if (!psocket) return;
 
+    g_publish_queue.Unregister(this);
+
     int count = mapPublishNotifiers.count(address);
 
     // remove this notifier from the list of publishers using this address
@@ -189,21 +340,35 @@ void CZMQAbstractPublishNotifier::Shutdown()
     psocket = nullptr;
 }
 
-bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, const void* data, size_t size)
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, const void* data, size_t size, size_t max_batch)
 {
     assert(psocket);
 
-    /* send three parts, command & data & a LE 4byte sequence number */
+    g_publish_queue.Push(this, command, data, size, max_batch);
+    return true;
+}
+
+void CZMQAbstractPublishNotifier::SendQueuedMessage(const char *command, const std::vector<unsigned char> &data, uint32_t skipped)
+{
+    /* dropped messages leave a gap in the sequence for subscribers to detect */
+    nSequence += skipped;
+
+    /* discard the subscription messages the XPUB socket queues for reading */
+    char sub[256];
+    while (zmq_recv(psocket, sub, sizeof(sub), ZMQ_DONTWAIT) >= 0) {
+    }
+
+    /* send three parts, command & data & a LE 4byte sequence number,
+       without waiting on subscribers which are at their high water mark */
     unsigned char msgseq[sizeof(uint32_t)];
     WriteLE32(&msgseq[0], nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), nullptr);
-    if (rc == -1)
-        return false;
+    int rc = zmq_send_multipart(psocket, ZMQ_DONTWAIT, command, strlen(command), data.data(), data.size(), msgseq, (size_t)sizeof(uint32_t), nullptr);
+    if (rc == -1) {
+        dropped_messages++;
+    }
 
-    /* increment memory only sequence number after sending */
+    /* increment memory only sequence number, also when sending failed */
     nSequence++;
-
-    return true;
 }
 
 bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
@@ -234,26 +399,33 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
     CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
     {
         LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
+        // The new tip is usually still in the recent block cache
+        std::shared_ptr<const CBlock> pblock = GetCachedBlock(pindex, consensusParams);
+        if (!pblock)
         {
             zmqError("Can't read block from disk");
             return false;
         }
 
-        ss << block;
+        ss << *pblock;
     }
 
     return SendZmqMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
 }
 
+bool CZMQPublishRawTransactionNotifier::Initialize(void *pcontext)
+{
+    max_batch = std::min(std::max(gArgs.GetArg("-zmqpubrawtxbatch", DEFAULT_ZMQ_RAWTX_BATCH), (int64_t)1), (int64_t)MAX_ZMQ_RAWTX_BATCH);
+    return CZMQAbstractPublishNotifier::Initialize(pcontext);
+}
+
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtx %s to %s\n", hash.GetHex(), this->address);
     CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
     ss << transaction;
-    return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size(), max_batch);
 }
 
 
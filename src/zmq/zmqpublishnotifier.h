@@ -7,22 +7,43 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <vector>
+
 class CBlockIndex;
+struct CZMQQueuedMessage;
+
+//! Raw transactions published in one rawtx message when sending falls behind
+static const int DEFAULT_ZMQ_RAWTX_BATCH {1};
+static const int MAX_ZMQ_RAWTX_BATCH {1000};
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
 private:
-    uint32_t nSequence {0U}; //!< upcounting per message sequence number
+    friend class CZMQPublishQueue;
+
+    uint32_t nSequence {0U}; //!< upcounting per message sequence number, only used on the publish thread
+
+    // Guarded by the publish queue mutex
+    size_t nQueued {0};                      //!< messages waiting in the publish queue
+    uint32_t nSkipped {0};                   //!< sequence numbers dropped since the last queued message
+    CZMQQueuedMessage *pBatch {nullptr};     //!< last queued message, while more data may be appended to it
+    size_t nBatched {0};                     //!< notifications in pBatch
+
+    void SendQueuedMessage(const char *command, const std::vector<unsigned char> &data, uint32_t skipped);
 
 public:
 
-    /* send zmq multipart message
+    /* queue zmq multipart message, sent from the publish thread
        parts:
           * command
           * data
           * message sequence number
+       Up to max_batch notifications are concatenated into one message
+       while the previous one is still waiting to be sent.
+       If the notifier's high water mark of messages is already queued,
+       the message is dropped and its sequence number skipped.
     */
-    bool SendZmqMessage(const char *command, const void* data, size_t size);
+    bool SendZmqMessage(const char *command, const void* data, size_t size, size_t max_batch = 1);
 
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
@@ -49,7 +70,11 @@ public:
 
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
 {
+private:
+    size_t max_batch {DEFAULT_ZMQ_RAWTX_BATCH};
+
 public:
+    bool Initialize(void *pcontext) override;
     using CZMQAbstractPublishNotifier::NotifyTransaction;
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
@@ -8,10 +8,11 @@
 # Test addressindex generation and fetching
 #
 
+import json
 import time
 
 from test_framework.test_particl import GhostTestFramework
-from test_framework.util import assert_equal
+from test_framework.util import assert_equal, rest_get
 
 
 class AddressIndexTest(GhostTestFramework):
@@ -21,7 +22,7 @@ class AddressIndexTest(GhostTestFramework):
         self.extra_args = [
             # Nodes 0/1 are "wallet" nodes
             ['-debug',],
-            ['-debug','-addressindex'],
+            ['-debug','-addressindex', '-rest'],
             # Nodes 2/3 are used for testing
             ['-debug','-addressindex',],
             ['-debug','-addressindex'],]
@@ -209,6 +210,13 @@ class AddressIndexTest(GhostTestFramework):
         assert_equal(len(utxos), 2)
         assert_equal(utxos[0]["satoshis"], 1500000000)
 
+        self.log.info("Testing REST...")
+        assert_equal(json.loads(rest_get(self.nodes[1], '/rest/addressdeltas/{}.json'.format(address2))), deltasAll)
+        assert_equal(json.loads(rest_get(self.nodes[1], '/rest/addressdeltas/{}/3/3.json'.format(address2))), deltas)
+        assert_equal(json.loads(rest_get(self.nodes[1], '/rest/addressutxos/{}.json'.format(address2))), utxos)
+        # Binary records are the 66 byte index key followed by the amount
+        assert_equal(len(rest_get(self.nodes[1], '/rest/addressdeltas/{}.bin'.format(address2))), 4 * (66 + 8))
+
         # Check that indexes will be updated with a reorg
         self.log.info("Testing reorg...")
         height_before = self.nodes[1].getblockcount()
@@ -7,8 +7,11 @@
 # Test addressindex generation and fetching
 #
 
+import json
+import os
+
 from test_framework.test_particl import GhostTestFramework
-from test_framework.util import assert_equal
+from test_framework.util import assert_equal, rest_get
 
 
 class SpentIndexTest(GhostTestFramework):
@@ -18,10 +21,10 @@ class SpentIndexTest(GhostTestFramework):
         self.extra_args = [
             # Nodes 0/1 are "wallet" nodes
             ['-debug',],
-            ['-debug','-spentindex'],
+            ['-debug','-spentindex', '-rest'],
             # Nodes 2/3 are used for testing
             ['-debug','-spentindex'],
-            ['-debug','-spentindex', '-txindex'],]
+            ['-debug','-spentindex', '-txindex', '-rest'],]
 
     def skip_test_if_missing_module(self):
         self.skip_if_no_wallet()
@@ -84,6 +87,11 @@ class SpentIndexTest(GhostTestFramework):
         assert_equal(info["index"], 0)
         assert_equal(info["height"], 1)
 
+        rest_info = json.loads(rest_get(nodes[1], '/rest/spentinfo/{}-{}.json'.format(unspent[0]["txid"], unspent[0]["vout"])))
+        assert_equal(rest_info, info)
+        rest_info_hex = rest_get(nodes[1], '/rest/spentinfo/{}-{}.hex'.format(unspent[0]["txid"], unspent[0]["vout"])).decode().strip()
+        assert_equal(rest_info_hex[:64], bytes.fromhex(sent_txid)[::-1].hex())
+
         print("Testing getrawtransaction method...")
 
         # Check that verbose raw transaction includes spent info
@@ -144,6 +152,27 @@ class SpentIndexTest(GhostTestFramework):
                 break
         assert(fFound)
 
+        # The REST endpoint streams the same deltas
+        rest_block = json.loads(rest_get(nodes[3], '/rest/blockdeltas/{}.json'.format(block1_hash)))
+        assert_equal(rest_block["deltas"], block["deltas"])
+        assert_equal(rest_block["height"], block["height"])
+        rest_block_bin = rest_get(nodes[3], '/rest/blockdeltas/{}.bin'.format(block1_hash))
+        assert_equal(rest_block_bin.hex(), rest_get(nodes[3], '/rest/blockdeltas/{}.hex'.format(block1_hash)).decode().strip())
+
+        # The range export resolves inputs from the undo data instead of the spent index
+        height = block["height"]
+        nodes[3].exportblockdeltas(height - 1, height, 'deltas.json', 'json')
+        with open(os.path.join(nodes[3].datadir, nodes[3].chain, 'deltas.json'), encoding='utf8') as f:
+            lines = [json.loads(line) for line in f]
+        assert_equal(len(lines), 2)
+        assert_equal(lines[1]["hash"], block1_hash)
+        assert_equal(lines[1]["deltas"], block["deltas"])
+        rest_lines = rest_get(nodes[3], '/rest/blockdeltasrange/{}/{}.json'.format(height - 1, height)).decode().splitlines()
+        assert_equal([json.loads(line) for line in rest_lines], lines)
+        nodes[3].exportblockdeltas(0, height, 'deltas.dat')
+        with open(os.path.join(nodes[3].datadir, nodes[3].chain, 'deltas.dat'), 'rb') as f:
+            assert_equal(f.read(), rest_get(nodes[3], '/rest/blockdeltasrange/0/{}.bin'.format(height)))
+
         print("Passed\n")
 
 
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 Ghost Core Team
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+import random
+import string
+import time
+
+from test_framework.test_particl import GhostTestFramework
+
+
+NUM_MESSAGES = 8
+MESSAGE_LEN = 3000  # Each smsgMsg is larger than the 1000 byte peer queue
+
+
+class SmsgHandlerThreadTest(GhostTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True  # Don't copy from cache
+        self.num_nodes = 2
+        self.extra_args = [['-debug=smsg', '-smsghandlerthread', '-smsgmaxpeerqueue=1'] for i in range(self.num_nodes)]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def setup_network(self, split=False):
+        self.add_nodes(self.num_nodes, extra_args=self.extra_args)
+        self.start_nodes()
+        self.connect_nodes_bi(0, 1)
+
+    def run_test(self):
+        nodes = self.nodes
+
+        nodes[0].extkeyimportmaster(nodes[0].mnemonic('new')['master'])
+        nodes[1].extkeyimportmaster(nodes[1].mnemonic('new')['master'])
+
+        address0 = nodes[0].getnewaddress()
+        address1 = nodes[1].getnewaddress()
+        nodes[0].smsgaddlocaladdress(address0)
+        nodes[1].smsgaddaddress(address0, nodes[0].smsglocalkeys()['wallet_keys'][0]['public_key'])
+
+        self.log.info('Send messages larger than the peer queue limit')
+        # Random text so the payload doesn't compress below the queue limit
+        texts = set()
+        with nodes[0].assert_debug_log(['smsg receive queue drained, resuming peer='], timeout=60):
+            for i in range(NUM_MESSAGES):
+                text = '{} '.format(i) + ''.join(random.choice(string.ascii_letters) for _ in range(MESSAGE_LEN))
+                ro = nodes[1].smsgsend(address1, address0, text)
+                assert(ro['result'] == 'Sent.')
+                texts.add(text)
+
+            self.log.info('Check every message arrives')
+            for i in range(60):
+                ro = nodes[0].smsginbox('all')
+                if len(ro['messages']) >= NUM_MESSAGES:
+                    break
+                time.sleep(1)
+
+        assert(len(ro['messages']) == NUM_MESSAGES)
+        assert(set(m['text'] for m in ro['messages']) == texts)
+        assert(all(m['from'] == address1 for m in ro['messages']))
+
+        self.log.info('Check the peer queues are empty')
+        for node in nodes:
+            for peer in node.smsgpeers():
+                assert(peer['num_queued'] == 0)
+                assert(peer['queued_bytes'] == 0)
+            assert(len(node.getpeerinfo()) == 1)
+
+
+if __name__ == '__main__':
+    SmsgHandlerThreadTest().main()
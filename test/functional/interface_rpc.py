@@ -34,6 +34,15 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_equal(command['method'], 'getrpcinfo')
         assert_greater_than_or_equal(command['duration'], 0)
         assert_equal(info['logpath'], os.path.join(self.nodes[0].datadir, self.chain, 'debug.log'))
+        assert_equal(info['batch_threads'], 0)
+
+        stats = self.nodes[0].getrpcinfo()['methods']['getrpcinfo']
+        assert_equal(stats['limit'], 0)
+        assert_equal(stats['active'], 1)
+        assert_greater_than_or_equal(stats['calls'], 1)
+        assert_equal(stats['errors'], 0)
+        assert_equal(sum(stats['latency'].values()), stats['calls'])
+        assert_equal(sum(stats['depth'].values()), stats['calls'] + 1)
 
     def test_batch_request(self):
         self.log.info("Testing basic JSON-RPC batch request...")
@@ -61,6 +70,39 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_equal(result_by_id[3]['error'], None)
         assert result_by_id[3]['result'] is not None
 
+    def test_parallel_batch_request(self):
+        self.log.info("Testing JSON-RPC batch requests executed in parallel...")
+
+        self.restart_node(0, extra_args=['-rpcbatchthreads=4', '-rpcmethodlimit=getblockhash:1'])
+        info = self.nodes[0].getrpcinfo()
+        assert_equal(info['batch_threads'], 4)
+        assert_equal(info['methods']['getblockhash']['limit'], 1)
+
+        genesis = self.nodes[0].getblockhash(0)
+        batch = []
+        for i in range(50):
+            batch.append({"method": "getblockhash", "id": 2 * i, "params": [0]})
+            batch.append({"method": "getblockheader" if i % 2 else "invalidmethod", "id": 2 * i + 1, "params": [genesis]})
+        results = self.nodes[0].batch(batch)
+
+        # Results are returned in request order
+        assert_equal([res['id'] for res in results], list(range(100)))
+        for i, res in enumerate(results):
+            if i % 4 == 1:
+                assert_equal(res['error']['code'], -32601)
+            else:
+                assert_equal(res['error'], None)
+
+        stats = self.nodes[0].getrpcinfo()['methods']['getblockhash']
+        assert_equal(stats['active'], 0)
+        assert_equal(stats['calls'], 51)
+        assert_equal(sum(stats['wait'].values()), 51)
+        assert_equal(self.nodes[0].getrpcinfo()['methods']['getblockheader']['calls'], 25)
+
+        self.stop_node(0)
+        self.nodes[0].assert_start_raises_init_error(['-rpcmethodlimit=getblockhash'], 'Error: Invalid -rpcmethodlimit value getblockhash, expected <method>:<n>')
+        self.start_node(0)
+
     def test_http_status_codes(self):
         self.log.info("Testing HTTP status codes for JSON-RPC requests...")
 
@@ -70,6 +112,7 @@ class RPCInterfaceTest(BitcoinTestFramework):
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_request()
+        self.test_parallel_batch_request()
         self.test_http_status_codes()
 
 
@@ -75,6 +75,8 @@ class ZMQTest (BitcoinTestFramework):
             self.test_mempool_sync()
             self.test_reorg()
             self.test_multiple_interfaces()
+            self.test_rawtx_batch()
+            self.test_dropped()
         finally:
             # Destroy the ZMQ context.
             self.log.debug("Destroying ZMQ context")
@@ -159,10 +161,10 @@ class ZMQTest (BitcoinTestFramework):
 
         self.log.info("Test the getzmqnotifications RPC")
         assert_equal(self.nodes[0].getzmqnotifications(), [
-            {"type": "pubhashblock", "address": address, "hwm": 1000},
-            {"type": "pubhashtx", "address": address, "hwm": 1000},
-            {"type": "pubrawblock", "address": address, "hwm": 1000},
-            {"type": "pubrawtx", "address": address, "hwm": 1000},
+            {"type": "pubhashblock", "address": address, "hwm": 1000, "dropped": 0},
+            {"type": "pubhashtx", "address": address, "hwm": 1000, "dropped": 0},
+            {"type": "pubrawblock", "address": address, "hwm": 1000, "dropped": 0},
+            {"type": "pubrawtx", "address": address, "hwm": 1000, "dropped": 0},
         ])
 
         assert_equal(self.nodes[1].getzmqnotifications(), [])
@@ -529,5 +531,81 @@ class ZMQTest (BitcoinTestFramework):
         assert_equal(self.nodes[0].getbestblockhash(), subscribers[0]['hashblock'].receive().hex())
         assert_equal(self.nodes[0].getbestblockhash(), subscribers[1]['hashblock'].receive().hex())
 
+    def test_rawtx_batch(self):
+        self.log.info("Test that batched rawtx messages hold the transactions in order")
+        address = 'tcp://127.0.0.1:28336'
+        max_batch = 10
+        socket = self.ctx.socket(zmq.SUB)
+        socket.set(zmq.RCVTIMEO, 60000)
+        rawtx = ZMQSubscriber(socket, b"rawtx")
+        socket.connect(address)
+
+        self.restart_node(0, ['-zmqpubrawtx=%s' % address, '-zmqpubrawtxbatch=%d' % max_batch])
+
+        # Relax so that the subscriber is ready before publishing zmq messages
+        sleep(0.2)
+
+        blockhashes = self.nodes[0].generatetoaddress(100, ADDRESS_BCRT1_UNSPENDABLE)
+        expected_txids = [self.nodes[0].getblock(blockhash)['tx'][0] for blockhash in blockhashes]
+
+        # The body of each message is one or more serialized transactions,
+        # receive() checks that no sequence number was skipped
+        txids = []
+        while len(txids) < len(expected_txids):
+            body = rawtx.receive()
+            stream = BytesIO(body)
+            num_txns = 0
+            while stream.tell() < len(body):
+                tx = CTransaction()
+                tx.deserialize(stream)
+                tx.calc_sha256()
+                txids.append(tx.hash)
+                num_txns += 1
+            assert 1 <= num_txns <= max_batch
+        assert_equal(txids, expected_txids)
+        assert_equal(self.nodes[0].getzmqnotifications()[0]['dropped'], 0)
+
+    def test_dropped(self):
+        self.log.info("Test that messages a slow subscriber can't take are counted and skip sequence numbers")
+        address = 'tcp://127.0.0.1:28337'
+        socket = self.ctx.socket(zmq.SUB)
+        socket.set(zmq.RCVHWM, 1)
+        socket.set(zmq.RCVBUF, 1024)
+        socket.set(zmq.RCVTIMEO, 60000)
+        socket.setsockopt(zmq.SUBSCRIBE, b"rawblock")
+        socket.connect(address)
+
+        self.restart_node(0, ['-zmqpubrawblock=%s' % address, '-zmqpubrawblockhwm=1'])
+        sleep(0.2)
+
+        # Don't read until the buffers between node and subscriber are full
+        # and the node has to drop messages
+        start_height = self.nodes[0].getblockcount()
+        num_blocks = 0
+        while self.nodes[0].getzmqnotifications()[0]['dropped'] == 0:
+            assert num_blocks < 5000
+            self.nodes[0].generatetoaddress(50, ADDRESS_BCRT1_UNSPENDABLE)
+            num_blocks += 50
+
+        # Every block is either received or counted as dropped, and each
+        # received message's sequence number is that of its block
+        received = 0
+        skipped = 0
+        next_sequence = 0
+        while received + self.nodes[0].getzmqnotifications()[0]['dropped'] < num_blocks:
+            topic, body, seq = socket.recv_multipart()
+            assert_equal(topic, b"rawblock")
+            sequence = struct.unpack('<I', seq)[-1]
+            assert sequence >= next_sequence
+            assert_equal(hash256_reversed(body[:80]).hex(), self.nodes[0].getblockhash(start_height + 1 + sequence))
+            skipped += sequence - next_sequence
+            next_sequence = sequence + 1
+            received += 1
+        dropped = self.nodes[0].getzmqnotifications()[0]['dropped']
+        assert_equal(received + dropped, num_blocks)
+        assert dropped > 0
+        # Messages dropped after the last received one leave no gap yet
+        assert_equal(skipped + num_blocks - next_sequence, dropped)
+
 if __name__ == '__main__':
     ZMQTest().main()
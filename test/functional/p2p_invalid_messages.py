@@ -5,6 +5,7 @@
 """Test node responses to invalid network messages."""
 
 import struct
+import sys
 import time
 
 from test_framework.messages import (
@@ -24,7 +25,7 @@ from test_framework.p2p import (
     P2PDataStore,
     P2PInterface,
 )
-from test_framework.test_framework import BitcoinTestFramework
+from test_framework.test_framework import BitcoinTestFramework, SkipTest
 from test_framework.util import (
     assert_equal,
     hex_str_to_bytes,
@@ -54,11 +55,24 @@ class SenderOfAddrV2(P2PInterface):
 
 
 class InvalidMessagesTest(BitcoinTestFramework):
+    def add_options(self, parser):
+        parser.add_argument("--socketevents", dest="socketevents", default=None,
+                            help="Socket readiness backend passed to the node (epoll or poll)")
+
     def set_test_params(self):
         self.num_nodes = 1
         self.setup_clean_chain = True
         self.extra_args = [["-whitelist=addr@127.0.0.1"]]
 
+    def skip_test_if_missing_module(self):
+        if self.options.socketevents == 'epoll' and not sys.platform.startswith('linux'):
+            raise SkipTest("epoll is only available on Linux")
+
+    def setup_network(self):
+        if self.options.socketevents is not None:
+            self.extra_args[0].append("-socketevents={}".format(self.options.socketevents))
+        self.setup_nodes()
+
     def run_test(self):
         self.test_buffer()
         self.test_magic_bytes()
@@ -5,11 +5,12 @@
 """Test ping message
 """
 
+import sys
 import time
 
 from test_framework.messages import msg_pong
 from test_framework.p2p import P2PInterface
-from test_framework.test_framework import BitcoinTestFramework
+from test_framework.test_framework import BitcoinTestFramework, SkipTest
 from test_framework.util import assert_equal
 
 PING_INTERVAL = 2 * 60
@@ -31,11 +32,24 @@ class NodeNoPong(P2PInterface):
 
 
 class PingPongTest(BitcoinTestFramework):
+    def add_options(self, parser):
+        parser.add_argument("--socketevents", dest="socketevents", default=None,
+                            help="Socket readiness backend passed to the node (epoll or poll)")
+
     def set_test_params(self):
         self.setup_clean_chain = True
         self.num_nodes = 1
         self.extra_args = [['-peertimeout=3']]
 
+    def skip_test_if_missing_module(self):
+        if self.options.socketevents == 'epoll' and not sys.platform.startswith('linux'):
+            raise SkipTest("epoll is only available on Linux")
+
+    def setup_network(self):
+        if self.options.socketevents is not None:
+            self.extra_args[0].append('-socketevents={}'.format(self.options.socketevents))
+        self.setup_nodes()
+
     def check_peer_info(self, *, pingtime, minping, pingwait):
         stats = self.nodes[0].getpeerinfo()[0]
         assert_equal(stats.pop('pingtime', None), pingtime)
@@ -42,6 +42,11 @@ class RpcMiscTest(BitcoinTestFramework):
         assert_greater_than(memory['chunks_free'], 0)
         assert_equal(memory['used'] + memory['free'], memory['total'])
 
+        blockcache = node.getmemoryinfo()['blockcache']
+        assert_equal(blockcache['max'], 32 * 1024 * 1024)
+        assert_greater_than_or_equal(blockcache['max'], blockcache['usage'])
+        assert_equal(blockcache['hits'], blockcache['block']['hits'] + blockcache['raw']['hits'] + blockcache['compact']['hits'])
+
         self.log.info("test mallocinfo")
         try:
             mallocinfo = node.getmemoryinfo(mode="mallocinfo")
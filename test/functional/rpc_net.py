@@ -44,7 +44,7 @@ class NetTest(BitcoinTestFramework):
     def set_test_params(self):
         self.setup_clean_chain = True
         self.num_nodes = 2
-        self.extra_args = [["-minrelaytxfee=0.00001000"], ["-minrelaytxfee=0.00000500"]]
+        self.extra_args = [["-minrelaytxfee=0.00001000", "-msghandlerthreads=2"], ["-minrelaytxfee=0.00000500"]]
         self.supports_cli = False
 
     def run_test(self):
@@ -144,6 +144,12 @@ class NetTest(BitcoinTestFramework):
         assert_equal(info['connections_in'], 1)
         assert_equal(info['connections_out'], 1)
 
+        # Peers are split between the message handler threads
+        handlers = info['messagehandlers']
+        assert_equal([h['name'] for h in handlers], ['msghand', 'msghand.1'])
+        assert_equal(sum(h['peers'] for h in handlers), 2)
+        assert_equal(len(self.nodes[1].getnetworkinfo()['messagehandlers']), 1)
+
         # check the `servicesnames` field
         network_info = [node.getnetworkinfo() for node in self.nodes]
         for info in network_info:
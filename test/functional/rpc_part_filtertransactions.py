@@ -209,6 +209,35 @@ class FilterTransactionsTest(GhostTestFramework):
         })
         assert(float(ro[0]['amount']) == -20.0)
 
+        #
+        # cursor
+        #
+
+        ro_all = nodes[0].filtertransactions({ 'count': 0 })
+        txids = []
+        cursor = ''
+        while True:
+            ro = nodes[0].filtertransactions({ 'count': 4, 'cursor': cursor })
+            txids += [t['txid'] for t in ro['tx']]
+            cursor = ro['next_cursor']
+            if cursor == '':
+                break
+        assert(txids == [t['txid'] for t in ro_all])
+
+        # cursor with a sort other than time => JSONRPCException
+        try:
+            nodes[0].filtertransactions({ 'sort': 'amount', 'cursor': '' })
+            assert(False)
+        except JSONRPCException as e:
+            assert('cursor requires sort by time' in e.error['message'])
+
+        # invalid cursor => JSONRPCException
+        try:
+            nodes[0].filtertransactions({ 'cursor': 'invalid' })
+            assert(False)
+        except JSONRPCException as e:
+            assert('Invalid cursor' in e.error['message'])
+
         #
         # include_watchonly
         #
@@ -9,6 +9,7 @@ from binascii import unhexlify
 from decimal import Decimal, ROUND_DOWN
 from subprocess import CalledProcessError
 import hashlib
+import http.client
 import inspect
 import json
 import logging
@@ -16,6 +17,7 @@ import os
 import re
 import time
 import unittest
+import urllib.parse
 
 from . import coverage
 from .authproxy import AuthServiceProxy, JSONRPCException
@@ -420,6 +422,16 @@ def set_node_times(nodes, t):
         node.setmocktime(t)
 
 
+def rest_get(node, uri):
+    """Return the body of a successful REST request to the node."""
+    url = urllib.parse.urlparse(node.url)
+    conn = http.client.HTTPConnection(url.hostname, url.port)
+    conn.request('GET', uri)
+    resp = conn.getresponse()
+    assert_equal(resp.status, 200)
+    return resp.read()
+
+
 # Transaction/Block functions
 #############################
 
@@ -195,6 +195,7 @@ BASE_SCRIPTS = [
     'p2p_invalid_locator.py',
     'p2p_invalid_block.py',
     'p2p_invalid_messages.py',
+    'p2p_invalid_messages.py --socketevents=epoll',
     'p2p_invalid_tx.py',
     'feature_assumevalid.py',
     'example_test.py',
@@ -274,6 +275,7 @@ BASE_SCRIPTS = [
     'rpc_deriveaddresses.py',
     'rpc_deriveaddresses.py --usecli',
     'p2p_ping.py',
+    'p2p_ping.py --socketevents=epoll',
     'rpc_scantxoutset.py',
     'feature_logging.py',
     'p2p_node_network_limited.py',
@@ -308,6 +310,9 @@ PARTICL_SCRIPTS = [
     'feature_part_smsgpaidfee.py',
     'wallet_part_multisig.py',
     'wallet_part_multiwallet.py',
+    'wallet_part_lazyload.py',
+    'wallet_part_stakearchive.py',
+    'wallet_part_consolidation.py',
     'feature_part_coldstaking.py',
     'rpc_part_filtertransactions.py',
     'feature_part_vote.py',
@@ -335,6 +340,7 @@ PARTICL_SCRIPTS = [
 PARTICL_SCRIPTS_EXT = [
     'feature_part_smsg_multiwallet.py',
     'feature_part_smsg_rollingcache.py',
+    'feature_part_smsg_handlerthread.py',
     'feature_part_treasury_fund.py',
     'rpc_part_tracefrozenoutputs.py',
     'feature_part_vote_extra.py',
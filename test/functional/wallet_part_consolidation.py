@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Particl Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+from test_framework.test_particl import GhostTestFramework
+
+
+class WalletParticlConsolidationTest(GhostTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [ ['-debug', '-noacceptnonstdtxn', '-reservebalance=10000000'] for i in range(self.num_nodes)]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def setup_network(self, split=False):
+        self.add_nodes(self.num_nodes, extra_args=self.extra_args)
+        self.start_nodes()
+        self.connect_nodes_bi(0, 1)
+
+    def run_test(self):
+        nodes = self.nodes
+
+        self.import_genesis_coins_a(nodes[0])
+        nodes[1].extkeyimportmaster(nodes[1].mnemonic('new')['master'])
+
+        addr1 = nodes[1].getnewaddress()
+        outputs = [{'address': addr1, 'amount': 0.1} for i in range(25)]
+        txid = nodes[0].sendtypeto('part', 'part', outputs)
+        self.wait_for_mempool(nodes[0], txid)
+        self.stakeBlocks(1)
+        assert(len(nodes[1].listunspent()) == 25)
+        assert('consolidation' not in nodes[1].getwalletinfo())
+
+        self.log.info('Test consolidation is skipped while the fee rate is high')
+        ro = nodes[1].walletsettings('consolidation', {'enabled': True, 'types': ['part'], 'maxfeerate': 0.00000001})
+        assert(ro['consolidation']['enabled'] is True)
+        self.wait_until(lambda: nodes[1].getwalletinfo()['consolidation']['skipped_fee'] > 0)
+        assert(nodes[1].getwalletinfo()['consolidation']['part']['planned'] == 0)
+
+        self.log.info('Test consolidating small outputs')
+        nodes[1].walletsettings('consolidation', {'enabled': True, 'types': ['part'], 'mininputs': 20, 'maxinputs': 20})
+        self.wait_until(lambda: nodes[1].getwalletinfo()['consolidation']['part']['executed'] == 1)
+        info = nodes[1].getwalletinfo()['consolidation']
+        assert(info['part']['planned'] == 1)
+        assert(info['part']['executed_inputs'] == 20)
+        assert(info['blind']['planned'] == 0)
+        txid = info['last_txid']
+        self.wait_for_mempool(nodes[0], txid)
+        assert(len(nodes[1].gettransaction(txid, False, True)['decoded']['vin']) == 20)
+
+        self.stakeBlocks(1)
+        assert(len(nodes[1].listunspent()) == 6)
+
+        self.log.info('Test invalid settings are rejected')
+        try:
+            nodes[1].walletsettings('consolidation', {'types': ['coins']})
+            assert(False)
+        except Exception as e:
+            assert('Unknown type' in str(e))
+
+
+if __name__ == '__main__':
+    WalletParticlConsolidationTest().main()
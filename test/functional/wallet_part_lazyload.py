@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Particl Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+from test_framework.test_particl import GhostTestFramework
+
+
+class WalletParticlLazyLoadTest(GhostTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [ ['-debug', '-noacceptnonstdtxn', '-reservebalance=10000000'] for i in range(self.num_nodes)]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def setup_network(self, split=False):
+        self.add_nodes(self.num_nodes, extra_args=self.extra_args)
+        self.start_nodes()
+        self.connect_nodes_bi(0, 1)
+
+    def reload_wallet(self, node):
+        node.unloadwallet('default_wallet')
+        return node.loadwallet('default_wallet')['load_stats']
+
+    def run_test(self):
+        nodes = self.nodes
+
+        self.import_genesis_coins_a(nodes[0])
+        nodes[1].extkeyimportmaster(nodes[1].mnemonic('new')['master'])
+
+        sx_addr1 = nodes[1].getnewstealthaddress()
+        addr0 = nodes[0].getnewaddress()
+        nodes[0].sendtypeto('part', 'blind', [{'address': sx_addr1, 'amount': 10.0}])
+        self.stakeBlocks(1)
+
+        # Spend all blind outputs so the records can be archived
+        blind_balance = nodes[1].getbalances()['mine']['blind_trusted']
+        spend_txid = nodes[1].sendtypeto('blind', 'part', [{'address': addr0, 'amount': blind_balance, 'subfee': True}])
+        self.sync_all()
+        self.stakeBlocks(3)
+
+        balances_before = nodes[1].getbalances()
+        txids_before = [t['txid'] for t in nodes[1].filtertransactions({'count': 0})]
+
+        stats = self.reload_wallet(nodes[1])
+        num_records = stats['records']
+        assert(num_records > 0)
+        assert(stats['records_archived'] == 0)
+
+        self.log.info('Test lazy loading records')
+        ro = nodes[1].walletsettings('lazyload', {'records': True, 'mindepth': 2})
+        assert(ro['lazyload']['records'] is True)
+
+        stats = self.reload_wallet(nodes[1])
+        assert(stats['records_newly_archived'] > 0)
+        assert(stats['records_archived'] == stats['records_newly_archived'])
+        assert(stats['records'] + stats['records_archived'] == num_records)
+
+        stats = self.reload_wallet(nodes[1])
+        assert(stats['records_newly_archived'] == 0)
+        assert(stats['records'] + stats['records_archived'] == num_records)
+
+        assert(nodes[1].getbalances() == balances_before)
+        assert([t['txid'] for t in nodes[1].filtertransactions({'count': 0})] == txids_before)
+        assert(nodes[1].gettransaction(spend_txid)['txid'] == spend_txid)
+
+        self.log.info('Test restoring archived records')
+        nodes[1].walletsettings('lazyload', {'records': False})
+        stats = self.reload_wallet(nodes[1])
+        assert(stats['records_restored'] > 0)
+        assert(stats['records_archived'] == 0)
+        assert(stats['records'] == num_records)
+        assert(nodes[1].getbalances() == balances_before)
+
+
+if __name__ == '__main__':
+    WalletParticlLazyLoadTest().main()
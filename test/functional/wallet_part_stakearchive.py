@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Particl Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+from test_framework.test_particl import GhostTestFramework
+from test_framework.util import assert_raises_rpc_error
+
+
+class WalletParticlStakeArchiveTest(GhostTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [ ['-debug', '-noacceptnonstdtxn', '-reservebalance=10000000'] for i in range(self.num_nodes)]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def setup_network(self, split=False):
+        self.add_nodes(self.num_nodes, extra_args=self.extra_args)
+        self.start_nodes()
+        self.connect_nodes_bi(0, 1)
+
+    def reload_wallet(self, node):
+        node.unloadwallet('default_wallet')
+        return node.loadwallet('default_wallet')['load_stats']
+
+    def run_test(self):
+        nodes = self.nodes
+
+        self.import_genesis_coins_a(nodes[0])
+        # Coinstakes must be buried by the stake maturity depth, 12 on regtest, to be archived
+        self.stakeBlocks(30)
+
+        balances_before = nodes[0].getbalances()
+        txids_before = [t['txid'] for t in nodes[0].filtertransactions({'count': 0, 'category': 'stake'})]
+        assert(len(txids_before) > 0)
+
+        stats = self.reload_wallet(nodes[0])
+        assert(stats['stakes_archived'] == 0)
+        assert('stakearchive' not in nodes[0].getstakinginfo())
+
+        self.log.info('Test archiving spent coinstakes')
+        assert_raises_rpc_error(-8, 'mindepth must be at least the stake maturity depth', nodes[0].walletsettings, 'stakearchive', {'enabled': True, 'mindepth': 1})
+        ro = nodes[0].walletsettings('stakearchive', {'enabled': True, 'mindepth': 12})
+        assert(ro['stakearchive']['enabled'] is True)
+
+        stats = self.reload_wallet(nodes[0])
+        num_archived = stats['stakes_newly_archived']
+        assert(num_archived > 0)
+        assert(stats['stakes_archived'] == num_archived)
+
+        stats = self.reload_wallet(nodes[0])
+        assert(stats['stakes_newly_archived'] == 0)
+        assert(stats['stakes_archived'] == num_archived)
+
+        assert(nodes[0].getbalances() == balances_before)
+        assert([t['txid'] for t in nodes[0].filtertransactions({'count': 0, 'category': 'stake'})] == txids_before)
+        assert(nodes[0].gettransaction(txids_before[-1])['txid'] == txids_before[-1])
+
+        archive_info = nodes[0].getstakinginfo()['stakearchive']
+        assert(archive_info['stakes'] >= num_archived)
+        assert(archive_info['filesize'] > 0)
+        assert(sum([m['stakes'] for m in archive_info['months']]) == archive_info['stakes'])
+        # The inputs of archived coinstakes are archived coinstakes or genesis outputs, all have a value
+        for m in archive_info['months']:
+            assert(m['staked'] > 0)
+            assert(m['reward'] < m['staked'])
+
+        self.log.info('Test staking continues with archived coinstakes')
+        self.stakeBlocks(2)
+        assert(nodes[0].getblockcount() == 32)
+
+
+if __name__ == '__main__':
+    WalletParticlStakeArchiveTest().main()